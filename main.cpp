@@ -11,12 +11,19 @@
 
 #include "mbed.h"
 #include "node_api.h"
+#include "node_sensor.h"
+#include "node_uplink.h"
+#include "node_airtime.h"
+#include "node_series.h"
+#include "node_window.h"
+#include "platform/mbed_minimal_printf.h"
 
 #define WISE_VERSION                  "1510S10MMV0106"
 #define NODE_AUTOGEN_APPKEY
 
 #define NODE_SENSOR_TEMP_HUM_ENABLE    1    ///< Enable or disable TEMP/HUM sensor report, default disable
 #define NODE_SENSOR_CO2_VOC_ENABLE     0    ///< Enable or disable CO2/VOC sensor report, default disable
+#define NODE_SENSOR_ENABLE             (NODE_SENSOR_TEMP_HUM_ENABLE||NODE_SENSOR_CO2_VOC_ENABLE)
 
 #define NODE_DEBUG(x,args...) node_printf_to_serial(x,##args)
 
@@ -24,6 +31,16 @@
 #define NODE_ACTIVE_PERIOD_IN_SEC      (node_sensor_report_interval)     ///< Period time to read/send sensor data  >= 3sec
 #define NODE_RXWINDOW_PERIOD_IN_SEC    4    ///< Rx windown time  
 #define NODE_ACTIVE_TX_PORT            1    ///< Lora Port to send data
+#define NODE_SENSOR_UPLINK_KEY         1    ///< Coalescing key of the sensor readings in the uplink queue
+// Series frames need a decoder of the type 0x0d on the server: build with -DNODE_SENSOR_SERIES_SAMPLES=6 to enable them
+#ifndef NODE_SENSOR_SERIES_SAMPLES
+#define NODE_SENSOR_SERIES_SAMPLES     1    ///< Readings packed per uplink, 1 to send each reading in its own TLV frame
+#endif
+// Summary TLVs need a decoder of the types with 0x80 set on the server: build with -DNODE_SENSOR_SUMMARY_ENABLE=1 to enable them
+#ifndef NODE_SENSOR_SUMMARY_ENABLE
+#define NODE_SENSOR_SUMMARY_ENABLE     0    ///< Summarize the samples of each report period: the mean in a series, the summary TLVs otherwise; 0 for the last sample
+#endif
+#define NODE_SENSOR_SUMMARY_QUANTILE   90   ///< Percentile of the samples in the summary TLVs, 0 for none
 
 #define NODE_M2_COM_UART 0    ///< Declare M2 COM UART for easy debug
 #define NODE_WISE_1510E MBED_CONF_TARGET_LSE_AVAILABLE
@@ -67,6 +84,15 @@ static char node_class=1;
 static char node_op_mode=1;
 static char node_act_mode=1;
 static char node_beacon_state=NODE_BCN_STATE_LOTTERY1;
+#define NODE_TX_DONE_SLOTS  4      ///< TX done results the state loop may fall behind by
+static volatile unsigned char node_tx_done_rc[NODE_TX_DONE_SLOTS];
+static volatile unsigned char node_tx_done_head=0;  ///< Results written by the TX done callback
+static volatile unsigned char node_tx_done_tail=0;  ///< Results read by the state loop
+static unsigned int node_report_ms; ///< Time of the last reading queued
+static int node_data_rate=-1;       ///< Data rate of the Advanwise modes, -1 when the stack picks it
+static unsigned int node_freq_hz;   ///< Frequency of Advanwise mode 1, 0 for the default channels
+static int node_airtime_sub_band;   ///< Duty cycle sub-band of the uplinks
+static int node_max_payload=NODE_UPLINK_FRAME_SIZE; ///< Largest payload of the sensor frames
 
 #if NODE_SENSOR_TEMP_HUM_ENABLE
 static unsigned int  node_sensor_temp_hum=0; ///<Temperature and humidity sensor global
@@ -75,8 +101,66 @@ static unsigned int  node_sensor_temp_hum=0; ///<Temperature and humidity sensor
 static  unsigned int node_sensor_voc_co2=0; ///<Voc and CO2 sensor global
 #endif
 
+#if NODE_SENSOR_SUMMARY_ENABLE
+typedef enum
+{
+    #if NODE_SENSOR_TEMP_HUM_ENABLE
+    NODE_WINDOW_TEMP,
+    NODE_WINDOW_HUM,
+    #endif
+    #if NODE_SENSOR_CO2_VOC_ENABLE
+    NODE_WINDOW_CO2,
+    NODE_WINDOW_TVOC,
+    #endif
+    NODE_WINDOW_COUNT
+}node_window_channel_t;
+
+///< TLV types of the windows
+static const unsigned char node_window_types[NODE_WINDOW_COUNT]={
+    #if NODE_SENSOR_TEMP_HUM_ENABLE
+    0x1, 0x2,
+    #endif
+    #if NODE_SENSOR_CO2_VOC_ENABLE
+    0x3, 0x4,
+    #endif
+};
+
+static node_window_t node_windows[NODE_WINDOW_COUNT]; ///< Samples of the report period, folded in by the sensor thread
+
+/** @brief Fold a sample into the window of its channel
+ *
+ */
+static void node_window_sample(node_window_channel_t channel, int value)
+{
+    core_util_critical_section_enter();
+    node_window_add(&node_windows[channel], value);
+    core_util_critical_section_exit();
+}
+#endif
+
 I2C i2c(PC_1, PC_0); ///<i2C define
 
+#if NODE_SENSOR_ENABLE
+static EventQueue node_sensor_queue(NODE_SENSOR_QUEUE_EVENTS*EVENTS_EVENT_SIZE); ///< Sensor sampling queue
+static Thread node_sensor_thread(osPriorityNormal, NODE_SENSOR_STACK_SIZE); ///< Thread dispatching the sensor queue
+static I2CBus node_i2c_bus(i2c, &node_sensor_queue); ///< Sensor I2C transactions
+#endif
+
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF
+/** @brief write formatted characters to a serial port
+ *
+ *  @param context serial port
+ *  @param data characters to write
+ *  @param length number of characters
+ *  @returns 0 on success
+ */
+static int node_serial_sink(void *context, const char *data, size_t length)
+{
+    ((RawSerial *)context)->write(data, length);
+    return 0;
+}
+#endif
+
 /** @brief print message via serial
  *
  *  @param format message to print
@@ -84,7 +168,19 @@ I2C i2c(PC_1, PC_0); ///<i2C define
  */
 int node_printf_to_serial(const char * format, ...)
 {
-    unsigned int i;
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF
+    va_list ap;
+
+    // Formatted straight to the serial port, without a message buffer
+    va_start(ap, format);
+	#if NODE_M2_COM_UART
+    mbed_minimal_vxprintf(node_serial_sink, &m2_serial, format, ap);
+	#else
+    mbed_minimal_vxprintf(node_serial_sink, &debug_serial, format, ap);
+	#endif
+    va_end(ap);
+	return 0;
+#else
     va_list ap;
 
     char buf[512 + 1];
@@ -95,102 +191,95 @@ int node_printf_to_serial(const char * format, ...)
 	va_end(ap);
 	
 	#if NODE_M2_COM_UART
-	for(i=0; i < strlen(buf); i++)
-	{
-		m2_serial.putc(buf[i]);
-	}
+	m2_serial.write(buf, strlen(buf));
 	#else
-	for(i=0; i < strlen(buf); i++)
-	{
-		debug_serial.putc(buf[i]);
-	}
+	debug_serial.write(buf, strlen(buf));
 	#endif
 	return 0;
+#endif
+}
+
+/** @brief print bytes in hexadecimal via serial
+ *
+ *  @param data bytes to print
+ *  @param len number of bytes
+ */
+static void node_hexdump_to_serial(const void *data, int len)
+{
+    const unsigned char *bytes = (const unsigned char *)data;
+    char buf[16 * 3 + 1];
+
+    // 16 bytes per print, instead of a formatted print per byte
+    while (len > 0) {
+        int n = (len > 16) ? 16 : len;
+
+        mbed_minimal_hexdump(buf, sizeof(buf), bytes, n, ' ');
+        NODE_DEBUG("%s", buf);
+        bytes += n;
+        len -= n;
+    }
 }
 
 #if NODE_SENSOR_CO2_VOC_ENABLE
+static char iaq_core_data[9];
+
 /** @brief TVOC and CO2 sensor read
  *
  */
-unsigned int iaq_core_sensor(void)
+static void iaq_core_sensor_read(node_sensor_t *sensor, int event)
 {
-    static unsigned int vc = 0;
-    char data_read[9];
-    #if NODE_DEEP_SLEEP_MODE_SUPPORT
-    if(node_op_mode==4)
-    {
-        i2c.lock();
-        i2c.read(0xB5, data_read, 9, 1);
-        i2c.unlock();
-    }
-    else
-        i2c.read(0xB5, data_read, 9, 1);
-    #else
-    i2c.read(0xB5, data_read, 9, 1);
-    #endif
+    char *data_read=sensor->data;
+
+    if(event!=I2C_EVENT_TRANSFER_COMPLETE)
+        return;
+
     if(data_read[2]==0x0||data_read[2]==0x10)
     {   
         //NODE_DEBUG(" IAQ status: %x \n\r",  data_read[2]);
         //NODE_DEBUG(" CO2:  %d ppm \n\r",   (data_read[0] << 8 | data_read[1]));
         //NODE_DEBUG(" TVOC: %d ppb \n\r",   (data_read[7] << 8 | data_read[8]));
 
-        vc = (data_read[0]<<24|data_read[1]<<16|data_read[7]<<8|data_read[8]);
+        node_sensor_voc_co2 = (data_read[0]<<24|data_read[1]<<16|data_read[7]<<8|data_read[8]);
+        #if NODE_SENSOR_SUMMARY_ENABLE
+        node_window_sample(NODE_WINDOW_CO2, data_read[0]<<8|data_read[1]);
+        node_window_sample(NODE_WINDOW_TVOC, data_read[7]<<8|data_read[8]);
+        #endif
     }
-    return vc;
 }
 
-/** @brief TVOC and CO2 sensor thread
+///< TVOC and CO2 sensor, need more than 2 sec to read
+static node_sensor_t iaq_core_sensor={"iAQ-Core", 2000, 0, 0, 0xB5, NULL, 0, iaq_core_data, 9, iaq_core_sensor_read};
+
+/** @brief TVOC and CO2 sensor init
  *
  */
-static void node_sensor_voc_co2_thread(void const *args) 
+static void iaq_core_sensor_init(void) 
 {
     char data_write[1];
     data_write[0]=0x06;//0x2;
     i2c.write(0xe0, data_write, 1, 0); // i2c expander enable channel_1 and ch2,no stop
-     
-    while(1) 
-    {      
-        node_sensor_voc_co2=( unsigned int)iaq_core_sensor();
-        Thread::wait(2000);//need more than 2 sec to read 
-    }
+
+    node_sensor_register(&iaq_core_sensor);
 }
 #endif
 
 #if NODE_SENSOR_TEMP_HUM_ENABLE
+#define HDC1510_REG_TEMP  0x0
+#define HDC1510_ADDR 0x80
+
+static const char hdc1510_cmd[1]={HDC1510_REG_TEMP};
+static char hdc1510_data[4];
+
 /** @brief Temperature and humidity sensor read
  *
  */
-static unsigned int hdc1510_sensor(void) 
+static void hdc1510_sensor_read(node_sensor_t *sensor, int event) 
 {
-    char data_write[3];
-    char data_read[4];
+    char *data_read=sensor->data;
 
-    #define HDC1510_REG_TEMP  0x0
-    #define HDC1510_ADDR 0x80
-    
-    data_write[0]=HDC1510_REG_TEMP;
+    if(event!=I2C_EVENT_TRANSFER_COMPLETE)
+        return;
 
-    #if NODE_DEEP_SLEEP_MODE_SUPPORT
-    if(node_op_mode==4)
-    {
-        i2c.lock();
-        i2c.write(HDC1510_ADDR, data_write, 1, 1); 
-        Thread::wait(50);
-        i2c.read(HDC1510_ADDR, data_read, 4, 0);
-        i2c.unlock();
-    }
-    else
-    {
-        i2c.write(HDC1510_ADDR, data_write, 1, 1); 
-        Thread::wait(50);
-        i2c.read(HDC1510_ADDR, data_read, 4, 0);
-    }
-    #else
-    i2c.write(HDC1510_ADDR, data_write, 1, 1); 
-    Thread::wait(50);
-    i2c.read(HDC1510_ADDR, data_read, 4, 0);
-    #endif
-    
     float tempval = (float)((data_read[0] << 8 | data_read[1]) * 165.0 / 65536.0 - 40.0);
 
     /*Temperature*/
@@ -202,20 +291,15 @@ static unsigned int hdc1510_sensor(void)
     yy=hempval*100;
     // printf("Humidity: %.2f %\r\n",hempval);
 
-    return (yy<<16)|ss; 
+    node_sensor_temp_hum=(yy<<16)|ss; 
+    #if NODE_SENSOR_SUMMARY_ENABLE
+    node_window_sample(NODE_WINDOW_TEMP, ss);
+    node_window_sample(NODE_WINDOW_HUM, yy);
+    #endif
 }
 
-/** @brief Temperature and humidity sensor thread
- *
- */
-static void node_sensor_temp_hum_thread(void const *args)
-{
-    while(1) 
-    {
-        Thread::wait(1000);
-        node_sensor_temp_hum=(unsigned int )hdc1510_sensor();
-    }
-}
+///< Temperature and humidity sensor, read 50 ms after the conversion starts
+static node_sensor_t hdc1510_sensor={"HDC1510", 1000, 100, 50, HDC1510_ADDR, hdc1510_cmd, 1, hdc1510_data, 4, hdc1510_sensor_read};
 #endif
 
 /** @brief node tx procedure done
@@ -223,8 +307,14 @@ static void node_sensor_temp_hum_thread(void const *args)
  */
 int node_tx_done_cb(unsigned char rc)
 {
+    unsigned char head=node_tx_done_head;
 
-    node_state=NODE_STATE_LOWPOWER;
+    // Handed to the state loop, which owns the uplink queue; the result is written before the head moves
+    if((unsigned char)(head-node_tx_done_tail)<NODE_TX_DONE_SLOTS)
+    {
+        node_tx_done_rc[head%NODE_TX_DONE_SLOTS]=rc;
+        node_tx_done_head=head+1;
+    }
     return 0;
 }
 
@@ -418,6 +508,7 @@ void node_get_config()
         ret=nodeApiGetDevAdvwiseDataRate(buf_out, 256);
         if(ret==NODE_API_OK)
         {
+            node_data_rate=atoi(buf_out);
             NODE_DEBUG("DevAdvwiseDataRate=%s\r\n", buf_out);
         }
     }
@@ -427,6 +518,7 @@ void node_get_config()
         ret=nodeApiGetDevAdvwiseFreq(buf_out, 256);
         if(ret==NODE_API_OK)
         {
+            node_freq_hz=strtoul(buf_out, NULL, 10);
             NODE_DEBUG("DevAdvwiseFreq=%sHz\r\n", buf_out);
         }
     }
@@ -518,6 +610,271 @@ unsigned char node_get_sensor_data (char *data)
     #endif
 }
 
+#if NODE_SENSOR_SERIES_SAMPLES>1
+///< TLV types of the channels of a series, as in node_get_sensor_data
+static const unsigned char node_series_types[]={
+    #if NODE_SENSOR_TEMP_HUM_ENABLE
+    0x1, 0x2,
+    #endif
+    #if NODE_SENSOR_CO2_VOC_ENABLE
+    0x3, 0x4,
+    #endif
+    #if NODE_GPIO_ENABLE
+    0x5,
+    #endif
+};
+
+/** @brief Read sensor values for a series
+ *
+ *  @param values value of each channel, in the units of its TLV
+ */
+static void node_get_sensor_values(int *values)
+{
+    int n=0;
+
+    #if NODE_SENSOR_TEMP_HUM_ENABLE
+    values[n++]=(short)(node_sensor_temp_hum&0xffff);   // 0.01 C, signed
+    values[n++]=(node_sensor_temp_hum>>16)&0xffff;      // 0.01 %RH
+    #endif
+    #if NODE_SENSOR_CO2_VOC_ENABLE
+    values[n++]=(node_sensor_voc_co2>>16)&0xffff;       // CO2 ppm
+    values[n++]=node_sensor_voc_co2&0xffff;             // TVOC ppb
+    #endif
+    #if NODE_GPIO_ENABLE
+    values[n++]=gpio0;
+    #endif
+}
+#endif
+
+#if NODE_SENSOR_SUMMARY_ENABLE
+/** @brief Take the windows of the report period, and start the next ones
+ *
+ *  @param windows filled with the windows of the channels
+ */
+static void node_take_sensor_windows(node_window_t *windows)
+{
+    int i;
+
+    core_util_critical_section_enter();
+    memcpy(windows, node_windows, sizeof(node_windows));
+    for(i=0; i<NODE_WINDOW_COUNT; i++)
+        node_window_reset(&node_windows[i]);
+    core_util_critical_section_exit();
+}
+
+/** @brief Read the summary of the sensor samples of a report period
+ *
+ *  @param data sensor_data, of NODE_UPLINK_FRAME_SIZE bytes
+ *  @param windows windows of the channels
+ *  @returns data_length, 0 if no sample was read
+ */
+static unsigned char node_get_sensor_summary(char *data, const node_window_t *windows)
+{
+    unsigned char len=0;
+    int i;
+
+    for(i=0; i<NODE_WINDOW_COUNT; i++)
+        len+=node_window_tlv(node_window_types[i], &windows[i], &data[len+2]);
+    if(len==0)
+        return 0;
+
+    #if NODE_GPIO_ENABLE
+    data[len+2]=0x5;
+    len++;  // GPIO
+    data[len+2]=0x1;
+    len++; // len:1 bytes
+    data[len+2]=gpio0;
+    len++;
+    #endif
+
+    //header
+    data[0]=len;
+    data[1]=0xc; //publish
+    return len+2;
+}
+#endif
+
+/** @brief Get the kernel time in ms, as the uplink queue counts it
+ *
+ */
+static unsigned int node_ms_count(void)
+{
+    return (unsigned int)Kernel::get_ms_count();
+}
+
+/** @brief Get the seed of the uplink backoff, different on every node
+ *
+ */
+static unsigned int node_uplink_seed(void)
+{
+    char deveui[17]={};
+    unsigned int seed=(unsigned int)time(NULL);
+    int i;
+
+    if(nodeApiGetFuseDevEui(deveui,16)==NODE_API_OK)
+    {
+        for(i=0; deveui[i]!=0; i++)
+            seed=seed*31+deveui[i];
+    }
+    return seed;
+}
+
+/** @brief Queue a sensor reading for uplink
+ *
+ *  @param now current time in ms
+ */
+static void node_queue_sensor_data(unsigned int now)
+{
+    unsigned char frame_len=0;
+    unsigned char flags=0;
+    char frame[NODE_UPLINK_FRAME_SIZE]={};
+
+    #if NODE_SENSOR_SUMMARY_ENABLE
+    node_window_t windows[NODE_WINDOW_COUNT];
+    #endif
+
+    node_report_ms=now;
+    #if NODE_SENSOR_SUMMARY_ENABLE
+    node_take_sensor_windows(windows);
+    #endif
+
+    if(node_beacon_state==NODE_BCN_STATE_SPS)
+        flags=NODE_UPLINK_HIGH_PRI;
+
+    #if NODE_SENSOR_SERIES_SAMPLES>1
+    {
+        int values[NODE_SERIES_MAX_CHANNELS];
+        int len;
+
+        // A series is sent when it closes, without coalescing; a reading too long for a series goes alone
+        node_get_sensor_values(values);
+        #if NODE_SENSOR_SUMMARY_ENABLE
+        {
+            node_window_summary_t summary;
+            int i;
+
+            // A reading of the series is the mean of the samples of its report period
+            for(i=0; i<NODE_WINDOW_COUNT; i++)
+            {
+                if(node_window_summary(&windows[i], &summary)==0)
+                    values[i]=summary.mean;
+            }
+        }
+        #endif
+        len=node_series_add((unsigned int)time(NULL), values, frame);
+        if(len==0)
+            return;
+        if(len>0)
+        {
+            if(node_uplink_push(NODE_ACTIVE_TX_PORT, frame, len, flags, 0, now)!=0)
+                NODE_DEBUG("TX: Queue full, series dropped\n\r");
+            return;
+        }
+    }
+    #endif
+
+    // The summary of the report period goes if the data rate carries it, the last reading otherwise
+    #if NODE_SENSOR_SUMMARY_ENABLE
+    frame_len=node_get_sensor_summary(frame, windows);
+    if(frame_len==0||frame_len>node_max_payload)
+    #endif
+    frame_len=node_get_sensor_data(frame);
+    if(frame_len==0)
+        return;
+
+    if(node_uplink_push(NODE_ACTIVE_TX_PORT, frame, frame_len, flags, NODE_SENSOR_UPLINK_KEY, now)!=0)
+        NODE_DEBUG("TX: Queue full, reading dropped\n\r");
+}
+
+/** @brief Send the next queued frame
+ *
+ *  @param now current time in ms
+ *  @returns NODE_STATE_TX while a frame is in flight, NODE_STATE_LOWPOWER otherwise
+ */
+static node_state_t node_send_queued(unsigned int now)
+{
+    const node_uplink_frame_t *frame;
+
+    // At a known data rate, a frame waits for the duty cycle budget instead of being refused
+    frame=node_uplink_peek(now);
+    if(frame!=NULL&&node_data_rate>=0)
+    {
+        int wait=node_airtime_until(node_data_rate, node_airtime_sub_band, frame->len, now);
+
+        if(wait>0)
+        {
+            NODE_DEBUG("TX: Duty cycle, %d ms to wait\n\r", wait);
+            return NODE_STATE_LOWPOWER;
+        }
+    }
+
+    switch(node_uplink_send(now, &frame))
+    {
+        case NODE_UPLINK_SENT:
+            if(node_data_rate>=0)
+                node_airtime_commit(node_data_rate, node_airtime_sub_band, frame->len, now);
+            NODE_DEBUG("TX: ");
+            node_hexdump_to_serial(frame->data, frame->len);
+
+            NODE_DEBUG("\n\r");
+            return NODE_STATE_TX;
+        case NODE_UPLINK_REFUSED:
+            NODE_DEBUG("TX: Forbidden! %d frames queued\n\r", node_uplink_count());
+            return NODE_STATE_LOWPOWER;
+        default:
+            return node_uplink_busy()?NODE_STATE_TX:NODE_STATE_LOWPOWER;
+    }
+}
+
+/** @brief Set up the airtime budget of the region
+ *
+ */
+static void node_airtime_setup(void)
+{
+    const node_airtime_region_t *region=node_airtime_get_region(NODE_REGION);
+
+    node_airtime_init(region, node_ms_count());
+
+    // The default channels are in the first sub-band
+    node_airtime_sub_band=0;
+    if(node_freq_hz!=0&&node_airtime_band(node_freq_hz)>=0)
+        node_airtime_sub_band=node_airtime_band(node_freq_hz);
+
+    // The stack may pick any data rate of the region for its frames
+    node_max_payload=-1;
+    if(node_data_rate>=0)
+        node_max_payload=node_airtime_max_payload(node_data_rate);
+    if(node_max_payload<0)
+        node_max_payload=node_airtime_safe_payload();
+    if(node_max_payload<0||node_max_payload>NODE_UPLINK_FRAME_SIZE)
+        node_max_payload=NODE_UPLINK_FRAME_SIZE;
+
+    if(node_data_rate>=0)
+    {
+        char frame[NODE_UPLINK_FRAME_SIZE]={};
+        unsigned char len=node_get_sensor_data(frame);
+
+        // A report as long on air could carry up to the packed length
+        NODE_DEBUG("Airtime: %s DR%d, %d us per %d-byte report, packed %d bytes, max %d bytes\r\n", region->name,
+            node_data_rate, node_airtime_frame_us(node_data_rate, len), len, node_airtime_pack(node_data_rate, len),
+            node_airtime_max_payload(node_data_rate));
+    }
+}
+
+#if NODE_SENSOR_SERIES_SAMPLES>1
+/** @brief Set up the series of sensor readings, in frames the data rate carries
+ *
+ */
+static void node_series_setup(void)
+{
+    if(node_series_init(node_series_types, sizeof(node_series_types), NODE_ACTIVE_PERIOD_IN_SEC,
+        NODE_SENSOR_SERIES_SAMPLES, node_max_payload)==0)
+    {
+        NODE_DEBUG("Series: %d readings every %d sec, up to %d bytes\r\n", NODE_SENSOR_SERIES_SAMPLES,
+            NODE_ACTIVE_PERIOD_IN_SEC, node_max_payload);
+    }
+}
+#endif
 
 /** @brief An loop to read and send sensor data via LoRa periodically
  *  
@@ -530,6 +887,12 @@ void node_state_loop()
     nodeApiSetRxDoneCb(node_rx_done_cb);
 
     node_state=NODE_STATE_LOWPOWER;
+    // No spill store: the flash pages left free by the LoRa library are not known, so a full queue drops frames
+    node_uplink_init(node_uplink_seed());
+    node_airtime_setup();
+    #if NODE_SENSOR_SERIES_SAMPLES>1
+    node_series_setup();
+    #endif
 
 	if(node_op_mode==4)
 	{
@@ -574,6 +937,28 @@ void node_state_loop()
 
             join_state=2;       
         }
+
+        if(node_tx_done_tail!=node_tx_done_head)
+        {
+            unsigned int now=node_ms_count();
+
+            while(node_tx_done_tail!=node_tx_done_head)
+            {
+                unsigned char tail=node_tx_done_tail;
+
+                node_uplink_tx_done(node_tx_done_rc[tail%NODE_TX_DONE_SLOTS], now);
+                node_tx_done_tail=tail+1;
+            }
+
+            // The frames due go out back to back; in WISE link 2.0 they wait for the next beacon
+            if(node_state==NODE_STATE_TX)
+            {
+                if(node_op_mode!=4&&node_uplink_until_due(now)==0)
+                    node_state=node_send_queued(now);
+                else
+                    node_state=NODE_STATE_LOWPOWER;
+            }
+        }
     
         switch(node_state)
         {
@@ -595,7 +980,7 @@ void node_state_loop()
                 }
                 else
                 {
-                    Thread::wait(NODE_RXWINDOW_PERIOD_IN_SEC*1000);
+                    Thread::wait(Seconds(NODE_RXWINDOW_PERIOD_IN_SEC));
 
                     /*Receive RX while sleep*/
                     if(node_state==NODE_STATE_RX_DONE)
@@ -607,7 +992,8 @@ void node_state_loop()
                         nodeApiSetDevSleepRTCWakeup(NODE_ACTIVE_PERIOD_IN_SEC-NODE_RXWINDOW_PERIOD_IN_SEC);
                         *p_lpin=1;
                         #else
-                        Thread::wait((NODE_ACTIVE_PERIOD_IN_SEC-NODE_RXWINDOW_PERIOD_IN_SEC)*1000);
+                        // Signed durations: a report interval shorter than the RX window does not wrap
+                        Thread::wait(Seconds(NODE_ACTIVE_PERIOD_IN_SEC)-Seconds(NODE_RXWINDOW_PERIOD_IN_SEC));
                         #endif
                         if(node_state==NODE_STATE_RX_DONE)
                             continue;
@@ -619,62 +1005,45 @@ void node_state_loop()
                 break;
             case NODE_STATE_ACTIVE:
             {
-                int i=0,ret=0;
-                unsigned char frame_len=0;
-                char frame[64]={};
-                
-                frame_len=node_get_sensor_data(frame);
-            
-                if(frame_len==0)
-                {
-                    node_state=NODE_STATE_LOWPOWER;
-                    break;
-                }
+                unsigned int now=node_ms_count();
 
+                node_queue_sensor_data(now);
+                node_state=node_send_queued(now);
+            }
+                break;
+            case NODE_STATE_TX:
+            {
+                unsigned int now;
 
-                if(node_beacon_state==NODE_BCN_STATE_SPS)
-                    ret=nodeApiSendDataHighPri(NODE_ACTIVE_TX_PORT, frame, frame_len);
-                else
-                    ret=nodeApiSendData(NODE_ACTIVE_TX_PORT, frame, frame_len);
+                Thread::wait(10);
+                now=node_ms_count();
 
-                if(ret==0)
-                {
-                    NODE_DEBUG("TX: ");
+                // Readings due while the frame is in flight are queued instead of lost
+                if(now-node_report_ms>=NODE_ACTIVE_PERIOD_IN_SEC*1000)
+                    node_queue_sensor_data(now);
 
-                    for(i=0;i<frame_len;i++)
-                    {
-                        NODE_DEBUG("%02X ",frame[i]);
-                    }
-                    
-                    NODE_DEBUG("\n\r");
-                    
-                    node_state=NODE_STATE_TX;
-                }
-                else
+                // Sends the next frame if the one in flight never gets its TX done; in WISE link 2.0 it waits for the next beacon
+                if(node_state==NODE_STATE_TX)
                 {
-                    NODE_DEBUG("TX: Forbidden!\n\r ");
-                    node_state=NODE_STATE_LOWPOWER;
+                    if(node_op_mode!=4)
+                        node_state=node_send_queued(now);
+                    else if(node_uplink_expire(now)||!node_uplink_busy())
+                        node_state=NODE_STATE_LOWPOWER;
                 }
             }
                 break;
-            case NODE_STATE_TX:
-                break;
             case NODE_STATE_RX:
                 break;
             case NODE_STATE_RX_DONE:
             {
                 if(node_rx_done_data.data_len!=0)
                 {
-                    int i=0;
                     int j=0;
                     char print_buf[512];
                     memset(print_buf, 0, sizeof(print_buf));
 
                     NODE_DEBUG("RX: ");
-                    for(i=0;i<node_rx_done_data.data_len;i++)
-                    {
-                        NODE_DEBUG("%02X ", node_rx_done_data.data[i]);
-                    }
+                    node_hexdump_to_serial(node_rx_done_data.data, node_rx_done_data.data_len);
 
                     NODE_DEBUG("\r\n(Length: %d, Port%d)\r\n", node_rx_done_data.data_len,node_rx_done_data.data_port);
                     
@@ -711,14 +1080,6 @@ void node_state_loop()
  */
 int main () 
 {
-    /*Create sensor thread*/
-    #if NODE_SENSOR_TEMP_HUM_ENABLE
-    Thread *p_node_sensor_temp_hum_thread;
-    #endif
-    #if NODE_SENSOR_CO2_VOC_ENABLE
-    Thread *p_node_sensor_co2_thread;
-    #endif
-    
     /* Init carrier board, must be first step */
     nodeApiInitCarrierBoard();
 
@@ -730,11 +1091,20 @@ int main ()
 	nodeApiInit(&debug_serial, &debug_serial);
 	#endif
 
+    /*Start sensor sampling*/
+    #if NODE_SENSOR_SUMMARY_ENABLE
+    for(int i=0; i<NODE_WINDOW_COUNT; i++)
+        node_window_init(&node_windows[i], NODE_SENSOR_SUMMARY_QUANTILE);
+    #endif
     #if NODE_SENSOR_TEMP_HUM_ENABLE
-    p_node_sensor_temp_hum_thread=new Thread(node_sensor_temp_hum_thread);
+    node_sensor_register(&hdc1510_sensor);
     #endif
     #if NODE_SENSOR_CO2_VOC_ENABLE
-    p_node_sensor_co2_thread=new Thread(node_sensor_voc_co2_thread);
+    iaq_core_sensor_init();
+    #endif
+    #if NODE_SENSOR_ENABLE
+    node_sensor_start(&node_sensor_queue, &node_i2c_bus);
+    node_sensor_thread.start(callback(&node_sensor_queue, &EventQueue::dispatch_forever));
     #endif
     
     /* Display version information */
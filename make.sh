@@ -33,4 +33,5 @@ else
 	exit 0
 fi
 
-mbed compile -t GCC_ARM -m MTB_ADV_WISE_1510  -c
+# node_airtime.h numbers the regions as above
+mbed compile -t GCC_ARM -m MTB_ADV_WISE_1510  -c -DNODE_REGION=$REGION
@@ -18,10 +18,68 @@
 
 #if DEVICE_ANALOGIN
 
+#if DEVICE_ANALOGIN_GROUP
+#include "platform/mbed_critical.h"
+#if MBED_CONF_RTOS_PRESENT
+#include "rtos/EventFlags.h"
+#else
+#include "platform/mbed_power_mgmt.h"
+#endif
+#endif
+
 namespace mbed {
 
 SingletonPtr<PlatformMutex> AnalogIn::_mutex;
 
+#if DEVICE_ANALOGIN_GROUP
+
+#define ANALOGIN_GROUP_END_FLAG     (1UL << 0)
+
+volatile bool AnalogIn::_group_active = false;
+#if MBED_CONF_RTOS_PRESENT
+// Set from the ADC interrupt at the end of a group conversion
+static SingletonPtr<rtos::EventFlags> group_end_flags;
+#endif
+
+// Called with the lock held, before the group conversion is started
+void AnalogIn::group_start()
+{
+#if MBED_CONF_RTOS_PRESENT
+    // Also builds the flags, which must not happen in the interrupt
+    group_end_flags->clear(ANALOGIN_GROUP_END_FLAG);
+#endif
+    _group_active = true;
+}
+
+// Called from the ADC interrupt, or with the lock held once the conversion is stopped
+void AnalogIn::group_end()
+{
+    _group_active = false;
+#if MBED_CONF_RTOS_PRESENT
+    group_end_flags->set(ANALOGIN_GROUP_END_FLAG);
+#endif
+}
+
+// Block the thread holding the lock until the group conversion ends, it takes
+// at most 16 channels * 256 conversions * 16 us
+void AnalogIn::group_wait()
+{
+    while (_group_active) {
+#if MBED_CONF_RTOS_PRESENT
+        group_end_flags->wait_any(ANALOGIN_GROUP_END_FLAG);
+#else
+        // Without threads, sleep until the interrupt of the next conversion
+        core_util_critical_section_enter();
+        if (_group_active) {
+            sleep();
+        }
+        core_util_critical_section_exit();
+#endif
+    }
+}
+
+#endif
+
 };
 
 #endif
@@ -109,15 +109,30 @@ public:
     }
 
 protected:
+#if DEVICE_ANALOGIN_GROUP
+    friend class AnalogInGroup;
+#endif
 
     virtual void lock() {
         _mutex->lock();
+#if DEVICE_ANALOGIN_GROUP
+        // A group conversion started under the lock may still use the ADC
+        group_wait();
+#endif
     }
 
     virtual void unlock() {
         _mutex->unlock();
     }
 
+#if DEVICE_ANALOGIN_GROUP
+    static void group_start();
+    static void group_end();
+    static void group_wait();
+
+    static volatile bool _group_active;
+#endif
+
     analogin_t _adc;
     static SingletonPtr<PlatformMutex> _mutex;
 };
@@ -0,0 +1,96 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "drivers/AnalogInGroup.h"
+
+#if DEVICE_ANALOGIN_GROUP
+
+#include "drivers/AnalogIn.h"
+#include "platform/mbed_power_mgmt.h"
+
+namespace mbed {
+
+AnalogInGroup::AnalogInGroup(const PinName *pins, int count, int oversampling) : _busy(false)
+{
+    lock();
+    // The sequence is programmed in the ADC, which another group may be converting
+    AnalogIn::group_wait();
+    analogin_group_init(&_group, pins, count, oversampling);
+    unlock();
+}
+
+int AnalogInGroup::read_u16(uint16_t *results, const Callback<void(int)> &callback)
+{
+    lock();
+    if (_busy) {
+        unlock();
+        return -1;
+    }
+    _callback = callback;
+    _busy = true;
+    // The ADC clock stops in deep sleep
+    sleep_manager_lock_deep_sleep();
+    // AnalogIn users wait for the end of the conversion before touching the ADC
+    AnalogIn::group_start();
+    if (analogin_group_start(&_group, results, &AnalogInGroup::irq_handler, (uint32_t)this) != 0) {
+        AnalogIn::group_end();
+        sleep_manager_unlock_deep_sleep();
+        _busy = false;
+        unlock();
+        return -1;
+    }
+    unlock();
+    return 0;
+}
+
+void AnalogInGroup::irq_handler(uint32_t id, int error)
+{
+    AnalogInGroup *handler = (AnalogInGroup *)id;
+
+    handler->_busy = false;
+    sleep_manager_unlock_deep_sleep();
+    AnalogIn::group_end();
+    if (handler->_callback) {
+        handler->_callback.call(error);
+    }
+}
+
+AnalogInGroup::~AnalogInGroup()
+{
+    lock();
+    analogin_group_free(&_group);
+    if (_busy) {
+        _busy = false;
+        sleep_manager_unlock_deep_sleep();
+        AnalogIn::group_end();
+    }
+    unlock();
+}
+
+void AnalogInGroup::lock()
+{
+    // The ADC is shared with the AnalogIn
+    AnalogIn::_mutex->lock();
+}
+
+void AnalogInGroup::unlock()
+{
+    AnalogIn::_mutex->unlock();
+}
+
+} // namespace mbed
+
+#endif
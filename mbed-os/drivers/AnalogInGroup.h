@@ -0,0 +1,105 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_ANALOGIN_GROUP_H
+#define MBED_ANALOGIN_GROUP_H
+
+#include "platform/platform.h"
+
+#if defined (DEVICE_ANALOGIN_GROUP) || defined(DOXYGEN_ONLY)
+
+#include "hal/analogin_group_api.h"
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+
+namespace mbed {
+/** \addtogroup drivers */
+
+/** A group of analog inputs, converted in one ADC sequence
+ *
+ * The sequence is programmed in the ADC once. Each conversion of the group
+ * converts every input in turn, averaging each one over several conversions
+ * in the ADC, and stores the results from the ADC interrupt, so the CPU is
+ * free or asleep meanwhile.
+ *
+ * @note Synchronization level: Thread safe
+ *
+ * Example:
+ * @code
+ * #include "mbed.h"
+ *
+ * const PinName pins[] = { ADC_VBAT, ADC_TEMP, ADC_VREF };
+ * AnalogInGroup adc(pins, 3, 16);
+ * uint16_t results[3];
+ * EventQueue queue;
+ *
+ * void print_results(int error) {
+ *     printf("VBAT %u, temperature %u, VREFINT %u\n", results[0], results[1], results[2]);
+ * }
+ *
+ * void adc_done(int error) {
+ *     queue.call(print_results, error);
+ * }
+ *
+ * int main() {
+ *     adc.read_u16(results, adc_done);
+ *     queue.dispatch_forever();
+ * }
+ * @endcode
+ * @ingroup drivers
+ */
+class AnalogInGroup : private NonCopyable<AnalogInGroup> {
+
+public:
+
+    /** Create a group of analog inputs
+     *
+     * @param pins         AnalogIn pins, converted in this order
+     * @param count        Number of pins, up to ANALOGIN_GROUP_MAX_CHANNELS
+     * @param oversampling Number of conversions averaged by the ADC for each result, a power of 2
+     */
+    AnalogInGroup(const PinName *pins, int count, int oversampling = 1);
+
+    /** Start the conversion of every input
+     *
+     * Deep sleep is locked until the end of the conversion.
+     *
+     * @param results  Buffer for one result per pin, normalised to 16 bits like AnalogIn::read_u16
+     * @param callback Called from the ADC interrupt with 0 once every result is stored, or -1
+     * @returns
+     *   0 if the conversion has started, -1 if a conversion is in progress
+     */
+    int read_u16(uint16_t *results, const Callback<void(int)> &callback);
+
+    virtual ~AnalogInGroup();
+
+protected:
+
+    virtual void lock();
+
+    virtual void unlock();
+
+    static void irq_handler(uint32_t id, int error);
+
+    analogin_group_t _group;
+    Callback<void(int)> _callback;
+    volatile bool _busy;
+};
+
+} // namespace mbed
+
+#endif
+
+#endif
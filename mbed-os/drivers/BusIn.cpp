@@ -29,6 +29,9 @@ BusIn::BusIn(PinName p0, PinName p1, PinName p2, PinName p3, PinName p4, PinName
             _nc_mask |= (1 << i);
         }
     }
+#if DEVICE_PORTIN
+    init_groups(pins);
+#endif
 }
 
 BusIn::BusIn(PinName pins[16]) {
@@ -40,6 +43,9 @@ BusIn::BusIn(PinName pins[16]) {
             _nc_mask |= (1 << i);
         }
     }
+#if DEVICE_PORTIN
+    init_groups(pins);
+#endif
 }
 
 BusIn::~BusIn() {
@@ -49,16 +55,26 @@ BusIn::~BusIn() {
             delete _pin[i];
         }
     }
+#if DEVICE_PORTIN
+    delete[] _groups;
+#endif
 }
 
 int BusIn::read() {
     int v = 0;
     lock();
+#if DEVICE_PORTIN
+    // One read per GPIO port
+    for (int g=0; g<_group_count; g++) {
+        v |= from_port(_groups[g], port_read(&_groups[g].port));
+    }
+#else
     for (int i=0; i<16; i++) {
         if (_pin[i] != 0) {
             v |= _pin[i]->read() << i;
         }
     }
+#endif
     unlock();
     return v;
 }
@@ -93,4 +109,65 @@ DigitalIn& BusIn::operator[] (int index) {
     return *_pin[index];
 }
 
+#if DEVICE_PORTIN
+void BusIn::init_groups(PinName pins[16]) {
+    PortName ports[16];
+    int port_of[16];
+    int i, g;
+
+    // One group per GPIO port used by the bus
+    _group_count = 0;
+    for (i=0; i<16; i++) {
+        if (pins[i] == NC) {
+            continue;
+        }
+        int pin_n;
+        PortName port = port_from_pin(pins[i], &pin_n);
+        _pin_n[i] = pin_n;
+        for (g=0; (g < _group_count) && (ports[g] != port); g++);
+        if (g == _group_count) {
+            ports[_group_count++] = port;
+        }
+        port_of[i] = g;
+    }
+
+    _groups = new PortGroup[_group_count];
+    for (g=0; g<_group_count; g++) {
+        PortGroup &group = _groups[g];
+        int port_mask = 0;
+
+        group.bus_mask = 0;
+        group.shift = 0;
+        group.ordered = true;
+        for (i=0; i<16; i++) {
+            if ((pins[i] == NC) || (port_of[i] != g)) {
+                continue;
+            }
+            if (group.bus_mask == 0) {
+                group.shift = _pin_n[i] - i;
+            } else if (_pin_n[i] - i != group.shift) {
+                group.ordered = false;
+            }
+            group.bus_mask |= 1 << i;
+            port_mask |= 1 << _pin_n[i];
+        }
+        port_init(&group.port, ports[g], port_mask, PIN_INPUT);
+    }
+}
+
+int BusIn::from_port(const PortGroup &group, int value) {
+    if (group.ordered) {
+        value = (group.shift >= 0) ? (value >> group.shift) : (value << -group.shift);
+        return value & group.bus_mask;
+    }
+    int v = 0;
+    for (int i=0; i<16; i++) {
+        if ((group.bus_mask & (1 << i)) && (value & (1 << _pin_n[i]))) {
+            v |= 1 << i;
+        }
+    }
+    return v;
+}
+#endif
+
 } // namespace mbed
@@ -18,6 +18,9 @@
 
 #include "platform/platform.h"
 #include "drivers/DigitalIn.h"
+#if DEVICE_PORTIN
+#include "hal/port_api.h"
+#endif
 #include "platform/PlatformMutex.h"
 #include "platform/NonCopyable.h"
 
@@ -116,9 +119,27 @@ protected:
 
     PlatformMutex _mutex;
 
+#if DEVICE_PORTIN
+    /* Pins of the bus on one GPIO port, read at once */
+    struct PortGroup {
+        port_t port;
+        int bus_mask;       // Bits of the bus on the port
+        int shift;          // Pin number within the port - bit number, if ordered
+        bool ordered;       // The pins are in the order of the bits, with a constant shift
+    };
+
+    PortGroup *_groups;
+    int _group_count;
+    uint8_t _pin_n[16];     // Pin number within its port of each bit
+#endif
+
 private:
     virtual void lock();
     virtual void unlock();
+#if DEVICE_PORTIN
+    void init_groups(PinName pins[16]);
+    int from_port(const PortGroup &group, int value);
+#endif
 };
 
 } // namespace mbed
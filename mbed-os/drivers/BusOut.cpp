@@ -29,6 +29,9 @@ BusOut::BusOut(PinName p0, PinName p1, PinName p2, PinName p3, PinName p4, PinNa
             _nc_mask |= (1 << i);
         }
     }
+#if DEVICE_PORTOUT
+    init_groups(pins);
+#endif
 }
 
 BusOut::BusOut(PinName pins[16]) {
@@ -40,6 +43,9 @@ BusOut::BusOut(PinName pins[16]) {
             _nc_mask |= (1 << i);
         }
     }
+#if DEVICE_PORTOUT
+    init_groups(pins);
+#endif
 }
 
 BusOut::~BusOut() {
@@ -49,26 +55,42 @@ BusOut::~BusOut() {
             delete _pin[i];
         }
     }
+#if DEVICE_PORTOUT
+    delete[] _groups;
+#endif
 }
 
 void BusOut::write(int value) {
     lock();
+#if DEVICE_PORTOUT
+    // One store per GPIO port, its pins change together
+    for (int g=0; g<_group_count; g++) {
+        port_write(&_groups[g].port, to_port(_groups[g], value));
+    }
+#else
     for (int i=0; i<16; i++) {
         if (_pin[i] != 0) {
             _pin[i]->write((value >> i) & 1);
         }
     }
+#endif
     unlock();
 }
 
 int BusOut::read() {
     lock();
     int v = 0;
+#if DEVICE_PORTOUT
+    for (int g=0; g<_group_count; g++) {
+        v |= from_port(_groups[g], port_read(&_groups[g].port));
+    }
+#else
     for (int i=0; i<16; i++) {
         if (_pin[i] != 0) {
             v |= _pin[i]->read() << i;
         }
     }
+#endif
     unlock();
     return v;
 }
@@ -105,4 +127,79 @@ void BusOut::unlock() {
     _mutex.unlock();
 }
 
+#if DEVICE_PORTOUT
+void BusOut::init_groups(PinName pins[16]) {
+    PortName ports[16];
+    int port_of[16];
+    int i, g;
+
+    // One group per GPIO port used by the bus
+    _group_count = 0;
+    for (i=0; i<16; i++) {
+        if (pins[i] == NC) {
+            continue;
+        }
+        int pin_n;
+        PortName port = port_from_pin(pins[i], &pin_n);
+        _pin_n[i] = pin_n;
+        for (g=0; (g < _group_count) && (ports[g] != port); g++);
+        if (g == _group_count) {
+            ports[_group_count++] = port;
+        }
+        port_of[i] = g;
+    }
+
+    _groups = new PortGroup[_group_count];
+    for (g=0; g<_group_count; g++) {
+        PortGroup &group = _groups[g];
+        int port_mask = 0;
+
+        group.bus_mask = 0;
+        group.shift = 0;
+        group.ordered = true;
+        for (i=0; i<16; i++) {
+            if ((pins[i] == NC) || (port_of[i] != g)) {
+                continue;
+            }
+            if (group.bus_mask == 0) {
+                group.shift = _pin_n[i] - i;
+            } else if (_pin_n[i] - i != group.shift) {
+                group.ordered = false;
+            }
+            group.bus_mask |= 1 << i;
+            port_mask |= 1 << _pin_n[i];
+        }
+        port_init(&group.port, ports[g], port_mask, PIN_OUTPUT);
+    }
+}
+
+int BusOut::to_port(const PortGroup &group, int value) {
+    value &= group.bus_mask;
+    if (group.ordered) {
+        return (group.shift >= 0) ? (value << group.shift) : (value >> -group.shift);
+    }
+    int port_value = 0;
+    for (int i=0; i<16; i++) {
+        if (value & (1 << i)) {
+            port_value |= 1 << _pin_n[i];
+        }
+    }
+    return port_value;
+}
+
+int BusOut::from_port(const PortGroup &group, int value) {
+    if (group.ordered) {
+        value = (group.shift >= 0) ? (value >> group.shift) : (value << -group.shift);
+        return value & group.bus_mask;
+    }
+    int v = 0;
+    for (int i=0; i<16; i++) {
+        if ((group.bus_mask & (1 << i)) && (value & (1 << _pin_n[i]))) {
+            v |= 1 << i;
+        }
+    }
+    return v;
+}
+#endif
+
 } // namespace mbed
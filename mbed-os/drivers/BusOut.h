@@ -17,6 +17,9 @@
 #define MBED_BUSOUT_H
 
 #include "drivers/DigitalOut.h"
+#if DEVICE_PORTOUT
+#include "hal/port_api.h"
+#endif
 #include "platform/PlatformMutex.h"
 #include "platform/NonCopyable.h"
 
@@ -120,6 +123,25 @@ protected:
     int _nc_mask;
 
     PlatformMutex _mutex;
+
+#if DEVICE_PORTOUT
+    /* Pins of the bus on one GPIO port, written at once */
+    struct PortGroup {
+        port_t port;
+        int bus_mask;       // Bits of the bus on the port
+        int shift;          // Pin number within the port - bit number, if ordered
+        bool ordered;       // The pins are in the order of the bits, with a constant shift
+    };
+
+    PortGroup *_groups;
+    int _group_count;
+    uint8_t _pin_n[16];     // Pin number within its port of each bit
+
+private:
+    void init_groups(PinName pins[16]);
+    int to_port(const PortGroup &group, int value);
+    int from_port(const PortGroup &group, int value);
+#endif
 };
 
 } // namespace mbed
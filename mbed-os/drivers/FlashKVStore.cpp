@@ -0,0 +1,526 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "drivers/FlashKVStore.h"
+#include "drivers/MbedCRC.h"
+#include "platform/mbed_assert.h"
+
+#ifdef DEVICE_FLASH
+
+namespace mbed {
+
+#define AREA_MAGIC       0x4B564131  // "KVA1"
+#define RECORD_MAGIC     0x4B565231  // "KVR1"
+#define ERASED_WORD      0xFFFFFFFF
+
+#define RECORD_FLAG_DELETED  0x01
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t erase_count;
+    uint32_t crc;           // CRC of the fields above
+} area_header_t;
+
+typedef struct {
+    uint32_t magic;
+    uint8_t key_size;
+    uint8_t flags;
+    uint16_t data_size;
+    uint32_t crc;           // CRC of the fields above, the key and the data
+} record_header_t;
+
+static inline uint32_t align_up(uint32_t value, uint32_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// FNV-1a, only used to skip non matching keys without reading the flash
+static uint32_t key_hash(const char *key, uint32_t key_size)
+{
+    uint32_t hash = 2166136261UL;
+    for (uint32_t i = 0; i < key_size; i++) {
+        hash = (hash ^ (uint8_t)key[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+static uint32_t compute_crc(const void *buffer, uint32_t size)
+{
+    MbedCRC<POLY_32BIT_ANSI, 32> ct;
+    uint32_t crc = 0;
+    ct.compute((void *)buffer, size, &crc);
+    return crc;
+}
+
+FlashKVStore::FlashKVStore(uint32_t address, uint32_t area_size)
+    : _address(address), _area_size(area_size), _page_size(0), _first_record(0),
+      _active(0), _seq(0), _erase_count(0), _free(0), _initialized(false),
+      _work_buf(NULL), _num_keys(0)
+{
+
+}
+
+FlashKVStore::~FlashKVStore()
+{
+    deinit();
+}
+
+int FlashKVStore::init()
+{
+    int ret = FLASHKV_ERROR_OK;
+    _mutex.lock();
+    if (_initialized) {
+        _mutex.unlock();
+        return FLASHKV_ERROR_OK;
+    }
+
+    if (_flash.init() != 0) {
+        _mutex.unlock();
+        return FLASHKV_ERROR_DEVICE_ERROR;
+    }
+
+    // The areas are not guessed: pages past the application image may hold the
+    // configuration of other flash users, so they must be given and reserved
+    uint32_t flash_start = _flash.get_flash_start();
+    uint32_t flash_end = flash_start + _flash.get_flash_size();
+    if ((_address < flash_start) || (_address >= flash_end)) {
+        _flash.deinit();
+        _mutex.unlock();
+        return FLASHKV_ERROR_INVALID_ARGUMENT;
+    }
+    if (_area_size == 0) {
+        _area_size = _flash.get_sector_size(_address);
+    }
+    if (((_address % _flash.get_sector_size(_address)) != 0) || ((_area_size % _flash.get_sector_size(_address)) != 0) ||
+        (_area_size > (flash_end - _address) / 2) || overlaps_application()) {
+        _flash.deinit();
+        _mutex.unlock();
+        return FLASHKV_ERROR_INVALID_ARGUMENT;
+    }
+
+    _page_size = _flash.get_page_size();
+    _first_record = align_up(sizeof(area_header_t), _page_size);
+    _work_buf = new uint8_t[record_size(FLASHKV_MAX_KEY_SIZE, MBED_CONF_DRIVERS_FLASH_KV_MAX_DATA_SIZE)];
+
+    // The valid area with the most recent sequence number is the active one
+    uint32_t seq[2];
+    uint32_t erase_count[2];
+    bool valid[2];
+    for (int area = 0; area < 2; area++) {
+        valid[area] = (read_area_header(area, &seq[area], &erase_count[area]) == FLASHKV_ERROR_OK);
+    }
+
+    if (valid[0] || valid[1]) {
+        if (valid[0] && valid[1]) {
+            _active = ((int32_t)(seq[1] - seq[0]) > 0) ? 1 : 0;
+        } else {
+            _active = valid[0] ? 0 : 1;
+        }
+        _seq = seq[_active];
+        _erase_count = erase_count[_active];
+        ret = scan();
+    } else {
+        _active = 0;
+        ret = format(0, 1, 1);
+    }
+
+    if (ret == FLASHKV_ERROR_OK) {
+        _initialized = true;
+    } else {
+        delete[] _work_buf;
+        _work_buf = NULL;
+        _flash.deinit();
+    }
+    _mutex.unlock();
+    return ret;
+}
+
+int FlashKVStore::deinit()
+{
+    _mutex.lock();
+    if (_initialized) {
+        _flash.deinit();
+        delete[] _work_buf;
+        _work_buf = NULL;
+        _num_keys = 0;
+        _initialized = false;
+    }
+    _mutex.unlock();
+    return FLASHKV_ERROR_OK;
+}
+
+int FlashKVStore::set(const char *key, const void *buffer, uint32_t size)
+{
+    uint32_t key_size = key ? strlen(key) : 0;
+    if ((key_size == 0) || (key_size > FLASHKV_MAX_KEY_SIZE) ||
+        (size > MBED_CONF_DRIVERS_FLASH_KV_MAX_DATA_SIZE) || (!buffer && size)) {
+        return FLASHKV_ERROR_INVALID_ARGUMENT;
+    }
+
+    _mutex.lock();
+    if (!_initialized) {
+        _mutex.unlock();
+        return FLASHKV_ERROR_NOT_INITIALIZED;
+    }
+
+    int i = find(key, key_size, key_hash(key, key_size));
+    if (i >= 0) {
+        // Skip the write, and the wear, if the value did not change
+        const record_header_t *header = (const record_header_t *)_work_buf;
+        uint32_t addr = area_address(_active) + _index[i].offset;
+        if ((_flash.read(_work_buf, addr, sizeof(record_header_t)) == 0) && (header->data_size == size) &&
+            (_flash.read(_work_buf, addr + sizeof(record_header_t) + key_size, size) == 0) &&
+            (memcmp(_work_buf, buffer, size) == 0)) {
+            _mutex.unlock();
+            return FLASHKV_ERROR_OK;
+        }
+    } else if (_num_keys == MBED_CONF_DRIVERS_FLASH_KV_MAX_KEYS) {
+        _mutex.unlock();
+        return FLASHKV_ERROR_FULL;
+    }
+
+    int ret = append(key, key_size, buffer, size, 0);
+    _mutex.unlock();
+    return ret;
+}
+
+int FlashKVStore::get(const char *key, void *buffer, uint32_t buffer_size, uint32_t *actual_size)
+{
+    uint32_t key_size = key ? strlen(key) : 0;
+    if ((key_size == 0) || (key_size > FLASHKV_MAX_KEY_SIZE) || (!buffer && buffer_size)) {
+        return FLASHKV_ERROR_INVALID_ARGUMENT;
+    }
+
+    _mutex.lock();
+    if (!_initialized) {
+        _mutex.unlock();
+        return FLASHKV_ERROR_NOT_INITIALIZED;
+    }
+
+    int i = find(key, key_size, key_hash(key, key_size));
+    if (i < 0) {
+        _mutex.unlock();
+        return FLASHKV_ERROR_NOT_FOUND;
+    }
+
+    record_header_t header;
+    uint32_t addr = area_address(_active) + _index[i].offset;
+    int ret = FLASHKV_ERROR_OK;
+    if (_flash.read(&header, addr, sizeof(header)) != 0) {
+        ret = FLASHKV_ERROR_DEVICE_ERROR;
+    } else {
+        uint32_t size = (header.data_size < buffer_size) ? header.data_size : buffer_size;
+        if (size && _flash.read(buffer, addr + sizeof(header) + key_size, size) != 0) {
+            ret = FLASHKV_ERROR_DEVICE_ERROR;
+        }
+        if (actual_size) {
+            *actual_size = header.data_size;
+        }
+    }
+    _mutex.unlock();
+    return ret;
+}
+
+int FlashKVStore::remove(const char *key)
+{
+    uint32_t key_size = key ? strlen(key) : 0;
+    if ((key_size == 0) || (key_size > FLASHKV_MAX_KEY_SIZE)) {
+        return FLASHKV_ERROR_INVALID_ARGUMENT;
+    }
+
+    _mutex.lock();
+    if (!_initialized) {
+        _mutex.unlock();
+        return FLASHKV_ERROR_NOT_INITIALIZED;
+    }
+
+    int ret = FLASHKV_ERROR_NOT_FOUND;
+    if (find(key, key_size, key_hash(key, key_size)) >= 0) {
+        ret = append(key, key_size, NULL, 0, RECORD_FLAG_DELETED);
+    }
+    _mutex.unlock();
+    return ret;
+}
+
+int FlashKVStore::reset()
+{
+    _mutex.lock();
+    if (!_initialized) {
+        _mutex.unlock();
+        return FLASHKV_ERROR_NOT_INITIALIZED;
+    }
+
+    int ret = FLASHKV_ERROR_OK;
+    int other = 1 - _active;
+    if (_flash.erase(area_address(other), _area_size) != 0) {
+        ret = FLASHKV_ERROR_DEVICE_ERROR;
+    } else {
+        ret = format(_active, _seq + 1, _erase_count + 1);
+    }
+    _mutex.unlock();
+    return ret;
+}
+
+uint32_t FlashKVStore::get_key_count() const
+{
+    return _num_keys;
+}
+
+uint32_t FlashKVStore::get_erase_count() const
+{
+    return _erase_count;
+}
+
+bool FlashKVStore::overlaps_application() const
+{
+#if defined(MBED_APP_START) && defined(MBED_APP_SIZE)
+    return (_address < MBED_APP_START + MBED_APP_SIZE) && (MBED_APP_START < _address + 2 * _area_size);
+#else
+    return false;
+#endif
+}
+
+uint32_t FlashKVStore::area_address(int area) const
+{
+    return _address + area * _area_size;
+}
+
+uint32_t FlashKVStore::record_size(uint32_t key_size, uint32_t data_size) const
+{
+    return align_up(sizeof(record_header_t) + key_size + data_size, _page_size);
+}
+
+int FlashKVStore::find(const char *key, uint32_t key_size, uint32_t hash)
+{
+    const record_header_t *header = (const record_header_t *)_work_buf;
+    for (uint32_t i = 0; i < _num_keys; i++) {
+        if (_index[i].hash != hash) {
+            continue;
+        }
+        // Overwrites the work buffer, the key must not be held in it
+        if ((_flash.read(_work_buf, area_address(_active) + _index[i].offset, sizeof(record_header_t) + key_size) == 0) &&
+            (header->key_size == key_size) && (memcmp(_work_buf + sizeof(record_header_t), key, key_size) == 0)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int FlashKVStore::read_area_header(int area, uint32_t *seq, uint32_t *erase_count)
+{
+    area_header_t header;
+    if (_flash.read(&header, area_address(area), sizeof(header)) != 0) {
+        return FLASHKV_ERROR_DEVICE_ERROR;
+    }
+
+    if ((header.magic != AREA_MAGIC) || (header.crc != compute_crc(&header, offsetof(area_header_t, crc)))) {
+        *erase_count = (header.magic == AREA_MAGIC) ? header.erase_count : 0;
+        return FLASHKV_ERROR_NOT_FOUND;
+    }
+
+    *seq = header.seq;
+    *erase_count = header.erase_count;
+    return FLASHKV_ERROR_OK;
+}
+
+int FlashKVStore::format(int area, uint32_t seq, uint32_t erase_count)
+{
+    if (_flash.erase(area_address(area), _area_size) != 0) {
+        return FLASHKV_ERROR_DEVICE_ERROR;
+    }
+
+    area_header_t header;
+    header.magic = AREA_MAGIC;
+    header.seq = seq;
+    header.erase_count = erase_count;
+    header.crc = compute_crc(&header, offsetof(area_header_t, crc));
+    if (_flash.program(&header, area_address(area), sizeof(header)) != 0) {
+        return FLASHKV_ERROR_DEVICE_ERROR;
+    }
+
+    _active = area;
+    _seq = seq;
+    _erase_count = erase_count;
+    _free = _first_record;
+    _num_keys = 0;
+    return FLASHKV_ERROR_OK;
+}
+
+int FlashKVStore::scan()
+{
+    uint32_t base = area_address(_active);
+    uint32_t offset = _first_record;
+    const record_header_t *header = (const record_header_t *)_work_buf;
+
+    _num_keys = 0;
+    while (offset + sizeof(record_header_t) <= _area_size) {
+        if (_flash.read(_work_buf, base + offset, sizeof(record_header_t)) != 0) {
+            return FLASHKV_ERROR_DEVICE_ERROR;
+        }
+        if (header->magic == ERASED_WORD) {
+            break;
+        }
+
+        uint32_t key_size = header->key_size;
+        uint32_t data_size = header->data_size;
+        uint32_t size = record_size(key_size, data_size);
+        if ((header->magic != RECORD_MAGIC) || (key_size == 0) || (key_size > FLASHKV_MAX_KEY_SIZE) ||
+            (data_size > MBED_CONF_DRIVERS_FLASH_KV_MAX_DATA_SIZE) || (offset + size > _area_size)) {
+            // The rest of the area cannot be parsed, force a garbage collection on the next write
+            offset = _area_size;
+            break;
+        }
+
+        // Torn or corrupted records are skipped, the previous value of the key stays in use
+        uint32_t crc = header->crc;
+        uint8_t flags = header->flags;
+        if (_flash.read(_work_buf, base + offset, sizeof(record_header_t) + key_size + data_size) != 0) {
+            return FLASHKV_ERROR_DEVICE_ERROR;
+        }
+        ((record_header_t *)_work_buf)->crc = 0;
+        if (crc == compute_crc(_work_buf, sizeof(record_header_t) + key_size + data_size)) {
+            char key[FLASHKV_MAX_KEY_SIZE];
+            memcpy(key, _work_buf + sizeof(record_header_t), key_size);
+            uint32_t hash = key_hash(key, key_size);
+            int i = find(key, key_size, hash);
+
+            if (flags & RECORD_FLAG_DELETED) {
+                if (i >= 0) {
+                    _index[i] = _index[--_num_keys];
+                }
+            } else if (i >= 0) {
+                _index[i].offset = offset;
+            } else if (_num_keys < MBED_CONF_DRIVERS_FLASH_KV_MAX_KEYS) {
+                _index[_num_keys].hash = hash;
+                _index[_num_keys].offset = offset;
+                _num_keys++;
+            }
+        }
+        offset += size;
+    }
+
+    _free = offset;
+    return FLASHKV_ERROR_OK;
+}
+
+int FlashKVStore::append(const char *key, uint32_t key_size, const void *buffer, uint32_t size, uint8_t flags)
+{
+    uint32_t rec_size = record_size(key_size, size);
+    if (_free + rec_size > _area_size) {
+        int ret = garbage_collect();
+        if (ret != FLASHKV_ERROR_OK) {
+            return ret;
+        }
+        if (_free + rec_size > _area_size) {
+            return FLASHKV_ERROR_FULL;
+        }
+    }
+
+    // Looked up before the record is built in the work buffer
+    int i = find(key, key_size, key_hash(key, key_size));
+
+    record_header_t *header = (record_header_t *)_work_buf;
+    header->magic = RECORD_MAGIC;
+    header->key_size = key_size;
+    header->flags = flags;
+    header->data_size = size;
+    header->crc = 0;
+    memcpy(_work_buf + sizeof(record_header_t), key, key_size);
+    if (size) {
+        memcpy(_work_buf + sizeof(record_header_t) + key_size, buffer, size);
+    }
+    header->crc = compute_crc(_work_buf, sizeof(record_header_t) + key_size + size);
+    memset(_work_buf + sizeof(record_header_t) + key_size + size, 0xFF,
+           rec_size - (sizeof(record_header_t) + key_size + size));
+
+    uint32_t offset = _free;
+    if (_flash.program(_work_buf, area_address(_active) + offset, rec_size) != 0) {
+        // The record may be partially programmed, and an erased hole would end
+        // the scan at boot: move the live records to the other area on the next write
+        _free = _area_size;
+        return FLASHKV_ERROR_DEVICE_ERROR;
+    }
+    _free += rec_size;
+
+    if (flags & RECORD_FLAG_DELETED) {
+        if (i >= 0) {
+            _index[i] = _index[--_num_keys];
+        }
+    } else if (i >= 0) {
+        _index[i].offset = offset;
+    } else {
+        _index[_num_keys].hash = key_hash(key, key_size);
+        _index[_num_keys].offset = offset;
+        _num_keys++;
+    }
+    return FLASHKV_ERROR_OK;
+}
+
+int FlashKVStore::garbage_collect()
+{
+    int other = 1 - _active;
+    uint32_t seq = 0;
+    uint32_t erase_count = 0;
+    uint32_t offsets[MBED_CONF_DRIVERS_FLASH_KV_MAX_KEYS];
+    read_area_header(other, &seq, &erase_count);
+
+    if (_flash.erase(area_address(other), _area_size) != 0) {
+        return FLASHKV_ERROR_DEVICE_ERROR;
+    }
+
+    // Copy the live records, the area header is written last so that the
+    // current area stays the active one if the copy is interrupted
+    uint32_t offset = _first_record;
+    for (uint32_t i = 0; i < _num_keys; i++) {
+        uint32_t src = area_address(_active) + _index[i].offset;
+        const record_header_t *header = (const record_header_t *)_work_buf;
+        if (_flash.read(_work_buf, src, sizeof(record_header_t)) != 0) {
+            return FLASHKV_ERROR_DEVICE_ERROR;
+        }
+        uint32_t size = record_size(header->key_size, header->data_size);
+        if ((_flash.read(_work_buf, src, size) != 0) ||
+            (_flash.program(_work_buf, area_address(other) + offset, size) != 0)) {
+            return FLASHKV_ERROR_DEVICE_ERROR;
+        }
+        offsets[i] = offset;
+        offset += size;
+    }
+
+    area_header_t header;
+    header.magic = AREA_MAGIC;
+    header.seq = _seq + 1;
+    header.erase_count = erase_count + 1;
+    header.crc = compute_crc(&header, offsetof(area_header_t, crc));
+    if (_flash.program(&header, area_address(other), sizeof(header)) != 0) {
+        return FLASHKV_ERROR_DEVICE_ERROR;
+    }
+
+    for (uint32_t i = 0; i < _num_keys; i++) {
+        _index[i].offset = offsets[i];
+    }
+    _active = other;
+    _seq = header.seq;
+    _erase_count = header.erase_count;
+    _free = offset;
+    return FLASHKV_ERROR_OK;
+}
+
+} /* namespace mbed */
+
+#endif /* DEVICE_FLASH */
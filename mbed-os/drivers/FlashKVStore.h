@@ -0,0 +1,206 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_FLASHKVSTORE_H
+#define MBED_FLASHKVSTORE_H
+
+#include "platform/platform.h"
+
+#if defined (DEVICE_FLASH) || defined(DOXYGEN_ONLY)
+
+#include "FlashIAP.h"
+#include "platform/PlatformMutex.h"
+#include "platform/NonCopyable.h"
+
+#ifndef MBED_CONF_DRIVERS_FLASH_KV_MAX_KEYS
+#define MBED_CONF_DRIVERS_FLASH_KV_MAX_KEYS       16
+#endif
+
+#ifndef MBED_CONF_DRIVERS_FLASH_KV_MAX_DATA_SIZE
+#define MBED_CONF_DRIVERS_FLASH_KV_MAX_DATA_SIZE  128
+#endif
+
+#ifndef MBED_CONF_DRIVERS_FLASH_KV_ADDRESS
+#define MBED_CONF_DRIVERS_FLASH_KV_ADDRESS        0
+#endif
+
+#ifndef MBED_CONF_DRIVERS_FLASH_KV_AREA_SIZE
+#define MBED_CONF_DRIVERS_FLASH_KV_AREA_SIZE      0
+#endif
+
+/** Maximum length of a key, excluding the terminating null character */
+#define FLASHKV_MAX_KEY_SIZE  16
+
+namespace mbed {
+
+/** \addtogroup drivers */
+
+/** Enum of standard error codes
+ *
+ *  @enum flash_kv_error
+ */
+enum flash_kv_error {
+    FLASHKV_ERROR_OK                 = 0,     /*!< no error */
+    FLASHKV_ERROR_DEVICE_ERROR       = -4101, /*!< flash read, program or erase failed */
+    FLASHKV_ERROR_NOT_FOUND          = -4102, /*!< key does not exist */
+    FLASHKV_ERROR_INVALID_ARGUMENT   = -4103, /*!< key, data size or flash areas out of range */
+    FLASHKV_ERROR_FULL               = -4104, /*!< no room left for the record or the key */
+    FLASHKV_ERROR_NOT_INITIALIZED    = -4105, /*!< init() was not called or failed */
+};
+
+/** Append-only key/value store on top of the internal flash.
+ *
+ * Records are appended to one of two flash areas and protected by a CRC.
+ * Updating a value never erases flash until the active area is full, at
+ * which point the live records are copied to the other area and the areas
+ * swap roles, so the erases alternate between the two. Values are located
+ * through a RAM index built by scanning the active area in init().
+ *
+ * Example:
+ * @code
+ * // Two sectors kept out of the application image and of other flash users
+ * FlashKVStore kv(0x0803F000, 0x800);
+ *
+ * int main() {
+ *     uint32_t interval = 10;
+ *
+ *     kv.init();
+ *     kv.get("interval", &interval, sizeof(interval));
+ *     interval = 60;
+ *     kv.set("interval", &interval, sizeof(interval));
+ * }
+ * @endcode
+ *
+ * @note Synchronization level: Thread safe
+ * @ingroup drivers
+ */
+class FlashKVStore : private NonCopyable<FlashKVStore> {
+public:
+    /** Create a key/value store on two consecutive flash areas
+     *
+     *  The areas are erased and programmed by the store, so they must be
+     *  reserved for it: out of the application image, by shrinking
+     *  target.mbed_app_size or the linker script ROM region, and out of the
+     *  pages of any other flash user.
+     *
+     *  @param address   Start of the first area, must be sector aligned.
+     *                   Defaults to the drivers.flash-kv-address option;
+     *                   init() fails if no address is given.
+     *  @param area_size Size of each area, must be a multiple of the sector size.
+     *                   Defaults to the drivers.flash-kv-area-size option;
+     *                   0 uses one sector per area.
+     */
+    FlashKVStore(uint32_t address = MBED_CONF_DRIVERS_FLASH_KV_ADDRESS,
+                 uint32_t area_size = MBED_CONF_DRIVERS_FLASH_KV_AREA_SIZE);
+    ~FlashKVStore();
+
+    /** Initialize the store and build the RAM index from the active area
+     *
+     *  Formats the first area if neither area holds a valid store.
+     *  @return 0 on success, FLASHKV_ERROR_INVALID_ARGUMENT if the areas are
+     *          not given, not sector aligned, past the end of the flash or in
+     *          the application image, or another negative error code on failure
+     */
+    int init();
+
+    /** Deinitialize the store
+     *
+     *  @return 0 on success or a negative error code on failure
+     */
+    int deinit();
+
+    /** Set the value of a key
+     *
+     *  Nothing is written if the stored value is already identical.
+     *
+     *  @param key    Null terminated key, up to FLASHKV_MAX_KEY_SIZE characters
+     *  @param buffer Value to store
+     *  @param size   Size of the value, up to MBED_CONF_DRIVERS_FLASH_KV_MAX_DATA_SIZE bytes
+     *  @return       0 on success or a negative error code on failure
+     */
+    int set(const char *key, const void *buffer, uint32_t size);
+
+    /** Get the value of a key
+     *
+     *  @param key         Null terminated key
+     *  @param buffer      Buffer to copy the value to
+     *  @param buffer_size Size of the buffer, the value is truncated if larger
+     *  @param actual_size If not NULL, receives the size of the stored value
+     *  @return            0 on success or a negative error code on failure
+     */
+    int get(const char *key, void *buffer, uint32_t buffer_size, uint32_t *actual_size = NULL);
+
+    /** Remove a key
+     *
+     *  @param key Null terminated key
+     *  @return    0 on success or a negative error code on failure
+     */
+    int remove(const char *key);
+
+    /** Remove all keys and erase both areas
+     *
+     *  @return 0 on success or a negative error code on failure
+     */
+    int reset();
+
+    /** Get the number of keys currently stored
+     *
+     *  @return Number of keys
+     */
+    uint32_t get_key_count() const;
+
+    /** Get the number of times the active area has been erased
+     *
+     *  @return Erase count of the active area
+     */
+    uint32_t get_erase_count() const;
+
+private:
+    struct index_entry_t {
+        uint32_t hash;
+        uint32_t offset;
+    };
+
+    bool overlaps_application() const;
+    uint32_t area_address(int area) const;
+    uint32_t record_size(uint32_t key_size, uint32_t data_size) const;
+    int find(const char *key, uint32_t key_size, uint32_t hash);
+    int read_area_header(int area, uint32_t *seq, uint32_t *erase_count);
+    int format(int area, uint32_t seq, uint32_t erase_count);
+    int scan();
+    int append(const char *key, uint32_t key_size, const void *buffer, uint32_t size, uint8_t flags);
+    int garbage_collect();
+
+    FlashIAP _flash;
+    uint32_t _address;
+    uint32_t _area_size;
+    uint32_t _page_size;
+    uint32_t _first_record;
+    int _active;
+    uint32_t _seq;
+    uint32_t _erase_count;
+    uint32_t _free;
+    bool _initialized;
+    uint8_t *_work_buf;
+    uint32_t _num_keys;
+    index_entry_t _index[MBED_CONF_DRIVERS_FLASH_KV_MAX_KEYS];
+    PlatformMutex _mutex;
+};
+
+} /* namespace mbed */
+
+#endif  /* DEVICE_FLASH */
+
+#endif  /* MBED_FLASHKVSTORE_H */
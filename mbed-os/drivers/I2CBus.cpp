@@ -0,0 +1,230 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "drivers/I2CBus.h"
+
+#if DEVICE_I2C_ASYNCH
+
+#include <string.h>
+#include "platform/mbed_assert.h"
+#include "platform/mbed_critical.h"
+
+namespace mbed {
+
+enum {
+    STAGE_IDLE = 0,     // not queued
+    STAGE_WRITE,        // queued for its write, or its write and read without a delay
+    STAGE_DELAY,        // waiting for the delay between the write and the read
+    STAGE_READ          // queued for its read
+};
+
+static us_timestamp_t now_us()
+{
+    return ticker_read_us(get_us_ticker_data());
+}
+
+I2CBus::I2CBus(I2C &i2c, events::EventQueue *queue) :
+    _i2c(i2c), _queue(queue), _head(NULL), _tail(NULL), _current(NULL), _transfer_start(0)
+{
+    reset_stats();
+}
+
+I2CBus::~I2CBus()
+{
+    // Transactions still queued are dropped, their callbacks are not called
+}
+
+int I2CBus::submit(I2CTransaction *transaction)
+{
+    core_util_critical_section_enter();
+    if (transaction->_stage != STAGE_IDLE) {
+        core_util_critical_section_exit();
+        return -1;
+    }
+    transaction->_stage = (transaction->tx_length > 0) ? STAGE_WRITE : STAGE_READ;
+    push_back(transaction);
+    core_util_critical_section_exit();
+
+    _queue->call(this, &I2CBus::process);
+    return 0;
+}
+
+void I2CBus::get_stats(stats_t *stats)
+{
+    core_util_critical_section_enter();
+    *stats = _stats;
+    stats->elapsed = now_us() - _stats_start;
+    core_util_critical_section_exit();
+
+    stats->utilization = stats->elapsed ? (uint32_t)(stats->busy_time * 1000 / stats->elapsed) : 0;
+}
+
+void I2CBus::reset_stats()
+{
+    core_util_critical_section_enter();
+    memset(&_stats, 0, sizeof(_stats));
+    _stats_start = now_us();
+    core_util_critical_section_exit();
+}
+
+void I2CBus::push_back(I2CTransaction *transaction)
+{
+    transaction->_next = NULL;
+    if (_tail != NULL) {
+        _tail->_next = transaction;
+    } else {
+        _head = transaction;
+    }
+    _tail = transaction;
+}
+
+void I2CBus::push_front(I2CTransaction *transaction)
+{
+    transaction->_next = _head;
+    _head = transaction;
+    if (_tail == NULL) {
+        _tail = transaction;
+    }
+}
+
+I2CTransaction *I2CBus::pop()
+{
+    I2CTransaction *transaction = _head;
+    if (transaction != NULL) {
+        _head = transaction->_next;
+        if (_head == NULL) {
+            _tail = NULL;
+        }
+    }
+    return transaction;
+}
+
+void I2CBus::process()
+{
+    if (_current != NULL) {
+        return;
+    }
+
+    core_util_critical_section_enter();
+    I2CTransaction *transaction = pop();
+    core_util_critical_section_exit();
+
+    if (transaction != NULL) {
+        start(transaction);
+    }
+}
+
+void I2CBus::start(I2CTransaction *transaction)
+{
+    const char *tx_buffer = NULL;
+    char *rx_buffer = NULL;
+    int tx_length = 0;
+    int rx_length = 0;
+
+    if (transaction->_stage == STAGE_WRITE) {
+        tx_buffer = transaction->tx_buffer;
+        tx_length = transaction->tx_length;
+        if (transaction->delay_ms == 0) {
+            rx_buffer = transaction->rx_buffer;
+            rx_length = transaction->rx_length;
+        }
+    } else {
+        rx_buffer = transaction->rx_buffer;
+        rx_length = transaction->rx_length;
+    }
+
+    // Keep the blocking calls of other threads off the bus until the end of the transfer
+    _i2c.lock();
+    _current = transaction;
+    _transfer_start = now_us();
+
+    if (_i2c.transfer(transaction->address, tx_buffer, tx_length, rx_buffer, rx_length,
+                      callback(this, &I2CBus::transfer_done), I2C_EVENT_ALL) != 0) {
+        // Another non-blocking transfer is in progress on this I2C peripheral, try again later
+        _current = NULL;
+        _i2c.unlock();
+
+        core_util_critical_section_enter();
+        push_front(transaction);
+        core_util_critical_section_exit();
+        _queue->call_in(1, this, &I2CBus::process);
+    }
+}
+
+void I2CBus::transfer_done(int event)
+{
+    // Called from the I2C interrupt
+    int id = _queue->call(this, &I2CBus::complete, event);
+    MBED_ASSERT(id != 0);
+    (void)id;
+}
+
+void I2CBus::complete(int event)
+{
+    I2CTransaction *transaction = _current;
+    us_timestamp_t busy_time = now_us() - _transfer_start;
+
+    _current = NULL;
+    _i2c.unlock();
+
+    core_util_critical_section_enter();
+    _stats.transfers++;
+    _stats.busy_time += busy_time;
+    core_util_critical_section_exit();
+
+    if ((event & I2C_EVENT_ALL) != I2C_EVENT_TRANSFER_COMPLETE) {
+        finish(transaction, event);
+    } else if ((transaction->_stage == STAGE_WRITE) && (transaction->delay_ms > 0) && (transaction->rx_length > 0)) {
+        // Release the bus during the delay
+        transaction->_stage = STAGE_DELAY;
+        int id = _queue->call_in(transaction->delay_ms, this, &I2CBus::delay_done, transaction);
+        MBED_ASSERT(id != 0);
+        (void)id;
+    } else {
+        finish(transaction, I2C_EVENT_TRANSFER_COMPLETE);
+    }
+
+    // Start the next transaction in the same wake-up
+    process();
+}
+
+void I2CBus::delay_done(I2CTransaction *transaction)
+{
+    core_util_critical_section_enter();
+    transaction->_stage = STAGE_READ;
+    push_front(transaction);
+    core_util_critical_section_exit();
+
+    process();
+}
+
+void I2CBus::finish(I2CTransaction *transaction, int event)
+{
+    core_util_critical_section_enter();
+    transaction->_stage = STAGE_IDLE;
+    _stats.transactions++;
+    if (event != I2C_EVENT_TRANSFER_COMPLETE) {
+        _stats.errors++;
+    }
+    core_util_critical_section_exit();
+
+    if (transaction->callback) {
+        transaction->callback(event);
+    }
+}
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,184 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_I2CBUS_H
+#define MBED_I2CBUS_H
+
+#include "platform/platform.h"
+
+#if defined (DEVICE_I2C_ASYNCH) || defined(DOXYGEN_ONLY)
+
+#include "drivers/I2C.h"
+#include "events/EventQueue.h"
+#include "hal/us_ticker_api.h"
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+
+namespace mbed {
+
+/** \addtogroup drivers */
+
+class I2CBus;
+
+/** An I2C transaction queued on an I2CBus
+ *
+ * Writes the TX buffer, waits for a delay with the bus released, for instance
+ * for a sensor conversion, then reads the RX buffer. Either buffer may be
+ * empty. Without a delay the write and the read are done in one transfer
+ * with a repeated start.
+ *
+ * The transaction is owned by the caller. It must stay valid and must not be
+ * modified from its submission until its callback is called.
+ *
+ * @ingroup drivers
+ */
+class I2CTransaction {
+public:
+    /** Create a transaction
+     *
+     *  @param address   8-bit I2C slave address
+     *  @param tx_buffer Data to write, or NULL
+     *  @param tx_length Number of bytes to write
+     *  @param rx_buffer Buffer for the data read, or NULL
+     *  @param rx_length Number of bytes to read
+     *  @param delay_ms  Time between the end of the write and the start of the read, in milliseconds
+     */
+    I2CTransaction(int address = 0, const char *tx_buffer = NULL, int tx_length = 0,
+                   char *rx_buffer = NULL, int rx_length = 0, int delay_ms = 0) :
+        address(address), tx_buffer(tx_buffer), tx_length(tx_length),
+        rx_buffer(rx_buffer), rx_length(rx_length), delay_ms(delay_ms),
+        _next(NULL), _stage(0)
+    {
+    }
+
+    int address;                    /**< 8-bit I2C slave address */
+    const char *tx_buffer;          /**< Data to write */
+    int tx_length;                  /**< Number of bytes to write, 0 for a read only */
+    char *rx_buffer;                /**< Buffer for the data read */
+    int rx_length;                  /**< Number of bytes to read, 0 for a write only */
+    int delay_ms;                   /**< Delay between the write and the read, in milliseconds */
+
+    /** Called from the event queue when the transaction ends, with
+     *  I2C_EVENT_TRANSFER_COMPLETE or the I2C_EVENT_ERROR* flags of the
+     *  failed transfer. The transaction may be submitted again from it.
+     */
+    event_callback_t callback;
+
+private:
+    friend class I2CBus;
+
+    I2CTransaction *_next;
+    int _stage;
+};
+
+/** Scheduler of the transactions of several drivers sharing an I2C bus
+ *
+ * Transactions are run one after the other from an event queue, with the
+ * non-blocking I2C::transfer. The next transaction starts as soon as the
+ * previous transfer ends, so transactions queued together are done in one
+ * wake-up. The bus is locked for each transfer only, and released during the
+ * delay of a transaction, so other transactions and the blocking I2C calls of
+ * other threads can use it meanwhile. The read of a transaction whose delay
+ * has expired runs before the transactions waiting for their write.
+ *
+ * Example:
+ * @code
+ * I2C i2c(PC_1, PC_0);
+ * EventQueue queue;
+ * I2CBus bus(i2c, &queue);
+ *
+ * const char reg = 0x00;
+ * char data[4];
+ * I2CTransaction hdc1510(0x80, &reg, 1, data, 4, 7);
+ *
+ * void hdc1510_done(int event) {
+ *     if (event == I2C_EVENT_TRANSFER_COMPLETE) {
+ *         // data holds the temperature and the humidity
+ *     }
+ * }
+ *
+ * int main() {
+ *     hdc1510.callback = hdc1510_done;
+ *     queue.call_every(1000, &bus, &I2CBus::submit, &hdc1510);
+ *     queue.dispatch_forever();
+ * }
+ * @endcode
+ *
+ * @note Synchronization level: Interrupt safe
+ * @ingroup drivers
+ */
+class I2CBus : private NonCopyable<I2CBus> {
+public:
+    /** Bus statistics since the last reset */
+    typedef struct {
+        uint32_t transactions;          /**< Number of transactions ended */
+        uint32_t errors;                /**< Number of transactions ended by an error */
+        uint32_t transfers;             /**< Number of transfers, a transaction with a delay takes two */
+        us_timestamp_t busy_time;       /**< Time with a transfer in progress, in microseconds */
+        us_timestamp_t elapsed;         /**< Time since the last reset, in microseconds */
+        uint32_t utilization;           /**< busy_time / elapsed, in tenths of a percent */
+    } stats_t;
+
+    /** Create a scheduler for an I2C bus
+     *
+     *  @param i2c   I2C master of the bus
+     *  @param queue Event queue running the transactions and their callbacks
+     */
+    I2CBus(I2C &i2c, events::EventQueue *queue);
+    ~I2CBus();
+
+    /** Queue a transaction
+     *
+     *  @param transaction Transaction to run
+     *  @return 0 if the transaction is queued, -1 if it is already queued or running
+     */
+    int submit(I2CTransaction *transaction);
+
+    /** Get the bus statistics
+     *
+     *  @param stats Statistics since the last reset
+     */
+    void get_stats(stats_t *stats);
+
+    /** Reset the bus statistics
+     */
+    void reset_stats();
+
+private:
+    void push_back(I2CTransaction *transaction);
+    void push_front(I2CTransaction *transaction);
+    I2CTransaction *pop();
+    void process();
+    void start(I2CTransaction *transaction);
+    void transfer_done(int event);
+    void complete(int event);
+    void delay_done(I2CTransaction *transaction);
+    void finish(I2CTransaction *transaction, int event);
+
+    I2C &_i2c;
+    events::EventQueue *_queue;
+    I2CTransaction *_head;
+    I2CTransaction *_tail;
+    I2CTransaction *_current;
+    us_timestamp_t _transfer_start;
+    us_timestamp_t _stats_start;
+    stats_t _stats;
+};
+
+} // namespace mbed
+
+#endif
+
+#endif
@@ -15,7 +15,9 @@
  */
 #include "drivers/RawSerial.h"
 #include "platform/mbed_wait_api.h"
+#include "platform/mbed_minimal_printf.h"
 #include <stdio.h>
+#include <string.h>
 #include <cstdarg>
 
 
@@ -45,12 +47,46 @@ int RawSerial::putc(int c) {
 
 int RawSerial::puts(const char *str) {
     lock();
-    while (*str)
-        putc(*str ++);
+    _base_write(str, strlen(str));
     unlock();
     return 0;
 }
 
+int RawSerial::write(const void *buffer, size_t length) {
+    lock();
+    _base_write(buffer, length);
+    unlock();
+    return length;
+}
+
+int RawSerial::read(void *buffer, size_t length) {
+    size_t count = 0;
+
+    lock();
+    while (count < length) {
+        count += _base_read(static_cast<char *>(buffer) + count, length - count);
+    }
+    unlock();
+    return count;
+}
+
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF
+static int raw_serial_sink(void *context, const char *data, size_t length) {
+    static_cast<RawSerial *>(context)->write(data, length);
+    return 0;
+}
+
+// The minimal printf formats straight to the serial, through a small stack buffer
+int RawSerial::printf(const char *format, ...) {
+    lock();
+    std::va_list arg;
+    va_start(arg, format);
+    int len = mbed_minimal_vxprintf(raw_serial_sink, this, format, arg);
+    va_end(arg);
+    unlock();
+    return len;
+}
+#else
 // Experimental support for printf in RawSerial. No Stream inheritance
 // means we can't call printf() directly, so we use sprintf() instead.
 // We only call malloc() for the sprintf() buffer if the buffer
@@ -77,6 +113,7 @@ int RawSerial::printf(const char *format, ...) {
     unlock();
     return len;
 }
+#endif
 
 /** Acquire exclusive access to this serial port
  */
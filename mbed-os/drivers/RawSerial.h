@@ -53,6 +53,11 @@ namespace mbed {
 class RawSerial: public SerialBase, private NonCopyable<RawSerial> {
 
 public:
+#if DEVICE_SERIAL_ASYNCH
+    using SerialBase::read;
+    using SerialBase::write;
+#endif
+
     /** Create a RawSerial port, connected to the specified transmit and receive pins, with the specified baud.
      *
      *  @param tx Transmit pin
@@ -86,6 +91,24 @@ public:
      */
     int puts(const char *str);
 
+    /** Write a block of chars to the serial port
+     *
+     * @param buffer The chars to write
+     * @param length The number of chars
+     *
+     * @returns The number of chars written
+     */
+    int write(const void *buffer, size_t length);
+
+    /** Read a block of chars from the serial port, waiting for all of them
+     *
+     * @param buffer The buffer for the chars
+     * @param length The number of chars to read
+     *
+     * @returns The number of chars read
+     */
+    int read(void *buffer, size_t length);
+
     int printf(const char *format, ...);
 
 protected:
@@ -36,6 +36,22 @@ int Serial::_putc(int c) {
     return _base_putc(c);
 }
 
+ssize_t Serial::_write(const void *buffer, size_t length) {
+    // Mutex is already held
+    _base_write(buffer, length);
+    return length;
+}
+
+ssize_t Serial::_read(void *buffer, size_t length) {
+    // Mutex is already held, wait for all the characters like the default
+    size_t count = 0;
+
+    while (count < length) {
+        count += _base_read(static_cast<char *>(buffer) + count, length - count);
+    }
+    return count;
+}
+
 void Serial::lock() {
     _mutex.lock();
 }
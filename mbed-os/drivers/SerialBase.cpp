@@ -109,6 +109,16 @@ int SerialBase::_base_putc(int c) {
     return c;
 }
 
+void SerialBase::_base_write(const void *buffer, size_t length) {
+    // Mutex is already held
+    serial_putc_buffer(&_serial, buffer, length);
+}
+
+size_t SerialBase::_base_read(void *buffer, size_t length) {
+    // Mutex is already held
+    return serial_getc_buffer(&_serial, buffer, length);
+}
+
 void SerialBase::send_break() {
     lock();
   // Wait for 1.5 frames before clearing the break condition
@@ -246,6 +246,21 @@ protected:
     int _base_getc();
     int _base_putc(int c);
 
+    /** Send a block of characters, waiting for each to be written
+     *
+     *  @param buffer The characters to send
+     *  @param length The number of characters
+     */
+    void _base_write(const void *buffer, size_t length);
+
+    /** Read the characters received, waiting for the first one
+     *
+     *  @param buffer The buffer for the characters
+     *  @param length The size of the buffer
+     *  @returns The number of characters read, at least 1 if length is not 0
+     */
+    size_t _base_read(void *buffer, size_t length);
+
 #if DEVICE_SERIAL_ASYNCH
     CThunk<SerialBase> _thunk_irq;
     DMAUsage _tx_usage;
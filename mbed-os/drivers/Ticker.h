@@ -23,6 +23,7 @@
 #include "platform/mbed_power_mgmt.h"
 #include "hal/lp_ticker_api.h"
 #include "platform/mbed_critical.h"
+#include "platform/Duration.h"
 
 namespace mbed {
 /** \addtogroup drivers */
@@ -123,6 +124,17 @@ public:
         core_util_critical_section_exit();
     }
 
+    /** Attach a function to be called by the Ticker, specifying the interval as a duration
+     *
+     *  Coarser durations convert to Microseconds, for example attach(func, Milliseconds(500)).
+     *
+     *  @param func pointer to the function to be called
+     *  @param t the time between calls, positive
+     */
+    void attach(Callback<void()> func, Microseconds t) {
+        attach_us(func, t.count());
+    }
+
     /** Attach a member function to be called by the Ticker, specifying the interval in micro-seconds
      *
      *  @param obj pointer to the object to call the member function on
@@ -72,7 +72,8 @@ int Timer::read_us() {
 }
 
 float Timer::read() {
-    return (float)read_us() / 1000000.0f;
+    // From the 64-bit time, as read_us() wraps after about 35 minutes
+    return (float)read_high_resolution_us() / 1000000.0f;
 }
 
 int Timer::read_ms() {
@@ -96,6 +97,10 @@ us_timestamp_t Timer::slicetime() {
     return ret;
 }
 
+Microseconds Timer::elapsed_time() {
+    return Microseconds(read_high_resolution_us());
+}
+
 void Timer::reset() {
     core_util_critical_section_enter();
     _start = ticker_read_us(_ticker_data);
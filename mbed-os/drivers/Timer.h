@@ -20,6 +20,7 @@
 #include "hal/ticker_api.h"
 #include "platform/NonCopyable.h"
 #include "platform/mbed_power_mgmt.h"
+#include "platform/Duration.h"
 
 namespace mbed {
 /** \addtogroup drivers */
@@ -95,6 +96,14 @@ public:
      */
     us_timestamp_t read_high_resolution_us();
 
+    /** Get the time passed as a duration
+     *
+     *  The count is 64-bit, it does not wrap like read_us() after about 35 minutes.
+     *
+     *  @returns    Time passed in micro seconds
+     */
+    Microseconds elapsed_time();
+
 protected:
     us_timestamp_t slicetime();
     int _running;            // whether the timer is running
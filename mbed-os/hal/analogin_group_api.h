@@ -0,0 +1,90 @@
+/** \addtogroup hal */
+/** @{*/
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_ANALOGIN_GROUP_API_H
+#define MBED_ANALOGIN_GROUP_API_H
+
+#include "device.h"
+
+#if DEVICE_ANALOGIN_GROUP
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Analogin group hal structure. analogin_group_s is declared in the target's hal
+ */
+typedef struct analogin_group_s analogin_group_t;
+
+/** Handler of the end of a group conversion, called from the ADC interrupt
+ *
+ * @param id    The id given to analogin_group_start
+ * @param error 0 if every result is valid, -1 if the sequence was cut short
+ */
+typedef void (*analogin_group_handler)(uint32_t id, int error);
+
+/**
+ * \defgroup hal_analogin_group Analogin group hal functions
+ * @{
+ */
+
+/** Initialize a group of analog inputs converted in one sequence
+ *
+ * The inputs are converted in order, each one averaged over
+ * oversampling conversions by the ADC.
+ *
+ * @param obj          The analogin group object to initialize
+ * @param pins         The analogin pin names, all on the same ADC
+ * @param count        The number of pins, up to ANALOGIN_GROUP_MAX_CHANNELS
+ * @param oversampling The number of conversions averaged per result, a power of 2 up to ANALOGIN_GROUP_MAX_OVERSAMPLING
+ */
+void analogin_group_init(analogin_group_t *obj, const PinName *pins, uint8_t count, uint16_t oversampling);
+
+/** Release the analogin group
+ *
+ * @param obj The analogin group object
+ */
+void analogin_group_free(analogin_group_t *obj);
+
+/** Start the conversion of every input of the group
+ *
+ * The results are stored as they are converted, in the order of the pins,
+ * as unsigned 16bit values like analogin_read_u16. The handler is called
+ * once the last one is stored. The ADC must stay clocked, so deep sleep must
+ * be locked until then. The ADC must not be initialized or read by
+ * analogin_init, analogin_read or analogin_group_init until then either:
+ * the caller waits for the handler, the HAL does not.
+ *
+ * @param obj     The analogin group object
+ * @param results Buffer for one result per pin
+ * @param handler The handler of the end of the conversion
+ * @param id      The id passed to the handler
+ * @return 0 if the conversion has started, -1 if the ADC is busy
+ */
+int analogin_group_start(analogin_group_t *obj, uint16_t *results, analogin_group_handler handler, uint32_t id);
+
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+#endif
+
+/** @}*/
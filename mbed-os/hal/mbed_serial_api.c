@@ -0,0 +1,42 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hal/serial_api.h"
+
+#if DEVICE_SERIAL
+
+#include "platform/mbed_toolchain.h"
+
+MBED_WEAK void serial_putc_buffer(serial_t *obj, const void *buffer, size_t length)
+{
+    const unsigned char *data = (const unsigned char *)buffer;
+
+    while (length--) {
+        serial_putc(obj, *data++);
+    }
+}
+
+MBED_WEAK size_t serial_getc_buffer(serial_t *obj, void *buffer, size_t length)
+{
+    if (length == 0) {
+        return 0;
+    }
+    // serial_getc polls serial_readable itself, polling it again per character would only add calls
+    *(unsigned char *)buffer = (unsigned char)serial_getc(obj);
+    return 1;
+}
+
+#endif
@@ -24,7 +24,7 @@
 #include "lp_ticker_api.h"
 #include <limits.h>
 #include <stdio.h>
-#include "mbed_stats.h"
+#include <string.h>
 
 
 #if DEVICE_SLEEP
@@ -34,13 +34,17 @@ static uint16_t deep_sleep_lock = 0U;
 static us_timestamp_t sleep_time = 0;
 static us_timestamp_t deep_sleep_time = 0;
 
-#if defined(MBED_CPU_STATS_ENABLED) && defined(DEVICE_LPTICKER)
+#if (defined(MBED_CPU_STATS_ENABLED) || defined(MBED_SLEEP_STATS_ENABLED)) && defined(DEVICE_LPTICKER)
+#define SLEEP_TICKER_ENABLED 1
+#endif
+
+#ifdef SLEEP_TICKER_ENABLED
 static ticker_data_t *sleep_ticker = NULL;
 #endif
 
 static inline us_timestamp_t read_us(void)
 {
-#if defined(MBED_CPU_STATS_ENABLED) && defined(DEVICE_LPTICKER)
+#ifdef SLEEP_TICKER_ENABLED
     if (NULL == sleep_ticker) {
         sleep_ticker = (ticker_data_t *)get_lp_ticker_data();
     }
@@ -70,7 +74,7 @@ us_timestamp_t mbed_time_deepsleep(void)
     return deep_sleep_time;
 }
 
-#ifdef MBED_SLEEP_TRACING_ENABLED
+#if defined(MBED_SLEEP_TRACING_ENABLED) || defined(MBED_SLEEP_STATS_ENABLED)
 
 // Number of drivers that can be stored in the structure
 #define STATISTIC_COUNT  10
@@ -78,16 +82,33 @@ us_timestamp_t mbed_time_deepsleep(void)
 typedef struct sleep_statistic {
     const char *identifier;
     uint8_t count;
+    uint32_t lock_total;
+    uint32_t unlock_total;
+    us_timestamp_t lock_start;
+    us_timestamp_t time_held;
 } sleep_statistic_t;
 
 static sleep_statistic_t sleep_stats[STATISTIC_COUNT];
 
+// Owners are keyed by their MBED_FILENAME pointer, so hash the pointer to
+// find the starting slot and probe linearly from there.
+static inline int sleep_tracker_slot(const char *const filename)
+{
+    return (int)((((uintptr_t)filename) >> 2) % STATISTIC_COUNT);
+}
+
 static sleep_statistic_t* sleep_tracker_find(const char *const filename)
 {
+    int slot = sleep_tracker_slot(filename);
+
     for (int i = 0; i < STATISTIC_COUNT; ++i) {
-        if (sleep_stats[i].identifier == filename) {
-            return &sleep_stats[i];
+        if (sleep_stats[slot].identifier == filename) {
+            return &sleep_stats[slot];
+        }
+        if (sleep_stats[slot].identifier == NULL) {
+            return NULL;
         }
+        slot = (slot + 1) % STATISTIC_COUNT;
     }
 
     return NULL;
@@ -95,12 +116,15 @@ static sleep_statistic_t* sleep_tracker_find(const char *const filename)
 
 static sleep_statistic_t* sleep_tracker_add(const char* const filename)
 {
+    int slot = sleep_tracker_slot(filename);
+
     for (int i = 0; i < STATISTIC_COUNT; ++i) {
-        if (sleep_stats[i].identifier == NULL) {
-            sleep_stats[i].identifier = filename;
+        if (sleep_stats[slot].identifier == NULL) {
+            sleep_stats[slot].identifier = filename;
 
-            return &sleep_stats[i];
+            return &sleep_stats[slot];
         }
+        slot = (slot + 1) % STATISTIC_COUNT;
     }
 
     debug("No free indexes left to use in mbed sleep tracker.\r\n");
@@ -108,6 +132,7 @@ static sleep_statistic_t* sleep_tracker_add(const char* const filename)
     return NULL;
 }
 
+#ifdef MBED_SLEEP_TRACING_ENABLED
 static void sleep_tracker_print_stats(void)
 {
     debug("Sleep locks held:\r\n");
@@ -117,16 +142,21 @@ static void sleep_tracker_print_stats(void)
         }
 
         if (sleep_stats[i].identifier == NULL) {
-            return;
+            continue;
         }
 
-        debug("[id: %s, count: %u]\r\n", sleep_stats[i].identifier,
-                                         sleep_stats[i].count);
+        debug("[id: %s, count: %u, held: %lu ms]\r\n", sleep_stats[i].identifier,
+                                                        sleep_stats[i].count,
+                                                        (unsigned long)(sleep_stats[i].time_held / 1000));
     }
 }
+#endif // MBED_SLEEP_TRACING_ENABLED
 
 void sleep_tracker_lock(const char *const filename, int line)
 {
+    us_timestamp_t now = read_us();
+
+    core_util_critical_section_enter();
     sleep_statistic_t *stat = sleep_tracker_find(filename);
 
     // Entry for this driver does not exist, create one.
@@ -134,27 +164,86 @@ void sleep_tracker_lock(const char *const filename, int line)
         stat = sleep_tracker_add(filename);
     }
 
-    core_util_atomic_incr_u8(&stat->count, 1);
+    if (stat != NULL) {
+        if (stat->count == 0) {
+            stat->lock_start = now;
+        }
+        stat->count++;
+        stat->lock_total++;
+    }
+    core_util_critical_section_exit();
 
+#ifdef MBED_SLEEP_TRACING_ENABLED
     debug("LOCK: %s, ln: %i, lock count: %u\r\n", filename, line, deep_sleep_lock);
+#endif
 }
 
 void sleep_tracker_unlock(const char* const filename, int line)
 {
+    us_timestamp_t now = read_us();
+
+    core_util_critical_section_enter();
     sleep_statistic_t *stat = sleep_tracker_find(filename);
 
     // Entry for this driver does not exist, something went wrong.
-    if (stat == NULL) {
+    if (stat == NULL || stat->count == 0) {
+        core_util_critical_section_exit();
         debug("Unlocking sleep for driver that was not previously locked: %s, ln: %i\r\n", filename, line);
         return;
     }
 
-    core_util_atomic_decr_u8(&stat->count, 1);
+    stat->count--;
+    stat->unlock_total++;
+    if (stat->count == 0) {
+        stat->time_held += now - stat->lock_start;
+    }
+    core_util_critical_section_exit();
 
+#ifdef MBED_SLEEP_TRACING_ENABLED
     debug("UNLOCK: %s, ln: %i, lock count: %u\r\n", filename, line, deep_sleep_lock);
+#endif
 }
 
-#endif // MBED_SLEEP_TRACING_ENABLED
+size_t mbed_stats_sleep_get_each(mbed_stats_sleep_t *stats, size_t count)
+{
+    MBED_ASSERT(stats != NULL);
+    memset(stats, 0, count * sizeof(mbed_stats_sleep_t));
+
+    size_t n = 0;
+    us_timestamp_t now = read_us();
+
+    core_util_critical_section_enter();
+    for (int i = 0; (i < STATISTIC_COUNT) && (n < count); ++i) {
+        if (sleep_stats[i].identifier == NULL) {
+            continue;
+        }
+
+        stats[n].owner = sleep_stats[i].identifier;
+        stats[n].lock_count = sleep_stats[i].count;
+        stats[n].lock_total = sleep_stats[i].lock_total;
+        stats[n].unlock_total = sleep_stats[i].unlock_total;
+        stats[n].time_held = sleep_stats[i].time_held;
+        if (sleep_stats[i].count != 0) {
+            stats[n].time_held += now - sleep_stats[i].lock_start;
+        }
+        stats[n].uptime = now;
+        n++;
+    }
+    core_util_critical_section_exit();
+
+    return n;
+}
+
+#else
+
+size_t mbed_stats_sleep_get_each(mbed_stats_sleep_t *stats, size_t count)
+{
+    MBED_ASSERT(stats != NULL);
+    memset(stats, 0, count * sizeof(mbed_stats_sleep_t));
+    return 0;
+}
+
+#endif // MBED_SLEEP_TRACING_ENABLED || MBED_SLEEP_STATS_ENABLED
 
 void sleep_manager_lock_deep_sleep_internal(void)
 {
@@ -234,4 +323,11 @@ bool sleep_manager_can_deep_sleep(void)
     return false;
 }
 
+size_t mbed_stats_sleep_get_each(mbed_stats_sleep_t *stats, size_t count)
+{
+    MBED_ASSERT(stats != NULL);
+    memset(stats, 0, count * sizeof(mbed_stats_sleep_t));
+    return 0;
+}
+
 #endif
@@ -0,0 +1,209 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "hal/trng_pool_api.h"
+
+#if DEVICE_TRNG_ASYNCH
+
+#include <stdbool.h>
+#include <string.h>
+#include "hal/trng_api.h"
+#include "platform/mbed_assert.h"
+#include "platform/mbed_critical.h"
+#include "platform/mbed_power_mgmt.h"
+
+MBED_STATIC_ASSERT((TRNG_POOL_SIZE & (TRNG_POOL_SIZE - 1)) == 0, "TRNG_POOL_SIZE must be a power of 2");
+
+static trng_t trng;
+static uint8_t pool[TRNG_POOL_SIZE];
+static uint32_t pool_head;          // bytes added, the pool holds pool_head - pool_tail bytes
+static uint32_t pool_tail;          // bytes taken
+static uint32_t pool_startup;       // bytes to test before filling the pool
+static bool pool_running = false;
+static bool pool_filling = false;
+static trng_pool_stats_t pool_stats;
+
+// Repetition count test
+static uint8_t rct_sample;
+static uint32_t rct_count;
+
+// Adaptive proportion test
+static uint8_t apt_sample;
+static uint32_t apt_count;
+static uint32_t apt_index;
+
+static void trng_pool_fill(bool fill)
+{
+    if (fill == pool_filling) {
+        return;
+    }
+    pool_filling = fill;
+    if (fill) {
+        // The TRNG clock stops in deep sleep
+        sleep_manager_lock_deep_sleep();
+        trng_irq_set(&trng, 1);
+    } else {
+        trng_irq_set(&trng, 0);
+        sleep_manager_unlock_deep_sleep();
+    }
+}
+
+static void trng_pool_restart(void)
+{
+    // Drop the bytes taken from the source since its last failure
+    memset(pool, 0, sizeof(pool));
+    pool_tail = pool_head;
+    pool_startup = TRNG_POOL_STARTUP_BYTES;
+    rct_count = 0;
+    apt_index = 0;
+}
+
+static int trng_pool_test(uint8_t sample)
+{
+    if ((rct_count > 0) && (sample == rct_sample)) {
+        if (++rct_count >= TRNG_POOL_RCT_CUTOFF) {
+            pool_stats.rct_failures++;
+            return -1;
+        }
+    } else {
+        rct_sample = sample;
+        rct_count = 1;
+    }
+
+    if (apt_index == 0) {
+        apt_sample = sample;
+        apt_count = 1;
+    } else if (sample == apt_sample) {
+        if (++apt_count >= TRNG_POOL_APT_CUTOFF) {
+            pool_stats.apt_failures++;
+            return -1;
+        }
+    }
+    if (++apt_index == TRNG_POOL_APT_WINDOW) {
+        apt_index = 0;
+    }
+    return 0;
+}
+
+static void trng_pool_irq(uint32_t id, uint32_t random, int error)
+{
+    int i;
+
+    (void)id;
+    if (error) {
+        pool_stats.source_errors++;
+        trng_pool_restart();
+        return;
+    }
+    pool_stats.words++;
+
+    for (i = 0; i < 4; i++) {
+        uint8_t sample = (uint8_t)(random >> (8 * i));
+
+        if (trng_pool_test(sample) != 0) {
+            trng_pool_restart();
+            return;
+        }
+        if (pool_startup > 0) {
+            pool_startup--;
+        } else if (pool_head - pool_tail < TRNG_POOL_SIZE) {
+            pool[pool_head & (TRNG_POOL_SIZE - 1)] = sample;
+            pool_head++;
+        }
+    }
+
+    if ((pool_startup == 0) && (pool_head - pool_tail == TRNG_POOL_SIZE)) {
+        trng_pool_fill(false);
+    }
+}
+
+void trng_pool_init(void)
+{
+    core_util_critical_section_enter();
+    memset(&pool_stats, 0, sizeof(pool_stats));
+    trng_pool_restart();
+    pool_running = true;
+    core_util_critical_section_exit();
+
+    trng_init(&trng);
+    trng_irq_handler(&trng, trng_pool_irq, 0);
+
+    core_util_critical_section_enter();
+    trng_pool_fill(true);
+    core_util_critical_section_exit();
+}
+
+void trng_pool_free(void)
+{
+    core_util_critical_section_enter();
+    trng_pool_fill(false);
+    trng_pool_restart();
+    pool_running = false;
+    core_util_critical_section_exit();
+
+    trng_free(&trng);
+}
+
+int trng_pool_get_bytes(uint8_t *output, size_t length, size_t *output_length)
+{
+    size_t count;
+    size_t offset;
+    size_t first;
+
+    core_util_critical_section_enter();
+    count = pool_head - pool_tail;
+    if (count > length) {
+        count = length;
+    }
+
+    // Copy at most two runs of the ring, clearing them
+    offset = pool_tail & (TRNG_POOL_SIZE - 1);
+    first = TRNG_POOL_SIZE - offset;
+    if (first > count) {
+        first = count;
+    }
+    memcpy(output, &pool[offset], first);
+    memset(&pool[offset], 0, first);
+    memcpy(output + first, pool, count - first);
+    memset(pool, 0, count - first);
+    pool_tail += count;
+
+    pool_stats.requests++;
+    pool_stats.bytes += count;
+    if (count < length) {
+        pool_stats.short_requests++;
+    }
+    if (pool_running && (count > 0)) {
+        trng_pool_fill(true);
+    }
+    core_util_critical_section_exit();
+
+    *output_length = count;
+    return (count == length) ? 0 : -1;
+}
+
+size_t trng_pool_available(void)
+{
+    return pool_head - pool_tail;
+}
+
+void trng_pool_get_stats(trng_pool_stats_t *stats)
+{
+    core_util_critical_section_enter();
+    *stats = pool_stats;
+    core_util_critical_section_exit();
+}
+
+#endif
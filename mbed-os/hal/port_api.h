@@ -44,6 +44,14 @@ typedef struct port_s port_t;
  */
 PinName port_pin(PortName port, int pin_n);
 
+/** Get the port of a pin and the pin number within the port
+ *
+ * @param pin   The pin name
+ * @param pin_n The pin number within the port
+ * @return The port name of the pin
+ */
+PortName port_from_pin(PinName pin, int *pin_n);
+
 /** Initilize the port
  *
  * @param obj  The port object to initialize
@@ -68,6 +76,9 @@ void port_mode(port_t *obj, PinMode mode);
 void port_dir(port_t *obj, PinDirection dir);
 
 /** Write value to the port
+ *
+ * The pins of the mask change together. The other pins of the port are not
+ * affected, even if an interrupt writes them meanwhile.
  *
  * @param obj   The port object
  * @param value The value to be set
@@ -185,6 +185,16 @@ void rtc_write(time_t t);
 uint32_t rtc_read_lp(void);
 
 uint32_t rtc_read_subseconds(void);
+
+/** Read RTC time in microseconds since UNIX epoch.
+ *
+ * The seconds and the sub-second part are taken from the same RTC read and
+ * the conversion uses integer arithmetic only. Targets without a sub-second
+ * counter get a default returning whole seconds of rtc_read().
+ *
+ * @return The current time in microseconds
+ */
+uint64_t rtc_read_us(void);
 /**@}*/
 
 #ifdef __cplusplus
@@ -185,6 +185,29 @@ int  serial_readable(serial_t *obj);
  */
 int  serial_writable(serial_t *obj);
 
+/** Send a block of characters. This is a blocking call, waiting for the peripheral to be
+ *  available for writing each character
+ *
+ * This function has a WEAK implementation calling serial_putc for each character.
+ *
+ * @param obj    The serial object
+ * @param buffer The characters to be sent
+ * @param length The number of characters
+ */
+void serial_putc_buffer(serial_t *obj, const void *buffer, size_t length);
+
+/** Get a block of characters. This is a blocking call, waiting for the first character
+ *
+ * After the first character, only the characters already received are read.
+ * This function has a WEAK implementation reading one character with serial_getc.
+ *
+ * @param obj    The serial object
+ * @param buffer The buffer for the characters
+ * @param length The size of the buffer
+ * @return The number of characters read, at least 1 if length is not 0
+ */
+size_t serial_getc_buffer(serial_t *obj, void *buffer, size_t length);
+
 /** Clear the serial peripheral
  *
  * @param obj The serial object
@@ -44,6 +44,9 @@ extern "C" {
 void trng_init(trng_t *obj);
 
 /** Deinitialize the TRNG peripheral
+ *
+ * With DEVICE_TRNG_ASYNCH, the background generation is stopped only if obj
+ * is the object given to trng_irq_handler.
  *
  * @param obj The TRNG object
  */
@@ -59,6 +62,37 @@ void trng_free(trng_t *obj);
  */
 int trng_get_bytes(trng_t *obj, uint8_t *output, size_t length, size_t *output_length);
 
+#if DEVICE_TRNG_ASYNCH
+
+/** Handler of the random words generated in the background, called from the TRNG interrupt
+ *
+ * @param id     The id given to trng_irq_handler
+ * @param random The random word, valid if error is 0
+ * @param error  0 for a random word, -1 for an error of the entropy source
+ */
+typedef void (*trng_handler)(uint32_t id, uint32_t random, int error);
+
+/** Set the handler of the random words generated in the background
+ *
+ * @param obj     The TRNG object
+ * @param handler The handler
+ * @param id      The id passed to the handler
+ */
+void trng_irq_handler(trng_t *obj, trng_handler handler, uint32_t id);
+
+/** Start or stop the generation of random words in the background
+ *
+ * While enabled, the handler is called with each random word as it is
+ * generated, or with an error when the entropy source fails. The TRNG must
+ * stay clocked, so deep sleep must be locked while enabled.
+ *
+ * @param obj    The TRNG object
+ * @param enable 1 to start, 0 to stop
+ */
+void trng_irq_set(trng_t *obj, uint32_t enable);
+
+#endif
+
 /**@}*/
 
 #ifdef __cplusplus
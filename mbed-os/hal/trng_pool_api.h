@@ -0,0 +1,124 @@
+/** \addtogroup hal */
+/** @{*/
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_TRNG_POOL_API_H
+#define MBED_TRNG_POOL_API_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "device.h"
+
+#if DEVICE_TRNG_ASYNCH
+
+/** Size of the pool in bytes, a power of 2 */
+#ifndef TRNG_POOL_SIZE
+#define TRNG_POOL_SIZE              64
+#endif
+
+/* Health test parameters, from NIST SP 800-90B 4.4, for a false positive
+ * probability of 2^-30 per byte with at least 4 bits of min-entropy per byte */
+
+/** Number of identical bytes in a row failing the repetition count test */
+#ifndef TRNG_POOL_RCT_CUTOFF
+#define TRNG_POOL_RCT_CUTOFF        9
+#endif
+
+/** Window of the adaptive proportion test, in bytes */
+#ifndef TRNG_POOL_APT_WINDOW
+#define TRNG_POOL_APT_WINDOW        512
+#endif
+
+/** Number of bytes of a window equal to its first byte failing the adaptive proportion test */
+#ifndef TRNG_POOL_APT_CUTOFF
+#define TRNG_POOL_APT_CUTOFF        71
+#endif
+
+/** Number of bytes tested and dropped at start up and after a failure, before filling the pool */
+#ifndef TRNG_POOL_STARTUP_BYTES
+#define TRNG_POOL_STARTUP_BYTES     1024
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Entropy pool statistics */
+typedef struct {
+    uint32_t words;             /**< Random words received from the TRNG */
+    uint32_t bytes;             /**< Bytes served */
+    uint32_t requests;          /**< Requests served */
+    uint32_t short_requests;    /**< Requests served partially, the pool being short */
+    uint32_t source_errors;     /**< Errors reported by the TRNG */
+    uint32_t rct_failures;      /**< Repetition count test failures */
+    uint32_t apt_failures;      /**< Adaptive proportion test failures */
+} trng_pool_stats_t;
+
+/**
+ * \defgroup hal_trng_pool Entropy pool functions
+ * @{
+ */
+
+/** Start the TRNG and fill the entropy pool
+ *
+ * The pool owns the TRNG: it is the one user allowed by trng_init. The pool
+ * is filled from the TRNG interrupt whenever bytes are taken from it. Every
+ * byte passes the repetition count and adaptive proportion tests. A failed
+ * test or an error of the TRNG empties the pool, which is filled again once
+ * TRNG_POOL_STARTUP_BYTES bytes pass the tests. Deep sleep is locked while
+ * the pool is filled.
+ */
+void trng_pool_init(void);
+
+/** Stop the TRNG and clear the entropy pool
+ */
+void trng_pool_free(void);
+
+/** Take random bytes from the entropy pool
+ *
+ * The bytes are copied out of the pool without waiting for the TRNG. They
+ * are cleared from the pool, which is then filled again in the background.
+ *
+ * @param output        The pointer to an output array
+ * @param length        The number of bytes wanted
+ * @param output_length The number of bytes copied, less than length if the pool was short
+ * @return 0 if length bytes were copied, -1 otherwise
+ */
+int trng_pool_get_bytes(uint8_t *output, size_t length, size_t *output_length);
+
+/** Get the number of bytes in the entropy pool
+ *
+ * @return The number of bytes trng_pool_get_bytes can return at once
+ */
+size_t trng_pool_available(void);
+
+/** Get the entropy pool statistics
+ *
+ * @param stats Statistics since trng_pool_init
+ */
+void trng_pool_get_stats(trng_pool_stats_t *stats);
+
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+#endif
+
+/** @}*/
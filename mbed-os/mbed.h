@@ -58,6 +58,7 @@
 #include "drivers/PortInOut.h"
 #include "drivers/PortOut.h"
 #include "drivers/AnalogIn.h"
+#include "drivers/AnalogInGroup.h"
 #include "drivers/AnalogOut.h"
 #include "drivers/PwmOut.h"
 #include "drivers/Serial.h"
@@ -65,11 +66,13 @@
 #include "drivers/SPISlave.h"
 #include "drivers/I2C.h"
 #include "drivers/I2CSlave.h"
+#include "drivers/I2CBus.h"
 #include "drivers/Ethernet.h"
 #include "drivers/CAN.h"
 #include "drivers/RawSerial.h"
 #include "drivers/UARTSerial.h"
 #include "drivers/FlashIAP.h"
+#include "drivers/FlashKVStore.h"
 #include "drivers/MbedCRC.h"
 
 // mbed Internal components
@@ -98,6 +101,7 @@
 #include "platform/Callback.h"
 #include "platform/FunctionPointer.h"
 #include "platform/ScopedLock.h"
+#include "platform/Duration.h"
 
 using namespace mbed;
 using namespace std;
@@ -21,6 +21,7 @@
 #include "ATCmdParser.h"
 #include "mbed_poll.h"
 #include "mbed_debug.h"
+#include "mbed_minimal_printf.h"
 
 #ifdef LF
 #undef LF
@@ -101,9 +102,27 @@ int ATCmdParser::read(char *data, int size)
 }
 
 
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF
+static int at_cmd_parser_sink(void *context, const char *data, size_t length)
+{
+    ATCmdParser *parser = static_cast<ATCmdParser *>(context);
+
+    for (size_t i = 0; i < length; i++) {
+        if (parser->putc(data[i]) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+#endif
+
 // printf/scanf handling
 int ATCmdParser::vprintf(const char *format, va_list args)
 {
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF
+    // Formatted straight to the stream, without going through _buffer
+    return mbed_minimal_vxprintf(at_cmd_parser_sink, this, format, args);
+#else
 
     if (vsprintf(_buffer, format, args) < 0) {
         return false;
@@ -116,6 +135,7 @@ int ATCmdParser::vprintf(const char *format, va_list args)
         }
     }
     return i;
+#endif
 }
 
 int ATCmdParser::vscanf(const char *format, va_list args)
@@ -184,9 +204,17 @@ int ATCmdParser::vscanf(const char *format, va_list args)
 bool ATCmdParser::vsend(const char *command, va_list args)
 {
     // Create and send command
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF
+    int length = mbed_minimal_vsnprintf(_buffer, _buffer_size, command, args);
+    if (length >= _buffer_size) {
+        // Never send a truncated command
+        return false;
+    }
+#else
     if (vsprintf(_buffer, command, args) < 0) {
         return false;
     }
+#endif
 
     for (int i = 0; _buffer[i]; i++) {
         if (putc(_buffer[i]) < 0) {
@@ -0,0 +1,395 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_DURATION_H
+#define MBED_DURATION_H
+
+#include <stdint.h>
+
+namespace mbed {
+
+/** \addtogroup platform */
+/** @{*/
+/**
+ * \defgroup platform_Duration Duration and TimePoint classes
+ * @{
+ */
+
+namespace detail {
+    struct duration_nil {};
+
+    template <bool B, typename R = duration_nil>
+    struct duration_enable_if { typedef R type; };
+
+    template <typename R>
+    struct duration_enable_if<false, R> {};
+
+    template <uint32_t A, uint32_t B>
+    struct duration_gcd { static const uint32_t value = duration_gcd<B, A % B>::value; };
+
+    template <uint32_t A>
+    struct duration_gcd<A, 0> { static const uint32_t value = A; };
+}
+
+/** A length of time, as a signed 64-bit count of ticks of a fixed period
+ *
+ * The period is a whole number of microseconds, known at compile time, so the
+ * conversions between units are integer multiplications and divisions by
+ * constants. A count of microseconds covers about 292000 years either way:
+ * the arithmetic does not wrap like the int of Timer::read_us(), and needs no
+ * floating point.
+ *
+ * A duration converts implicitly to a finer period, which is exact, for
+ * example Seconds to Milliseconds. The other way truncates and must be
+ * written with duration_cast(). The operators between durations of different
+ * periods compute in the finest period that holds both exactly.
+ *
+ * Example:
+ * @code
+ * Milliseconds period = Seconds(2) + Milliseconds(500);     // 2500 ms
+ * Microseconds half = period / 2;                            // 1250000 us
+ * Seconds whole = duration_cast<Seconds>(period);            // 2 s
+ * @endcode
+ *
+ * @tparam Period The length of a tick in microseconds
+ */
+template <uint32_t Period>
+class Duration {
+public:
+    /** The length of a tick in microseconds */
+    static const uint32_t period = Period;
+
+    /** Create a zero duration
+     */
+    Duration() : _count(0)
+    {
+    }
+
+    /** Create a duration of a number of ticks
+     *
+     * @param count The number of ticks
+     */
+    explicit Duration(int64_t count) : _count(count)
+    {
+    }
+
+    /** Convert a duration of a coarser period, exactly
+     *
+     * @param d The duration
+     */
+    template <uint32_t P>
+    Duration(const Duration<P> &d,
+             typename detail::duration_enable_if<P % Period == 0>::type = detail::duration_nil())
+        : _count(d.count() * (int64_t)(P / Period))
+    {
+    }
+
+    /** Get the number of ticks
+     *
+     * @returns The number of ticks
+     */
+    int64_t count() const
+    {
+        return _count;
+    }
+
+    /** A zero duration */
+    static Duration zero()
+    {
+        return Duration(0);
+    }
+
+    /** The longest duration */
+    static Duration max()
+    {
+        return Duration((int64_t)(~(uint64_t)0 >> 1));
+    }
+
+    Duration operator-() const
+    {
+        return Duration(-_count);
+    }
+
+    Duration &operator+=(const Duration &d)
+    {
+        _count += d._count;
+        return *this;
+    }
+
+    Duration &operator-=(const Duration &d)
+    {
+        _count -= d._count;
+        return *this;
+    }
+
+    Duration &operator*=(int64_t factor)
+    {
+        _count *= factor;
+        return *this;
+    }
+
+    /** Divide, truncating toward zero */
+    Duration &operator/=(int64_t divisor)
+    {
+        _count /= divisor;
+        return *this;
+    }
+
+private:
+    int64_t _count;
+};
+
+/** A duration in microseconds, the resolution of the us ticker */
+typedef Duration<1> Microseconds;
+/** A duration in milliseconds, the resolution of the RTOS tick */
+typedef Duration<1000> Milliseconds;
+/** A duration in seconds */
+typedef Duration<1000000> Seconds;
+
+/** Convert a duration to another period, truncating toward zero
+ *
+ * @tparam To The type of the result
+ * @param d   The duration
+ * @returns   The duration in the period of To
+ */
+template <typename To, uint32_t P>
+To duration_cast(const Duration<P> &d)
+{
+    // The constants select one of the branches at compile time
+    const uint32_t gcd = detail::duration_gcd<P, To::period>::value;
+    const int64_t multiplier = P / gcd;
+    const int64_t divisor = To::period / gcd;
+
+    if (divisor == 1) {
+        return To(d.count() * multiplier);
+    } else if (multiplier == 1) {
+        return To(d.count() / divisor);
+    } else {
+        return To(d.count() * multiplier / divisor);
+    }
+}
+
+template <uint32_t P1, uint32_t P2>
+Duration<detail::duration_gcd<P1, P2>::value> operator+(const Duration<P1> &a, const Duration<P2> &b)
+{
+    Duration<detail::duration_gcd<P1, P2>::value> sum(a);
+    return sum += b;
+}
+
+template <uint32_t P1, uint32_t P2>
+Duration<detail::duration_gcd<P1, P2>::value> operator-(const Duration<P1> &a, const Duration<P2> &b)
+{
+    Duration<detail::duration_gcd<P1, P2>::value> difference(a);
+    return difference -= b;
+}
+
+template <uint32_t P>
+Duration<P> operator*(const Duration<P> &d, int64_t factor)
+{
+    return Duration<P>(d.count() * factor);
+}
+
+template <uint32_t P>
+Duration<P> operator*(int64_t factor, const Duration<P> &d)
+{
+    return Duration<P>(d.count() * factor);
+}
+
+/** Divide a duration, truncating toward zero */
+template <uint32_t P>
+Duration<P> operator/(const Duration<P> &d, int64_t divisor)
+{
+    return Duration<P>(d.count() / divisor);
+}
+
+/** Get how many times a duration holds another, truncating toward zero */
+template <uint32_t P1, uint32_t P2>
+int64_t operator/(const Duration<P1> &a, const Duration<P2> &b)
+{
+    const uint32_t common = detail::duration_gcd<P1, P2>::value;
+    return Duration<common>(a).count() / Duration<common>(b).count();
+}
+
+/** Get what remains of a duration after a whole number of another */
+template <uint32_t P1, uint32_t P2>
+Duration<detail::duration_gcd<P1, P2>::value> operator%(const Duration<P1> &a, const Duration<P2> &b)
+{
+    const uint32_t common = detail::duration_gcd<P1, P2>::value;
+    return Duration<common>(Duration<common>(a).count() % Duration<common>(b).count());
+}
+
+template <uint32_t P1, uint32_t P2>
+bool operator==(const Duration<P1> &a, const Duration<P2> &b)
+{
+    const uint32_t common = detail::duration_gcd<P1, P2>::value;
+    return Duration<common>(a).count() == Duration<common>(b).count();
+}
+
+template <uint32_t P1, uint32_t P2>
+bool operator!=(const Duration<P1> &a, const Duration<P2> &b)
+{
+    return !(a == b);
+}
+
+template <uint32_t P1, uint32_t P2>
+bool operator<(const Duration<P1> &a, const Duration<P2> &b)
+{
+    const uint32_t common = detail::duration_gcd<P1, P2>::value;
+    return Duration<common>(a).count() < Duration<common>(b).count();
+}
+
+template <uint32_t P1, uint32_t P2>
+bool operator>(const Duration<P1> &a, const Duration<P2> &b)
+{
+    return b < a;
+}
+
+template <uint32_t P1, uint32_t P2>
+bool operator<=(const Duration<P1> &a, const Duration<P2> &b)
+{
+    return !(b < a);
+}
+
+template <uint32_t P1, uint32_t P2>
+bool operator>=(const Duration<P1> &a, const Duration<P2> &b)
+{
+    return !(a < b);
+}
+
+/** A point in time of a clock, as the duration since the epoch of the clock
+ *
+ * Time points of different clocks do not mix. The difference of two time
+ * points is a duration, and a time point moved by a duration is another time
+ * point of the same clock.
+ *
+ * A clock is a type with a duration typedef and a static now() function
+ * returning its time point, like rtos::Kernel::Clock.
+ *
+ * @tparam Clock The clock
+ * @tparam D     The duration since the epoch, by default the one of the clock
+ */
+template <typename Clock, typename D = typename Clock::duration>
+class TimePoint {
+public:
+    typedef D duration;
+
+    /** Create the time point of the epoch of the clock
+     */
+    TimePoint() : _since_epoch()
+    {
+    }
+
+    /** Create a time point at a duration from the epoch of the clock
+     *
+     * @param since_epoch The duration since the epoch
+     */
+    explicit TimePoint(const D &since_epoch) : _since_epoch(since_epoch)
+    {
+    }
+
+    /** Get the duration since the epoch of the clock
+     *
+     * @returns The duration since the epoch
+     */
+    D time_since_epoch() const
+    {
+        return _since_epoch;
+    }
+
+    TimePoint &operator+=(const D &d)
+    {
+        _since_epoch += d;
+        return *this;
+    }
+
+    TimePoint &operator-=(const D &d)
+    {
+        _since_epoch -= d;
+        return *this;
+    }
+
+private:
+    D _since_epoch;
+};
+
+// The duration operands are not deduced, so that coarser durations convert to D
+
+template <typename Clock, typename D>
+TimePoint<Clock, D> operator+(const TimePoint<Clock, D> &t, const typename TimePoint<Clock, D>::duration &d)
+{
+    return TimePoint<Clock, D>(t.time_since_epoch() + d);
+}
+
+template <typename Clock, typename D>
+TimePoint<Clock, D> operator+(const typename TimePoint<Clock, D>::duration &d, const TimePoint<Clock, D> &t)
+{
+    return TimePoint<Clock, D>(t.time_since_epoch() + d);
+}
+
+template <typename Clock, typename D>
+TimePoint<Clock, D> operator-(const TimePoint<Clock, D> &t, const typename TimePoint<Clock, D>::duration &d)
+{
+    return TimePoint<Clock, D>(t.time_since_epoch() - d);
+}
+
+template <typename Clock, typename D>
+D operator-(const TimePoint<Clock, D> &a, const TimePoint<Clock, D> &b)
+{
+    return a.time_since_epoch() - b.time_since_epoch();
+}
+
+template <typename Clock, typename D>
+bool operator==(const TimePoint<Clock, D> &a, const TimePoint<Clock, D> &b)
+{
+    return a.time_since_epoch() == b.time_since_epoch();
+}
+
+template <typename Clock, typename D>
+bool operator!=(const TimePoint<Clock, D> &a, const TimePoint<Clock, D> &b)
+{
+    return a.time_since_epoch() != b.time_since_epoch();
+}
+
+template <typename Clock, typename D>
+bool operator<(const TimePoint<Clock, D> &a, const TimePoint<Clock, D> &b)
+{
+    return a.time_since_epoch() < b.time_since_epoch();
+}
+
+template <typename Clock, typename D>
+bool operator>(const TimePoint<Clock, D> &a, const TimePoint<Clock, D> &b)
+{
+    return a.time_since_epoch() > b.time_since_epoch();
+}
+
+template <typename Clock, typename D>
+bool operator<=(const TimePoint<Clock, D> &a, const TimePoint<Clock, D> &b)
+{
+    return a.time_since_epoch() <= b.time_since_epoch();
+}
+
+template <typename Clock, typename D>
+bool operator>=(const TimePoint<Clock, D> &a, const TimePoint<Clock, D> &b)
+{
+    return a.time_since_epoch() >= b.time_since_epoch();
+}
+
+/**@}*/
+
+/**@}*/
+
+} // namespace mbed
+
+#endif // MBED_DURATION_H
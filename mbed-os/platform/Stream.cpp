@@ -15,6 +15,7 @@
  */
 #include "platform/Stream.h"
 #include "platform/mbed_error.h"
+#include "platform/mbed_minimal_printf.h"
 #include <errno.h>
 
 namespace mbed {
@@ -72,31 +73,44 @@ int Stream::close() {
 }
 
 ssize_t Stream::write(const void* buffer, size_t length) {
-    const char* ptr = (const char*)buffer;
-    const char* end = ptr + length;
+    lock();
+    ssize_t ret = _write(buffer, length);
+    unlock();
+
+    return ret;
+}
 
+ssize_t Stream::read(void* buffer, size_t length) {
     lock();
+    ssize_t ret = _read(buffer, length);
+    unlock();
+
+    return ret;
+}
+
+ssize_t Stream::_write(const void* buffer, size_t length) {
+    const unsigned char* ptr = (const unsigned char*)buffer;
+    const unsigned char* end = ptr + length;
+
+    // Unsigned, so that a 0xFF character is not taken for EOF
     while (ptr != end) {
         if (_putc(*ptr++) == EOF) {
             break;
         }
     }
-    unlock();
 
-    return ptr - (const char*)buffer;
+    return ptr - (const unsigned char*)buffer;
 }
 
-ssize_t Stream::read(void* buffer, size_t length) {
+ssize_t Stream::_read(void* buffer, size_t length) {
     char* ptr = (char*)buffer;
     char* end = ptr + length;
 
-    lock();
     while (ptr != end) {
         int c = _getc();
         if (c==EOF) break;
         *ptr++ = c;
     }
-    unlock();
 
     return ptr - (const char*)buffer;
 }
@@ -129,7 +143,11 @@ int Stream::printf(const char* format, ...) {
     std::va_list arg;
     va_start(arg, format);
     fflush(_file);
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF
+    int r = mbed_minimal_vfprintf(_file, format, arg);
+#else
     int r = vfprintf(_file, format, arg);
+#endif
     va_end(arg);
     unlock();
     return r;
@@ -149,7 +167,11 @@ int Stream::scanf(const char* format, ...) {
 int Stream::vprintf(const char* format, std::va_list args) {
     lock();
     fflush(_file);
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF
+    int r = mbed_minimal_vfprintf(_file, format, args);
+#else
     int r = vfprintf(_file, format, args);
+#endif
     unlock();
     return r;
 }
@@ -70,6 +70,28 @@ protected:
     virtual int _putc(int c) = 0;
     virtual int _getc() = 0;
 
+    /** Write a block of characters, called by write() with the lock held
+     *
+     *  The default calls _putc() for each character. Subclasses able to send
+     *  a whole block override it.
+     *
+     *  @param buffer The characters to write
+     *  @param length The number of characters
+     *  @returns The number of characters written
+     */
+    virtual ssize_t _write(const void *buffer, size_t length);
+
+    /** Read a block of characters, called by read() with the lock held
+     *
+     *  The default calls _getc() for each character until length are read
+     *  or EOF is returned.
+     *
+     *  @param buffer The buffer for the characters
+     *  @param length The number of characters to read
+     *  @returns The number of characters read
+     */
+    virtual ssize_t _read(void *buffer, size_t length);
+
     std::FILE *_file;
 
     /** Acquire exclusive access to this object.
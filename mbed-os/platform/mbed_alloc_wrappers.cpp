@@ -17,8 +17,8 @@
 #include "platform/mbed_mem_trace.h"
 #include "platform/mbed_stats.h"
 #include "platform/mbed_toolchain.h"
-#include "platform/SingletonPtr.h"
-#include "platform/PlatformMutex.h"
+#include "platform/mbed_critical.h"
+#include "cmsis.h"
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
@@ -40,6 +40,10 @@ are active, the second one (MBED_MEM_TRACING_ENABLED) will trace the first one's
 /* Implementation of the runtime max heap usage checker                       */
 /******************************************************************************/
 
+/* The statistics are updated with atomic operations so that allocations from
+ * different threads are not serialized by the statistics. The requested size
+ * of each block is kept in a header in front of it, to be accounted at free. */
+
 /* Size must be a multiple of 8 to keep alignment */
 typedef struct {
     uint32_t size;
@@ -47,8 +51,41 @@ typedef struct {
 } alloc_info_t;
 
 #ifdef MBED_HEAP_STATS_ENABLED
-static SingletonPtr<PlatformMutex> malloc_stats_mutex;
 static mbed_stats_heap_t heap_stats = {0, 0, 0, 0, 0};
+static mbed_stats_heap_histogram_t heap_histogram;
+
+static inline uint32_t heap_size_class(uint32_t size)
+{
+    uint32_t size_class = (size != 0) ? (31 - __CLZ(size)) : 0;
+    return (size_class < MBED_STATS_HEAP_SIZE_CLASSES) ? size_class : (MBED_STATS_HEAP_SIZE_CLASSES - 1);
+}
+
+static void heap_stats_alloc(uint32_t size)
+{
+    uint32_t size_class = heap_size_class(size);
+    uint32_t current_size = core_util_atomic_incr_u32(&heap_stats.current_size, size);
+    uint32_t max_size = heap_stats.max_size;
+
+    core_util_atomic_incr_u32(&heap_stats.total_size, size);
+    core_util_atomic_incr_u32(&heap_histogram.live_cnt[size_class], 1);
+    core_util_atomic_incr_u32(&heap_histogram.total_cnt[size_class], 1);
+    while (current_size > max_size) {
+        if (core_util_atomic_cas_u32(&heap_stats.max_size, &max_size, current_size)) {
+            break;
+        }
+    }
+}
+
+static void heap_stats_free(uint32_t size)
+{
+    core_util_atomic_decr_u32(&heap_stats.current_size, size);
+    core_util_atomic_decr_u32(&heap_histogram.live_cnt[heap_size_class(size)], 1);
+}
+
+static void heap_stats_fail(void)
+{
+    core_util_atomic_incr_u32(&heap_stats.alloc_fail_cnt, 1);
+}
 #endif
 
 void mbed_stats_heap_get(mbed_stats_heap_t *stats)
@@ -57,14 +94,26 @@ void mbed_stats_heap_get(mbed_stats_heap_t *stats)
     extern uint32_t mbed_heap_size;
     heap_stats.reserved_size = mbed_heap_size;
 
-    malloc_stats_mutex->lock();
     memcpy(stats, &heap_stats, sizeof(mbed_stats_heap_t));
-    malloc_stats_mutex->unlock();
+    // The allocations are counted by size class only
+    stats->alloc_cnt = 0;
+    for (int i = 0; i < MBED_STATS_HEAP_SIZE_CLASSES; i++) {
+        stats->alloc_cnt += heap_histogram.live_cnt[i];
+    }
 #else
     memset(stats, 0, sizeof(mbed_stats_heap_t));
 #endif
 }
 
+void mbed_stats_heap_histogram_get(mbed_stats_heap_histogram_t *stats)
+{
+#ifdef MBED_HEAP_STATS_ENABLED
+    memcpy(stats, &heap_histogram, sizeof(mbed_stats_heap_histogram_t));
+#else
+    memset(stats, 0, sizeof(mbed_stats_heap_histogram_t));
+#endif
+}
+
 /******************************************************************************/
 /* GCC memory allocation wrappers                                             */
 /******************************************************************************/
@@ -98,21 +147,14 @@ extern "C" void * malloc_wrapper(struct _reent * r, size_t size, void * caller)
     mbed_mem_trace_lock();
 #endif
 #ifdef MBED_HEAP_STATS_ENABLED
-    malloc_stats_mutex->lock();
     alloc_info_t *alloc_info = (alloc_info_t*)__real__malloc_r(r, size + sizeof(alloc_info_t));
     if (alloc_info != NULL) {
         alloc_info->size = size;
         ptr = (void*)(alloc_info + 1);
-        heap_stats.current_size += size;
-        heap_stats.total_size += size;
-        heap_stats.alloc_cnt += 1;
-        if (heap_stats.current_size > heap_stats.max_size) {
-            heap_stats.max_size = heap_stats.current_size;
-        }
+        heap_stats_alloc(size);
     } else {
-        heap_stats.alloc_fail_cnt += 1;
+        heap_stats_fail();
     }
-    malloc_stats_mutex->unlock();
 #else // #ifdef MBED_HEAP_STATS_ENABLED
     ptr = __real__malloc_r(r, size);
 #endif // #ifdef MBED_HEAP_STATS_ENABLED
@@ -131,11 +173,9 @@ extern "C" void * __wrap__realloc_r(struct _reent * r, void * ptr, size_t size)
 #ifdef MBED_HEAP_STATS_ENABLED
     // Implement realloc_r with malloc and free.
     // The function realloc_r can't be used here directly since
-    // it can call into __wrap__malloc_r (returns ptr + 4) or
+    // it can call into __wrap__malloc_r (returns ptr + 8) or
     // resize memory directly (returns ptr + 0).
 
-    // Note - no lock needed since malloc and free are thread safe
-
     // Get old size
     uint32_t old_size = 0;
     if (ptr != NULL) {
@@ -174,15 +214,12 @@ extern "C" void free_wrapper(struct _reent * r, void * ptr, void * caller) {
     mbed_mem_trace_lock();
 #endif
 #ifdef MBED_HEAP_STATS_ENABLED
-    malloc_stats_mutex->lock();
     alloc_info_t *alloc_info = NULL;
     if (ptr != NULL) {
         alloc_info = ((alloc_info_t*)ptr) - 1;
-        heap_stats.current_size -= alloc_info->size;
-        heap_stats.alloc_cnt -= 1;
+        heap_stats_free(alloc_info->size);
     }
     __real__free_r(r, (void*)alloc_info);
-    malloc_stats_mutex->unlock();
 #else // #ifdef MBED_HEAP_STATS_ENABLED
     __real__free_r(r, ptr);
 #endif // #ifdef MBED_HEAP_STATS_ENABLED
@@ -270,21 +307,14 @@ extern "C" void* malloc_wrapper(size_t size, void* caller) {
     mbed_mem_trace_lock();
 #endif
 #ifdef MBED_HEAP_STATS_ENABLED
-    malloc_stats_mutex->lock();
     alloc_info_t *alloc_info = (alloc_info_t*)SUPER_MALLOC(size + sizeof(alloc_info_t));
     if (alloc_info != NULL) {
         alloc_info->size = size;
         ptr = (void*)(alloc_info + 1);
-        heap_stats.current_size += size;
-        heap_stats.total_size += size;
-        heap_stats.alloc_cnt += 1;
-        if (heap_stats.current_size > heap_stats.max_size) {
-            heap_stats.max_size = heap_stats.current_size;
-        }
+        heap_stats_alloc(size);
     } else {
-        heap_stats.alloc_fail_cnt += 1;
+        heap_stats_fail();
     }
-    malloc_stats_mutex->unlock();
 #else // #ifdef MBED_HEAP_STATS_ENABLED
     ptr = SUPER_MALLOC(size);
 #endif // #ifdef MBED_HEAP_STATS_ENABLED
@@ -363,15 +393,12 @@ extern "C" void free_wrapper(void *ptr, void* caller) {
     mbed_mem_trace_lock();
 #endif
 #ifdef MBED_HEAP_STATS_ENABLED
-    malloc_stats_mutex->lock();
     alloc_info_t *alloc_info = NULL;
     if (ptr != NULL) {
         alloc_info = ((alloc_info_t*)ptr) - 1;
-        heap_stats.current_size -= alloc_info->size;
-        heap_stats.alloc_cnt -= 1;
+        heap_stats_free(alloc_info->size);
     }
     SUPER_FREE((void*)alloc_info);
-    malloc_stats_mutex->unlock();
 #else // #ifdef MBED_HEAP_STATS_ENABLED
     SUPER_FREE(ptr);
 #endif // #ifdef MBED_HEAP_STATS_ENABLED
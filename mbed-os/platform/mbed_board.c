@@ -20,6 +20,7 @@
 #include "platform/mbed_interface.h"
 #include "platform/mbed_critical.h"
 #include "hal/serial_api.h"
+#include "platform/mbed_minimal_printf.h"
 
 #if DEVICE_SERIAL
 extern int stdio_uart_inited;
@@ -61,7 +62,15 @@ void mbed_error_vfprintf(const char * format, va_list arg) {
 #define ERROR_BUF_SIZE      (128)
     core_util_critical_section_enter();
     char buffer[ERROR_BUF_SIZE];
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF
+    int size = mbed_minimal_vsnprintf(buffer, ERROR_BUF_SIZE, format, arg);
+#else
     int size = vsnprintf(buffer, ERROR_BUF_SIZE, format, arg);
+#endif
+    if (size >= ERROR_BUF_SIZE) {
+        // Truncated, only the buffer is printed
+        size = ERROR_BUF_SIZE - 1;
+    }
     if (size > 0) {
         if (!stdio_uart_inited) {
             serial_init(&stdio_uart, STDIO_UART_TX, STDIO_UART_RX);
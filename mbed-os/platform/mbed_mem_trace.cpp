@@ -21,6 +21,8 @@
 #include "platform/mbed_critical.h"
 #include "platform/SingletonPtr.h"
 #include "platform/PlatformMutex.h"
+#include "hal/us_ticker_api.h"
+#include "cmsis.h"
 
 /******************************************************************************
  * Internal variables, functions and helpers
@@ -34,6 +36,15 @@ static mbed_mem_trace_cb_t mem_trace_cb;
 static uint8_t trace_lock_count;
 static SingletonPtr<PlatformMutex> mem_trace_mutex;
 
+/* Ring of binary records. Records are only written with the trace mutex held,
+ * so there is a single producer and 'ring_head' is only written by it, while
+ * 'ring_tail' is only written by the reader. */
+#define RING_MASK (MBED_CONF_PLATFORM_MEM_TRACE_RING_SIZE - 1)
+static mbed_mem_trace_record_t ring[MBED_CONF_PLATFORM_MEM_TRACE_RING_SIZE];
+static volatile uint32_t ring_head;
+static volatile uint32_t ring_tail;
+static volatile uint32_t ring_dropped;
+
 #define TRACE_FIRST_LOCK() (trace_lock_count < 2)
 
 
@@ -127,3 +138,66 @@ void mbed_mem_trace_default_callback(uint8_t op, void *res, void *caller, ...) {
     va_end(va);
 }
 
+void mbed_mem_trace_binary_callback(uint8_t op, void *res, void *caller, ...) {
+    va_list va;
+    uint32_t head = ring_head;
+
+    if ((head - ring_tail) >= MBED_CONF_PLATFORM_MEM_TRACE_RING_SIZE) {
+        ring_dropped++;
+        return;
+    }
+
+    mbed_mem_trace_record_t *record = &ring[head & RING_MASK];
+    record->timestamp = us_ticker_read();
+    record->res = (uint32_t)res;
+    record->caller = (uint32_t)caller;
+    record->ptr = 0;
+    record->size = 0;
+    record->op = op;
+
+    va_start(va, caller);
+    switch(op) {
+        case MBED_MEM_TRACE_MALLOC:
+            record->size = va_arg(va, size_t);
+            break;
+
+        case MBED_MEM_TRACE_REALLOC:
+            record->ptr = (uint32_t)va_arg(va, void*);
+            record->size = va_arg(va, size_t);
+            break;
+
+        case MBED_MEM_TRACE_CALLOC:
+            record->size = va_arg(va, size_t);
+            record->size *= va_arg(va, size_t);
+            break;
+
+        case MBED_MEM_TRACE_FREE:
+            record->ptr = (uint32_t)va_arg(va, void*);
+            break;
+    }
+    va_end(va);
+
+    // Publish the record only once it is complete
+    __DMB();
+    ring_head = head + 1;
+}
+
+size_t mbed_mem_trace_ring_read(mbed_mem_trace_record_t *records, size_t count) {
+    uint32_t tail = ring_tail;
+    uint32_t available = ring_head - tail;
+    size_t n = (available < count) ? available : count;
+
+    __DMB();
+    for (size_t i = 0; i < n; i++) {
+        records[i] = ring[(tail + i) & RING_MASK];
+    }
+    __DMB();
+    ring_tail = tail + n;
+
+    return n;
+}
+
+uint32_t mbed_mem_trace_ring_dropped(void) {
+    return ring_dropped;
+}
+
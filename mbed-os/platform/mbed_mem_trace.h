@@ -150,6 +150,59 @@ void mbed_mem_trace_free(void *ptr, void *caller);
  */
 void mbed_mem_trace_default_callback(uint8_t op, void *res, void *caller, ...);
 
+/** Number of records held by the binary trace ring, must be a power of 2 */
+#ifndef MBED_CONF_PLATFORM_MEM_TRACE_RING_SIZE
+#define MBED_CONF_PLATFORM_MEM_TRACE_RING_SIZE  128
+#endif
+
+/**
+ * Record stored by the binary memory trace callback.
+ *
+ * All the fields are 32-bit wide so that a dump of the ring can be decoded
+ * on the host with this same definition.
+ */
+typedef struct {
+    uint32_t timestamp;     /**< Time of the operation in microseconds, from the us ticker */
+    uint32_t res;           /**< Result of the operation (0 for 'free') */
+    uint32_t caller;        /**< Caller of the operation */
+    uint32_t ptr;           /**< 'ptr' argument of 'realloc' and 'free', 0 otherwise */
+    uint32_t size;          /**< Requested size in bytes ('nmemb * size' for 'calloc') */
+    uint8_t op;             /**< Operation (MBED_MEM_TRACE_MALLOC, ...) */
+    uint8_t reserved[3];
+} mbed_mem_trace_record_t;
+
+/**
+ * Binary memory trace callback. DO NOT CALL DIRECTLY. It is meant to be used
+ * as the argument of 'mbed_mem_trace_set_callback'.
+ *
+ * Instead of formatting each operation like the default callback, it stores an
+ * mbed_mem_trace_record_t in a RAM ring and returns. The ring is emptied with
+ * 'mbed_mem_trace_ring_read', typically from a low priority thread which writes
+ * the records to a file or a serial port for the host side analyzer in
+ * tools/debug_tools/mem_trace. When the ring is full new records are dropped
+ * and counted.
+ */
+void mbed_mem_trace_binary_callback(uint8_t op, void *res, void *caller, ...);
+
+/**
+ * Move records out of the binary trace ring, oldest first.
+ *
+ * Only one context may read the ring at a time; it may run concurrently with
+ * the traced memory operations.
+ *
+ * @param records array to fill.
+ * @param count number of records the array can hold.
+ * @return number of records copied to the array.
+ */
+size_t mbed_mem_trace_ring_read(mbed_mem_trace_record_t *records, size_t count);
+
+/**
+ * Get the number of records dropped because the binary trace ring was full.
+ *
+ * @return number of records dropped since boot.
+ */
+uint32_t mbed_mem_trace_ring_dropped(void);
+
 /** @}*/
 
 #ifdef __cplusplus
@@ -0,0 +1,516 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdint.h>
+#include <string.h>
+#include "platform/mbed_minimal_printf.h"
+
+/* Without 64-bit support, %lld and %jd are still consumed as 64-bit but printed on 32 bits */
+#ifndef MBED_CONF_PLATFORM_MINIMAL_PRINTF_ENABLE_64_BIT
+#define MBED_CONF_PLATFORM_MINIMAL_PRINTF_ENABLE_64_BIT     1
+#endif
+
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF_ENABLE_64_BIT
+typedef uint64_t minimal_uint_t;
+typedef int64_t minimal_int_t;
+#else
+typedef uint32_t minimal_uint_t;
+typedef int32_t minimal_int_t;
+#endif
+
+/* Conversion flags */
+#define FLAG_LEFT       0x01
+#define FLAG_ZERO       0x02
+#define FLAG_PLUS       0x04
+#define FLAG_SPACE      0x08
+#define FLAG_ALT        0x10
+#define FLAG_UPPER      0x20
+
+/* Length modifiers */
+typedef enum {
+    LENGTH_CHAR,
+    LENGTH_SHORT,
+    LENGTH_INT,
+    LENGTH_LONG,
+    LENGTH_LONG_LONG,
+    LENGTH_INTMAX,
+    LENGTH_SIZE,
+    LENGTH_PTRDIFF,
+    LENGTH_LONG_DOUBLE
+} minimal_length_t;
+
+/* Digits of a 64-bit integer in octal */
+#define DIGITS_MAX      22
+
+static const char digits_lower[] = "0123456789abcdef";
+static const char digits_upper[] = "0123456789ABCDEF";
+
+/* Output to a buffer, or to a sink through a chunk buffer */
+typedef struct {
+    char *buffer;
+    size_t size;
+    size_t index;
+    size_t total;
+    mbed_minimal_sink_t sink;
+    void *context;
+    int error;
+} minimal_output_t;
+
+static void output_flush(minimal_output_t *out)
+{
+    if (out->sink && out->index && !out->error) {
+        if (out->sink(out->context, out->buffer, out->index) < 0) {
+            out->error = 1;
+        }
+    }
+    out->index = 0;
+}
+
+static void output_chars(minimal_output_t *out, const char *data, size_t length)
+{
+    out->total += length;
+    while (length) {
+        size_t space = out->size - out->index;
+
+        if (space == 0) {
+            if (!out->sink) {
+                // Buffer full, only count
+                return;
+            }
+            output_flush(out);
+            space = out->size;
+        }
+        if (space > length) {
+            space = length;
+        }
+        memcpy(out->buffer + out->index, data, space);
+        out->index += space;
+        data += space;
+        length -= space;
+    }
+}
+
+static void output_char(minimal_output_t *out, char c)
+{
+    if (out->index < out->size) {
+        out->buffer[out->index++] = c;
+        out->total++;
+    } else {
+        output_chars(out, &c, 1);
+    }
+}
+
+static void output_repeat(minimal_output_t *out, char c, int count)
+{
+    for (; count > 0; count--) {
+        output_char(out, c);
+    }
+}
+
+/* Write the digits of value at the end of digits, and return the first one */
+static char *convert(char *digits, minimal_uint_t value, unsigned int base, const char *set)
+{
+    char *first = digits + DIGITS_MAX;
+    uint32_t small;
+
+    if (base == 10) {
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF_ENABLE_64_BIT
+        // 64-bit divisions only for the digits above 32 bits
+        while (value > UINT32_MAX) {
+            *--first = (char)('0' + value % 10);
+            value /= 10;
+        }
+#endif
+        small = (uint32_t)value;
+        while (small) {
+            *--first = (char)('0' + small % 10);
+            small /= 10;
+        }
+    } else {
+        unsigned int shift = (base == 16) ? 4 : 3;
+
+        while (value) {
+            *--first = set[value & (base - 1)];
+            value >>= shift;
+        }
+    }
+    return first;
+}
+
+static void format_integer(minimal_output_t *out, minimal_uint_t value, char sign, const char *prefix,
+                           unsigned int base, int flags, int width, int precision)
+{
+    char digits[DIGITS_MAX];
+    char *first = convert(digits, value, base, (flags & FLAG_UPPER) ? digits_upper : digits_lower);
+    int count = (int)(digits + DIGITS_MAX - first);
+    int prefix_length = (int)strlen(prefix);
+    int zeros;
+    int pad;
+
+    // The precision is the minimum number of digits, 1 by default
+    zeros = ((precision < 0) ? 1 : precision) - count;
+    if ((base == 8) && (flags & FLAG_ALT) && (zeros <= 0)) {
+        // Alternate octal form starts with 0
+        zeros = 1;
+    }
+    if (zeros < 0) {
+        zeros = 0;
+    }
+    pad = width - ((sign ? 1 : 0) + prefix_length + zeros + count);
+    if ((flags & FLAG_ZERO) && !(flags & FLAG_LEFT) && (precision < 0) && (pad > 0)) {
+        zeros += pad;
+        pad = 0;
+    }
+
+    if (!(flags & FLAG_LEFT)) {
+        output_repeat(out, ' ', pad);
+    }
+    if (sign) {
+        output_char(out, sign);
+    }
+    output_chars(out, prefix, prefix_length);
+    output_repeat(out, '0', zeros);
+    output_chars(out, first, count);
+    if (flags & FLAG_LEFT) {
+        output_repeat(out, ' ', pad);
+    }
+}
+
+static void format_string(minimal_output_t *out, const char *string, int flags, int width, int precision)
+{
+    int length = 0;
+
+    if (string == NULL) {
+        string = "(null)";
+    }
+    // Do not read past the precision, the string does not have to be null terminated
+    while (((precision < 0) || (length < precision)) && string[length]) {
+        length++;
+    }
+    if (!(flags & FLAG_LEFT)) {
+        output_repeat(out, ' ', width - length);
+    }
+    output_chars(out, string, length);
+    if (flags & FLAG_LEFT) {
+        output_repeat(out, ' ', width - length);
+    }
+}
+
+static minimal_int_t signed_argument(va_list *arguments, minimal_length_t length)
+{
+    switch (length) {
+        case LENGTH_CHAR:
+            return (signed char)va_arg(*arguments, int);
+        case LENGTH_SHORT:
+            return (short)va_arg(*arguments, int);
+        case LENGTH_LONG:
+            return va_arg(*arguments, long);
+        case LENGTH_LONG_LONG:
+            return (minimal_int_t)va_arg(*arguments, long long);
+        case LENGTH_INTMAX:
+            return (minimal_int_t)va_arg(*arguments, intmax_t);
+        case LENGTH_SIZE:
+            return (minimal_int_t)va_arg(*arguments, size_t);
+        case LENGTH_PTRDIFF:
+            return va_arg(*arguments, ptrdiff_t);
+        default:
+            return va_arg(*arguments, int);
+    }
+}
+
+static minimal_uint_t unsigned_argument(va_list *arguments, minimal_length_t length)
+{
+    switch (length) {
+        case LENGTH_CHAR:
+            return (unsigned char)va_arg(*arguments, unsigned int);
+        case LENGTH_SHORT:
+            return (unsigned short)va_arg(*arguments, unsigned int);
+        case LENGTH_LONG:
+            return va_arg(*arguments, unsigned long);
+        case LENGTH_LONG_LONG:
+            return (minimal_uint_t)va_arg(*arguments, unsigned long long);
+        case LENGTH_INTMAX:
+            return (minimal_uint_t)va_arg(*arguments, uintmax_t);
+        case LENGTH_SIZE:
+            return va_arg(*arguments, size_t);
+        case LENGTH_PTRDIFF:
+            return (minimal_uint_t)va_arg(*arguments, ptrdiff_t);
+        default:
+            return va_arg(*arguments, unsigned int);
+    }
+}
+
+static int format_output(minimal_output_t *out, const char *format, va_list *arguments)
+{
+    while (*format) {
+        const char *start = format;
+        minimal_length_t length = LENGTH_INT;
+        int flags = 0;
+        int width = 0;
+        int precision = -1;
+
+        // Characters up to the next conversion
+        while (*format && (*format != '%')) {
+            format++;
+        }
+        output_chars(out, start, format - start);
+        if (!*format) {
+            break;
+        }
+        start = format++;
+
+        for (;; format++) {
+            if (*format == '-') {
+                flags |= FLAG_LEFT;
+            } else if (*format == '0') {
+                flags |= FLAG_ZERO;
+            } else if (*format == '+') {
+                flags |= FLAG_PLUS;
+            } else if (*format == ' ') {
+                flags |= FLAG_SPACE;
+            } else if (*format == '#') {
+                flags |= FLAG_ALT;
+            } else {
+                break;
+            }
+        }
+
+        if (*format == '*') {
+            width = va_arg(*arguments, int);
+            if (width < 0) {
+                flags |= FLAG_LEFT;
+                width = -width;
+            }
+            format++;
+        } else {
+            while ((*format >= '0') && (*format <= '9')) {
+                width = width * 10 + (*format++ - '0');
+            }
+        }
+
+        if (*format == '.') {
+            format++;
+            precision = 0;
+            if (*format == '*') {
+                // A negative precision is taken as omitted
+                precision = va_arg(*arguments, int);
+                if (precision < 0) {
+                    precision = -1;
+                }
+                format++;
+            } else {
+                while ((*format >= '0') && (*format <= '9')) {
+                    precision = precision * 10 + (*format++ - '0');
+                }
+            }
+        }
+
+        switch (*format) {
+            case 'h':
+                format++;
+                length = LENGTH_SHORT;
+                if (*format == 'h') {
+                    format++;
+                    length = LENGTH_CHAR;
+                }
+                break;
+            case 'l':
+                format++;
+                length = LENGTH_LONG;
+                if (*format == 'l') {
+                    format++;
+                    length = LENGTH_LONG_LONG;
+                }
+                break;
+            case 'j':
+                format++;
+                length = LENGTH_INTMAX;
+                break;
+            case 'z':
+                format++;
+                length = LENGTH_SIZE;
+                break;
+            case 't':
+                format++;
+                length = LENGTH_PTRDIFF;
+                break;
+            case 'L':
+                format++;
+                length = LENGTH_LONG_DOUBLE;
+                break;
+            default:
+                break;
+        }
+
+        switch (*format) {
+            case 'd':
+            case 'i': {
+                minimal_int_t value = signed_argument(arguments, length);
+                char sign = (flags & FLAG_PLUS) ? '+' : ((flags & FLAG_SPACE) ? ' ' : 0);
+
+                if (value < 0) {
+                    sign = '-';
+                }
+                format_integer(out, (value < 0) ? (minimal_uint_t)0 - (minimal_uint_t)value : (minimal_uint_t)value,
+                               sign, "", 10, flags, width, precision);
+                break;
+            }
+            case 'u':
+                format_integer(out, unsigned_argument(arguments, length), 0, "", 10, flags, width, precision);
+                break;
+            case 'o':
+                format_integer(out, unsigned_argument(arguments, length), 0, "", 8, flags, width, precision);
+                break;
+            case 'X':
+                flags |= FLAG_UPPER;
+            /* fall through */
+            case 'x': {
+                minimal_uint_t value = unsigned_argument(arguments, length);
+                const char *prefix = "";
+
+                if ((flags & FLAG_ALT) && value) {
+                    prefix = (flags & FLAG_UPPER) ? "0X" : "0x";
+                }
+                format_integer(out, value, 0, prefix, 16, flags, width, precision);
+                break;
+            }
+            case 'p':
+                format_integer(out, (uintptr_t)va_arg(*arguments, void *), 0, "0x", 16, flags, width, precision);
+                break;
+            case 'c': {
+                char c = (char)va_arg(*arguments, int);
+
+                if (!(flags & FLAG_LEFT)) {
+                    output_repeat(out, ' ', width - 1);
+                }
+                output_char(out, c);
+                if (flags & FLAG_LEFT) {
+                    output_repeat(out, ' ', width - 1);
+                }
+                break;
+            }
+            case 's':
+                format_string(out, va_arg(*arguments, const char *), flags, width, precision);
+                break;
+            case '%':
+                output_char(out, '%');
+                break;
+            case 'n':
+                // Not supported, writing through the arguments is never needed to log
+                (void)va_arg(*arguments, void *);
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                // No floating point, the conversion is copied as written
+                if (length == LENGTH_LONG_DOUBLE) {
+                    (void)va_arg(*arguments, long double);
+                } else {
+                    (void)va_arg(*arguments, double);
+                }
+                output_chars(out, start, format + 1 - start);
+                break;
+            case '\0':
+                // Truncated conversion at the end of the format
+                output_chars(out, start, format - start);
+                continue;
+            default:
+                output_chars(out, start, format + 1 - start);
+                break;
+        }
+        format++;
+    }
+
+    return out->error ? -1 : (int)out->total;
+}
+
+int mbed_minimal_vxprintf(mbed_minimal_sink_t sink, void *context, const char *format, va_list arguments)
+{
+    char chunk[MBED_MINIMAL_PRINTF_CHUNK_SIZE];
+    minimal_output_t out = {chunk, sizeof(chunk), 0, 0, sink, context, 0};
+    va_list copy;
+
+    va_copy(copy, arguments);
+    format_output(&out, format, &copy);
+    va_end(copy);
+    output_flush(&out);
+
+    return out.error ? -1 : (int)out.total;
+}
+
+int mbed_minimal_vsnprintf(char *buffer, size_t size, const char *format, va_list arguments)
+{
+    // The last character of the buffer is kept for the null character
+    minimal_output_t out = {buffer, size ? size - 1 : 0, 0, 0, NULL, NULL, 0};
+    va_list copy;
+    int total;
+
+    va_copy(copy, arguments);
+    total = format_output(&out, format, &copy);
+    va_end(copy);
+    if (size) {
+        buffer[out.index] = '\0';
+    }
+
+    return total;
+}
+
+int mbed_minimal_snprintf(char *buffer, size_t size, const char *format, ...)
+{
+    va_list arguments;
+    int total;
+
+    va_start(arguments, format);
+    total = mbed_minimal_vsnprintf(buffer, size, format, arguments);
+    va_end(arguments);
+
+    return total;
+}
+
+static int stream_sink(void *context, const char *data, size_t length)
+{
+    return (fwrite(data, 1, length, (FILE *)context) == length) ? 0 : -1;
+}
+
+int mbed_minimal_vfprintf(FILE *stream, const char *format, va_list arguments)
+{
+    return mbed_minimal_vxprintf(stream_sink, stream, format, arguments);
+}
+
+size_t mbed_minimal_hexdump(char *buffer, size_t size, const void *data, size_t length, char separator)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+    size_t step = separator ? 3 : 2;
+    size_t count = 0;
+
+    if (size == 0) {
+        return 0;
+    }
+    for (; length && (count + step < size); length--, bytes++) {
+        buffer[count++] = digits_upper[*bytes >> 4];
+        buffer[count++] = digits_upper[*bytes & 0x0F];
+        if (separator) {
+            buffer[count++] = separator;
+        }
+    }
+    buffer[count] = '\0';
+
+    return count;
+}
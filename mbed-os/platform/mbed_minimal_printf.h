@@ -0,0 +1,125 @@
+
+/** \addtogroup platform */
+/** @{*/
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_MINIMAL_PRINTF_H
+#define MBED_MINIMAL_PRINTF_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \defgroup platform_minimal_printf minimal printf functions
+ *
+ * A compact formatter for the logging and AT command paths, selected instead of
+ * the C library printf with the platform.minimal-printf option.
+ *
+ * It supports the conversions d, i, u, o, x, X, c, s, p and %, the flags '-', '0',
+ * '+', ' ' and '#', the width and the precision, given or '*', and the length
+ * modifiers hh, h, l, ll, j, z and t. It has no floating point: %f, %e, %g and %a
+ * consume their double and are copied to the output as written, like the other
+ * unknown conversions. %n is ignored.
+ *
+ * The functions are reentrant: they use no static data and no heap. Their stack
+ * is bounded, about 500 bytes from mbed_minimal_vsnprintf() down to the sink as
+ * measured with GCC -fstack-usage on a 64-bit host: 112 bytes for
+ * mbed_minimal_vsnprintf(), 144 for mbed_minimal_vxprintf() with its chunk of
+ * MBED_MINIMAL_PRINTF_CHUNK_SIZE bytes, 128 for the parsing of the format and
+ * 144 for the conversion of an integer, plus the stack of the sink.
+ * @{
+ */
+
+/** Size of the stack buffer through which the output is passed to a sink */
+#ifndef MBED_MINIMAL_PRINTF_CHUNK_SIZE
+#define MBED_MINIMAL_PRINTF_CHUNK_SIZE  32
+#endif
+
+/** Sink of the formatted output
+ *
+ * @param context The context given to mbed_minimal_vxprintf
+ * @param data    The formatted characters, not null terminated
+ * @param length  The number of characters
+ * @return 0 on success, negative on error. The sink is not called again after an error.
+ */
+typedef int (*mbed_minimal_sink_t)(void *context, const char *data, size_t length);
+
+/** Format to a sink, in chunks of up to MBED_MINIMAL_PRINTF_CHUNK_SIZE characters
+ *
+ * @param sink      The sink of the output
+ * @param context   The context passed to the sink
+ * @param format    The printf format
+ * @param arguments The arguments of the format
+ * @return The number of characters formatted, or -1 if the sink failed
+ */
+int mbed_minimal_vxprintf(mbed_minimal_sink_t sink, void *context, const char *format, va_list arguments);
+
+/** Format to a buffer, like vsnprintf
+ *
+ * @param buffer    The buffer, null terminated if size is not 0
+ * @param size      The size of the buffer
+ * @param format    The printf format
+ * @param arguments The arguments of the format
+ * @return The number of characters the whole output has, without the null character
+ */
+int mbed_minimal_vsnprintf(char *buffer, size_t size, const char *format, va_list arguments);
+
+/** Format to a buffer, like snprintf
+ *
+ * @param buffer The buffer, null terminated if size is not 0
+ * @param size   The size of the buffer
+ * @param format The printf format
+ * @return The number of characters the whole output has, without the null character
+ */
+int mbed_minimal_snprintf(char *buffer, size_t size, const char *format, ...);
+
+/** Format to a stream, like vfprintf
+ *
+ * @param stream    The stream
+ * @param format    The printf format
+ * @param arguments The arguments of the format
+ * @return The number of characters written, or -1 on a write error
+ */
+int mbed_minimal_vfprintf(FILE *stream, const char *format, va_list arguments);
+
+/** Write bytes in hexadecimal, two upper case digits per byte
+ *
+ * A fast path for dumps, without parsing a format per byte.
+ *
+ * @param buffer    The buffer, null terminated if size is not 0
+ * @param size      The size of the buffer
+ * @param data      The bytes
+ * @param length    The number of bytes
+ * @param separator The character written after each byte, or 0 for none
+ * @return The number of characters written, without the null character.
+ *         Only whole bytes are written.
+ */
+size_t mbed_minimal_hexdump(char *buffer, size_t size, const void *data, size_t length, char separator);
+
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/** @}*/
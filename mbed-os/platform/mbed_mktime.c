@@ -28,42 +28,26 @@
 #define EDGE_TIMESTAMP_FULL_LEAP_YEAR_SUPPORT 3220095     // 7th of February 1970 at 06:28:15
 #define EDGE_TIMESTAMP_4_YEAR_LEAP_YEAR_SUPPORT 3133695  // 6th of February 1970 at 06:28:15
 
+/* Number of days between 01.01.1970 and 01.03.2100, the first day after the
+ * 29th of February that RTCs without full leap year support insert in 2100. */
+#define DAYS_TO_MARCH_2100 47541
+
+/* Number of days between 01.03.1968 and 01.01.1970. The conversion from days
+ * uses 4-year cycles starting the 1st of March of a leap year so that the
+ * leap day is always the last day of a cycle. */
+#define DAYS_FROM_MARCH_1968 671
+#define DAYS_BY_4_YEARS (4 * 365 + 1)
+
 /*
- * 2 dimensional array containing the number of seconds elapsed before a given 
+ * 2 dimensional array containing the number of days elapsed before a given
  * month.
  * The second index map to the month while the first map to the type of year:
- *   - 0: non leap year 
+ *   - 0: non leap year
  *   - 1: leap year
  */
-static const uint32_t seconds_before_month[2][12] = {
-    {
-        0,
-        31 * SECONDS_BY_DAY,
-        (31 + 28) * SECONDS_BY_DAY,
-        (31 + 28 + 31) * SECONDS_BY_DAY,
-        (31 + 28 + 31 + 30) * SECONDS_BY_DAY,
-        (31 + 28 + 31 + 30 + 31) * SECONDS_BY_DAY,
-        (31 + 28 + 31 + 30 + 31 + 30) * SECONDS_BY_DAY,
-        (31 + 28 + 31 + 30 + 31 + 30 + 31) * SECONDS_BY_DAY,
-        (31 + 28 + 31 + 30 + 31 + 30 + 31 + 31) * SECONDS_BY_DAY,
-        (31 + 28 + 31 + 30 + 31 + 30 + 31 + 31 + 30) * SECONDS_BY_DAY,
-        (31 + 28 + 31 + 30 + 31 + 30 + 31 + 31 + 30 + 31) * SECONDS_BY_DAY,
-        (31 + 28 + 31 + 30 + 31 + 30 + 31 + 31 + 30 + 31 + 30) * SECONDS_BY_DAY,
-    },
-    {
-        0,
-        31 * SECONDS_BY_DAY,
-        (31 + 29) * SECONDS_BY_DAY,
-        (31 + 29 + 31) * SECONDS_BY_DAY,
-        (31 + 29 + 31 + 30) * SECONDS_BY_DAY,
-        (31 + 29 + 31 + 30 + 31) * SECONDS_BY_DAY,
-        (31 + 29 + 31 + 30 + 31 + 30) * SECONDS_BY_DAY,
-        (31 + 29 + 31 + 30 + 31 + 30 + 31) * SECONDS_BY_DAY,
-        (31 + 29 + 31 + 30 + 31 + 30 + 31 + 31) * SECONDS_BY_DAY,
-        (31 + 29 + 31 + 30 + 31 + 30 + 31 + 31 + 30) * SECONDS_BY_DAY,
-        (31 + 29 + 31 + 30 + 31 + 30 + 31 + 31 + 30 + 31) * SECONDS_BY_DAY,
-        (31 + 29 + 31 + 30 + 31 + 30 + 31 + 31 + 30 + 31 + 30) * SECONDS_BY_DAY,
-    }
+static const uint16_t days_before_month[2][12] = {
+    { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334 },
+    { 0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335 }
 };
 
 bool _rtc_is_leap_year(int year, rtc_leap_year_support_t leap_year_support) {
@@ -90,6 +74,47 @@ bool _rtc_is_leap_year(int year, rtc_leap_year_support_t leap_year_support) {
     return (year) % 4 ? false : true;
 }
 
+uint32_t _rtc_days_from_civil(int year, int month, int mday, rtc_leap_year_support_t leap_year_support) {
+    /* Valid in the range [70:206]: leap years between 1970 and the start of the year. */
+    uint32_t count_of_leap_days = ((year - 1) / 4) - (69 / 4);
+    if (leap_year_support == RTC_FULL_LEAP_YEAR_SUPPORT && year > 200) {
+        count_of_leap_days--; // 2100 is not a leap year
+    }
+
+    return ((year - 70) * 365) + count_of_leap_days +
+           days_before_month[_rtc_is_leap_year(year, leap_year_support)][month] + (mday - 1);
+}
+
+void _rtc_civil_from_days(uint32_t days, struct tm* time_info, rtc_leap_year_support_t leap_year_support) {
+    /* The 1st of January 1970 was a Thursday which is equal to 4 in the weekday representation ranging from [0:6]. */
+    time_info->tm_wday = (days + 4) % 7;
+
+    /* Devices with full leap year support skip the 29th of February 2100
+     * which the 4-year cycles below would otherwise produce. */
+    if (leap_year_support == RTC_FULL_LEAP_YEAR_SUPPORT && days >= DAYS_TO_MARCH_2100) {
+        days++;
+    }
+
+    days += DAYS_FROM_MARCH_1968;
+    uint32_t cycle = days / DAYS_BY_4_YEARS;
+    uint32_t day_of_cycle = days % DAYS_BY_4_YEARS;
+    /* The leap day is the last day of the cycle and belongs to the 4th year. */
+    uint32_t year_of_cycle = (day_of_cycle - day_of_cycle / (DAYS_BY_4_YEARS - 1)) / 365;
+    uint32_t day_of_year = day_of_cycle - (year_of_cycle * 365);   // [0:365] counted from the 1st of March
+    uint32_t month = (5 * day_of_year + 2) / 153;                  // [0:11] counted from March
+
+    time_info->tm_mday = day_of_year - ((153 * month + 2) / 5) + 1;
+    time_info->tm_year = 68 + (cycle * 4) + year_of_cycle;
+    if (month < 10) {
+        time_info->tm_mon = month + 2;
+        time_info->tm_yday = day_of_year + 31 + 28 + _rtc_is_leap_year(time_info->tm_year, leap_year_support);
+    } else {
+        time_info->tm_mon = month - 10;
+        time_info->tm_yday = day_of_year - (365 - 31 - 28);
+        time_info->tm_year++;
+    }
+}
+
 bool _rtc_maketime(const struct tm* time, time_t * seconds, rtc_leap_year_support_t leap_year_support) {
     if (seconds == NULL || time == NULL) {
         return false;
@@ -105,8 +130,7 @@ bool _rtc_maketime(const struct tm* time, time_t * seconds, rtc_leap_year_suppor
     uint32_t result = time->tm_sec;
     result += time->tm_min * SECONDS_BY_MINUTES;
     result += time->tm_hour * SECONDS_BY_HOUR;
-    result += (time->tm_mday - 1) * SECONDS_BY_DAY;
-    result += seconds_before_month[_rtc_is_leap_year(time->tm_year, leap_year_support)][time->tm_mon];
+    result += (time->tm_mday - 1 + days_before_month[_rtc_is_leap_year(time->tm_year, leap_year_support)][time->tm_mon]) * SECONDS_BY_DAY;
 
     /* Check if we are within valid range. */
     if (time->tm_year == LAST_VALID_YEAR) {
@@ -116,17 +140,7 @@ bool _rtc_maketime(const struct tm* time, time_t * seconds, rtc_leap_year_suppor
         }
     }
 
-    if (time->tm_year > 70) { 
-        /* Valid in the range [70:206]. */
-        uint32_t count_of_leap_days = ((time->tm_year - 1) / 4) - (70 / 4);
-        if (leap_year_support == RTC_FULL_LEAP_YEAR_SUPPORT) {
-            if (time->tm_year > 200) {
-                count_of_leap_days--; // 2100 is not a leap year
-            }
-        }
-
-        result += (((time->tm_year - 70) * 365) + count_of_leap_days) * SECONDS_BY_DAY;
-    }
+    result += _rtc_days_from_civil(time->tm_year, 0, 1, leap_year_support) * SECONDS_BY_DAY;
 
     *seconds = result;
 
@@ -147,44 +161,7 @@ bool _rtc_localtime(time_t timestamp, struct tm* time_info, rtc_leap_year_suppor
     time_info->tm_hour = seconds % 24;
     seconds = seconds / 24;  // timestamp in days;
 
-    /* Compute the weekday.
-     * The 1st of January 1970 was a Thursday which is equal to 4 in the weekday representation ranging from [0:6].
-     */
-    time_info->tm_wday = (seconds + 4) % 7;
-
-    /* Years start at 70. */
-    time_info->tm_year = 70;
-    while (true) { 
-        if (_rtc_is_leap_year(time_info->tm_year, leap_year_support) && seconds >= 366) {
-            ++time_info->tm_year;
-            seconds -= 366;
-        } else if (!_rtc_is_leap_year(time_info->tm_year, leap_year_support) && seconds >= 365) {
-            ++time_info->tm_year;
-            seconds -= 365;
-        } else {
-            /* The remaining days are less than a years. */
-            break;
-        }
-    }
-
-    time_info->tm_yday = seconds;
-
-    /* Convert days into seconds and find the current month. */
-    seconds *= SECONDS_BY_DAY;
-    time_info->tm_mon = 11;
-    bool leap = _rtc_is_leap_year(time_info->tm_year, leap_year_support);
-    for (uint32_t i = 0; i < 12; ++i) {
-        if ((uint32_t) seconds < seconds_before_month[leap][i]) {
-            time_info->tm_mon = i - 1;
-            break;
-        }
-    }
-
-    /* Remove month from timestamp and compute the number of days.
-     * Note: unlike other fields, days are not 0 indexed.
-     */
-    seconds -= seconds_before_month[leap][time_info->tm_mon];
-    time_info->tm_mday = (seconds / SECONDS_BY_DAY) + 1;
+    _rtc_civil_from_days(seconds, time_info, leap_year_support);
 
     return true;
 }
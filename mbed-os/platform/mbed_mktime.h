@@ -62,6 +62,42 @@ typedef enum {
  */
 bool _rtc_is_leap_year(int year, rtc_leap_year_support_t leap_year_support);
 
+/** Compute the number of days elapsed since UNIX epoch for a civil date.
+ *
+ * The computation runs in constant time whatever the date.
+ *
+ * @param year The year in the range [70:206]. Year 0 is translated into year 1900 CE.
+ * @param month The month in the range [0:11].
+ * @param mday The day of the month in the range [1:31].
+ * @param leap_year_support use RTC_FULL_LEAP_YEAR_SUPPORT if RTC device is able
+ * to correctly detect all leap years in range [70:206] otherwise use RTC_4_YEAR_LEAP_YEAR_SUPPORT.
+ *
+ * @return The number of days between the 1st of January 1970 and the date in input.
+ *
+ * @note The date in input is not validated.
+ * @note For use by the HAL only
+ */
+uint32_t _rtc_days_from_civil(int year, int month, int mday, rtc_leap_year_support_t leap_year_support);
+
+/** Convert a number of days elapsed since UNIX epoch into a civil date.
+ *
+ * The computation runs in constant time whatever the date.
+ *
+ * @param days The number of days since the 1st of January 1970, valid up to the 7th of February 2106.
+ * @param time_info Pointer to the object which will contain the result of
+ * the conversion. The tm fields filled by this function are:
+ *   - tm_mday
+ *   - tm_mon
+ *   - tm_year
+ *   - tm_wday
+ *   - tm_yday
+ * @param leap_year_support use RTC_FULL_LEAP_YEAR_SUPPORT if RTC device is able
+ * to correctly detect all leap years in range [70:206] otherwise use RTC_4_YEAR_LEAP_YEAR_SUPPORT.
+ *
+ * @note For use by the HAL only
+ */
+void _rtc_civil_from_days(uint32_t days, struct tm* time_info, rtc_leap_year_support_t leap_year_support);
+
 /* Convert a calendar time into time since UNIX epoch as a time_t.
  *
  * This function is a thread safe (partial) replacement for mktime. It is
@@ -64,7 +64,11 @@ extern "C" {
  * }
  * @endcode
  */
-#ifdef MBED_SLEEP_TRACING_ENABLED
+#if defined(MBED_ALL_STATS_ENABLED) && !defined(MBED_SLEEP_STATS_ENABLED)
+#define MBED_SLEEP_STATS_ENABLED    1
+#endif
+
+#if defined(MBED_SLEEP_TRACING_ENABLED) || defined(MBED_SLEEP_STATS_ENABLED)
 
 void sleep_tracker_lock(const char *const filename, int line);
 void sleep_tracker_unlock(const char *const filename, int line);
@@ -91,7 +95,7 @@ void sleep_tracker_unlock(const char *const filename, int line);
 #define sleep_manager_unlock_deep_sleep() \
     sleep_manager_unlock_deep_sleep_internal()
 
-#endif // MBED_SLEEP_TRACING_ENABLED
+#endif // MBED_SLEEP_TRACING_ENABLED || MBED_SLEEP_STATS_ENABLED
 
 /** Lock the deep sleep mode
  *
@@ -27,6 +27,7 @@
 #include "platform/mbed_stats.h"
 #include "platform/mbed_critical.h"
 #include "platform/mbed_poll.h"
+#include "platform/mbed_minimal_printf.h"
 #include "platform/PlatformMutex.h"
 #include "drivers/UARTSerial.h"
 #include "us_ticker_api.h"
@@ -168,20 +169,13 @@ DirectSerial::DirectSerial(PinName tx, PinName rx, int baud) {
 }
 
 ssize_t DirectSerial::write(const void *buffer, size_t size) {
-    const unsigned char *buf = static_cast<const unsigned char *>(buffer);
-    for (size_t i = 0; i < size; i++) {
-        serial_putc(&stdio_uart, buf[i]);
-    }
+    serial_putc_buffer(&stdio_uart, buffer, size);
     return size;
 }
 
 ssize_t DirectSerial::read(void *buffer, size_t size) {
-    unsigned char *buf = static_cast<unsigned char *>(buffer);
-    if (size == 0) {
-        return 0;
-    }
-    buf[0] = serial_getc(&stdio_uart);
-    return 1;
+    // Waits for the first character, and takes the ones already received with it
+    return serial_getc_buffer(&stdio_uart, buffer, size);
 }
 
 short DirectSerial::poll(short events) const {
@@ -1242,6 +1236,77 @@ int __wrap_atexit(void (*func)()) {
 
 #endif
 
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF && (defined(TOOLCHAIN_GCC) || defined(TOOLCHAIN_ARM))
+
+/*
+ * Retarget the printf family of the C library to the minimal printf, so that
+ * the formatter of the C library is not linked. GCC_ARM links with the wrap
+ * flags of tools/profiles/extensions/minimal-printf.json, added after the
+ * build profile:
+ *     mbed compile --profile develop --profile mbed-os/tools/profiles/extensions/minimal-printf.json
+ * ARM substitutes the functions. IAR selects its own small formatter in the
+ * library options of the project.
+ */
+#if defined(TOOLCHAIN_GCC)
+#define MINIMAL_PRINTF_RETARGET(name)   __wrap_##name
+#else
+#define MINIMAL_PRINTF_RETARGET(name)   $Sub$$##name
+#endif
+
+extern "C" {
+
+int MINIMAL_PRINTF_RETARGET(printf)(const char *format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    int ret = mbed_minimal_vfprintf(stdout, format, arguments);
+    va_end(arguments);
+    return ret;
+}
+
+int MINIMAL_PRINTF_RETARGET(vprintf)(const char *format, va_list arguments) {
+    return mbed_minimal_vfprintf(stdout, format, arguments);
+}
+
+int MINIMAL_PRINTF_RETARGET(fprintf)(FILE *stream, const char *format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    int ret = mbed_minimal_vfprintf(stream, format, arguments);
+    va_end(arguments);
+    return ret;
+}
+
+int MINIMAL_PRINTF_RETARGET(vfprintf)(FILE *stream, const char *format, va_list arguments) {
+    return mbed_minimal_vfprintf(stream, format, arguments);
+}
+
+int MINIMAL_PRINTF_RETARGET(sprintf)(char *buffer, const char *format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    int ret = mbed_minimal_vsnprintf(buffer, INT_MAX, format, arguments);
+    va_end(arguments);
+    return ret;
+}
+
+int MINIMAL_PRINTF_RETARGET(vsprintf)(char *buffer, const char *format, va_list arguments) {
+    return mbed_minimal_vsnprintf(buffer, INT_MAX, format, arguments);
+}
+
+int MINIMAL_PRINTF_RETARGET(snprintf)(char *buffer, size_t size, const char *format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    int ret = mbed_minimal_vsnprintf(buffer, size, format, arguments);
+    va_end(arguments);
+    return ret;
+}
+
+int MINIMAL_PRINTF_RETARGET(vsnprintf)(char *buffer, size_t size, const char *format, va_list arguments) {
+    return mbed_minimal_vsnprintf(buffer, size, format, arguments);
+}
+
+}
+
+#endif
+
 
 
 namespace mbed {
@@ -3,11 +3,13 @@
 #include "mbed_power_mgmt.h"
 #include <string.h>
 #include <stdlib.h>
+#include <stdio.h>
 
 #include "device.h"
 #ifdef MBED_CONF_RTOS_PRESENT
 #include "cmsis_os2.h"
 #include "rtos_idle.h"
+#include "mbed_rtx_thread_cpu.h"
 #elif defined(MBED_STACK_STATS_ENABLED) || defined(MBED_THREAD_STATS_ENABLED) || defined(MBED_CPU_STATS_ENABLED)
 #warning Statistics are currently not supported without the rtos.
 #endif
@@ -29,6 +31,16 @@ void mbed_stats_cpu_get(mbed_stats_cpu_t *stats)
 }
 
 // note: mbed_stats_heap_get defined in mbed_alloc_wrappers.cpp
+// note: mbed_stats_sleep_get_each defined in mbed_sleep_manager.c
+// note: mbed_stats_idle_get defined in mbed_rtx_idle.cpp with the rtos
+#ifndef MBED_CONF_RTOS_PRESENT
+void mbed_stats_idle_get(mbed_stats_idle_t *stats)
+{
+    MBED_ASSERT(stats != NULL);
+    memset(stats, 0, sizeof(mbed_stats_idle_t));
+}
+#endif
+
 void mbed_stats_stack_get(mbed_stats_stack_t *stats)
 {
     MBED_ASSERT(stats != NULL);
@@ -110,6 +122,7 @@ size_t mbed_stats_thread_get_each(mbed_stats_thread_t *stats, size_t count)
         stats[i].stack_size = osThreadGetStackSize(threads[i]);
         stats[i].stack_space = osThreadGetStackSpace(threads[i]);
         stats[i].name = osThreadGetName(threads[i]);
+        mbed_rtx_thread_cpu_get(threads[i], &stats[i].cpu_time, &stats[i].switch_count);
     }
     osKernelUnlock();
     free(threads);
@@ -117,6 +130,93 @@ size_t mbed_stats_thread_get_each(mbed_stats_thread_t *stats, size_t count)
     return i;
 }
 
+#if defined(MBED_THREAD_STATS_ENABLED) && defined(MBED_CONF_RTOS_PRESENT)
+typedef struct {
+    uint32_t id;
+    us_timestamp_t cpu_time;
+    uint32_t switch_count;
+} thread_top_t;
+
+static thread_top_t top_prev[MBED_STATS_THREAD_TOP_MAX];
+static size_t top_prev_count;
+
+static const char *thread_state_name(uint32_t state)
+{
+    switch (state) {
+        case osThreadReady:
+            return "ready";
+        case osThreadRunning:
+            return "running";
+        case osThreadBlocked:
+            return "blocked";
+        case osThreadTerminated:
+            return "terminated";
+        default:
+            return "inactive";
+    }
+}
+#endif
+
+void mbed_stats_thread_top(void)
+{
+#if defined(MBED_THREAD_STATS_ENABLED) && defined(MBED_CONF_RTOS_PRESENT)
+    size_t count = osThreadGetCount();
+    mbed_stats_thread_t *stats = malloc(count * sizeof(mbed_stats_thread_t));
+    MBED_ASSERT(stats != NULL);
+    count = mbed_stats_thread_get_each(stats, count);
+
+    // Keep the current totals for the next call
+    thread_top_t current[MBED_STATS_THREAD_TOP_MAX];
+    size_t current_count = 0;
+    for (size_t i = 0; i < count && current_count < MBED_STATS_THREAD_TOP_MAX; i++) {
+        current[current_count].id = stats[i].id;
+        current[current_count].cpu_time = stats[i].cpu_time;
+        current[current_count].switch_count = stats[i].switch_count;
+        current_count++;
+    }
+
+    // Turn the totals into differences with the previous call, threads created since then start from 0
+    us_timestamp_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = 0; j < top_prev_count; j++) {
+            if (top_prev[j].id == stats[i].id && top_prev[j].cpu_time <= stats[i].cpu_time) {
+                stats[i].cpu_time -= top_prev[j].cpu_time;
+                stats[i].switch_count -= top_prev[j].switch_count;
+                break;
+            }
+        }
+        total += stats[i].cpu_time;
+    }
+
+    memcpy(top_prev, current, current_count * sizeof(thread_top_t));
+    top_prev_count = current_count;
+
+    for (size_t i = 1; i < count; i++) {
+        mbed_stats_thread_t entry = stats[i];
+        size_t j = i;
+        while (j > 0 && stats[j - 1].cpu_time < entry.cpu_time) {
+            stats[j] = stats[j - 1];
+            j--;
+        }
+        stats[j] = entry;
+    }
+
+    printf("%-10s %-16s %-10s %4s %6s %10s %8s %11s\n",
+           "thread", "name", "state", "prio", "cpu", "time (ms)", "switches", "stack");
+    for (size_t i = 0; i < count; i++) {
+        uint32_t permille = total ? (uint32_t)((stats[i].cpu_time * 1000) / total) : 0;
+        printf("0x%08lx %-16.16s %-10s %4lu %3lu.%lu%% %10lu %8lu %5lu/%-5lu\n",
+               (unsigned long)stats[i].id, stats[i].name ? stats[i].name : "",
+               thread_state_name(stats[i].state), (unsigned long)stats[i].priority,
+               (unsigned long)(permille / 10), (unsigned long)(permille % 10),
+               (unsigned long)(stats[i].cpu_time / 1000), (unsigned long)stats[i].switch_count,
+               (unsigned long)(stats[i].stack_size - stats[i].stack_space), (unsigned long)stats[i].stack_size);
+    }
+
+    free(stats);
+#endif
+}
+
 void mbed_stats_sys_get(mbed_stats_sys_t *stats)
 {
     MBED_ASSERT(stats != NULL);
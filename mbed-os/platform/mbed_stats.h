@@ -36,6 +36,7 @@ extern "C" {
 #define MBED_CPU_STATS_ENABLED      1
 #define MBED_HEAP_STATS_ENABLED     1
 #define MBED_THREAD_STATS_ENABLED   1
+#define MBED_SLEEP_STATS_ENABLED    1
 #endif
 
 /**
@@ -53,10 +54,34 @@ typedef struct {
 /**
  *  Fill the passed in heap stat structure with heap stats.
  *
+ *  The counters are updated without a lock, so they are read one by one and
+ *  may be from slightly different points in time if allocations are in progress.
+ *
  *  @param stats    A pointer to the mbed_stats_heap_t structure to fill
  */
 void mbed_stats_heap_get(mbed_stats_heap_t *stats);
 
+/** Number of log2 size classes of mbed_stats_heap_histogram_t */
+#define MBED_STATS_HEAP_SIZE_CLASSES    16
+
+/**
+ * struct mbed_stats_heap_histogram_t definition
+ *
+ * Class n counts the blocks whose size is in [2^n, 2^(n+1)) bytes, the last class
+ * also counts all the larger blocks and class 0 the empty blocks.
+ */
+typedef struct {
+    uint32_t live_cnt[MBED_STATS_HEAP_SIZE_CLASSES];     /**< Current number of allocations in each size class. */
+    uint32_t total_cnt[MBED_STATS_HEAP_SIZE_CLASSES];    /**< Cumulative number of allocations in each size class. */
+} mbed_stats_heap_histogram_t;
+
+/**
+ *  Fill the passed in structure with the number of allocations per size class.
+ *
+ *  @param stats    A pointer to the mbed_stats_heap_histogram_t structure to fill
+ */
+void mbed_stats_heap_histogram_get(mbed_stats_heap_histogram_t *stats);
+
 /**
  * struct mbed_stats_stack_t definition
  */
@@ -102,6 +127,32 @@ typedef struct {
  */
 void mbed_stats_cpu_get(mbed_stats_cpu_t *stats);
 
+/**
+ * struct mbed_stats_idle_t definition
+ *
+ * Decisions of the tickless idle governor (rtos.idle-governor), which chooses the low power mode of each
+ * idle period from the time left until the next wake-up and the measured wake-up latencies.
+ */
+typedef struct {
+    uint32_t wfi_count;               /**< Idle periods too short for sleep, spent in WFI */
+    uint32_t sleep_count;             /**< Idle periods spent in sleep */
+    uint32_t deep_sleep_count;        /**< Idle periods spent in deep sleep, unless the sleep manager refused it */
+    uint32_t deep_sleep_denied;       /**< Idle periods long enough for deep sleep spent in sleep because of a deep sleep lock */
+    uint32_t early_wake_count;        /**< Sleeps and deep sleeps ended by an interrupt before the scheduled wake-up */
+    uint32_t sleep_latency;           /**< Average wake-up latency of sleep in microseconds */
+    uint32_t deep_sleep_latency;      /**< Average wake-up latency of deep sleep in microseconds */
+} mbed_stats_idle_t;
+
+/**
+ *  Fill the passed in structure with the decisions of the idle governor.
+ *
+ *  The decisions are only reported when MBED_CPU_STATS_ENABLED is defined and the governor runs, that is
+ *  with MBED_TICKLESS, an LP ticker and rtos.idle-governor enabled. Otherwise the structure is filled with zeros.
+ *
+ *  @param stats    A pointer to the mbed_stats_idle_t structure to fill
+ */
+void mbed_stats_idle_get(mbed_stats_idle_t *stats);
+
 /**
  * struct mbed_stats_thread_t definition
  */
@@ -112,6 +163,8 @@ typedef struct {
     uint32_t stack_size;        /**< Thread Stack Size */
     uint32_t stack_space;       /**< Thread remaining stack size */
     const char   *name;         /**< Thread Object name */
+    us_timestamp_t cpu_time;    /**< Time the thread has been running, in microseconds */
+    uint32_t switch_count;      /**< Number of times the thread has been switched in */
 } mbed_stats_thread_t;
 
 /**
@@ -124,6 +177,43 @@ typedef struct {
  */
 size_t mbed_stats_thread_get_each(mbed_stats_thread_t *stats, size_t count);
 
+/** Maximum number of threads whose previous times are kept by mbed_stats_thread_top */
+#ifndef MBED_STATS_THREAD_TOP_MAX
+#define MBED_STATS_THREAD_TOP_MAX   16
+#endif
+
+/**
+ *  Print a table of the threads sorted by their share of the CPU time since the previous call, like top.
+ *
+ *  Meant to be called periodically from a thread, for instance with EventQueue::call_every. The first
+ *  call reports the shares since boot. The idle thread is listed, so the shares add up to 100%.
+ */
+void mbed_stats_thread_top(void);
+
+/**
+ * struct mbed_stats_sleep_t definition
+ */
+typedef struct {
+    const char *owner;          /**< Owner of the deep sleep lock (source file which took it) */
+    uint32_t lock_count;        /**< Number of deep sleep locks currently held by the owner */
+    uint32_t lock_total;        /**< Number of times the owner locked deep sleep */
+    uint32_t unlock_total;      /**< Number of times the owner unlocked deep sleep */
+    us_timestamp_t time_held;   /**< Accumulated time the owner kept deep sleep locked, including the current hold */
+    us_timestamp_t uptime;      /**< Time since system is up and running, to derive lock/unlock rates */
+} mbed_stats_sleep_t;
+
+/**
+ *  Fill the passed array of stat structures with the deep sleep lock stats for each owner.
+ *
+ *  Owners with a non-zero lock_count form the set currently preventing deep sleep.
+ *
+ *  @param stats    A pointer to an array of mbed_stats_sleep_t structures to fill
+ *  @param count    The number of mbed_stats_sleep_t structures in the provided array
+ *  @return         The number of mbed_stats_sleep_t structures that have been filled,
+ *                  this is equal to the number of owners that ever took a deep sleep lock.
+ */
+size_t mbed_stats_sleep_get_each(mbed_stats_sleep_t *stats, size_t count);
+
 /**
  * enum mbed_compiler_id_t definition
  */
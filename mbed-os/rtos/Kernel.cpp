@@ -60,4 +60,8 @@ uint64_t Kernel::get_ms_count() {
     }
 }
 
+Kernel::Clock::time_point Kernel::Clock::now() {
+    return time_point(mbed::Milliseconds(get_ms_count()));
+}
+
 }
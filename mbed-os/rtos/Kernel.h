@@ -23,6 +23,7 @@
 #define KERNEL_H
 
 #include <stdint.h>
+#include "platform/Duration.h"
 
 namespace rtos {
 /** \addtogroup rtos */
@@ -43,6 +44,20 @@ namespace Kernel {
  */
 uint64_t get_ms_count();
 
+/** The RTOS kernel millisecond tick count as a clock, whose epoch is the boot.
+     Its time points are the absolute times of Thread::wait_until().
+ */
+struct Clock {
+    typedef mbed::Milliseconds duration;
+    typedef mbed::TimePoint<Clock, mbed::Milliseconds> time_point;
+
+    /** Read the current time
+         @return  The time since boot, as get_ms_count()
+         @note You cannot call this function from ISR context.
+     */
+    static time_point now();
+};
+
 } // namespace Kernel
 
 } // namespace rtos
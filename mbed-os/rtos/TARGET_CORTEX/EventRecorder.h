@@ -0,0 +1,73 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_EVENT_RECORDER_H
+#define MBED_EVENT_RECORDER_H
+
+/* Subset of the Keil Event Recorder API used by rtx_evr.c and mbed_rtx_handlers.c,
+ * backed by the RTX event ring (mbed_rtx_evr_ring.c). It is only included when
+ * RTE_Compiler_EventRecorder is defined, which mbed_rtx_conf.h does when the
+ * rtos.event-recorder-ring-size option is not 0. */
+
+#include <stdint.h>
+#include "mbed_rtx_evr_ring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EventLevelError     0x00000U    ///< Run-time error
+#define EventLevelAPI       0x10000U    ///< API function call
+#define EventLevelOp        0x20000U    ///< Internal operation
+#define EventLevelDetail    0x30000U    ///< Additional detailed information
+
+/// Create an event ID from a level, a component number and a message number
+#define EventID(level, comp_no, msg_no) \
+    (((level) & 0x30000U) | (((comp_no) & 0xFFU) << 8) | ((msg_no) & 0xFFU))
+
+/** Record an event with two 32-bit arguments
+ *
+ *  @param id   event ID
+ *  @param val1 first argument
+ *  @param val2 second argument
+ *  @return     1 if the event was recorded, 0 if the ring was full
+ */
+uint32_t EventRecord2(uint32_t id, uint32_t val1, uint32_t val2);
+
+/** Record an event with four 32-bit arguments
+ *
+ *  @param id   event ID
+ *  @param val1 first argument
+ *  @param val2 second argument
+ *  @param val3 third argument
+ *  @param val4 fourth argument
+ *  @return     1 if the event was recorded, 0 if the ring was full
+ */
+uint32_t EventRecord4(uint32_t id, uint32_t val1, uint32_t val2, uint32_t val3, uint32_t val4);
+
+/** Record an event with a data block, only the first 12 bytes are kept
+ *
+ *  @param id   event ID
+ *  @param data data block
+ *  @param len  length of the data block in bytes
+ *  @return     1 if the event was recorded, 0 if the ring was full
+ */
+uint32_t EventRecordData(uint32_t id, const void *data, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBED_EVENT_RECORDER_H */
@@ -0,0 +1,70 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include "mbed_idle_governor.h"
+
+/* Weight of a new latency measurement in the average, as a power of 2 */
+#define LATENCY_SHIFT   3
+
+void mbed_idle_governor_init(mbed_idle_governor_t *gov, uint32_t sleep_min_us,
+                             uint32_t deep_sleep_min_us, uint32_t deep_latency_us)
+{
+    memset(gov, 0, sizeof(*gov));
+    gov->sleep_min_us = sleep_min_us;
+    gov->deep_sleep_min_us = deep_sleep_min_us;
+    gov->latency[MBED_IDLE_DEEP_SLEEP] = deep_latency_us;
+}
+
+mbed_idle_mode_t mbed_idle_governor_select(mbed_idle_governor_t *gov, uint32_t idle_us, bool deep_sleep_allowed)
+{
+    mbed_idle_mode_t mode = MBED_IDLE_WFI;
+    uint32_t deep_sleep_us = gov->latency[MBED_IDLE_DEEP_SLEEP] + gov->deep_sleep_min_us;
+
+    if (idle_us >= deep_sleep_us && deep_sleep_allowed) {
+        mode = MBED_IDLE_DEEP_SLEEP;
+    } else {
+        if (idle_us >= deep_sleep_us) {
+            gov->denied_count++;
+        }
+        if (idle_us >= gov->sleep_min_us) {
+            mode = MBED_IDLE_SLEEP;
+        }
+    }
+
+    gov->count[mode]++;
+    return mode;
+}
+
+uint32_t mbed_idle_governor_advance(const mbed_idle_governor_t *gov, mbed_idle_mode_t mode)
+{
+    return gov->latency[mode];
+}
+
+void mbed_idle_governor_wake(mbed_idle_governor_t *gov, mbed_idle_mode_t mode, int32_t late)
+{
+    if (late < 0) {
+        // Woken by an interrupt, which says nothing about the latency
+        if (mode != MBED_IDLE_WFI) {
+            gov->early_wake_count++;
+        }
+        return;
+    }
+
+    int32_t latency = (int32_t)gov->latency[mode];
+    latency += (late - latency) / (1 << LATENCY_SHIFT);
+    gov->latency[mode] = (uint32_t)latency;
+}
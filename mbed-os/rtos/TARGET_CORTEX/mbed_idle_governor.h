@@ -0,0 +1,113 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_IDLE_GOVERNOR_H
+#define MBED_IDLE_GOVERNOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Shortest predicted idle time, in microseconds, for which the governor uses sleep rather than WFI */
+#ifndef MBED_CONF_RTOS_IDLE_SLEEP_MIN_US
+#define MBED_CONF_RTOS_IDLE_SLEEP_MIN_US            100
+#endif
+
+/** Shortest time, in microseconds, that must be left in deep sleep once the wake-up latency is paid */
+#ifndef MBED_CONF_RTOS_IDLE_DEEP_SLEEP_MIN_US
+#define MBED_CONF_RTOS_IDLE_DEEP_SLEEP_MIN_US       2000
+#endif
+
+/** Deep sleep wake-up latency, in microseconds, assumed until it has been measured */
+#ifndef MBED_CONF_RTOS_IDLE_DEEP_SLEEP_LATENCY_US
+#define MBED_CONF_RTOS_IDLE_DEEP_SLEEP_LATENCY_US   1000
+#endif
+
+/** Low power modes chosen by the idle governor */
+typedef enum {
+    MBED_IDLE_WFI = 0,          /**< Wait for interrupt, without the sleep manager */
+    MBED_IDLE_SLEEP,            /**< Sleep with deep sleep locked */
+    MBED_IDLE_DEEP_SLEEP,       /**< Deep sleep */
+    MBED_IDLE_MODES
+} mbed_idle_mode_t;
+
+/**
+ * State of the idle governor.
+ *
+ * The governor chooses the low power mode of each idle period from the time
+ * left until the next wake-up, which is the earliest of the next RTX delay or
+ * timer and the next ticker event. Deep sleep is only used when the time left
+ * covers its measured wake-up latency plus a minimum residency; a mode's
+ * latency is measured as the time between the scheduled wake-up and the
+ * moment the idle loop runs again.
+ */
+typedef struct {
+    uint32_t sleep_min_us;                  /**< Shortest idle time put in sleep */
+    uint32_t deep_sleep_min_us;             /**< Shortest residency in deep sleep after the latency */
+    uint32_t latency[MBED_IDLE_MODES];      /**< Average wake-up latency of each mode, in microseconds */
+    uint32_t count[MBED_IDLE_MODES];        /**< Number of idle periods spent in each mode */
+    uint32_t early_wake_count;              /**< Sleeps and deep sleeps ended by an interrupt before the wake-up */
+    uint32_t denied_count;                  /**< Deep sleeps chosen but prevented by a deep sleep lock */
+} mbed_idle_governor_t;
+
+/**
+ * Initialize the idle governor.
+ *
+ * @param gov                governor state.
+ * @param sleep_min_us       shortest predicted idle time, in microseconds, put in sleep rather than WFI.
+ * @param deep_sleep_min_us  shortest time, in microseconds, to be left in deep sleep after the latency.
+ * @param deep_latency_us    deep sleep wake-up latency, in microseconds, until it is measured.
+ */
+void mbed_idle_governor_init(mbed_idle_governor_t *gov, uint32_t sleep_min_us,
+                             uint32_t deep_sleep_min_us, uint32_t deep_latency_us);
+
+/**
+ * Choose the low power mode of an idle period.
+ *
+ * @param gov                governor state.
+ * @param idle_us            time until the next scheduled wake-up, in microseconds.
+ * @param deep_sleep_allowed false if a deep sleep lock is held.
+ * @return the mode to use.
+ */
+mbed_idle_mode_t mbed_idle_governor_select(mbed_idle_governor_t *gov, uint32_t idle_us, bool deep_sleep_allowed);
+
+/**
+ * Get how early to schedule the wake-up so that the mode's latency does not
+ * delay the next deadline.
+ *
+ * @param gov   governor state.
+ * @param mode  mode chosen by mbed_idle_governor_select.
+ * @return time to take off the wake-up, in microseconds.
+ */
+uint32_t mbed_idle_governor_advance(const mbed_idle_governor_t *gov, mbed_idle_mode_t mode);
+
+/**
+ * Report the end of an idle period.
+ *
+ * @param gov    governor state.
+ * @param mode   mode used.
+ * @param late   time between the scheduled wake-up and the return to the idle loop, in
+ *               microseconds; negative if an interrupt ended the idle period early.
+ */
+void mbed_idle_governor_wake(mbed_idle_governor_t *gov, mbed_idle_mode_t mode, int32_t late);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBED_IDLE_GOVERNOR_H */
@@ -49,6 +49,29 @@
 
 #define OS_DYNAMIC_MEM_SIZE         0
 
+/** Constant time TLSF allocator for the RTX memory pools, see rtx_memory_tlsf.c */
+#if defined(MBED_CONF_RTOS_TLSF_MEMORY_ALLOCATOR) && MBED_CONF_RTOS_TLSF_MEMORY_ALLOCATOR
+#define OS_MEMORY_TLSF              1
+#endif
+
+/** Constant time insertion into the RTX ready list, see rtx_thread_ready.c */
+#if defined(MBED_CONF_RTOS_PRIORITY_BITMAP_READY_LIST) && MBED_CONF_RTOS_PRIORITY_BITMAP_READY_LIST
+#define OS_THREAD_READY_BITMAP      1
+#endif
+
+/** Constant time insertion into RTX message queues, see MessageQueuePut in rtx_msgqueue.c */
+#if defined(MBED_CONF_RTOS_MSGQUEUE_PRIORITY_BUCKETS)
+#define OS_MSGQUEUE_PRIO_BUCKETS    MBED_CONF_RTOS_MSGQUEUE_PRIORITY_BUCKETS
+#endif
+#if defined(MBED_CONF_RTOS_MSGQUEUE_PRIORITY_QUEUES)
+#define OS_MSGQUEUE_PRIO_NUM        MBED_CONF_RTOS_MSGQUEUE_PRIORITY_QUEUES
+#endif
+
+/** Record the RTX events in a RAM ring through the Event Recorder API, see mbed_rtx_evr_ring.c */
+#if defined(MBED_CONF_RTOS_EVENT_RECORDER_RING_SIZE) && (MBED_CONF_RTOS_EVENT_RECORDER_RING_SIZE > 0)
+#define RTE_Compiler_EventRecorder
+#endif
+
 #if defined(OS_TICK_FREQ) && (OS_TICK_FREQ != 1000)
 #error "OS Tickrate must be 1000 for system timing"
 #endif
@@ -61,6 +84,11 @@
 #define OS_STACK_WATERMARK          1
 #endif
 
+/** Per thread run time for mbed_stats_thread_get_each, kept outside of the thread control block, see rtx_thread_cpu.c */
+#if !defined(OS_THREAD_CPU_TIME) && (defined(MBED_THREAD_STATS_ENABLED) || defined(MBED_ALL_STATS_ENABLED))
+#define OS_THREAD_CPU_TIME          1
+#endif
+
 /* Run threads unprivileged when uVisor is enabled. */
 #if defined(FEATURE_UVISOR) && defined(TARGET_UVISOR_SUPPORTED)
 # define OS_PRIVILEGE_MODE           0
@@ -0,0 +1,174 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "cmsis.h"
+#include "rtx_lib.h"
+#include "mbed_rtx_conf.h"
+#include "EventRecorder.h"
+#include "platform/mbed_assert.h"
+#include "platform/mbed_critical.h"
+#include "hal/us_ticker_api.h"
+
+#if MBED_CONF_RTOS_EVENT_RECORDER_RING_SIZE > 0
+
+MBED_STATIC_ASSERT((MBED_CONF_RTOS_EVENT_RECORDER_RING_SIZE & (MBED_CONF_RTOS_EVENT_RECORDER_RING_SIZE - 1)) == 0,
+                   "rtos.event-recorder-ring-size must be a power of 2");
+
+// Used from rtx_evr.c
+#define EvtRtxThreadCreated     EventID(EventLevelOp, 0xF2U, 0x03U)
+
+/* The hooks run in threads, in the SVC handler and in interrupts at any
+ * priority, so several writers may be active at once. A writer reserves a
+ * slot by moving 'ring_head' forward with a compare and swap, fills it and
+ * writes the non-zero 'id' last to publish it. The reader only consumes a slot
+ * whose 'id' is set, clears it and then moves 'ring_tail', so a slot is always
+ * empty again before a writer can reserve it on the next lap. */
+#define RING_MASK (MBED_CONF_RTOS_EVENT_RECORDER_RING_SIZE - 1)
+static mbed_rtx_evr_record_t ring[MBED_CONF_RTOS_EVENT_RECORDER_RING_SIZE];
+static volatile uint32_t ring_head;
+static volatile uint32_t ring_tail;
+static volatile uint32_t ring_dropped;
+
+static uint32_t ring_put(uint32_t id, uint32_t val1, uint32_t val2, uint32_t val3, uint32_t val4)
+{
+    uint32_t head = ring_head;
+
+    do {
+        if ((head - ring_tail) >= MBED_CONF_RTOS_EVENT_RECORDER_RING_SIZE) {
+            core_util_atomic_incr_u32(&ring_dropped, 1);
+            return 0;
+        }
+    } while (!core_util_atomic_cas_u32(&ring_head, &head, head + 1));
+
+    mbed_rtx_evr_record_t *record = &ring[head & RING_MASK];
+    record->timestamp = us_ticker_read();
+    record->val[0] = val1;
+    record->val[1] = val2;
+    record->val[2] = val3;
+    record->val[3] = val4;
+
+    // Publish the record only once it is complete
+    __DMB();
+    record->id = id;
+
+    return 1;
+}
+
+static uint32_t ring_put_name(osRtxThread_t *thread)
+{
+    uint32_t name[3] = { 0 };
+
+    if (thread->name != NULL) {
+        strncpy((char *)name, thread->name, sizeof(name));
+    }
+
+    return ring_put(MBED_RTX_EVR_RING_THREAD_NAME, (uint32_t)thread, name[0], name[1], name[2]);
+}
+
+uint32_t EventRecord2(uint32_t id, uint32_t val1, uint32_t val2)
+{
+    uint32_t ret = ring_put(id, val1, val2, 0, 0);
+
+    // The thread name is not part of the RTX event, record it separately for the host tools
+    if (id == EvtRtxThreadCreated) {
+        ret &= ring_put_name((osRtxThread_t *)val1);
+    }
+
+    return ret;
+}
+
+uint32_t EventRecord4(uint32_t id, uint32_t val1, uint32_t val2, uint32_t val3, uint32_t val4)
+{
+    return ring_put(id, val1, val2, val3, val4);
+}
+
+uint32_t EventRecordData(uint32_t id, const void *data, uint32_t len)
+{
+    uint32_t val[3] = { 0 };
+
+    memcpy(val, data, (len < sizeof(val)) ? len : sizeof(val));
+
+    return ring_put(id, len, val[0], val[1], val[2]);
+}
+
+size_t mbed_rtx_evr_ring_read(mbed_rtx_evr_record_t *records, size_t count)
+{
+    uint32_t tail = ring_tail;
+    size_t n = 0;
+
+    while ((n < count) && (tail != ring_head)) {
+        mbed_rtx_evr_record_t *record = &ring[tail & RING_MASK];
+
+        // Reserved but not published yet, the writer was preempted
+        if (record->id == 0) {
+            break;
+        }
+        __DMB();
+        records[n++] = *record;
+        record->id = 0;
+        tail++;
+    }
+    __DMB();
+    ring_tail = tail;
+
+    return n;
+}
+
+uint32_t mbed_rtx_evr_ring_dropped(void)
+{
+    return ring_dropped;
+}
+
+void mbed_rtx_evr_ring_name_threads(void)
+{
+    uint32_t thread_n = osThreadGetCount();
+    osThreadId_t *threads;
+
+    threads = malloc(sizeof(osThreadId_t) * thread_n);
+    MBED_ASSERT(threads != NULL);
+
+    osKernelLock();
+    thread_n = osThreadEnumerate(threads, thread_n);
+
+    for (uint32_t i = 0; i < thread_n; i++) {
+        ring_put_name((osRtxThread_t *)threads[i]);
+    }
+    osKernelUnlock();
+
+    free(threads);
+}
+
+#else
+
+size_t mbed_rtx_evr_ring_read(mbed_rtx_evr_record_t *records, size_t count)
+{
+    (void)records;
+    (void)count;
+    return 0;
+}
+
+uint32_t mbed_rtx_evr_ring_dropped(void)
+{
+    return 0;
+}
+
+void mbed_rtx_evr_ring_name_threads(void)
+{
+}
+
+#endif
@@ -0,0 +1,91 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_RTX_EVR_RING_H
+#define MBED_RTX_EVR_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \addtogroup rtos */
+/** @{*/
+
+/** Number of records held by the RTX event ring, must be a power of 2. 0 disables the ring. */
+#ifndef MBED_CONF_RTOS_EVENT_RECORDER_RING_SIZE
+#define MBED_CONF_RTOS_EVENT_RECORDER_RING_SIZE  0
+#endif
+
+/** Component number of the records generated by the ring itself */
+#define MBED_RTX_EVR_RING_COMPONENT     0xEFU
+
+/** Thread name record: val[0] is the thread ID, val[1..3] the first 12 characters of its name */
+#define MBED_RTX_EVR_RING_THREAD_NAME   ((MBED_RTX_EVR_RING_COMPONENT << 8) | 0x00U)
+
+/**
+ * Record stored in the RTX event ring.
+ *
+ * 'id' uses the Event Recorder encoding: level in bits 17:16, component number
+ * in bits 15:8 and message number in bits 7:0, so the RTX events keep the
+ * numbers listed in rtx_evr.c. All the fields are 32-bit wide so that a dump
+ * of the ring can be decoded on the host with this same definition.
+ *
+ * Data records (EventRecordData) keep their length in val[0] and the first
+ * 12 bytes of the data in val[1..3].
+ */
+typedef struct {
+    uint32_t timestamp;     /**< Time of the event in microseconds, from the us ticker */
+    uint32_t id;            /**< Event ID, never 0 for a valid record */
+    uint32_t val[4];        /**< Event arguments, unused ones are 0 */
+} mbed_rtx_evr_record_t;
+
+/**
+ * Move records out of the RTX event ring, oldest first.
+ *
+ * The RTX event hooks add records from any context, including interrupts,
+ * without locking. Only one context may read the ring at a time.
+ *
+ * @param records array to fill.
+ * @param count number of records the array can hold.
+ * @return number of records copied to the array.
+ */
+size_t mbed_rtx_evr_ring_read(mbed_rtx_evr_record_t *records, size_t count);
+
+/**
+ * Get the number of records dropped because the RTX event ring was full.
+ *
+ * @return number of records dropped since boot.
+ */
+uint32_t mbed_rtx_evr_ring_dropped(void);
+
+/**
+ * Add a thread name record for every existing thread.
+ *
+ * Names are recorded automatically when threads are created; call this when
+ * the records of the thread creations may have been dropped or discarded, for
+ * instance before starting a new capture.
+ */
+void mbed_rtx_evr_ring_name_threads(void);
+
+/** @}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MBED_RTX_EVR_RING_H */
@@ -21,16 +21,21 @@
 #include "mbed_error.h"
 #include "mbed_interface.h"
 #include "RTX_Config.h"
+#include "us_ticker_api.h"
+#include "mbed_rtx_thread_cpu.h"
 
 #ifdef RTE_Compiler_EventRecorder
 #include "EventRecorder.h"              // Keil::Compiler:Event Recorder
 // Used from rtx_evr.c
-#define EvtRtxThreadExit               EventID(EventLevelAPI, 0xF2U, 0x19U)
-#define EvtRtxThreadTerminate          EventID(EventLevelAPI, 0xF2U, 0x1AU)
+#define EvtRtxThreadExit               EventID(EventLevelAPI, 0xF2U, 0x1AU)
+#define EvtRtxThreadTerminate          EventID(EventLevelAPI, 0xF2U, 0x1BU)
 #endif
 
 extern void rtos_idle_loop(void);
 extern void thread_terminate_hook(osThreadId_t id);
+#if (OS_THREAD_CPU_TIME != 0)
+extern uint32_t osRtxThreadCpuTimeGet(const osRtxThread_t *thread, uint64_t *cpu_time, uint32_t *switch_count);
+#endif
 
 __NO_RETURN void osRtxIdleThread (void *argument)
 {
@@ -75,6 +80,26 @@ __NO_RETURN uint32_t osRtxErrorNotify (uint32_t code, void *object_id)
     for (;;) {}
 }
 
+#if (OS_THREAD_CPU_TIME != 0)
+// Time stamps of the thread run time accounting, called at every thread switch
+uint32_t osRtxThreadCpuTimeStamp (void)
+{
+    return us_ticker_read();
+}
+#endif
+
+bool mbed_rtx_thread_cpu_get(osThreadId_t thread_id, uint64_t *cpu_time, uint32_t *switch_count)
+{
+#if (OS_THREAD_CPU_TIME != 0)
+    return osRtxThreadCpuTimeGet((const osRtxThread_t *)thread_id, cpu_time, switch_count) != 0U;
+#else
+    (void)thread_id;
+    *cpu_time = 0;
+    *switch_count = 0;
+    return false;
+#endif
+}
+
 #if defined(MBED_TRAP_ERRORS_ENABLED) && MBED_TRAP_ERRORS_ENABLED
 
 static const char* error_msg(int32_t status)
@@ -22,11 +22,15 @@
 
 #include "rtos/rtos_idle.h"
 #include "platform/mbed_power_mgmt.h"
+#include "platform/mbed_stats.h"
 #include "TimerEvent.h"
 #include "lp_ticker_api.h"
+#include "us_ticker_api.h"
+#include "mbed_idle_governor.h"
 #include "mbed_critical.h"
 #include "mbed_assert.h"
 #include <new>
+#include <string.h>
 #include "rtx_os.h"
 extern "C" {
 #include "rtx_lib.h"
@@ -87,6 +91,97 @@ uint32_t OS_Tick_GetInterval (void) {
   return 1000;
 }
 
+#if MBED_CONF_RTOS_IDLE_GOVERNOR
+
+static mbed_idle_governor_t idle_governor;
+static bool idle_governor_initialized;
+
+// Time until the next event of a ticker, if it has one before 'limit'
+static uint32_t time_to_next_event(const ticker_data_t *ticker, uint32_t limit)
+{
+    timestamp_t next;
+
+    if (!ticker_get_next_timestamp(ticker, &next)) {
+        return limit;
+    }
+    int32_t delta = (int32_t)(next - (timestamp_t)ticker_read_us(ticker));
+    if (delta <= 0) {
+        return 0;
+    }
+    return ((uint32_t)delta < limit) ? (uint32_t)delta : limit;
+}
+
+static void default_idle_hook(void)
+{
+    const ticker_data_t *lp_ticker = get_lp_ticker_data();
+
+    if (!idle_governor_initialized) {
+        mbed_idle_governor_init(&idle_governor, MBED_CONF_RTOS_IDLE_SLEEP_MIN_US,
+                                MBED_CONF_RTOS_IDLE_DEEP_SLEEP_MIN_US, MBED_CONF_RTOS_IDLE_DEEP_SLEEP_LATENCY_US);
+        idle_governor_initialized = true;
+    }
+
+    // The next wake-up is the next RTX delay or timer, or an earlier event of one of the tickers
+    uint32_t ticks_to_sleep = osKernelSuspend();
+    uint32_t idle_us = (ticks_to_sleep < (UINT32_MAX / 1000)) ? ticks_to_sleep * 1000 : UINT32_MAX;
+    idle_us = time_to_next_event(lp_ticker, idle_us);
+    idle_us = time_to_next_event(get_us_ticker_data(), idle_us);
+
+    // Wake up ahead of the RTX deadline by the latency of the mode expected
+    mbed_idle_mode_t mode = mbed_idle_governor_select(&idle_governor, idle_us, sleep_manager_can_deep_sleep());
+    uint32_t advance_ticks = (mbed_idle_governor_advance(&idle_governor, mode) + 500) / 1000;
+    if (ticks_to_sleep > advance_ticks + 1) {
+        ticks_to_sleep -= advance_ticks;
+    }
+    os_timer->suspend(ticks_to_sleep);
+
+    timestamp_t wake_time = 0;
+    bool have_wake_time = ticker_get_next_timestamp(lp_ticker, &wake_time);
+
+    bool event_pending = false;
+    bool first = true;
+    while (!os_timer->suspend_time_passed() && !event_pending) {
+
+        core_util_critical_section_enter();
+        if (osRtxInfo.kernel.pendSV) {
+            event_pending = true;
+        } else {
+            // After an early wake-up, choose again for the time left
+            if (!first) {
+                mode = mbed_idle_governor_select(&idle_governor, time_to_next_event(lp_ticker, idle_us),
+                                                 sleep_manager_can_deep_sleep());
+            }
+            first = false;
+
+            switch (mode) {
+                case MBED_IDLE_WFI:
+                    __WFI();
+                    break;
+                case MBED_IDLE_SLEEP:
+                    sleep_manager_lock_deep_sleep_internal();
+                    sleep();
+                    sleep_manager_unlock_deep_sleep_internal();
+                    break;
+                default:
+                    sleep();
+                    break;
+            }
+
+            if (have_wake_time) {
+                int32_t late = (int32_t)((timestamp_t)ticker_read_us(lp_ticker) - wake_time);
+                mbed_idle_governor_wake(&idle_governor, mode, late);
+            }
+        }
+        core_util_critical_section_exit();
+
+        // Ensure interrupts get a chance to fire
+        __ISB();
+    }
+    osKernelResume(os_timer->resume());
+}
+
+#else
+
 static void default_idle_hook(void)
 {
     uint32_t ticks_to_sleep = osKernelSuspend();
@@ -109,6 +204,8 @@ static void default_idle_hook(void)
     osKernelResume(os_timer->resume());
 }
 
+#endif // MBED_CONF_RTOS_IDLE_GOVERNOR
+
 #elif defined(FEATURE_UVISOR)
 
 static void default_idle_hook(void)
@@ -131,6 +228,35 @@ static void default_idle_hook(void)
 
 #endif // (defined(MBED_TICKLESS) && defined(DEVICE_LPTICKER))
 
+#if defined(MBED_TICKLESS) && defined(DEVICE_LPTICKER) && MBED_CONF_RTOS_IDLE_GOVERNOR
+
+void mbed_stats_idle_get(mbed_stats_idle_t *stats)
+{
+    MBED_ASSERT(stats != NULL);
+    memset(stats, 0, sizeof(mbed_stats_idle_t));
+#if defined(MBED_CPU_STATS_ENABLED)
+    core_util_critical_section_enter();
+    stats->wfi_count = idle_governor.count[MBED_IDLE_WFI];
+    stats->sleep_count = idle_governor.count[MBED_IDLE_SLEEP];
+    stats->deep_sleep_count = idle_governor.count[MBED_IDLE_DEEP_SLEEP];
+    stats->deep_sleep_denied = idle_governor.denied_count;
+    stats->early_wake_count = idle_governor.early_wake_count;
+    stats->sleep_latency = idle_governor.latency[MBED_IDLE_SLEEP];
+    stats->deep_sleep_latency = idle_governor.latency[MBED_IDLE_DEEP_SLEEP];
+    core_util_critical_section_exit();
+#endif
+}
+
+#else
+
+void mbed_stats_idle_get(mbed_stats_idle_t *stats)
+{
+    MBED_ASSERT(stats != NULL);
+    memset(stats, 0, sizeof(mbed_stats_idle_t));
+}
+
+#endif
+
 static void (*idle_hook_fptr)(void) = &default_idle_hook;
 
 void rtos_attach_idle_hook(void (*fptr)(void))
@@ -0,0 +1,49 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_RTX_THREAD_CPU_H
+#define MBED_RTX_THREAD_CPU_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cmsis_os2.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Get the run time and the switch count of a thread.
+ *
+ * The counters are accumulated by RTX at every thread switch when
+ * OS_THREAD_CPU_TIME is enabled, which MBED_THREAD_STATS_ENABLED does. They
+ * are kept outside of the thread control block, so enabling them does not
+ * change the size of osRtxThread_t or mbed_rtos_storage_thread_t.
+ *
+ * @note Must be called with the kernel locked, e.g. inside osKernelLock().
+ *
+ * @param thread_id    Thread to read
+ * @param cpu_time     Time the thread has been running, in microseconds
+ * @param switch_count Number of times the thread has been switched in
+ * @return true if the thread is accounted, false with zeros otherwise
+ */
+bool mbed_rtx_thread_cpu_get(osThreadId_t thread_id, uint64_t *cpu_time, uint32_t *switch_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
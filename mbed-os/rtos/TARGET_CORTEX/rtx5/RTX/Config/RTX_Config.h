@@ -223,6 +223,30 @@
 #define OS_PRIVILEGE_MODE           1
 #endif
  
+//   <q>Priority indexed Ready list
+//   <i> Index the Ready list by priority with a bitmap so that a thread is made ready in constant time.
+//   <i> Enabling this option increases the RAM usage by 264 bytes.
+#ifndef OS_THREAD_READY_BITMAP
+#define OS_THREAD_READY_BITMAP      0
+#endif
+ 
+//   <q>Thread run time accounting
+//   <i> Accumulate the run time and the number of switches of each thread at thread switch.
+//   <i> Time stamps in microseconds are provided by the function osRtxThreadCpuTimeStamp.
+//   <i> The totals are kept outside of the thread control block, which keeps its size.
+//   <i> Enabling this option increases slightly the execution time of a thread switch.
+#ifndef OS_THREAD_CPU_TIME
+#define OS_THREAD_CPU_TIME          0
+#endif
+ 
+//   <o>Number of accounted threads <1-1000>
+//   <i> Defines the number of threads whose run time is accumulated at a time.
+//   <i> Threads created while all are accounted are not accounted.
+//   <i> Each thread takes 16 bytes of RAM.
+#ifndef OS_THREAD_CPU_TIME_NUM
+#define OS_THREAD_CPU_TIME_NUM      16
+#endif
+ 
 // </h>
  
 // <h>Timer Configuration
@@ -394,6 +418,23 @@
  
 //   </e>
  
+//   <o>Number of Message Priority Buckets <0-32>
+//   <i> Defines the number of message priorities indexed by each queue, from priority 0.
+//   <i> A message of an indexed priority is queued in constant time; higher priorities share the last bucket.
+//   <i> The index is kept outside of the Message Queue control block, which keeps its size.
+//   <i> Default: 0 (messages are queued by scanning from the tail of the queue)
+#ifndef OS_MSGQUEUE_PRIO_BUCKETS
+#define OS_MSGQUEUE_PRIO_BUCKETS    0
+#endif
+ 
+//   <o>Number of indexed Message Queues <1-1000>
+//   <i> Defines the number of Message Queues indexed by priority at a time.
+//   <i> Queues created while all are indexed are not indexed.
+//   <i> Each queue takes 8 bytes of RAM plus 4 bytes per Priority Bucket.
+#ifndef OS_MSGQUEUE_PRIO_NUM
+#define OS_MSGQUEUE_PRIO_NUM        4
+#endif
+ 
 // </h>
  
 // Number of Threads which use standard C/C++ library libspace
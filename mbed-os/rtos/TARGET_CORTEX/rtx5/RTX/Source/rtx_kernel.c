@@ -104,6 +104,9 @@ static osStatus_t svcRtxKernelInitialize (void) {
 
   // Initialize osRtxInfo
   memset(&osRtxInfo.kernel, 0, sizeof(osRtxInfo) - offsetof(osRtxInfo_t, kernel));
+#if (OS_THREAD_READY_BITMAP != 0)
+  osRtxThreadReadyInit();
+#endif
 
   osRtxInfo.isr_queue.data = osRtxConfig.isr_queue.data;
   osRtxInfo.isr_queue.max  = osRtxConfig.isr_queue.max;
@@ -187,6 +187,20 @@ extern void         osRtxThreadWaitExit   (os_thread_t *thread, uint32_t ret_val
 extern bool_t       osRtxThreadWaitEnter  (uint8_t state, uint32_t timeout);
 extern void         osRtxThreadStackCheck (void);
 extern bool_t       osRtxThreadStartup    (void);
+#if (OS_THREAD_READY_BITMAP != 0)
+extern void         osRtxThreadReadyInit  (void);
+extern void         osRtxThreadReadyInsert(os_thread_t *thread, bool_t head);
+extern os_thread_t *osRtxThreadReadyGet   (void);
+extern void         osRtxThreadReadyRemove(os_thread_t *thread);
+extern void         osRtxThreadReadySort  (os_thread_t *thread);
+#endif
+#if (OS_THREAD_CPU_TIME != 0)
+extern uint32_t     osRtxThreadCpuTimeStamp (void);
+extern void         osRtxThreadCpuTimeNew   (const os_thread_t *thread);
+extern void         osRtxThreadCpuTimeFree  (const os_thread_t *thread);
+extern void         osRtxThreadCpuTimeSwitch(os_thread_t *thread);
+extern uint32_t     osRtxThreadCpuTimeGet   (const os_thread_t *thread, uint64_t *cpu_time, uint32_t *switch_count);
+#endif
 
 // Timer Library functions
 extern void osRtxTimerThread (void *argument);
@@ -0,0 +1,385 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Project:     CMSIS-RTOS RTX
+ * Title:       Memory functions (Two-Level Segregated Fit)
+ *
+ * -----------------------------------------------------------------------------
+ */
+
+#include "rtx_lib.h"
+
+#ifndef OS_MEMORY_TLSF
+#define OS_MEMORY_TLSF              0
+#endif
+
+#if (OS_MEMORY_TLSF != 0)
+
+// Free blocks are kept in segregated lists indexed by a first level (power of
+// two) and a second level (linear subdivision of the power of two). Two levels
+// of bitmaps locate a non-empty list of large enough blocks with a couple of
+// bit scans, so allocation and release run in constant time regardless of the
+// number of live blocks. Physical neighbours are linked for immediate merging.
+
+#define MEM_ALIGN_LOG2          3U                          // 8-byte alignment
+#define MEM_SL_LOG2             3U                          // 8 second level lists
+#define MEM_SL_COUNT            (1U << MEM_SL_LOG2)
+#define MEM_FL_SHIFT            (MEM_SL_LOG2 + MEM_ALIGN_LOG2)
+#define MEM_SMALL_SIZE          (1U << MEM_FL_SHIFT)        // Sizes below share first level 0
+#define MEM_FL_MAX              24U                         // Largest block: 2^(MEM_FL_MAX+1)-8
+#define MEM_FL_COUNT            (MEM_FL_MAX - MEM_FL_SHIFT + 2U)
+
+//  Memory Block Header structure
+typedef struct mem_tlsf_block_s {
+  struct mem_tlsf_block_s *prev_phys;   // Previous physical block (NULL for first block)
+  uint32_t                 info;        // Block Info
+} mem_tlsf_block_t;
+
+//  Free Memory Block links (stored in the block payload)
+typedef struct {
+  mem_tlsf_block_t        *next;        // Next free block in list
+  mem_tlsf_block_t        *prev;        // Previous free block in list
+} mem_tlsf_link_t;
+
+//  Memory Pool Header structure
+typedef struct {
+  uint32_t          size;                               // Memory Pool size
+  uint32_t          used;                               // Used Memory
+  uint32_t          max_used;                           // Max used Memory
+  uint32_t          fl_bitmap;                          // Non-empty first level lists
+  uint8_t           sl_bitmap[MEM_FL_COUNT];            // Non-empty second level lists
+  mem_tlsf_block_t *free[MEM_FL_COUNT][MEM_SL_COUNT];   // Free lists
+} mem_tlsf_head_t;
+
+//  Memory Block Info: Length = <31:3>:'000', Free = <2>, Type = <1:0>
+#define MB_INFO_LEN_MASK        0xFFFFFFF8U     // Length mask
+#define MB_INFO_FREE            0x00000004U     // Free flag
+#define MB_INFO_TYPE_MASK       0x00000003U     // Type mask
+
+#define MEM_HEAD_SIZE           (((uint32_t)sizeof(mem_tlsf_head_t)  + 7U) & ~7U)
+#define MEM_BLOCK_HEAD_SIZE     (((uint32_t)sizeof(mem_tlsf_block_t) + 7U) & ~7U)
+#define MEM_BLOCK_MIN_SIZE      (MEM_BLOCK_HEAD_SIZE + (((uint32_t)sizeof(mem_tlsf_link_t) + 7U) & ~7U))
+
+//  Memory Head Pointer
+__STATIC_INLINE mem_tlsf_head_t *MemHeadPtr (void *mem) {
+  //lint -e{9079} -e{9087} "conversion from pointer to void to pointer to other type" [MISRA Note 6]
+  return ((mem_tlsf_head_t *)mem);
+}
+
+//  Memory Block Pointer
+__STATIC_INLINE mem_tlsf_block_t *MemBlockPtr (void *mem, uint32_t offset) {
+  uint32_t          addr;
+  mem_tlsf_block_t *ptr;
+
+  //lint --e{923} --e{9078} "cast between pointer and unsigned int" [MISRA Note 8]
+  addr = (uint32_t)mem + offset;
+  ptr  = (mem_tlsf_block_t *)addr;
+
+  return ptr;
+}
+
+//  Free Memory Block links
+__STATIC_INLINE mem_tlsf_link_t *MemLinkPtr (mem_tlsf_block_t *block) {
+  //lint -e{9079} -e{9087} "conversion from pointer to void to pointer to other type" [MISRA Note 6]
+  return ((mem_tlsf_link_t *)(void *)MemBlockPtr(block, MEM_BLOCK_HEAD_SIZE));
+}
+
+//  Next physical Memory Block
+__STATIC_INLINE mem_tlsf_block_t *MemBlockNext (mem_tlsf_block_t *block) {
+  return MemBlockPtr(block, block->info & MB_INFO_LEN_MASK);
+}
+
+//  Index of most significant bit set (value must not be 0)
+__STATIC_INLINE uint32_t MemFls (uint32_t value) {
+  return (31U - (uint32_t)__CLZ(value));
+}
+
+//  Index of least significant bit set (value must not be 0)
+__STATIC_INLINE uint32_t MemFfs (uint32_t value) {
+  return MemFls(value & (0U - value));
+}
+
+//  Map block size to list indexes
+static void MemMapping (uint32_t size, uint32_t *fl, uint32_t *sl) {
+  uint32_t n;
+
+  if (size < MEM_SMALL_SIZE) {
+    *fl = 0U;
+    *sl = size >> MEM_ALIGN_LOG2;
+  } else {
+    n   = MemFls(size);
+    *sl = (size >> (n - MEM_SL_LOG2)) ^ MEM_SL_COUNT;
+    *fl = n - (MEM_FL_SHIFT - 1U);
+  }
+}
+
+//  Insert block into free list
+static void MemFreeInsert (mem_tlsf_head_t *head, mem_tlsf_block_t *block) {
+  mem_tlsf_block_t *next;
+  uint32_t          fl, sl;
+
+  MemMapping(block->info & MB_INFO_LEN_MASK, &fl, &sl);
+
+  next = head->free[fl][sl];
+  MemLinkPtr(block)->next = next;
+  MemLinkPtr(block)->prev = NULL;
+  if (next != NULL) {
+    MemLinkPtr(next)->prev = block;
+  }
+  head->free[fl][sl] = block;
+  head->sl_bitmap[fl] |= (uint8_t)(1U << sl);
+  head->fl_bitmap     |= 1U << fl;
+}
+
+//  Remove block from free list
+static void MemFreeRemove (mem_tlsf_head_t *head, mem_tlsf_block_t *block) {
+  mem_tlsf_block_t *next = MemLinkPtr(block)->next;
+  mem_tlsf_block_t *prev = MemLinkPtr(block)->prev;
+  uint32_t          fl, sl;
+
+  if (next != NULL) {
+    MemLinkPtr(next)->prev = prev;
+  }
+  if (prev != NULL) {
+    MemLinkPtr(prev)->next = next;
+  } else {
+    MemMapping(block->info & MB_INFO_LEN_MASK, &fl, &sl);
+    head->free[fl][sl] = next;
+    if (next == NULL) {
+      head->sl_bitmap[fl] &= (uint8_t)~(1U << sl);
+      if (head->sl_bitmap[fl] == 0U) {
+        head->fl_bitmap &= ~(1U << fl);
+      }
+    }
+  }
+}
+
+//  Find a free block of at least the requested size
+static mem_tlsf_block_t *MemFreeFind (mem_tlsf_head_t *head, uint32_t size) {
+  uint32_t fl, sl;
+  uint32_t map;
+
+  // Round up to the next list so that any block in it is large enough
+  if (size >= MEM_SMALL_SIZE) {
+    size += (1U << (MemFls(size) - MEM_SL_LOG2)) - 1U;
+  }
+  MemMapping(size, &fl, &sl);
+  if (fl >= MEM_FL_COUNT) {
+    //lint -e{904} "Return statement before end of function" [MISRA Note 1]
+    return NULL;
+  }
+
+  map = (uint32_t)head->sl_bitmap[fl] & (~0U << sl);
+  if (map == 0U) {
+    if ((fl + 1U) >= MEM_FL_COUNT) {
+      //lint -e{904} "Return statement before end of function" [MISRA Note 1]
+      return NULL;
+    }
+    map = head->fl_bitmap & (~0U << (fl + 1U));
+    if (map == 0U) {
+      //lint -e{904} "Return statement before end of function" [MISRA Note 1]
+      return NULL;
+    }
+    fl  = MemFfs(map);
+    map = head->sl_bitmap[fl];
+  }
+  sl = MemFfs(map);
+
+  return head->free[fl][sl];
+}
+
+
+//  ==== Library functions ====
+
+/// Initialize Memory Pool with variable block size.
+/// \param[in]  mem             pointer to memory pool.
+/// \param[in]  size            size of a memory pool in bytes.
+/// \return 1 - success, 0 - failure.
+uint32_t osRtxMemoryInit (void *mem, uint32_t size) {
+  mem_tlsf_head_t  *head;
+  mem_tlsf_block_t *ptr;
+  uint32_t          fl, sl;
+
+  // Check parameters
+  //lint -e{923} "cast from pointer to unsigned int" [MISRA Note 7]
+  if ((mem == NULL) || (((uint32_t)mem & 7U) != 0U) || ((size & 7U) != 0U) ||
+      (size < (MEM_HEAD_SIZE + MEM_BLOCK_MIN_SIZE + MEM_BLOCK_HEAD_SIZE))) {
+    EvrRtxMemoryInit(mem, size, 0U);
+    //lint -e{904} "Return statement before end of function" [MISRA Note 1]
+    return 0U;
+  }
+
+  // Check that the initial free block can be indexed
+  MemMapping(size - MEM_HEAD_SIZE - MEM_BLOCK_HEAD_SIZE, &fl, &sl);
+  if (fl >= MEM_FL_COUNT) {
+    EvrRtxMemoryInit(mem, size, 0U);
+    //lint -e{904} "Return statement before end of function" [MISRA Note 1]
+    return 0U;
+  }
+
+  // Initialize memory pool header
+  head = MemHeadPtr(mem);
+  memset(head, 0, sizeof(mem_tlsf_head_t));
+  head->size     = size;
+  head->used     = MEM_HEAD_SIZE + MEM_BLOCK_HEAD_SIZE;
+  head->max_used = head->used;
+
+  // Initialize the free block spanning the pool and the last (sentinel) block
+  ptr = MemBlockPtr(mem, MEM_HEAD_SIZE);
+  ptr->prev_phys = NULL;
+  ptr->info      = (size - MEM_HEAD_SIZE - MEM_BLOCK_HEAD_SIZE) | MB_INFO_FREE;
+  MemBlockNext(ptr)->prev_phys = ptr;
+  MemBlockNext(ptr)->info      = 0U;
+  MemFreeInsert(head, ptr);
+
+  EvrRtxMemoryInit(mem, size, 1U);
+
+  return 1U;
+}
+
+/// Allocate a memory block from a Memory Pool.
+/// \param[in]  mem             pointer to memory pool.
+/// \param[in]  size            size of a memory block in bytes.
+/// \param[in]  type            memory block type: 0 - generic, 1 - control block
+/// \return allocated memory block or NULL in case of no memory is available.
+void *osRtxMemoryAlloc (void *mem, uint32_t size, uint32_t type) {
+  mem_tlsf_head_t  *head;
+  mem_tlsf_block_t *p, *p_new;
+  uint32_t          block_size;
+  uint32_t          hole_size;
+  void             *ptr;
+
+  // Check parameters
+  if ((mem == NULL) || (size == 0U) || ((type & ~MB_INFO_TYPE_MASK) != 0U) ||
+      (size > (MemHeadPtr(mem))->size)) {
+    EvrRtxMemoryAlloc(mem, size, type, NULL);
+    //lint -e{904} "Return statement before end of function" [MISRA Note 1]
+    return NULL;
+  }
+  head = MemHeadPtr(mem);
+
+  // Add block header to size
+  block_size = size + MEM_BLOCK_HEAD_SIZE;
+  // Make sure that block is 8-byte aligned
+  block_size = (block_size + 7U) & ~((uint32_t)7U);
+  // Make sure that the block can hold the free list links once released
+  if (block_size < MEM_BLOCK_MIN_SIZE) {
+    block_size = MEM_BLOCK_MIN_SIZE;
+  }
+
+  // Take a large enough block from the free lists
+  p = MemFreeFind(head, block_size);
+  if (p == NULL) {
+    EvrRtxMemoryAlloc(mem, size, type, NULL);
+    //lint -e{904} "Return statement before end of function" [MISRA Note 1]
+    return NULL;
+  }
+  MemFreeRemove(head, p);
+
+  // Split off the remainder if it can hold a block
+  hole_size = (p->info & MB_INFO_LEN_MASK) - block_size;
+  if (hole_size >= MEM_BLOCK_MIN_SIZE) {
+    p_new = MemBlockPtr(p, block_size);
+    p_new->prev_phys = p;
+    p_new->info      = hole_size | MB_INFO_FREE;
+    MemBlockNext(p_new)->prev_phys = p_new;
+    MemFreeInsert(head, p_new);
+  } else {
+    block_size = p->info & MB_INFO_LEN_MASK;
+  }
+  p->info = block_size | type;
+
+  // Update used memory
+  head->used += block_size;
+
+  // Update max used memory
+  if (head->max_used < head->used) {
+    head->max_used = head->used;
+  }
+
+  ptr = MemBlockPtr(p, MEM_BLOCK_HEAD_SIZE);
+
+  EvrRtxMemoryAlloc(mem, size, type, ptr);
+
+  return ptr;
+}
+
+/// Return an allocated memory block back to a Memory Pool.
+/// \param[in]  mem             pointer to memory pool.
+/// \param[in]  block           memory block to be returned to the memory pool.
+/// \return 1 - success, 0 - failure.
+uint32_t osRtxMemoryFree (void *mem, void *block) {
+  mem_tlsf_head_t  *head;
+  mem_tlsf_block_t *p, *p_next;
+  uint32_t          addr;
+
+  // Check parameters
+  if ((mem == NULL) || (block == NULL)) {
+    EvrRtxMemoryFree(mem, block, 0U);
+    //lint -e{904} "Return statement before end of function" [MISRA Note 1]
+    return 0U;
+  }
+  head = MemHeadPtr(mem);
+
+  // Check that the block lies in the pool and is allocated
+  //lint -e{923} "cast from pointer to unsigned int" [MISRA Note 7]
+  addr = (uint32_t)block;
+  //lint -e{923} "cast from pointer to unsigned int" [MISRA Note 7]
+  if (((addr & 7U) != 0U) ||
+      (addr < ((uint32_t)mem + MEM_HEAD_SIZE + MEM_BLOCK_HEAD_SIZE)) ||
+      (addr >= ((uint32_t)mem + head->size))) {
+    EvrRtxMemoryFree(mem, block, 0U);
+    //lint -e{904} "Return statement before end of function" [MISRA Note 1]
+    return 0U;
+  }
+  p = MemBlockPtr(block, 0U - MEM_BLOCK_HEAD_SIZE);
+  if (((p->info & MB_INFO_FREE) != 0U) || ((p->info & MB_INFO_LEN_MASK) == 0U) ||
+      (MemBlockNext(p)->prev_phys != p)) {
+    EvrRtxMemoryFree(mem, block, 0U);
+    //lint -e{904} "Return statement before end of function" [MISRA Note 1]
+    return 0U;
+  }
+
+  // Update used memory
+  head->used -= p->info & MB_INFO_LEN_MASK;
+  p->info = (p->info & MB_INFO_LEN_MASK) | MB_INFO_FREE;
+
+  // Merge with the previous physical block
+  if ((p->prev_phys != NULL) && ((p->prev_phys->info & MB_INFO_FREE) != 0U)) {
+    MemFreeRemove(head, p->prev_phys);
+    p->prev_phys->info += p->info & MB_INFO_LEN_MASK;
+    p = p->prev_phys;
+  }
+
+  // Merge with the next physical block
+  p_next = MemBlockNext(p);
+  if ((p_next->info & MB_INFO_FREE) != 0U) {
+    MemFreeRemove(head, p_next);
+    p->info += p_next->info & MB_INFO_LEN_MASK;
+  }
+
+  MemBlockNext(p)->prev_phys = p;
+  MemFreeInsert(head, p);
+
+  EvrRtxMemoryFree(mem, block, 1U);
+
+  return 1U;
+}
+
+#endif  // (OS_MEMORY_TLSF != 0)
@@ -36,6 +36,111 @@ __attribute__((section(".data.os.msgqueue.obj"))) =
 
 //  ==== Helper functions ====
 
+#if (OS_MSGQUEUE_PRIO_BUCKETS != 0)
+
+#if (OS_MSGQUEUE_PRIO_BUCKETS > 32)
+#error "Invalid number of Message Priority Buckets!"
+#endif
+
+#if (OS_MSGQUEUE_PRIO_NUM == 0)
+#error "Invalid number of indexed Message Queues!"
+#endif
+
+// Messages stay in a single list sorted by priority. Priorities below
+// OS_MSGQUEUE_PRIO_BUCKETS each form a FIFO segment of that list whose last
+// message is recorded, with a bitmap of the non-empty segments; the remaining
+// priorities share the last segment, at the head of the list.
+//
+// The index is kept in a table of OS_MSGQUEUE_PRIO_NUM entries rather than in
+// the control block, whose size is compiled into code built against rtx_os.h.
+// An entry is claimed when a queue is created and released when it is
+// deleted; queues created while the table is full are not indexed and insert
+// by walking back from the tail of the queue.
+
+typedef struct {
+  const os_message_queue_t *mq;         // Message Queue, NULL if free
+  uint32_t              prio_map;       // Non-empty Priority Buckets
+  os_message_t *prio_last[OS_MSGQUEUE_PRIO_BUCKETS]; // Last Message of each Priority Bucket
+} msgqueue_index_t;
+
+static msgqueue_index_t MessageQueueIndex[OS_MSGQUEUE_PRIO_NUM];
+
+/// Find the priority index of a Message Queue.
+/// \param[in]  mq              message queue object.
+/// \return index or NULL if the queue is not indexed.
+static msgqueue_index_t *MessageQueueIndexFind (const os_message_queue_t *mq) {
+  uint32_t n;
+
+  for (n = 0U; n < OS_MSGQUEUE_PRIO_NUM; n++) {
+    if (MessageQueueIndex[n].mq == mq) {
+      //lint -e{904} "Return statement before end of function" [MISRA Note 1]
+      return &MessageQueueIndex[n];
+    }
+  }
+
+  return NULL;
+}
+
+/// Claim a priority index for a new, empty Message Queue.
+/// \param[in]  mq              message queue object.
+static void MessageQueueIndexNew (const os_message_queue_t *mq) {
+  msgqueue_index_t *index;
+
+  index = MessageQueueIndexFind(NULL);
+  if (index != NULL) {
+    index->mq       = mq;
+    index->prio_map = 0U;
+    memset(index->prio_last, 0, sizeof(index->prio_last));
+  }
+}
+
+/// Release the priority index of a Message Queue.
+/// \param[in]  mq              message queue object.
+static void MessageQueueIndexFree (const os_message_queue_t *mq) {
+  msgqueue_index_t *index;
+
+  index = MessageQueueIndexFind(mq);
+  if (index != NULL) {
+    index->mq = NULL;
+  }
+}
+
+/// Priority Bucket of a Message.
+/// \param[in]  priority        message priority.
+/// \return bucket index.
+__STATIC_INLINE uint32_t MessageQueueBucket (uint32_t priority) {
+  return ((priority < (OS_MSGQUEUE_PRIO_BUCKETS - 1U)) ? priority : (OS_MSGQUEUE_PRIO_BUCKETS - 1U));
+}
+
+/// Find the last Message with priority higher or equal to specified one.
+/// \param[in]  index           priority index of the message queue.
+/// \param[in]  priority        message priority.
+/// \return message object or NULL to insert at head.
+static os_message_t *MessageQueueFindPrev (const msgqueue_index_t *index, uint32_t priority) {
+  os_message_t *prev;
+  uint32_t      bucket;
+  uint32_t      map;
+
+  bucket = MessageQueueBucket(priority);
+  prev   = index->prio_last[bucket];
+  if (prev == NULL) {
+    // Closest non-empty bucket of higher priority
+    map = index->prio_map & ~((2U << bucket) - 1U);
+    if (map != 0U) {
+      prev = index->prio_last[31U - __CLZ(map & (0U - map))];
+    }
+  } else {
+    // Shared bucket: skip the messages of lower priority
+    while ((prev != NULL) && (prev->priority < priority)) {
+      prev = prev->prev;
+    }
+  }
+
+  return prev;
+}
+
+#endif
+
 /// Put a Message into Queue sorted by Priority (Highest at Head).
 /// \param[in]  mq              message queue object.
 /// \param[in]  msg             message object.
@@ -44,6 +149,44 @@ static void MessageQueuePut (os_message_queue_t *mq, os_message_t *msg) {
   uint32_t      primask = __get_PRIMASK();
 #endif
   os_message_t *prev, *next;
+#if (OS_MSGQUEUE_PRIO_BUCKETS != 0)
+  msgqueue_index_t *index;
+  uint32_t          bucket;
+
+  index = MessageQueueIndexFind(mq);
+  if (index != NULL) {
+    prev = MessageQueueFindPrev(index, msg->priority);
+    next = (prev != NULL) ? prev->next : mq->msg_first;
+  } else {
+    prev = mq->msg_last;
+    next = NULL;
+    while ((prev != NULL) && (prev->priority < msg->priority)) {
+      next = prev;
+      prev = prev->prev;
+    }
+  }
+  msg->prev = prev;
+  msg->next = next;
+  if (prev != NULL) {
+    prev->next = msg;
+  } else {
+    mq->msg_first = msg;
+  }
+  if (next != NULL) {
+    next->prev = msg;
+  } else {
+    mq->msg_last = msg;
+  }
+
+  // Message is the last of its bucket unless inserted within the shared bucket
+  if (index != NULL) {
+    bucket = MessageQueueBucket(msg->priority);
+    if ((next == NULL) || (MessageQueueBucket(next->priority) != bucket)) {
+      index->prio_last[bucket] = msg;
+      index->prio_map |= 1U << bucket;
+    }
+  }
+#else
 
   if (mq->msg_last != NULL) {
     prev = mq->msg_last;
@@ -70,6 +213,7 @@ static void MessageQueuePut (os_message_queue_t *mq, os_message_t *msg) {
     mq->msg_first= msg;
     mq->msg_last = msg;
   }
+#endif
 
 #if (EXCLUSIVE_ACCESS == 0)
   __disable_irq();
@@ -142,6 +286,23 @@ static os_message_t *MessageQueueGet (os_message_queue_t *mq) {
 /// \param[in]  mq              message queue object.
 /// \param[in]  msg             message object.
 static void MessageQueueRemove (os_message_queue_t *mq, const os_message_t *msg) {
+#if (OS_MSGQUEUE_PRIO_BUCKETS != 0)
+  msgqueue_index_t *index;
+  uint32_t          bucket;
+
+  index = MessageQueueIndexFind(mq);
+  if (index != NULL) {
+    bucket = MessageQueueBucket(msg->priority);
+    if (index->prio_last[bucket] == msg) {
+      if ((msg->prev != NULL) && (MessageQueueBucket(msg->prev->priority) == bucket)) {
+        index->prio_last[bucket] = msg->prev;
+      } else {
+        index->prio_last[bucket] = NULL;
+        index->prio_map &= ~(1U << bucket);
+      }
+    }
+  }
+#endif
 
   if (msg->prev != NULL) {
     msg->prev->next = msg->next;
@@ -372,6 +533,9 @@ static osMessageQueueId_t svcRtxMessageQueueNew (uint32_t msg_count, uint32_t ms
     mq->msg_count   = 0U;
     mq->msg_first   = NULL;
     mq->msg_last    = NULL;
+#if (OS_MSGQUEUE_PRIO_BUCKETS != 0)
+    MessageQueueIndexNew(mq);
+#endif
     (void)osRtxMemoryPoolInit(&mq->mp_info, msg_count, block_size, mq_mem);
 
     // Register post ISR processing function
@@ -769,6 +933,10 @@ static osStatus_t svcRtxMessageQueueDelete (osMessageQueueId_t mq_id) {
   // Mark object as inactive
   mq->state = osRtxObjectInactive;
 
+#if (OS_MSGQUEUE_PRIO_BUCKETS != 0)
+  MessageQueueIndexFree(mq);
+#endif
+
   // Unblock waiting threads
   if (mq->thread_list != NULL) {
     do {
@@ -148,6 +148,14 @@ void osRtxThreadListPut (os_object_t *object, os_thread_t *thread) {
     return;
   }
 
+#if (OS_THREAD_READY_BITMAP != 0)
+  if (object == &osRtxInfo.thread.ready) {
+    osRtxThreadReadyInsert(thread, FALSE);
+    //lint -e{904} "Return statement before end of function" [MISRA Note 1]
+    return;
+  }
+#endif
+
   priority = thread->priority;
 
   prev = osRtxThreadObject(object);
@@ -170,6 +178,13 @@ void osRtxThreadListPut (os_object_t *object, os_thread_t *thread) {
 os_thread_t *osRtxThreadListGet (os_object_t *object) {
   os_thread_t *thread;
 
+#if (OS_THREAD_READY_BITMAP != 0)
+  if (object == &osRtxInfo.thread.ready) {
+    //lint -e{904} "Return statement before end of function" [MISRA Note 1]
+    return osRtxThreadReadyGet();
+  }
+#endif
+
   thread = object->thread_list;
   if (thread != NULL) {
     object->thread_list = thread->thread_next;
@@ -209,6 +224,14 @@ void osRtxThreadListSort (os_thread_t *thread) {
   }
   object = osRtxObject(thread0);
 
+#if (OS_THREAD_READY_BITMAP != 0)
+  if (object == &osRtxInfo.thread.ready) {
+    osRtxThreadReadySort(thread);
+    //lint -e{904} "Return statement before end of function" [MISRA Note 1]
+    return;
+  }
+#endif
+
   if (object != NULL) {
     osRtxThreadListRemove(thread);
     osRtxThreadListPut(object, thread);
@@ -219,6 +242,14 @@ void osRtxThreadListSort (os_thread_t *thread) {
 /// \param[in]  thread          thread object.
 void osRtxThreadListRemove (os_thread_t *thread) {
 
+#if (OS_THREAD_READY_BITMAP != 0)
+  if (thread->state == osRtxThreadReady) {
+    osRtxThreadReadyRemove(thread);
+    //lint -e{904} "Return statement before end of function" [MISRA Note 1]
+    return;
+  }
+#endif
+
   if (thread->thread_prev != NULL) {
     thread->thread_prev->thread_next = thread->thread_next;
     if (thread->thread_next != NULL) {
@@ -394,11 +425,16 @@ uint32_t *osRtxThreadRegPtr (const os_thread_t *thread) {
 /// Block running Thread execution and register it as Ready to Run.
 /// \param[in]  thread          running thread object.
 static void osRtxThreadBlock (os_thread_t *thread) {
+#if (OS_THREAD_READY_BITMAP == 0)
   os_thread_t *prev, *next;
   int32_t      priority;
+#endif
 
   thread->state = osRtxThreadReady;
 
+#if (OS_THREAD_READY_BITMAP != 0)
+  osRtxThreadReadyInsert(thread, TRUE);
+#else
   priority = thread->priority;
 
   prev = osRtxThreadObject(&osRtxInfo.thread.ready);
@@ -414,6 +450,7 @@ static void osRtxThreadBlock (os_thread_t *thread) {
   if (next != NULL) {
     next->thread_prev = thread;
   }
+#endif
 
   EvrRtxThreadPreempted(thread);
 }
@@ -422,6 +459,10 @@ static void osRtxThreadBlock (os_thread_t *thread) {
 /// \param[in]  thread          thread object.
 void osRtxThreadSwitch (os_thread_t *thread) {
 
+#if (OS_THREAD_CPU_TIME != 0)
+  osRtxThreadCpuTimeSwitch(thread);
+#endif
+
   thread->state = osRtxThreadRunning;
   osRtxInfo.thread.run.next = thread;
   osRtxThreadStackCheck();
@@ -779,6 +820,9 @@ osThreadId_t svcRtxThreadNew (osThreadFunc_t func, void *argument, const osThrea
   #if (DOMAIN_NS == 1)
     thread->tz_memory     = tz_memory;
   #endif
+  #if (OS_THREAD_CPU_TIME != 0)
+    osRtxThreadCpuTimeNew(thread);
+  #endif
 
     // Initialize stack
     //lint --e{613} false detection: "Possible use of null pointer"
@@ -1122,6 +1166,10 @@ static void osRtxThreadFree (os_thread_t *thread) {
   // Mark object as inactive
   thread->state = osRtxThreadInactive;
 
+#if (OS_THREAD_CPU_TIME != 0)
+  osRtxThreadCpuTimeFree(thread);
+#endif
+
 #if (DOMAIN_NS == 1)
   // Free secure process stack
   if (thread->tz_memory != 0U) {
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Project:     CMSIS-RTOS RTX
+ * Title:       Thread run time accounting
+ *
+ * -----------------------------------------------------------------------------
+ */
+
+#include "rtx_lib.h"
+
+#if (OS_THREAD_CPU_TIME != 0)
+
+// The time since the last thread switch is charged to the thread leaving the
+// CPU when the next one is selected. Time stamps are 32-bit microseconds, so
+// a thread must not run for more than 71 minutes without a switch.
+// The thread leaving the CPU is the one last selected (run.next): several
+// switches may happen in one SVC or PendSV before run.curr is updated.
+//
+// The totals are kept in a table indexed by a hash of the thread control
+// block address rather than in the control block, whose size is compiled
+// into code built against rtx_os.h. Collisions take the next free entry; a
+// released entry is marked deleted so that the entries after it stay found.
+// Threads created while the table is full are not accounted.
+
+#define THREAD_CPU_DELETED      ((const os_thread_t *)1U)
+
+typedef struct {
+  const os_thread_t *thread;            // Thread, NULL if free or THREAD_CPU_DELETED
+  uint32_t     switch_count;            // Number of times the Thread was switched in
+  uint64_t         cpu_time;            // Accumulated run time in microseconds
+} thread_cpu_t;
+
+static thread_cpu_t ThreadCpu[OS_THREAD_CPU_TIME_NUM];
+static uint32_t ThreadCpuTimeLast;      // Time stamp of the last thread switch
+
+//  First entry to look at for a Thread
+__STATIC_INLINE uint32_t ThreadCpuHash (const os_thread_t *thread) {
+  //lint -e{923} "cast from pointer to unsigned int" [MISRA Note 7]
+  return (uint32_t)(((uintptr_t)thread >> 3) % OS_THREAD_CPU_TIME_NUM);
+}
+
+//  Find the entry of a Thread
+static thread_cpu_t *ThreadCpuFind (const os_thread_t *thread) {
+  uint32_t n, i;
+
+  i = ThreadCpuHash(thread);
+  for (n = 0U; n < OS_THREAD_CPU_TIME_NUM; n++) {
+    if (ThreadCpu[i].thread == thread) {
+      //lint -e{904} "Return statement before end of function" [MISRA Note 1]
+      return &ThreadCpu[i];
+    }
+    if (ThreadCpu[i].thread == NULL) {
+      break;
+    }
+    i = (i + 1U) % OS_THREAD_CPU_TIME_NUM;
+  }
+
+  return NULL;
+}
+
+/// Start the accounting of a new Thread.
+/// \param[in]  thread          thread object.
+void osRtxThreadCpuTimeNew (const os_thread_t *thread) {
+  uint32_t n, i;
+
+  osRtxThreadCpuTimeFree(thread);
+
+  i = ThreadCpuHash(thread);
+  for (n = 0U; n < OS_THREAD_CPU_TIME_NUM; n++) {
+    if ((ThreadCpu[i].thread == NULL) || (ThreadCpu[i].thread == THREAD_CPU_DELETED)) {
+      ThreadCpu[i].thread       = thread;
+      ThreadCpu[i].switch_count = 0U;
+      ThreadCpu[i].cpu_time     = 0U;
+      break;
+    }
+    i = (i + 1U) % OS_THREAD_CPU_TIME_NUM;
+  }
+}
+
+/// Stop the accounting of a Thread whose control block is released.
+/// \param[in]  thread          thread object.
+void osRtxThreadCpuTimeFree (const os_thread_t *thread) {
+  thread_cpu_t *entry;
+  uint32_t      next;
+
+  entry = ThreadCpuFind(thread);
+  if (entry == NULL) {
+    //lint -e{904} "Return statement before end of function" [MISRA Note 1]
+    return;
+  }
+
+  // A deleted mark is only needed when an entry may follow it
+  next = ((uint32_t)(entry - ThreadCpu) + 1U) % OS_THREAD_CPU_TIME_NUM;
+  if (ThreadCpu[next].thread == NULL) {
+    entry->thread = NULL;
+  } else {
+    entry->thread = THREAD_CPU_DELETED;
+  }
+}
+
+/// Account the run time of the running Thread and count the switch.
+/// \param[in]  thread          thread object being switched in.
+void osRtxThreadCpuTimeSwitch (os_thread_t *thread) {
+  os_thread_t  *thread_running;
+  thread_cpu_t *entry;
+  uint32_t      now;
+
+  now = osRtxThreadCpuTimeStamp();
+  thread_running = osRtxInfo.thread.run.next;
+
+  if (thread_running != NULL) {
+    entry = ThreadCpuFind(thread_running);
+    if (entry != NULL) {
+      entry->cpu_time += now - ThreadCpuTimeLast;
+    }
+  }
+  ThreadCpuTimeLast = now;
+
+  if (thread != thread_running) {
+    entry = ThreadCpuFind(thread);
+    if (entry != NULL) {
+      entry->switch_count++;
+    }
+  }
+}
+
+/// Get the run time and the switch count of a Thread, including the current run of the running Thread.
+/// \note Must be called with the kernel locked or from the SVC/ISR context.
+/// \param[in]  thread          thread object.
+/// \param[out] cpu_time        run time in microseconds.
+/// \param[out] switch_count    number of times the Thread was switched in.
+/// \return 1 - accounted, 0 - not accounted.
+uint32_t osRtxThreadCpuTimeGet (const os_thread_t *thread, uint64_t *cpu_time, uint32_t *switch_count) {
+  const thread_cpu_t *entry;
+
+  entry = ThreadCpuFind(thread);
+  if (entry == NULL) {
+    *cpu_time     = 0U;
+    *switch_count = 0U;
+    //lint -e{904} "Return statement before end of function" [MISRA Note 1]
+    return 0U;
+  }
+
+  *cpu_time     = entry->cpu_time;
+  *switch_count = entry->switch_count;
+  if (thread == osRtxInfo.thread.run.next) {
+    *cpu_time += osRtxThreadCpuTimeStamp() - ThreadCpuTimeLast;
+  }
+
+  return 1U;
+}
+
+#endif
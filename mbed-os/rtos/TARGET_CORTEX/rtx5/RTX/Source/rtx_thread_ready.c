@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2013-2018 Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Project:     CMSIS-RTOS RTX
+ * Title:       Thread Ready list priority index
+ *
+ * -----------------------------------------------------------------------------
+ */
+
+#include "rtx_lib.h"
+
+#if (OS_THREAD_READY_BITMAP != 0)
+
+// The Ready list stays a single list sorted by priority, so that everything
+// walking it is unaffected, but each priority is a FIFO segment of that list.
+// The last thread of every non-empty segment is recorded together with a
+// 64-bit bitmap of the non-empty priorities: a thread is inserted after the
+// last thread of its own priority, or of the closest higher priority found
+// with CLZ, instead of scanning the list.
+
+#define READY_PRIORITY_NUM      64U
+
+static os_thread_t *ReadyLast[READY_PRIORITY_NUM];      // Last thread of each priority
+static uint32_t     ReadyMap[READY_PRIORITY_NUM/32U];   // Non-empty priorities
+
+//  Index of least significant bit set (value must not be 0)
+__STATIC_INLINE uint32_t ReadyFfs (uint32_t value) {
+  return (31U - (uint32_t)__CLZ(value & (0U - value)));
+}
+
+//  Closest non-empty priority above specified priority (-1 if none)
+static int32_t ReadyHigher (uint32_t priority) {
+  uint32_t map;
+  uint32_t n;
+
+  n = priority + 1U;
+  if (n < 32U) {
+    map = ReadyMap[0] & (0xFFFFFFFFU << n);
+    if (map != 0U) {
+      //lint -e{904} "Return statement before end of function" [MISRA Note 1]
+      return (int32_t)ReadyFfs(map);
+    }
+    n = 32U;
+  }
+  if (n < 64U) {
+    map = ReadyMap[1] & (0xFFFFFFFFU << (n - 32U));
+    if (map != 0U) {
+      //lint -e{904} "Return statement before end of function" [MISRA Note 1]
+      return (int32_t)(32U + ReadyFfs(map));
+    }
+  }
+  return -1;
+}
+
+//  Remove a Thread from the index of specified priority
+static void ReadyIndexRemove (os_thread_t *thread, uint32_t priority) {
+  os_thread_t *prev;
+
+  if (ReadyLast[priority] == thread) {
+    prev = thread->thread_prev;
+    if ((prev != osRtxThreadObject(&osRtxInfo.thread.ready)) &&
+        ((uint32_t)prev->priority == priority)) {
+      ReadyLast[priority] = prev;
+    } else {
+      ReadyLast[priority] = NULL;
+      ReadyMap[priority >> 5] &= ~(1U << (priority & 31U));
+    }
+  }
+}
+
+//  Unlink a Thread from the Ready list
+static void ReadyUnlink (os_thread_t *thread) {
+
+  thread->thread_prev->thread_next = thread->thread_next;
+  if (thread->thread_next != NULL) {
+    thread->thread_next->thread_prev = thread->thread_prev;
+  }
+  thread->thread_prev = NULL;
+}
+
+
+//  ==== Library functions ====
+
+/// Reset the Ready list priority index.
+void osRtxThreadReadyInit (void) {
+
+  memset(ReadyLast, 0, sizeof(ReadyLast));
+  memset(ReadyMap,  0, sizeof(ReadyMap));
+}
+
+/// Put a Thread into the Ready list.
+/// \param[in]  thread          thread object.
+/// \param[in]  head            TRUE - before, FALSE - after threads of same priority.
+void osRtxThreadReadyInsert (os_thread_t *thread, bool_t head) {
+  os_thread_t *prev;
+  uint32_t     priority;
+  int32_t      higher;
+
+  priority = (uint32_t)thread->priority;
+
+  if ((head == FALSE) && (ReadyLast[priority] != NULL)) {
+    prev = ReadyLast[priority];
+  } else {
+    higher = ReadyHigher(priority);
+    if (higher < 0) {
+      prev = osRtxThreadObject(&osRtxInfo.thread.ready);
+    } else {
+      prev = ReadyLast[higher];
+    }
+  }
+
+  thread->thread_prev = prev;
+  thread->thread_next = prev->thread_next;
+  prev->thread_next = thread;
+  if (thread->thread_next != NULL) {
+    thread->thread_next->thread_prev = thread;
+  }
+
+  if ((head == FALSE) || (ReadyLast[priority] == NULL)) {
+    ReadyLast[priority] = thread;
+    ReadyMap[priority >> 5] |= 1U << (priority & 31U);
+  }
+}
+
+/// Get the Thread with Highest Priority from the Ready list and remove it.
+/// \return thread object.
+os_thread_t *osRtxThreadReadyGet (void) {
+  os_thread_t *thread;
+
+  thread = osRtxInfo.thread.ready.thread_list;
+  if (thread != NULL) {
+    ReadyIndexRemove(thread, (uint32_t)thread->priority);
+    ReadyUnlink(thread);
+  }
+
+  return thread;
+}
+
+/// Remove a Thread from the Ready list.
+/// \param[in]  thread          thread object.
+void osRtxThreadReadyRemove (os_thread_t *thread) {
+
+  if (thread->thread_prev != NULL) {
+    ReadyIndexRemove(thread, (uint32_t)thread->priority);
+    ReadyUnlink(thread);
+  }
+}
+
+/// Re-sort a Thread in the Ready list after its priority was changed.
+/// \param[in]  thread          thread object.
+void osRtxThreadReadySort (os_thread_t *thread) {
+  uint32_t map;
+  uint32_t n, priority;
+
+  // The thread is indexed under its previous priority if it is the last of it
+  for (n = 0U; n < (READY_PRIORITY_NUM/32U); n++) {
+    map = ReadyMap[n];
+    while (map != 0U) {
+      priority = (n * 32U) + ReadyFfs(map);
+      if (ReadyLast[priority] == thread) {
+        ReadyIndexRemove(thread, priority);
+      }
+      map &= map - 1U;
+    }
+  }
+  ReadyUnlink(thread);
+
+  osRtxThreadReadyInsert(thread, FALSE);
+}
+
+#endif  // (OS_THREAD_READY_BITMAP != 0)
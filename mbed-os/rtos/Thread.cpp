@@ -33,6 +33,10 @@ MBED_STATIC_ASSERT(ALIGN_UP(1, 8) == 8, "ALIGN_UP macro error");
 MBED_STATIC_ASSERT(ALIGN_DOWN(7, 8) == 0, "ALIGN_DOWN macro error");
 MBED_STATIC_ASSERT(ALIGN_DOWN(8, 8) == 8, "ALIGN_DOWN macro error");
 
+#ifndef MBED_CONF_RTOS_WAIT_US_LP_TICKER_MIN_US
+#define MBED_CONF_RTOS_WAIT_US_LP_TICKER_MIN_US 0
+#endif
+
 static void (*terminate_hook)(osThreadId_t id) = 0;
 extern "C" void thread_terminate_hook(osThreadId_t id)
 {
@@ -43,6 +47,28 @@ extern "C" void thread_terminate_hook(osThreadId_t id)
 
 namespace rtos {
 
+namespace {
+// One-shot ticker event releasing the semaphore a thread waits on
+class WaitUsEvent : public mbed::TimerEvent {
+public:
+    WaitUsEvent(const ticker_data_t *data) : TimerEvent(data), _sem(0) {
+    }
+
+    void wait(uint32_t microsec) {
+        insert_absolute(ticker_read_us(_ticker_data) + microsec);
+        _sem.wait();
+    }
+
+protected:
+    virtual void handler() {
+        _sem.release();
+    }
+
+private:
+    Semaphore _sem;
+};
+}
+
 #ifndef MBED_TZ_DEFAULT_ACCESS
 #define MBED_TZ_DEFAULT_ACCESS   0
 #endif
@@ -359,10 +385,60 @@ osEvent Thread::signal_wait(int signals, unsigned int millisec) {
     return evt;
 }
 
+osEvent Thread::signal_wait(int signals, mbed::Milliseconds timeout) {
+    int64_t millisec = timeout.count();
+
+    if (millisec < 0) {
+        millisec = 0;
+    } else if (millisec >= osWaitForever) {
+        millisec = osWaitForever - 1;
+    }
+    return signal_wait(signals, (unsigned int)millisec);
+}
+
 osStatus Thread::wait(unsigned int millisec) {
     return osDelay(millisec);
 }
 
+osStatus Thread::wait(mbed::Milliseconds duration) {
+    int64_t remaining = duration.count();
+    osStatus status = osOK;
+
+    // osDelay takes 32 bits, and osWaitForever would not return
+    while ((remaining > 0) && (status == osOK)) {
+        uint32_t step = (remaining > 0x7FFFFFFF) ? 0x7FFFFFFF : (uint32_t)remaining;
+        status = osDelay(step);
+        remaining -= step;
+    }
+    return status;
+}
+
+osStatus Thread::wait_us(uint32_t microsec) {
+    if (core_util_is_isr_active()) {
+        return osErrorISR;
+    }
+    if (microsec == 0) {
+        return osOK;
+    }
+
+#if DEVICE_LPTICKER
+    if ((MBED_CONF_RTOS_WAIT_US_LP_TICKER_MIN_US != 0) && (microsec >= MBED_CONF_RTOS_WAIT_US_LP_TICKER_MIN_US)) {
+        WaitUsEvent event(get_lp_ticker_data());
+        event.wait(microsec);
+        return osOK;
+    }
+#endif
+
+    sleep_manager_lock_deep_sleep();
+    {
+        WaitUsEvent event(get_us_ticker_data());
+        event.wait(microsec);
+    }
+    sleep_manager_unlock_deep_sleep();
+
+    return osOK;
+}
+
 osStatus Thread::wait_until(uint64_t millisec) {
     // CMSIS-RTOS 2.1.0 and 2.1.1 differ in the time type, which we determine
     // by looking at the return type of osKernelGetTickCount. We assume
@@ -392,6 +468,13 @@ osStatus Thread::wait_until(uint64_t millisec) {
     }
 }
 
+osStatus Thread::wait_until(Kernel::Clock::time_point time) {
+    int64_t millisec = time.time_since_epoch().count();
+
+    // Times before the boot are in the past, like 0
+    return wait_until((uint64_t)((millisec < 0) ? 0 : millisec));
+}
+
 osStatus Thread::yield() {
     return osThreadYield();
 }
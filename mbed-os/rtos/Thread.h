@@ -31,6 +31,8 @@
 #include "platform/NonCopyable.h"
 #include "rtos/Semaphore.h"
 #include "rtos/Mutex.h"
+#include "rtos/Kernel.h"
+#include "platform/Duration.h"
 
 namespace rtos {
 /** \addtogroup rtos */
@@ -391,6 +393,15 @@ public:
     */
     static osEvent signal_wait(int signals, unsigned int millisec=osWaitForever);
 
+    /** Wait for one or more Thread Flags to become signaled for the current RUNNING thread.
+      @param   signals   wait until all specified signal flags are set or 0 for any single signal flag.
+      @param   timeout   timeout, clamped to 0 and to just below osWaitForever (about 49 days).
+      @return  event flag information or error code.
+
+      @note You cannot call this function from ISR context.
+    */
+    static osEvent signal_wait(int signals, mbed::Milliseconds timeout);
+
     /** Wait for a specified time period in milliseconds
       Being tick-based, the delay will be up to the specified time - eg for
       a value of 1 the system waits until the next millisecond tick occurs,
@@ -402,6 +413,33 @@ public:
     */
     static osStatus wait(unsigned int millisec);
 
+    /** Wait for a specified duration
+      Coarser durations convert to Milliseconds, for example wait(Seconds(4)).
+      Durations longer than a 32-bit millisecond delay are waited in steps,
+      and a duration of 0 or less returns at once.
+      @param   duration  time delay value
+      @return  status code that indicates the execution status of the function.
+
+      @note You cannot call this function from ISR context.
+    */
+    static osStatus wait(mbed::Milliseconds duration);
+
+    /** Wait for a specified time period in microseconds
+      The delay does not depend on the RTOS tick: the thread blocks on a
+      one-shot us ticker event, and other threads run or the core sleeps
+      meanwhile. The delay is at least the specified time, plus the interrupt
+      and thread switch latency of a few microseconds, so very short delays
+      are still better served by wait_us(). Deep sleep is locked during the
+      wait as the us ticker stops in deep sleep, except on targets with an LP
+      ticker for delays of at least rtos.wait-us-lp-ticker-min-us, which use
+      the LP ticker at its own resolution.
+      @param   microsec  time delay value
+      @return  status code that indicates the execution status of the function.
+
+      @note You cannot call this function from ISR context.
+    */
+    static osStatus wait_us(uint32_t microsec);
+
     /** Wait until a specified time in millisec
       The specified time is according to Kernel::get_ms_count().
       @param   millisec absolute time in millisec
@@ -418,6 +456,15 @@ public:
     */
     static osStatus wait_until(uint64_t millisec);
 
+    /** Wait until a specified time point of Kernel::Clock
+      @param   time  absolute time, for example Kernel::Clock::now() + Seconds(10)
+      @return  status code that indicates the execution status of the function.
+      @note the limits and the early return of wait_until(uint64_t) apply.
+
+      @note You cannot call this function from ISR context.
+    */
+    static osStatus wait_until(Kernel::Clock::time_point time);
+
     /** Pass control to next thread that is in state READY.
       @return  status code that indicates the execution status of the function.
 
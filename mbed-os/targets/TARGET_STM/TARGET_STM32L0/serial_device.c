@@ -217,6 +217,38 @@ void serial_putc(serial_t *obj, int c)
     huart->Instance->TDR = (uint32_t)(c & (uint16_t)0xFF);
 }
 
+void serial_putc_buffer(serial_t *obj, const void *buffer, size_t length)
+{
+    struct serial_s *obj_s = SERIAL_S(obj);
+    UART_HandleTypeDef *huart = &uart_handlers[obj_s->index];
+    const uint8_t *data = (const uint8_t *)buffer;
+
+    // The handle is looked up once, then each character only waits for TXE
+    while (length--) {
+        while (__HAL_UART_GET_FLAG(huart, UART_FLAG_TXE) == RESET);
+        huart->Instance->TDR = *data++;
+    }
+}
+
+size_t serial_getc_buffer(serial_t *obj, void *buffer, size_t length)
+{
+    struct serial_s *obj_s = SERIAL_S(obj);
+    UART_HandleTypeDef *huart = &uart_handlers[obj_s->index];
+    uint8_t *data = (uint8_t *)buffer;
+    size_t count = 0;
+
+    if (length == 0) {
+        return 0;
+    }
+    // Wait for the first character, clearing an overrun, then take the ones already received
+    while (!serial_readable(obj));
+    do {
+        data[count++] = (uint8_t)huart->Instance->RDR;
+    } while ((count < length) && (__HAL_UART_GET_FLAG(huart, UART_FLAG_RXNE) != RESET));
+
+    return count;
+}
+
 void serial_clear(serial_t *obj)
 {
     struct serial_s *obj_s = SERIAL_S(obj);
@@ -52,10 +52,16 @@ struct port_s {
     PinDirection direction;
     __IO uint32_t *reg_in;
     __IO uint32_t *reg_out;
+    __IO uint32_t *reg_set;
 };
 
 struct trng_s {
     RNG_HandleTypeDef handle;
+#if DEVICE_TRNG_ASYNCH
+    uint32_t handler;
+    uint32_t id;
+    volatile uint8_t discard;   // Drop the next random word, generated across a seed error
+#endif
 };
 
 #include "common_objects.h"
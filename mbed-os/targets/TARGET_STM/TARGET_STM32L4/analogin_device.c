@@ -27,6 +27,7 @@
  */
 #include "mbed_assert.h"
 #include "analogin_api.h"
+#include "analogin_group_api.h"
 
 #if DEVICE_ANALOGIN
 
@@ -36,7 +37,18 @@
 #include "mbed_error.h"
 #include "PeripheralPins.h"
 
-void analogin_init(analogin_t *obj, PinName pin)
+#if DEVICE_ANALOGIN_GROUP
+#include "mbed_critical.h"
+
+// Group whose sequence is programmed in the ADC
+static analogin_group_t *volatile adc_group_programmed = NULL;
+// Group being converted
+static analogin_group_t *volatile adc_group_active = NULL;
+// The ADC is configured for the single conversions of the AnalogIn
+static volatile bool adc_single_channel = true;
+#endif
+
+static uint32_t adc_pinmap(PinName pin, ADC_HandleTypeDef *handle)
 {
     uint32_t function = (uint32_t)NC;
 
@@ -46,132 +58,171 @@ void analogin_init(analogin_t *obj, PinName pin)
     if ((pin < 0xF0) || (pin >= 0x100)) {
         // Normal channels
         // Get the peripheral name from the pin and assign it to the object
-        obj->handle.Instance = (ADC_TypeDef *)pinmap_peripheral(pin, PinMap_ADC);
+        handle->Instance = (ADC_TypeDef *)pinmap_peripheral(pin, PinMap_ADC);
         // Get the functions (adc channel) from the pin and assign it to the object
         function = pinmap_function(pin, PinMap_ADC);
         // Configure GPIO
         pinmap_pinout(pin, PinMap_ADC);
     } else {
         // Internal channels
-        obj->handle.Instance = (ADC_TypeDef *)pinmap_peripheral(pin, PinMap_ADC_Internal);
+        handle->Instance = (ADC_TypeDef *)pinmap_peripheral(pin, PinMap_ADC_Internal);
         function = pinmap_function(pin, PinMap_ADC_Internal);
         // No GPIO configuration for internal channels
     }
-    MBED_ASSERT(obj->handle.Instance != (ADC_TypeDef *)NC);
+    MBED_ASSERT(handle->Instance != (ADC_TypeDef *)NC);
     MBED_ASSERT(function != (uint32_t)NC);
 
-    obj->channel = STM_PIN_CHANNEL(function);
-
-    // Save pin number for the read function
-    obj->pin = pin;
+    return STM_PIN_CHANNEL(function);
+}
 
+static void adc_handle_init(ADC_HandleTypeDef *handle)
+{
     // Configure ADC object structures
-    obj->handle.State = HAL_ADC_STATE_RESET;
-    obj->handle.Init.ClockPrescaler        = ADC_CLOCK_ASYNC_DIV2;          // Asynchronous clock mode, input ADC clock
-    obj->handle.Init.Resolution            = ADC_RESOLUTION_12B;
-    obj->handle.Init.DataAlign             = ADC_DATAALIGN_RIGHT;
-    obj->handle.Init.ScanConvMode          = DISABLE;                       // Sequencer disabled (ADC conversion on only 1 channel: channel set on rank 1)
-    obj->handle.Init.EOCSelection          = ADC_EOC_SINGLE_CONV;           // On STM32L1xx ADC, overrun detection is enabled only if EOC selection is set to each conversion (or transfer by DMA enabled, this is not the case in this example).
-    obj->handle.Init.LowPowerAutoWait      = DISABLE;
-    obj->handle.Init.ContinuousConvMode    = DISABLE;                       // Continuous mode disabled to have only 1 conversion at each conversion trig
-    obj->handle.Init.NbrOfConversion       = 1;                             // Parameter discarded because sequencer is disabled
-    obj->handle.Init.DiscontinuousConvMode = DISABLE;                       // Parameter discarded because sequencer is disabled
-    obj->handle.Init.NbrOfDiscConversion   = 1;                             // Parameter discarded because sequencer is disabled
-    obj->handle.Init.ExternalTrigConv      = ADC_SOFTWARE_START;            // Software start to trig the 1st conversion manually, without external event
-    obj->handle.Init.ExternalTrigConvEdge  = ADC_EXTERNALTRIGCONVEDGE_NONE;
-    obj->handle.Init.DMAContinuousRequests = DISABLE;
-    obj->handle.Init.Overrun               = ADC_OVR_DATA_OVERWRITTEN;      // DR register is overwritten with the last conversion result in case of overrun
-    obj->handle.Init.OversamplingMode      = DISABLE;                       // No oversampling
+    handle->State = HAL_ADC_STATE_RESET;
+    handle->Init.ClockPrescaler        = ADC_CLOCK_ASYNC_DIV2;          // Asynchronous clock mode, input ADC clock
+    handle->Init.Resolution            = ADC_RESOLUTION_12B;
+    handle->Init.DataAlign             = ADC_DATAALIGN_RIGHT;
+    handle->Init.ScanConvMode          = DISABLE;                       // Sequencer disabled (ADC conversion on only 1 channel: channel set on rank 1)
+    handle->Init.EOCSelection          = ADC_EOC_SINGLE_CONV;           // On STM32L1xx ADC, overrun detection is enabled only if EOC selection is set to each conversion (or transfer by DMA enabled, this is not the case in this example).
+    handle->Init.LowPowerAutoWait      = DISABLE;
+    handle->Init.ContinuousConvMode    = DISABLE;                       // Continuous mode disabled to have only 1 conversion at each conversion trig
+    handle->Init.NbrOfConversion       = 1;                             // Parameter discarded because sequencer is disabled
+    handle->Init.DiscontinuousConvMode = DISABLE;                       // Parameter discarded because sequencer is disabled
+    handle->Init.NbrOfDiscConversion   = 1;                             // Parameter discarded because sequencer is disabled
+    handle->Init.ExternalTrigConv      = ADC_SOFTWARE_START;            // Software start to trig the 1st conversion manually, without external event
+    handle->Init.ExternalTrigConvEdge  = ADC_EXTERNALTRIGCONVEDGE_NONE;
+    handle->Init.DMAContinuousRequests = DISABLE;
+    handle->Init.Overrun               = ADC_OVR_DATA_OVERWRITTEN;      // DR register is overwritten with the last conversion result in case of overrun
+    handle->Init.OversamplingMode      = DISABLE;                       // No oversampling
+}
 
+static void adc_start(ADC_HandleTypeDef *handle)
+{
     // Enable ADC clock
     __HAL_RCC_ADC_CLK_ENABLE();
     __HAL_RCC_ADC_CONFIG(RCC_ADCCLKSOURCE_SYSCLK);
 
-    if (HAL_ADC_Init(&obj->handle) != HAL_OK) {
+    if (HAL_ADC_Init(handle) != HAL_OK) {
         error("Cannot initialize ADC");
     }
 
     // ADC calibration is done only once
-    if (!HAL_ADCEx_Calibration_GetValue(&obj->handle, ADC_SINGLE_ENDED)) {
-        HAL_ADCEx_Calibration_Start(&obj->handle, ADC_SINGLE_ENDED);
+    if (!HAL_ADCEx_Calibration_GetValue(handle, ADC_SINGLE_ENDED)) {
+        HAL_ADCEx_Calibration_Start(handle, ADC_SINGLE_ENDED);
     }
 }
 
-uint16_t adc_read(analogin_t *obj)
+void analogin_init(analogin_t *obj, PinName pin)
 {
-    ADC_ChannelConfTypeDef sConfig = {0};
+    obj->channel = adc_pinmap(pin, &obj->handle);
 
-    // Configure ADC channel
-    sConfig.Rank         = ADC_REGULAR_RANK_1;
-    sConfig.SamplingTime = ADC_SAMPLETIME_47CYCLES_5; //  default value (1.5 us for 80MHz clock)
-    sConfig.SingleDiff   = ADC_SINGLE_ENDED;
-    sConfig.OffsetNumber = ADC_OFFSET_NONE;
-    sConfig.Offset       = 0;
+    // Save pin number for the read function
+    obj->pin = pin;
+
+    adc_handle_init(&obj->handle);
+#if DEVICE_ANALOGIN_GROUP
+    // The caller waits for the end of a group conversion, see AnalogIn::lock
+    MBED_ASSERT(adc_group_active == NULL);
+    adc_group_programmed = NULL;
+    adc_single_channel = true;
+#endif
+    adc_start(&obj->handle);
+}
+
+static int adc_channel_config(uint8_t channel, ADC_ChannelConfTypeDef *sConfig)
+{
+    sConfig->SamplingTime = ADC_SAMPLETIME_47CYCLES_5; //  default value (1.5 us for 80MHz clock)
+    sConfig->SingleDiff   = ADC_SINGLE_ENDED;
+    sConfig->OffsetNumber = ADC_OFFSET_NONE;
+    sConfig->Offset       = 0;
 
-    switch (obj->channel) {
+    switch (channel) {
         case 0:
-            sConfig.Channel = ADC_CHANNEL_VREFINT;
-            sConfig.SamplingTime = ADC_SAMPLETIME_247CYCLES_5; // Minimum ADC sampling time when reading the internal reference voltage is 4us
+            sConfig->Channel = ADC_CHANNEL_VREFINT;
+            sConfig->SamplingTime = ADC_SAMPLETIME_247CYCLES_5; // Minimum ADC sampling time when reading the internal reference voltage is 4us
             break;
         case 1:
-            sConfig.Channel = ADC_CHANNEL_1;
+            sConfig->Channel = ADC_CHANNEL_1;
             break;
         case 2:
-            sConfig.Channel = ADC_CHANNEL_2;
+            sConfig->Channel = ADC_CHANNEL_2;
             break;
         case 3:
-            sConfig.Channel = ADC_CHANNEL_3;
+            sConfig->Channel = ADC_CHANNEL_3;
             break;
         case 4:
-            sConfig.Channel = ADC_CHANNEL_4;
+            sConfig->Channel = ADC_CHANNEL_4;
             break;
         case 5:
-            sConfig.Channel = ADC_CHANNEL_5;
+            sConfig->Channel = ADC_CHANNEL_5;
             break;
         case 6:
-            sConfig.Channel = ADC_CHANNEL_6;
+            sConfig->Channel = ADC_CHANNEL_6;
             break;
         case 7:
-            sConfig.Channel = ADC_CHANNEL_7;
+            sConfig->Channel = ADC_CHANNEL_7;
             break;
         case 8:
-            sConfig.Channel = ADC_CHANNEL_8;
+            sConfig->Channel = ADC_CHANNEL_8;
             break;
         case 9:
-            sConfig.Channel = ADC_CHANNEL_9;
+            sConfig->Channel = ADC_CHANNEL_9;
             break;
         case 10:
-            sConfig.Channel = ADC_CHANNEL_10;
+            sConfig->Channel = ADC_CHANNEL_10;
             break;
         case 11:
-            sConfig.Channel = ADC_CHANNEL_11;
+            sConfig->Channel = ADC_CHANNEL_11;
             break;
         case 12:
-            sConfig.Channel = ADC_CHANNEL_12;
+            sConfig->Channel = ADC_CHANNEL_12;
             break;
         case 13:
-            sConfig.Channel = ADC_CHANNEL_13;
+            sConfig->Channel = ADC_CHANNEL_13;
             break;
         case 14:
-            sConfig.Channel = ADC_CHANNEL_14;
+            sConfig->Channel = ADC_CHANNEL_14;
             break;
         case 15:
-            sConfig.Channel = ADC_CHANNEL_15;
+            sConfig->Channel = ADC_CHANNEL_15;
             break;
         case 16:
-            sConfig.Channel = ADC_CHANNEL_16;
+            sConfig->Channel = ADC_CHANNEL_16;
             break;
         case 17:
-            sConfig.Channel = ADC_CHANNEL_TEMPSENSOR;
-            sConfig.SamplingTime = ADC_SAMPLETIME_247CYCLES_5; // Minimum ADC sampling time when reading the temperature is 5us
+            sConfig->Channel = ADC_CHANNEL_TEMPSENSOR;
+            sConfig->SamplingTime = ADC_SAMPLETIME_247CYCLES_5; // Minimum ADC sampling time when reading the temperature is 5us
             break;
         case 18:
-            sConfig.Channel = ADC_CHANNEL_VBAT;
-            sConfig.SamplingTime = ADC_SAMPLETIME_640CYCLES_5; // Minimum ADC sampling time when reading the VBAT is 12us
+            sConfig->Channel = ADC_CHANNEL_VBAT;
+            sConfig->SamplingTime = ADC_SAMPLETIME_640CYCLES_5; // Minimum ADC sampling time when reading the VBAT is 12us
             break;
         default:
-            return 0;
+            return -1;
     }
+    return 0;
+}
+
+uint16_t adc_read(analogin_t *obj)
+{
+    ADC_ChannelConfTypeDef sConfig = {0};
+
+    // Configure ADC channel
+    sConfig.Rank         = ADC_REGULAR_RANK_1;
+    if (adc_channel_config(obj->channel, &sConfig) != 0) {
+        return 0;
+    }
+
+#if DEVICE_ANALOGIN_GROUP
+    MBED_ASSERT(adc_group_active == NULL);
+
+    // Replace the sequence of a group by a single channel
+    if (!adc_single_channel) {
+        HAL_ADC_Init(&obj->handle);
+        adc_group_programmed = NULL;
+        adc_single_channel = true;
+    }
+#endif
 
     HAL_ADC_ConfigChannel(&obj->handle, &sConfig);
 
@@ -185,4 +236,162 @@ uint16_t adc_read(analogin_t *obj)
     }
 }
 
+#if DEVICE_ANALOGIN_GROUP
+
+static const uint32_t adc_ranks[ANALOGIN_GROUP_MAX_CHANNELS] = {
+    ADC_REGULAR_RANK_1, ADC_REGULAR_RANK_2, ADC_REGULAR_RANK_3, ADC_REGULAR_RANK_4,
+    ADC_REGULAR_RANK_5, ADC_REGULAR_RANK_6, ADC_REGULAR_RANK_7, ADC_REGULAR_RANK_8,
+    ADC_REGULAR_RANK_9, ADC_REGULAR_RANK_10, ADC_REGULAR_RANK_11, ADC_REGULAR_RANK_12,
+    ADC_REGULAR_RANK_13, ADC_REGULAR_RANK_14, ADC_REGULAR_RANK_15, ADC_REGULAR_RANK_16
+};
+
+// Oversampling ratios 2 to 256
+static const uint32_t adc_oversampling_ratios[8] = {
+    ADC_OVERSAMPLING_RATIO_2, ADC_OVERSAMPLING_RATIO_4, ADC_OVERSAMPLING_RATIO_8, ADC_OVERSAMPLING_RATIO_16,
+    ADC_OVERSAMPLING_RATIO_32, ADC_OVERSAMPLING_RATIO_64, ADC_OVERSAMPLING_RATIO_128, ADC_OVERSAMPLING_RATIO_256
+};
+
+// Right shifts of 1 to 4 bits
+static const uint32_t adc_oversampling_shifts[4] = {
+    ADC_RIGHTBITSHIFT_1, ADC_RIGHTBITSHIFT_2, ADC_RIGHTBITSHIFT_3, ADC_RIGHTBITSHIFT_4
+};
+
+static void adc_group_program(analogin_group_t *obj)
+{
+    ADC_ChannelConfTypeDef sConfig = {0};
+    int i;
+
+    for (i = 0; i < obj->count; i++) {
+        sConfig.Rank = adc_ranks[i];
+        adc_channel_config(obj->channels[i], &sConfig);
+        HAL_ADC_ConfigChannel(&obj->handle, &sConfig);
+    }
+    adc_group_programmed = obj;
+    adc_single_channel = false;
+}
+
+void analogin_group_init(analogin_group_t *obj, const PinName *pins, uint8_t count, uint16_t oversampling)
+{
+    int ratio_log2 = 0;
+    int i;
+
+    MBED_ASSERT((count > 0) && (count <= ANALOGIN_GROUP_MAX_CHANNELS));
+    MBED_ASSERT((oversampling > 0) && (oversampling <= ANALOGIN_GROUP_MAX_OVERSAMPLING));
+    MBED_ASSERT((oversampling & (oversampling - 1)) == 0);
+
+    for (i = 0; i < count; i++) {
+        obj->channels[i] = adc_pinmap(pins[i], &obj->handle);
+    }
+    obj->count = count;
+    obj->index = 0;
+
+    while ((1 << ratio_log2) < oversampling) {
+        ratio_log2++;
+    }
+
+    adc_handle_init(&obj->handle);
+    obj->handle.Init.ScanConvMode = ENABLE;
+    obj->handle.Init.NbrOfConversion = count;
+    // The ADC waits for the result to be read before the next conversion, so none is overwritten
+    obj->handle.Init.LowPowerAutoWait = ENABLE;
+
+    // The sum of the conversions is shifted down to 16 bits at most
+    obj->bits = 12 + ratio_log2;
+    if (ratio_log2 > 0) {
+        obj->handle.Init.OversamplingMode = ENABLE;
+        obj->handle.Init.Oversampling.Ratio = adc_oversampling_ratios[ratio_log2 - 1];
+        obj->handle.Init.Oversampling.RightBitShift = ADC_RIGHTBITSHIFT_NONE;
+        obj->handle.Init.Oversampling.TriggeredMode = ADC_TRIGGEREDMODE_SINGLE_TRIGGER;
+        obj->handle.Init.Oversampling.OversamplingStopReset = ADC_REGOVERSAMPLING_CONTINUED_MODE;
+        if (ratio_log2 > 4) {
+            obj->handle.Init.Oversampling.RightBitShift = adc_oversampling_shifts[ratio_log2 - 5];
+            obj->bits = 16;
+        }
+    }
+
+    MBED_ASSERT(adc_group_active == NULL);
+    adc_start(&obj->handle);
+    adc_group_program(obj);
+}
+
+void analogin_group_free(analogin_group_t *obj)
+{
+    core_util_critical_section_enter();
+    if (adc_group_active == obj) {
+        HAL_ADC_Stop_IT(&obj->handle);
+        adc_group_active = NULL;
+    }
+    if (adc_group_programmed == obj) {
+        adc_group_programmed = NULL;
+    }
+    core_util_critical_section_exit();
+}
+
+static void adc_group_irq(void)
+{
+    analogin_group_t *obj = adc_group_active;
+
+    if (obj != NULL) {
+        HAL_ADC_IRQHandler(&obj->handle);
+    }
+}
+
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
+{
+    analogin_group_t *obj = adc_group_active;
+
+    if ((obj == NULL) || (hadc != &obj->handle)) {
+        return;
+    }
+
+    if (__HAL_ADC_GET_FLAG(hadc, ADC_FLAG_EOC)) {
+        // Reading the result starts the next conversion
+        uint32_t value = HAL_ADC_GetValue(hadc);
+
+        if (obj->index < obj->count) {
+            // Scale to 16 bits like analogin_read_u16
+            value = (value << (16 - obj->bits)) | (value >> (2 * obj->bits - 16));
+            obj->results[obj->index++] = (uint16_t)value;
+        }
+    }
+
+    if (__HAL_ADC_GET_FLAG(hadc, ADC_FLAG_EOS)) {
+        adc_group_active = NULL;
+        ((analogin_group_handler)obj->handler)(obj->id, (obj->index == obj->count) ? 0 : -1);
+    }
+}
+
+int analogin_group_start(analogin_group_t *obj, uint16_t *results, analogin_group_handler handler, uint32_t id)
+{
+    core_util_critical_section_enter();
+    if ((adc_group_active != NULL) || ADC_IS_CONVERSION_ONGOING_REGULAR(&obj->handle)) {
+        core_util_critical_section_exit();
+        return -1;
+    }
+    adc_group_active = obj;
+    core_util_critical_section_exit();
+
+    // The sequence is programmed once, unless an AnalogIn or another group used the ADC since
+    if (adc_group_programmed != obj) {
+        HAL_ADC_Init(&obj->handle);
+        adc_group_program(obj);
+    }
+
+    obj->results = results;
+    obj->index = 0;
+    obj->handler = (uint32_t)handler;
+    obj->id = id;
+
+    NVIC_SetVector(ADC1_IRQn, (uint32_t)adc_group_irq);
+    NVIC_EnableIRQ(ADC1_IRQn);
+
+    if (HAL_ADC_Start_IT(&obj->handle) != HAL_OK) {
+        adc_group_active = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+#endif
+
 #endif
@@ -122,6 +122,22 @@ struct analogin_s {
     uint8_t channel;
 };
 
+#if DEVICE_ANALOGIN_GROUP
+#define ANALOGIN_GROUP_MAX_CHANNELS     16      // Length of the ADC regular sequence
+#define ANALOGIN_GROUP_MAX_OVERSAMPLING 256     // Highest ratio of the ADC oversampler
+
+struct analogin_group_s {
+    ADC_HandleTypeDef handle;
+    uint8_t channels[ANALOGIN_GROUP_MAX_CHANNELS];
+    uint8_t count;
+    uint8_t bits;               // Resolution of the oversampled results
+    volatile uint8_t index;     // Rank of the next result
+    uint16_t *results;
+    uint32_t handler;
+    uint32_t id;
+};
+#endif
+
 #include "gpio_object.h"
 
 struct dac_s {
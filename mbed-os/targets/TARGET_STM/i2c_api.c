@@ -32,6 +32,13 @@
 #include "mbed_assert.h"
 #include "i2c_api.h"
 #include "platform/mbed_wait_api.h"
+#include "platform/mbed_critical.h"
+#include "platform/mbed_power_mgmt.h"
+
+#if MBED_CONF_RTOS_PRESENT
+#include "cmsis_os2.h"
+#include "mbed_rtos_storage.h"
+#endif
 
 #if DEVICE_I2C
 
@@ -58,7 +65,7 @@
 #endif
 
 /*  Family specific description for I2C */
-#define I2C_NUM (1)//(5)
+#define I2C_NUM (5)
 static I2C_HandleTypeDef* i2c_handles[I2C_NUM];
 
 /* Timeout values are based on core clock and I2C clock.
@@ -79,6 +86,70 @@ static I2C_HandleTypeDef* i2c_handles[I2C_NUM];
 */
 #define FLAG_TIMEOUT ((int)0x1000)
 
+#if MBED_CONF_RTOS_PRESENT
+/* Synchronous transfers block the calling thread on a semaphore released by
+   the completion and error callbacks, so other threads run or the core sleeps
+   until the end of the transfer. The semaphores are created on first use. */
+static mbed_rtos_storage_semaphore_t i2c_sync_sem_storage[I2C_NUM];
+static osSemaphoreId_t i2c_sync_sem[I2C_NUM];
+#endif
+
+/* Wake up a thread waiting in i2c_sync_wait */
+static void i2c_sync_signal(struct i2c_s *obj_s)
+{
+#if MBED_CONF_RTOS_PRESENT
+    if (i2c_sync_sem[obj_s->index] != NULL) {
+        osSemaphoreRelease(i2c_sync_sem[obj_s->index]);
+    }
+#else
+    (void)obj_s;
+#endif
+}
+
+/* Wait for the end of a transfer started in interrupt mode.
+   Returns 0 if it did not end within timeout_us.
+   Before the kernel starts, in interrupts and in critical sections the event
+   flag is polled instead. */
+static uint32_t i2c_sync_wait(struct i2c_s *obj_s, uint32_t timeout_us)
+{
+#if MBED_CONF_RTOS_PRESENT
+    if ((osKernelGetState() == osKernelRunning) && !core_util_is_isr_active() &&
+        !core_util_in_critical_section()) {
+        osSemaphoreId_t sem = i2c_sync_sem[obj_s->index];
+        uint32_t ticks = (uint32_t)(((uint64_t)timeout_us * osKernelGetTickFreq() + 999999) / 1000000) + 1;
+
+        if (sem == NULL) {
+            osSemaphoreAttr_t attr = { 0 };
+            attr.name = "i2c";
+            attr.cb_mem = &i2c_sync_sem_storage[obj_s->index];
+            attr.cb_size = sizeof(i2c_sync_sem_storage[obj_s->index]);
+            sem = osSemaphoreNew(1, 0, &attr);
+            MBED_ASSERT(sem != NULL);
+            i2c_sync_sem[obj_s->index] = sem;
+        }
+
+        /* The I2C clock stops in deep sleep */
+        sleep_manager_lock_deep_sleep();
+        /* A token may be left over by a transfer which timed out, so check
+           the event flag again after each wake-up */
+        while (!(obj_s->event & I2C_EVENT_ALL)) {
+            if (osSemaphoreAcquire(sem, ticks) != osOK) {
+                break;
+            }
+        }
+        sleep_manager_unlock_deep_sleep();
+
+        return (obj_s->event & I2C_EVENT_ALL) ? timeout_us : 0;
+    }
+#endif
+
+    while(!(obj_s->event & I2C_EVENT_ALL) && (--timeout_us != 0)) {
+        wait_us(1);
+    }
+
+    return timeout_us;
+}
+
 /* GENERIC INIT and HELPERS FUNCTIONS */
 
 #if defined(I2C1_BASE)
@@ -753,9 +824,7 @@ int i2c_read(i2c_t *obj, int address, char *data, int length, int stop) {
     if(ret == HAL_OK) {
         timeout = BYTE_TIMEOUT_US * (length + 1);
         /*  transfer started : wait completion or timeout */
-        while(!(obj_s->event & I2C_EVENT_ALL) && (--timeout != 0)) {
-            wait_us(1);
-        }
+        timeout = i2c_sync_wait(obj_s, timeout);
 
         i2c_ev_err_disable(obj);
 
@@ -804,9 +873,7 @@ int i2c_write(i2c_t *obj, int address, const char *data, int length, int stop) {
     if(ret == HAL_OK) {
         timeout = BYTE_TIMEOUT_US * (length + 1);
         /*  transfer started : wait completion or timeout */
-        while(!(obj_s->event & I2C_EVENT_ALL) && (--timeout != 0)) {
-            wait_us(1);
-        }
+        timeout = i2c_sync_wait(obj_s, timeout);
 
         i2c_ev_err_disable(obj);
 
@@ -845,6 +912,7 @@ void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c){
     {
         /* Set event flag */
         obj_s->event = I2C_EVENT_TRANSFER_COMPLETE;
+        i2c_sync_signal(obj_s);
     }
 }
 
@@ -855,6 +923,7 @@ void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef *hi2c){
 
     /* Set event flag */
     obj_s->event = I2C_EVENT_TRANSFER_COMPLETE;
+    i2c_sync_signal(obj_s);
 }
 
 void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c){
@@ -884,6 +953,7 @@ void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c){
 
     /* Keep Set event flag */
     obj_s->event = I2C_EVENT_ERROR;
+    i2c_sync_signal(obj_s);
 }
 
 #if DEVICE_I2CSLAVE
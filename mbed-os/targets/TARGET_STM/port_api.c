@@ -43,6 +43,12 @@ PinName port_pin(PortName port, int pin_n)
     return (PinName)(pin_n + (port << 4));
 }
 
+PortName port_from_pin(PinName pin, int *pin_n)
+{
+    *pin_n = STM_PIN(pin);
+    return (PortName)STM_PORT(pin);
+}
+
 void port_init(port_t *obj, PortName port, int mask, PinDirection dir)
 {
     uint32_t port_index = (uint32_t)port;
@@ -56,6 +62,7 @@ void port_init(port_t *obj, PortName port, int mask, PinDirection dir)
     obj->direction = dir;
     obj->reg_in    = &gpio->IDR;
     obj->reg_out   = &gpio->ODR;
+    obj->reg_set   = &gpio->BSRR;
 
     port_dir(obj, dir);
 }
@@ -87,7 +94,8 @@ void port_mode(port_t *obj, PinMode mode)
 
 void port_write(port_t *obj, int value)
 {
-    *obj->reg_out = (*obj->reg_out & ~obj->mask) | (value & obj->mask);
+    // Set and reset the pins of the mask in one store to BSRR
+    *obj->reg_set = (value & obj->mask) | ((~value & obj->mask) << 16);
 }
 
 int port_read(port_t *obj)
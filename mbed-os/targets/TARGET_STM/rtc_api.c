@@ -176,7 +176,17 @@ It is then not a problem to not use shifts.
 */
 unsigned int subsec;
 
-time_t rtc_read(void)
+/* Convert a number of RTC sub-second ticks into microseconds with 32-bit
+ * integer operations only: 1000000 = 15625 * 64 and both partial products
+ * fit in 32 bits for a synchronous prescaler up to 15 bits.
+ */
+static inline uint32_t rtc_ticks_to_us(uint32_t ticks, uint32_t ticks_per_second)
+{
+    uint32_t scaled = ticks * 15625;
+    return ((scaled / ticks_per_second) * 64) + (((scaled % ticks_per_second) * 64) / ticks_per_second);
+}
+
+static time_t rtc_read_calendar(uint32_t *subsec_us)
 {
     RTC_DateTypeDef dateStruct = {0};
     RTC_TimeTypeDef timeStruct = {0};
@@ -209,7 +219,7 @@ time_t rtc_read(void)
     timeinfo.tm_min  = timeStruct.Minutes;
     timeinfo.tm_sec  = timeStruct.Seconds;
 
-    subsec=1000000.f *((double)(timeStruct.SecondFraction-timeStruct.SubSeconds)/(timeStruct.SecondFraction+1));
+    *subsec_us = rtc_ticks_to_us(timeStruct.SecondFraction - timeStruct.SubSeconds, timeStruct.SecondFraction + 1);
 
     // Convert to timestamp
     time_t t;
@@ -220,6 +230,24 @@ time_t rtc_read(void)
     return t;
 }
 
+time_t rtc_read(void)
+{
+    uint32_t us;
+    time_t t = rtc_read_calendar(&us);
+
+    subsec = us;
+
+    return t;
+}
+
+uint64_t rtc_read_us(void)
+{
+    uint32_t us;
+    time_t t = rtc_read_calendar(&us);
+
+    return ((uint64_t)(uint32_t)t * 1000000) + us;
+}
+
 void rtc_write(time_t t)
 {
     RTC_DateTypeDef dateStruct = {0};
@@ -28,6 +28,10 @@
 
 static uint8_t users = 0;
 
+#if DEVICE_TRNG_ASYNCH
+static trng_t *trng_irq_obj = NULL;
+#endif
+
 void trng_init(trng_t *obj)
 {
     uint32_t dummy;
@@ -62,6 +66,14 @@ void trng_init(trng_t *obj)
 
 void trng_free(trng_t *obj)
 {
+#if DEVICE_TRNG_ASYNCH
+    /* Only the object given to trng_irq_handler owns the interrupt, which may feed the entropy pool */
+    if (trng_irq_obj == obj) {
+        trng_irq_set(obj, 0);
+        trng_irq_obj = NULL;
+    }
+#endif
+
     /*Disable the RNG peripheral */
     HAL_RNG_DeInit(&obj->handle);
     /* RNG Peripheral clock disable - assume we're the only users of RNG  */
@@ -97,4 +109,64 @@ int trng_get_bytes(trng_t *obj, uint8_t *output, size_t length, size_t *output_l
     return( ret );
 }
 
+#if DEVICE_TRNG_ASYNCH
+
+static void trng_irq(void)
+{
+    trng_t *obj = trng_irq_obj;
+    RNG_HandleTypeDef *handle = &obj->handle;
+    trng_handler handler = (trng_handler)obj->handler;
+
+    if (__HAL_RNG_GET_IT(handle, RNG_IT_SEI)) {
+        /* Seed error: the random word being generated must not be used, restart the RNG */
+        __HAL_RNG_CLEAR_IT(handle, RNG_IT_SEI);
+        __HAL_RNG_DISABLE(handle);
+        __HAL_RNG_ENABLE(handle);
+        obj->discard = 1;
+        handler(obj->id, 0, -1);
+        return;
+    }
+
+    if (__HAL_RNG_GET_IT(handle, RNG_IT_CEI)) {
+        /* Clock error: the RNG clock is too slow, the words already generated are still valid */
+        __HAL_RNG_CLEAR_IT(handle, RNG_IT_CEI);
+        handler(obj->id, 0, -1);
+    }
+
+    if (__HAL_RNG_GET_IT(handle, RNG_IT_DRDY)) {
+        /* Reading the word clears the flag */
+        uint32_t random = handle->Instance->DR;
+
+        if (obj->discard) {
+            obj->discard = 0;
+        } else {
+            handler(obj->id, random, 0);
+        }
+    }
+}
+
+void trng_irq_handler(trng_t *obj, trng_handler handler, uint32_t id)
+{
+    obj->handler = (uint32_t)handler;
+    obj->id = id;
+    obj->discard = 0;
+    trng_irq_obj = obj;
+
+    NVIC_SetVector(RNG_IRQn, (uint32_t)trng_irq);
+}
+
+void trng_irq_set(trng_t *obj, uint32_t enable)
+{
+    if (enable) {
+        __HAL_RNG_ENABLE_IT(&obj->handle);
+        NVIC_EnableIRQ(RNG_IRQn);
+    } else {
+        __HAL_RNG_DISABLE_IT(&obj->handle);
+        NVIC_DisableIRQ(RNG_IRQn);
+        NVIC_ClearPendingIRQ(RNG_IRQn);
+    }
+}
+
+#endif
+
 #endif
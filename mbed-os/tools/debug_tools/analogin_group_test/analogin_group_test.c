@@ -0,0 +1,581 @@
+/* Host test of the analogin group of targets/TARGET_STM/TARGET_STM32L4/analogin_device.c
+ *
+ * The STM32L4 HAL is replaced by a model of the ADC: the registers are mapped at the
+ * address of ADC1, the regular sequence, the oversampler and the wait for the data
+ * register to be read are simulated, and the end of each conversion calls the vector
+ * set with NVIC_SetVector, like the ADC interrupt.
+ */
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "analogin_api.h"
+#include "analogin_group_api.h"
+#include "pinmap.h"
+
+uint16_t analogin_read_u16(analogin_t *obj);
+
+#define SYSCLK_HZ       80000000.0
+#define ADC_CLK_HZ      40000000.0      // SYSCLK / 2, ADC_CLOCK_ASYNC_DIV2
+
+/* Estimated CPU cycles of the HAL calls at 80 MHz, not measured */
+#define CYCLES_CONFIG_CHANNEL   250
+#define CYCLES_START            150
+#define CYCLES_POLL             60
+#define CYCLES_GET_VALUE        10
+#define CYCLES_START_IT         200
+#define CYCLES_IRQ              160     // exception entry and exit, HAL_ADC_IRQHandler and the callback
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+/* ADC model */
+
+static struct {
+    ADC_TypeDef *regs;
+    ADC_InitTypeDef config;         // configuration of the last HAL_ADC_Init
+    uint32_t sequence[17];          // channel of each rank
+    uint32_t sampling[17];          // sampling time of each rank, in tenths of cycles
+    double input[19];               // input of each channel, in 12-bit LSB
+    double noise;                   // peak noise, in 12-bit LSB
+    int calibrated;
+    int running;                    // sequence started with HAL_ADC_Start_IT
+    int rank;                       // rank of the next conversion
+    uint32_t vector;
+    int irq_enabled;
+
+    int inits;
+    int config_channels;
+    int starts;
+    int polls;
+    int polls_in_scan;              // single conversions polled while the ADC was set for a sequence
+    int starts_it;
+    int stops_it;
+    int irqs;
+    int overruns;                   // conversions ended with the previous result still unread
+    double cpu_cycles;
+    double adc_seconds;
+} adc;
+
+static uint32_t noise_state = 1;
+
+static double noise_sample(void)
+{
+    noise_state = noise_state * 1103515245 + 12345;
+    return ((double)((noise_state >> 8) & 0xFFFF) / 32768.0 - 1.0) * adc.noise;
+}
+
+static uint32_t adc_convert(int rank)
+{
+    uint32_t channel = adc.sequence[rank];
+    uint32_t ratio = adc.config.OversamplingMode ? adc.config.Oversampling.Ratio : 1;
+    uint32_t sum = 0;
+    uint32_t i;
+
+    for (i = 0; i < ratio; i++) {
+        long sample = lround(adc.input[channel] + noise_sample());
+
+        sum += (sample < 0) ? 0 : (sample > 4095) ? 4095 : (uint32_t)sample;
+    }
+    adc.adc_seconds += ratio * (adc.sampling[rank] / 10.0 + 12.5) / ADC_CLK_HZ;
+
+    if (adc.config.OversamplingMode) {
+        sum >>= adc.config.Oversampling.RightBitShift;
+    }
+    return sum;
+}
+
+static int sequence_length(void)
+{
+    return adc.config.ScanConvMode ? (int)adc.config.NbrOfConversion : 1;
+}
+
+HAL_StatusTypeDef HAL_ADC_Init(ADC_HandleTypeDef *hadc)
+{
+    if (hadc->Instance != adc.regs) {
+        return HAL_ERROR;
+    }
+    adc.config = hadc->Init;
+    adc.inits++;
+    return HAL_OK;
+}
+
+uint32_t HAL_ADCEx_Calibration_GetValue(ADC_HandleTypeDef *hadc, uint32_t SingleDiff)
+{
+    (void)hadc;
+    (void)SingleDiff;
+    return adc.calibrated;
+}
+
+HAL_StatusTypeDef HAL_ADCEx_Calibration_Start(ADC_HandleTypeDef *hadc, uint32_t SingleDiff)
+{
+    (void)hadc;
+    (void)SingleDiff;
+    adc.calibrated++;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_ConfigChannel(ADC_HandleTypeDef *hadc, ADC_ChannelConfTypeDef *sConfig)
+{
+    (void)hadc;
+    adc.sequence[sConfig->Rank] = sConfig->Channel;
+    adc.sampling[sConfig->Rank] = sConfig->SamplingTime;
+    adc.config_channels++;
+    adc.cpu_cycles += CYCLES_CONFIG_CHANNEL;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_Start(ADC_HandleTypeDef *hadc)
+{
+    hadc->Instance->CR |= ADC_CR_ADSTART;
+    adc.rank = 1;
+    adc.starts++;
+    adc.cpu_cycles += CYCLES_START;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_PollForConversion(ADC_HandleTypeDef *hadc, uint32_t Timeout)
+{
+    double adc_seconds = adc.adc_seconds;
+
+    (void)Timeout;
+    if (sequence_length() > 1) {
+        adc.polls_in_scan++;
+    }
+    hadc->Instance->DR = adc_convert(adc.rank);
+    hadc->Instance->ISR |= ADC_FLAG_EOC | ADC_FLAG_EOS;
+    hadc->Instance->CR &= ~ADC_CR_ADSTART;
+    adc.polls++;
+    // The CPU spins for the whole conversion
+    adc.cpu_cycles += CYCLES_POLL + (adc.adc_seconds - adc_seconds) * SYSCLK_HZ;
+    return HAL_OK;
+}
+
+uint32_t HAL_ADC_GetValue(ADC_HandleTypeDef *hadc)
+{
+    hadc->Instance->ISR &= ~ADC_FLAG_EOC;
+    adc.cpu_cycles += CYCLES_GET_VALUE;
+    return hadc->Instance->DR;
+}
+
+HAL_StatusTypeDef HAL_ADC_Start_IT(ADC_HandleTypeDef *hadc)
+{
+    if (hadc->Instance->CR & ADC_CR_ADSTART) {
+        return HAL_BUSY;
+    }
+    hadc->Instance->ISR &= ~(ADC_FLAG_EOC | ADC_FLAG_EOS);
+    hadc->Instance->IER = ADC_FLAG_EOC;
+    hadc->Instance->CR |= ADC_CR_ADSTART;
+    adc.running = 1;
+    adc.rank = 1;
+    adc.starts_it++;
+    adc.cpu_cycles += CYCLES_START_IT;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_Stop_IT(ADC_HandleTypeDef *hadc)
+{
+    hadc->Instance->IER = 0;
+    hadc->Instance->CR &= ~ADC_CR_ADSTART;
+    adc.running = 0;
+    adc.stops_it++;
+    return HAL_OK;
+}
+
+void HAL_ADC_IRQHandler(ADC_HandleTypeDef *hadc)
+{
+    uint32_t isr = hadc->Instance->ISR;
+    uint32_t ier = hadc->Instance->IER;
+
+    // Like the HAL, the EOC and EOS interrupts are disabled at the end of a software started sequence
+    if (((isr & ADC_FLAG_EOC) && (ier & ADC_FLAG_EOC)) || ((isr & ADC_FLAG_EOS) && (ier & ADC_FLAG_EOS))) {
+        if (isr & ADC_FLAG_EOS) {
+            hadc->Instance->IER &= ~(ADC_FLAG_EOC | ADC_FLAG_EOS);
+        }
+        HAL_ADC_ConvCpltCallback(hadc);
+        hadc->Instance->ISR &= ~(ADC_FLAG_EOC | ADC_FLAG_EOS);
+    }
+}
+
+void NVIC_SetVector(IRQn_Type IRQn, uint32_t vector)
+{
+    (void)IRQn;
+    adc.vector = vector;
+}
+
+void NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+    (void)IRQn;
+    adc.irq_enabled = 1;
+}
+
+/* Run the sequence started with HAL_ADC_Start_IT to its end */
+static void adc_run(void)
+{
+    while (adc.running) {
+        if (adc.regs->ISR & ADC_FLAG_EOC) {
+            if (adc.config.LowPowerAutoWait) {
+                // The ADC waits for the result to be read, it never comes
+                printf("ADC stalled at rank %d\n", adc.rank);
+                adc.running = 0;
+                break;
+            }
+            adc.overruns++;
+        }
+        adc.regs->DR = adc_convert(adc.rank);
+        adc.regs->ISR |= ADC_FLAG_EOC;
+        if (adc.rank == sequence_length()) {
+            adc.regs->ISR |= ADC_FLAG_EOS;
+            adc.regs->CR &= ~ADC_CR_ADSTART;
+            adc.running = 0;
+        }
+        adc.rank++;
+
+        if (adc.irq_enabled && (adc.regs->IER & ADC_FLAG_EOC) && adc.vector) {
+            adc.irqs++;
+            adc.cpu_cycles += CYCLES_IRQ;
+            ((void (*)(void))(uintptr_t)adc.vector)();
+        }
+    }
+}
+
+/* mbed stand-ins */
+
+const PinMap PinMap_ADC[] = {
+    {PA_0, ADC1_BASE, 5 << 16},
+    {PA_1, ADC1_BASE, 6 << 16},
+    {PC_0, ADC1_BASE, 1 << 16},
+    {NC, NC, 0}
+};
+
+const PinMap PinMap_ADC_Internal[] = {
+    {ADC_TEMP, ADC1_BASE, 17 << 16},
+    {ADC_VBAT, ADC1_BASE, 18 << 16},
+    {ADC_VREF, ADC1_BASE, 0 << 16},
+    {NC, NC, 0}
+};
+
+static const PinMap *pinmap_find(PinName pin, const PinMap *map)
+{
+    while (map->pin != NC) {
+        if (map->pin == pin) {
+            return map;
+        }
+        map++;
+    }
+    return map;
+}
+
+uint32_t pinmap_peripheral(PinName pin, const PinMap *map)
+{
+    return (uint32_t)pinmap_find(pin, map)->peripheral;
+}
+
+uint32_t pinmap_function(PinName pin, const PinMap *map)
+{
+    return (uint32_t)pinmap_find(pin, map)->function;
+}
+
+void pinmap_pinout(PinName pin, const PinMap *map)
+{
+    (void)pin;
+    (void)map;
+}
+
+void error(const char *format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    printf("\n");
+    exit(1);
+}
+
+void mbed_assert_internal(const char *expr, const char *file, int line)
+{
+    printf("assertion failed: %s, %s:%d\n", expr, file, line);
+    exit(1);
+}
+
+void core_util_critical_section_enter(void)
+{
+}
+
+void core_util_critical_section_exit(void)
+{
+}
+
+/* Group handler */
+
+static int handler_calls;
+static uint32_t handler_id;
+static int handler_error;
+
+static void group_handler(uint32_t id, int error)
+{
+    handler_calls++;
+    handler_id = id;
+    handler_error = error;
+}
+
+static uint16_t scale_12(uint32_t raw)
+{
+    return (uint16_t)((raw << 4) | (raw >> 8));
+}
+
+static void reset_counts(void)
+{
+    adc.inits = adc.config_channels = adc.starts = adc.polls = adc.polls_in_scan = 0;
+    adc.starts_it = adc.stops_it = adc.irqs = adc.overruns = 0;
+    adc.cpu_cycles = adc.adc_seconds = 0;
+    handler_calls = 0;
+}
+
+static void set_inputs(void)
+{
+    adc.input[5] = 1000;    // PA_0
+    adc.input[6] = 3000;    // PA_1
+    adc.input[18] = 1200;   // VBAT / 3
+    adc.input[17] = 950;    // temperature sensor
+    adc.input[0] = 1490;    // VREFINT
+}
+
+static void test_sequence(void)
+{
+    static const PinName pins[4] = {PA_0, ADC_VBAT, ADC_TEMP, ADC_VREF};
+    static const uint32_t channels[4] = {5, 18, 17, 0};
+    analogin_group_t group;
+    analogin_t ain;
+    uint16_t results[4];
+    int i;
+
+    reset_counts();
+    analogin_group_init(&group, pins, 4, 1);
+    CHECK(adc.config.ScanConvMode == ENABLE);
+    CHECK(adc.config.NbrOfConversion == 4);
+    CHECK(adc.config.LowPowerAutoWait == ENABLE);
+    CHECK(adc.config.OversamplingMode == DISABLE);
+    CHECK(adc.calibrated == 1);
+    for (i = 0; i < 4; i++) {
+        CHECK(adc.sequence[i + 1] == channels[i]);
+    }
+
+    // Repeated conversions use the sequence programmed once, without polling
+    reset_counts();
+    for (i = 0; i < 10; i++) {
+        memset(results, 0, sizeof(results));
+        CHECK(analogin_group_start(&group, results, group_handler, 0x1234) == 0);
+        adc_run();
+        CHECK(handler_calls == i + 1);
+        CHECK(handler_id == 0x1234);
+        CHECK(handler_error == 0);
+        CHECK(results[0] == scale_12(1000));
+        CHECK(results[1] == scale_12(1200));
+        CHECK(results[2] == scale_12(950));
+        CHECK(results[3] == scale_12(1490));
+    }
+    CHECK(adc.inits == 0);
+    CHECK(adc.config_channels == 0);
+    CHECK(adc.polls == 0);
+    CHECK(adc.starts_it == 10);
+    CHECK(adc.irqs == 40);
+    CHECK(adc.overruns == 0);
+
+    // A conversion in progress makes the ADC busy
+    CHECK(analogin_group_start(&group, results, group_handler, 0) == 0);
+    CHECK(analogin_group_start(&group, results, group_handler, 0) == -1);
+    adc_run();
+    CHECK(handler_calls == 11);
+
+    // An AnalogIn read replaces the sequence by its channel
+    reset_counts();
+    analogin_init(&ain, PA_1);
+    CHECK(adc.config.ScanConvMode == DISABLE);
+    CHECK(adc.calibrated == 1);
+    CHECK(analogin_read_u16(&ain) == scale_12(3000));
+    CHECK(adc.polls_in_scan == 0);
+
+    // then the group programs its sequence again
+    reset_counts();
+    CHECK(analogin_group_start(&group, results, group_handler, 0) == 0);
+    adc_run();
+    CHECK(adc.inits == 1);
+    CHECK(adc.config_channels == 4);
+    CHECK(results[0] == scale_12(1000));
+    CHECK(results[3] == scale_12(1490));
+
+    // and a read after a group conversion sets the ADC back for a single channel
+    reset_counts();
+    CHECK(analogin_read_u16(&ain) == scale_12(3000));
+    CHECK(adc.inits == 1);
+    CHECK(adc.polls_in_scan == 0);
+    reset_counts();
+    CHECK(analogin_read_u16(&ain) == scale_12(3000));
+    CHECK(adc.inits == 0);
+
+    analogin_group_free(&group);
+}
+
+static void test_oversampling(void)
+{
+    static const PinName pins[2] = {PA_0, ADC_VREF};
+    static const uint16_t ratios[4] = {2, 16, 32, 256};
+    static const uint32_t shifts[4] = {ADC_RIGHTBITSHIFT_NONE, ADC_RIGHTBITSHIFT_NONE, ADC_RIGHTBITSHIFT_1, ADC_RIGHTBITSHIFT_4};
+    analogin_group_t group;
+    uint16_t results[2];
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        analogin_group_init(&group, pins, 2, ratios[i]);
+        CHECK(adc.config.OversamplingMode == ENABLE);
+        CHECK(adc.config.Oversampling.Ratio == ratios[i]);
+        CHECK(adc.config.Oversampling.RightBitShift == shifts[i]);
+
+        CHECK(analogin_group_start(&group, results, group_handler, 0) == 0);
+        adc_run();
+        CHECK(handler_error == 0);
+        if (ratios[i] == 2) {
+            // 13-bit sums, scaled to 16 bits
+            CHECK(results[0] == (uint16_t)((2000 << 3) | (2000 >> 10)));
+        } else {
+            // 16-bit sums or shifted sums
+            CHECK(results[0] == 16000);
+            CHECK(results[1] == 1490 * 16);
+        }
+        analogin_group_free(&group);
+    }
+}
+
+static void test_groups(void)
+{
+    static const PinName pins_a[1] = {PA_0};
+    static const PinName pins_b[2] = {ADC_VREF, ADC_TEMP};
+    analogin_group_t a, b;
+    uint16_t results_a[1], results_b[2];
+
+    analogin_group_init(&a, pins_a, 1, 1);
+    analogin_group_init(&b, pins_b, 2, 4);
+
+    // Groups sharing the ADC program their own sequence
+    reset_counts();
+    CHECK(analogin_group_start(&a, results_a, group_handler, 1) == 0);
+    CHECK(analogin_group_start(&b, results_b, group_handler, 2) == -1);
+    adc_run();
+    CHECK(handler_id == 1);
+    CHECK(adc.inits == 1);
+    CHECK(results_a[0] == scale_12(1000));
+
+    CHECK(analogin_group_start(&b, results_b, group_handler, 2) == 0);
+    adc_run();
+    CHECK(handler_id == 2);
+    CHECK(adc.inits == 2);
+    CHECK(results_b[0] == (uint16_t)((1490 * 4 << 2) | (1490 * 4 >> 12)));
+
+    // Freeing a group being converted stops the ADC
+    reset_counts();
+    CHECK(analogin_group_start(&a, results_a, group_handler, 1) == 0);
+    analogin_group_free(&a);
+    CHECK(adc.stops_it == 1);
+    CHECK(handler_calls == 0);
+    CHECK(analogin_group_start(&b, results_b, group_handler, 2) == 0);
+    adc_run();
+    CHECK(handler_calls == 1);
+    CHECK(handler_id == 2);
+
+    analogin_group_free(&b);
+}
+
+/* CPU time and noise of an averaged reading of VBAT, the temperature and VREFINT */
+static void report_costs(void)
+{
+    static const PinName pins[3] = {ADC_VBAT, ADC_TEMP, ADC_VREF};
+    static const int ratios[3] = {1, 16, 256};
+    analogin_t ain[3];
+    analogin_group_t group;
+    uint16_t results[3];
+    int r, i, j, k;
+
+    adc.noise = 3;
+    printf("3 channels, %-4s  %12s  %12s  %11s  %9s\n", "avg", "CPU busy us", "ADC time us", "interrupts", "VBAT sd");
+
+    for (r = 0; r < 3; r++) {
+        double sum = 0, sum2 = 0;
+
+        // AnalogIn, averaged by the application
+        for (i = 0; i < 3; i++) {
+            analogin_init(&ain[i], pins[i]);
+        }
+        reset_counts();
+        for (k = 0; k < 100; k++) {
+            uint32_t vbat = 0;
+
+            for (i = 0; i < 3; i++) {
+                for (j = 0; j < ratios[r]; j++) {
+                    uint32_t value = analogin_read_u16(&ain[i]);
+
+                    if (i == 0) {
+                        vbat += value;
+                    }
+                }
+            }
+            sum += (double)vbat / ratios[r];
+            sum2 += ((double)vbat / ratios[r]) * ((double)vbat / ratios[r]);
+        }
+        printf("AnalogIn    x%-4d  %12.1f  %12.1f  %11d  %9.1f\n", ratios[r],
+               adc.cpu_cycles / SYSCLK_HZ * 1e6 / 100, adc.adc_seconds * 1e6 / 100, 0,
+               sqrt(sum2 / 100 - (sum / 100) * (sum / 100)));
+
+        // Group, averaged by the oversampler
+        analogin_group_init(&group, pins, 3, ratios[r]);
+        reset_counts();
+        sum = sum2 = 0;
+        for (k = 0; k < 100; k++) {
+            analogin_group_start(&group, results, group_handler, 0);
+            adc_run();
+            sum += results[0];
+            sum2 += (double)results[0] * results[0];
+        }
+        CHECK(handler_calls == 100);
+        CHECK(adc.polls == 0);
+        printf("Group       x%-4d  %12.1f  %12.1f  %11d  %9.1f\n", ratios[r],
+               adc.cpu_cycles / SYSCLK_HZ * 1e6 / 100, adc.adc_seconds * 1e6 / 100, adc.irqs / 100,
+               sqrt(sum2 / 100 - (sum / 100) * (sum / 100)));
+        analogin_group_free(&group);
+    }
+    printf("CPU busy us: estimated HAL call cycles plus the polled conversions, per reading\n");
+    adc.noise = 0;
+}
+
+int main(void)
+{
+    // Map the ADC registers at the address of ADC1
+    adc.regs = mmap((void *)ADC1_BASE, 4096, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+    if (adc.regs != (ADC_TypeDef *)ADC1_BASE) {
+        printf("cannot map the ADC registers\n");
+        return 1;
+    }
+    set_inputs();
+
+    test_sequence();
+    test_oversampling();
+    test_groups();
+    report_costs();
+
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All tests passed\n");
+    return 0;
+}
@@ -0,0 +1,10 @@
+/* Host stand-in for the target PeripheralPins.h */
+#ifndef ANALOGIN_GROUP_TEST_PERIPHERALPINS_H
+#define ANALOGIN_GROUP_TEST_PERIPHERALPINS_H
+
+#include "pinmap.h"
+
+extern const PinMap PinMap_ADC[];
+extern const PinMap PinMap_ADC_Internal[];
+
+#endif
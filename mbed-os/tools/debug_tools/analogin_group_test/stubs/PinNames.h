@@ -0,0 +1,21 @@
+/* Host stand-in for the target PinNames.h */
+#ifndef ANALOGIN_GROUP_TEST_PINNAMES_H
+#define ANALOGIN_GROUP_TEST_PINNAMES_H
+
+typedef enum {
+    PA_0 = 0x00,
+    PA_1 = 0x01,
+    PC_0 = 0x20,
+    ADC_TEMP = 0xF0,
+    ADC_VREF = 0xF1,
+    ADC_VBAT = 0xF2,
+    NC = (int)0xFFFFFFFF
+} PinName;
+
+typedef enum {
+    PullNone = 0
+} PinMode;
+
+#define STM_PIN_CHANNEL(X)  (((X) >> 16) & 0x1F)
+
+#endif
@@ -0,0 +1,171 @@
+/* Host stand-in for the STM32L4 HAL definitions used by analogin_device.c */
+#ifndef ANALOGIN_GROUP_TEST_CMSIS_H
+#define ANALOGIN_GROUP_TEST_CMSIS_H
+
+#include <stdint.h>
+
+typedef enum {
+    HAL_OK = 0,
+    HAL_ERROR,
+    HAL_BUSY,
+    HAL_TIMEOUT
+} HAL_StatusTypeDef;
+
+typedef enum {
+    ADC1_IRQn = 18
+} IRQn_Type;
+
+typedef struct {
+    volatile uint32_t ISR;
+    volatile uint32_t IER;
+    volatile uint32_t CR;
+    volatile uint32_t DR;
+} ADC_TypeDef;
+
+typedef struct {
+    uint32_t Ratio;
+    uint32_t RightBitShift;
+    uint32_t TriggeredMode;
+    uint32_t OversamplingStopReset;
+} ADC_OversamplingTypeDef;
+
+typedef struct {
+    uint32_t ClockPrescaler;
+    uint32_t Resolution;
+    uint32_t DataAlign;
+    uint32_t ScanConvMode;
+    uint32_t EOCSelection;
+    uint32_t LowPowerAutoWait;
+    uint32_t ContinuousConvMode;
+    uint32_t NbrOfConversion;
+    uint32_t DiscontinuousConvMode;
+    uint32_t NbrOfDiscConversion;
+    uint32_t ExternalTrigConv;
+    uint32_t ExternalTrigConvEdge;
+    uint32_t DMAContinuousRequests;
+    uint32_t Overrun;
+    uint32_t OversamplingMode;
+    ADC_OversamplingTypeDef Oversampling;
+} ADC_InitTypeDef;
+
+typedef struct {
+    ADC_TypeDef *Instance;
+    ADC_InitTypeDef Init;
+    uint32_t State;
+} ADC_HandleTypeDef;
+
+typedef struct {
+    uint32_t Channel;
+    uint32_t Rank;
+    uint32_t SamplingTime;
+    uint32_t SingleDiff;
+    uint32_t OffsetNumber;
+    uint32_t Offset;
+} ADC_ChannelConfTypeDef;
+
+#define ADC1_BASE                           0x50040000UL
+
+#define DISABLE                             0
+#define ENABLE                              1
+
+#define HAL_ADC_STATE_RESET                 0
+#define ADC_CLOCK_ASYNC_DIV2                1
+#define ADC_RESOLUTION_12B                  0
+#define ADC_DATAALIGN_RIGHT                 0
+#define ADC_EOC_SINGLE_CONV                 4
+#define ADC_SOFTWARE_START                  0
+#define ADC_EXTERNALTRIGCONVEDGE_NONE       0
+#define ADC_OVR_DATA_OVERWRITTEN            1
+#define ADC_SINGLE_ENDED                    0
+#define ADC_OFFSET_NONE                     4
+#define RCC_ADCCLKSOURCE_SYSCLK             3
+
+/* Ranks, ratios, shifts and sampling times are stored as plain numbers for the ADC model */
+#define ADC_REGULAR_RANK_1                  1
+#define ADC_REGULAR_RANK_2                  2
+#define ADC_REGULAR_RANK_3                  3
+#define ADC_REGULAR_RANK_4                  4
+#define ADC_REGULAR_RANK_5                  5
+#define ADC_REGULAR_RANK_6                  6
+#define ADC_REGULAR_RANK_7                  7
+#define ADC_REGULAR_RANK_8                  8
+#define ADC_REGULAR_RANK_9                  9
+#define ADC_REGULAR_RANK_10                 10
+#define ADC_REGULAR_RANK_11                 11
+#define ADC_REGULAR_RANK_12                 12
+#define ADC_REGULAR_RANK_13                 13
+#define ADC_REGULAR_RANK_14                 14
+#define ADC_REGULAR_RANK_15                 15
+#define ADC_REGULAR_RANK_16                 16
+
+#define ADC_OVERSAMPLING_RATIO_2            2
+#define ADC_OVERSAMPLING_RATIO_4            4
+#define ADC_OVERSAMPLING_RATIO_8            8
+#define ADC_OVERSAMPLING_RATIO_16           16
+#define ADC_OVERSAMPLING_RATIO_32           32
+#define ADC_OVERSAMPLING_RATIO_64           64
+#define ADC_OVERSAMPLING_RATIO_128          128
+#define ADC_OVERSAMPLING_RATIO_256          256
+
+#define ADC_RIGHTBITSHIFT_NONE              0
+#define ADC_RIGHTBITSHIFT_1                 1
+#define ADC_RIGHTBITSHIFT_2                 2
+#define ADC_RIGHTBITSHIFT_3                 3
+#define ADC_RIGHTBITSHIFT_4                 4
+
+#define ADC_TRIGGEREDMODE_SINGLE_TRIGGER    0
+#define ADC_REGOVERSAMPLING_CONTINUED_MODE  0
+
+/* Sampling times in tenths of ADC clock cycles */
+#define ADC_SAMPLETIME_47CYCLES_5           475
+#define ADC_SAMPLETIME_247CYCLES_5          2475
+#define ADC_SAMPLETIME_640CYCLES_5          6405
+
+#define ADC_CHANNEL_VREFINT                 0
+#define ADC_CHANNEL_1                       1
+#define ADC_CHANNEL_2                       2
+#define ADC_CHANNEL_3                       3
+#define ADC_CHANNEL_4                       4
+#define ADC_CHANNEL_5                       5
+#define ADC_CHANNEL_6                       6
+#define ADC_CHANNEL_7                       7
+#define ADC_CHANNEL_8                       8
+#define ADC_CHANNEL_9                       9
+#define ADC_CHANNEL_10                      10
+#define ADC_CHANNEL_11                      11
+#define ADC_CHANNEL_12                      12
+#define ADC_CHANNEL_13                      13
+#define ADC_CHANNEL_14                      14
+#define ADC_CHANNEL_15                      15
+#define ADC_CHANNEL_16                      16
+#define ADC_CHANNEL_TEMPSENSOR              17
+#define ADC_CHANNEL_VBAT                    18
+
+#define ADC_FLAG_EOC                        (1UL << 2)
+#define ADC_FLAG_EOS                        (1UL << 3)
+#define ADC_CR_ADSTART                      (1UL << 2)
+
+#define __HAL_ADC_GET_FLAG(__HANDLE__, __FLAG__) \
+    ((((__HANDLE__)->Instance->ISR) & (__FLAG__)) == (__FLAG__))
+#define ADC_IS_CONVERSION_ONGOING_REGULAR(__HANDLE__) \
+    ((((__HANDLE__)->Instance->CR) & ADC_CR_ADSTART) == ADC_CR_ADSTART)
+
+#define __HAL_RCC_ADC_CLK_ENABLE()          do { } while (0)
+#define __HAL_RCC_ADC_CONFIG(__SOURCE__)    do { (void)(__SOURCE__); } while (0)
+
+HAL_StatusTypeDef HAL_ADC_Init(ADC_HandleTypeDef *hadc);
+HAL_StatusTypeDef HAL_ADC_ConfigChannel(ADC_HandleTypeDef *hadc, ADC_ChannelConfTypeDef *sConfig);
+HAL_StatusTypeDef HAL_ADC_Start(ADC_HandleTypeDef *hadc);
+HAL_StatusTypeDef HAL_ADC_PollForConversion(ADC_HandleTypeDef *hadc, uint32_t Timeout);
+HAL_StatusTypeDef HAL_ADC_Start_IT(ADC_HandleTypeDef *hadc);
+HAL_StatusTypeDef HAL_ADC_Stop_IT(ADC_HandleTypeDef *hadc);
+uint32_t HAL_ADC_GetValue(ADC_HandleTypeDef *hadc);
+void HAL_ADC_IRQHandler(ADC_HandleTypeDef *hadc);
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc);
+uint32_t HAL_ADCEx_Calibration_GetValue(ADC_HandleTypeDef *hadc, uint32_t SingleDiff);
+HAL_StatusTypeDef HAL_ADCEx_Calibration_Start(ADC_HandleTypeDef *hadc, uint32_t SingleDiff);
+
+void NVIC_SetVector(IRQn_Type IRQn, uint32_t vector);
+void NVIC_EnableIRQ(IRQn_Type IRQn);
+
+#endif
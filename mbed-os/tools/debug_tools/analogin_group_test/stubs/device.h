@@ -0,0 +1,29 @@
+/* Host stand-in for the target device.h, with the STM32L4 struct analogin_s and analogin_group_s */
+#ifndef ANALOGIN_GROUP_TEST_DEVICE_H
+#define ANALOGIN_GROUP_TEST_DEVICE_H
+
+#include <stdbool.h>
+#include "cmsis.h"
+#include "PinNames.h"
+
+struct analogin_s {
+    ADC_HandleTypeDef handle;
+    PinName pin;
+    uint8_t channel;
+};
+
+#define ANALOGIN_GROUP_MAX_CHANNELS     16
+#define ANALOGIN_GROUP_MAX_OVERSAMPLING 256
+
+struct analogin_group_s {
+    ADC_HandleTypeDef handle;
+    uint8_t channels[ANALOGIN_GROUP_MAX_CHANNELS];
+    uint8_t count;
+    uint8_t bits;
+    volatile uint8_t index;
+    uint16_t *results;
+    uint32_t handler;
+    uint32_t id;
+};
+
+#endif
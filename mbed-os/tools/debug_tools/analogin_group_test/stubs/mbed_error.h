@@ -0,0 +1,7 @@
+/* Host stand-in for mbed_error.h */
+#ifndef ANALOGIN_GROUP_TEST_MBED_ERROR_H
+#define ANALOGIN_GROUP_TEST_MBED_ERROR_H
+
+void error(const char *format, ...);
+
+#endif
@@ -0,0 +1,392 @@
+/* Host test of BusOut and BusIn against a mocked STM32 GPIO register file
+ *
+ * Built twice: with DEVICE_PORTOUT and DEVICE_PORTIN, the buses write and read
+ * whole GPIO ports through port_api.c, without them they use the loop over
+ * their DigitalOut and DigitalIn pins.
+ */
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "drivers/BusOut.h"
+#include "drivers/BusIn.h"
+#include "hal/pinmap.h"
+
+using namespace mbed;
+
+#if DEVICE_PORTOUT && DEVICE_PORTIN
+#define VARIANT "port"
+#else
+#define VARIANT "loop"
+#endif
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+/* GPIO register file */
+
+static GPIO_TypeDef gpio_ports[3];
+static uint32_t gpio_input[3];      // levels read from IDR
+
+static struct {
+    uint32_t loads;
+    uint32_t odr_loads;
+    uint32_t stores;
+    uint32_t changing_stores;       // stores changing at least one output
+    bool counting;
+} gpio_stats;
+
+gpio_reg::operator uint32_t() const
+{
+    if (gpio_stats.counting) {
+        gpio_stats.loads++;
+        if (role == GPIO_REG_ODR) {
+            gpio_stats.odr_loads++;
+        }
+    }
+    // Output pins read their own level
+    return (role == GPIO_REG_IDR) ? (gpio_input[port] | gpio_ports[port].ODR.value) : value;
+}
+
+gpio_reg &gpio_reg::operator=(uint32_t v)
+{
+    GPIO_TypeDef *gpio = &gpio_ports[port];
+    uint32_t odr = gpio->ODR.value;
+
+    switch (role) {
+        case GPIO_REG_ODR:
+            odr = v & 0xFFFF;
+            break;
+        case GPIO_REG_BSRR:
+            // Set bits win over reset bits
+            odr = (odr & ~(v >> 16)) | (v & 0xFFFF);
+            break;
+        case GPIO_REG_BRR:
+            odr &= ~(v & 0xFFFF);
+            break;
+        default:
+            break;
+    }
+    if (gpio_stats.counting) {
+        gpio_stats.stores++;
+        if (odr != gpio->ODR.value) {
+            gpio_stats.changing_stores++;
+        }
+    }
+    gpio->ODR.value = odr;
+    return *this;
+}
+
+static void gpio_reset(void)
+{
+    for (int p = 0; p < 3; p++) {
+        gpio_ports[p].IDR.role = GPIO_REG_IDR;
+        gpio_ports[p].ODR.role = GPIO_REG_ODR;
+        gpio_ports[p].BSRR.role = GPIO_REG_BSRR;
+        gpio_ports[p].BRR.role = GPIO_REG_BRR;
+        gpio_ports[p].IDR.port = gpio_ports[p].ODR.port = gpio_ports[p].BSRR.port = gpio_ports[p].BRR.port = p;
+        gpio_ports[p].ODR.value = 0;
+        gpio_input[p] = 0;
+    }
+}
+
+static void count_start(void)
+{
+    gpio_stats.loads = gpio_stats.odr_loads = gpio_stats.stores = gpio_stats.changing_stores = 0;
+    gpio_stats.counting = true;
+}
+
+static void count_stop(void)
+{
+    gpio_stats.counting = false;
+}
+
+static int pin_level(PinName pin)
+{
+    return (gpio_ports[STM_PORT(pin)].ODR.value >> STM_PIN(pin)) & 1;
+}
+
+static void set_input(PinName pin, int level)
+{
+    if (level) {
+        gpio_input[STM_PORT(pin)] |= 1 << STM_PIN(pin);
+    } else {
+        gpio_input[STM_PORT(pin)] &= ~(1 << STM_PIN(pin));
+    }
+}
+
+/* HAL stand-ins */
+
+static int pin_modes;
+
+GPIO_TypeDef *Set_GPIO_Clock(uint32_t port_idx)
+{
+    return &gpio_ports[port_idx];
+}
+
+static void gpio_setup(gpio_t *obj, PinName pin)
+{
+    GPIO_TypeDef *gpio = &gpio_ports[STM_PORT(pin)];
+
+    obj->pin = pin;
+    obj->mask = 1 << STM_PIN(pin);
+    obj->gpio = gpio;
+    obj->reg_in = &gpio->IDR;
+    obj->reg_set = &gpio->BSRR;
+    obj->reg_clr = &gpio->BRR;
+}
+
+extern "C" {
+
+void gpio_init_out(gpio_t *obj, PinName pin)
+{
+    gpio_setup(obj, pin);
+    gpio_write(obj, 0);
+}
+
+void gpio_init_out_ex(gpio_t *obj, PinName pin, int value)
+{
+    gpio_setup(obj, pin);
+    gpio_write(obj, value);
+}
+
+void gpio_init_in(gpio_t *obj, PinName pin)
+{
+    gpio_setup(obj, pin);
+}
+
+void gpio_init_in_ex(gpio_t *obj, PinName pin, PinMode mode)
+{
+    (void)mode;
+    gpio_setup(obj, pin);
+}
+
+void gpio_mode(gpio_t *obj, PinMode mode)
+{
+    (void)obj;
+    (void)mode;
+    pin_modes++;
+}
+
+void pin_function(PinName pin, int function)
+{
+    (void)pin;
+    (void)function;
+}
+
+void pin_mode(PinName pin, PinMode mode)
+{
+    (void)pin;
+    (void)mode;
+    pin_modes++;
+}
+
+void core_util_critical_section_enter(void)
+{
+}
+
+void core_util_critical_section_exit(void)
+{
+}
+
+void mbed_assert_internal(const char *expr, const char *file, int line)
+{
+    printf("assertion failed: %s, %s:%d\n", expr, file, line);
+    exit(1);
+}
+
+}
+
+void error(const char *format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    exit(1);
+}
+
+/* Tests */
+
+// 8 bits on PA_0 to PA_7
+static PinName bus8[16] = {PA_0, PA_1, PA_2, PA_3, PA_4, PA_5, PA_6, PA_7, NC, NC, NC, NC, NC, NC, NC, NC};
+
+// 16 bits on three ports, the last four out of order
+static PinName bus16[16] = {PB_8, PB_9, PB_10, PB_11, PB_12, PB_13, PB_14, PB_15,
+                            PC_0, PC_1, PC_2, PC_3, PA_15, PA_12, PA_9, PA_10};
+
+// Bits 1, 3 and 4 not connected
+static PinName bus_nc[16] = {PC_4, NC, PC_6, NC, NC, PC_9, PB_0, NC, NC, NC, NC, NC, NC, NC, NC, NC};
+
+static uint32_t next_value(uint32_t *state)
+{
+    *state = *state * 1103515245 + 12345;
+    return (*state >> 8) & 0xFFFF;
+}
+
+#if DEVICE_PORTOUT && DEVICE_PORTIN
+static int ports_used(PinName *pins)
+{
+    int used = 0;
+
+    for (int i = 0; i < 16; i++) {
+        if (pins[i] != NC) {
+            used |= 1 << STM_PORT(pins[i]);
+        }
+    }
+    return __builtin_popcount(used);
+}
+#endif
+
+static void test_bus_out(PinName *pins)
+{
+    BusOut bus(pins);
+    uint32_t state = 1;
+
+    // Pins of the ports outside the bus keep their level
+    gpio_ports[0].ODR.value |= 1 << 8;
+    gpio_ports[2].ODR.value |= 1 << 13;
+
+    for (int n = 0; n < 1000; n++) {
+        int value = next_value(&state);
+
+        count_start();
+        bus.write(value);
+        count_stop();
+
+        for (int i = 0; i < 16; i++) {
+            if (pins[i] != NC) {
+                CHECK(pin_level(pins[i]) == ((value >> i) & 1));
+            }
+        }
+        CHECK(((gpio_ports[0].ODR.value >> 8) & 1) == 1);
+        CHECK(((gpio_ports[2].ODR.value >> 13) & 1) == 1);
+        CHECK(bus.read() == (value & bus.mask()));
+        CHECK((int)bus == (value & bus.mask()));
+
+#if DEVICE_PORTOUT
+        // One store per port, without reading ODR back
+        CHECK(gpio_stats.stores == (uint32_t)ports_used(pins));
+        CHECK(gpio_stats.odr_loads == 0);
+#endif
+    }
+
+    // Bits can still be written one by one
+    bus = 0;
+    bus[0] = 1;
+    CHECK(bus.read() == 1);
+}
+
+static void test_bus_in(PinName *pins)
+{
+    BusIn bus(pins);
+    uint32_t state = 7;
+
+    for (int n = 0; n < 1000; n++) {
+        int value = next_value(&state);
+
+        for (int i = 0; i < 16; i++) {
+            if (pins[i] != NC) {
+                set_input(pins[i], (value >> i) & 1);
+            }
+        }
+        // Noise on the other pins
+        gpio_input[1] ^= 0x00F0;
+
+        count_start();
+        int read = bus.read();
+        count_stop();
+
+        CHECK(read == (value & bus.mask()));
+#if DEVICE_PORTIN
+        // One IDR read per port
+        CHECK(gpio_stats.loads == (uint32_t)ports_used(pins));
+#endif
+    }
+
+    pin_modes = 0;
+    bus.mode(PullUp);
+    CHECK(pin_modes == __builtin_popcount(bus.mask()));
+}
+
+static double write_ns(BusOut &bus)
+{
+    struct timespec start, end;
+    const int writes = 1000000;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int n = 0; n < writes; n++) {
+        bus.write(n);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / writes;
+}
+
+static double read_ns(BusIn &bus)
+{
+    struct timespec start, end;
+    const int reads = 1000000;
+    volatile int sink = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int n = 0; n < reads; n++) {
+        sink += bus.read();
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    (void)sink;
+    return ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / reads;
+}
+
+/* GPIO accesses and host time of a write and a read */
+static void report(const char *name, PinName *pins)
+{
+    BusOut out(pins);
+    BusIn in(pins);
+    uint32_t stores, changing, loads;
+
+    out.write(0);
+    count_start();
+    out.write(0xFFFF);
+    count_stop();
+    stores = gpio_stats.stores;
+    changing = gpio_stats.changing_stores;
+
+    count_start();
+    in.read();
+    count_stop();
+    loads = gpio_stats.loads;
+
+    printf("%s %-6s  %6u  %13u  %7.1f  %5u  %7.1f\n", VARIANT, name, stores, changing, write_ns(out), loads, read_ns(in));
+}
+
+int main(void)
+{
+    gpio_reset();
+    test_bus_out(bus8);
+    test_bus_out(bus16);
+    test_bus_out(bus_nc);
+    gpio_reset();
+    test_bus_in(bus8);
+    test_bus_in(bus16);
+    test_bus_in(bus_nc);
+
+    printf("             write:  stores  changing pins  host ns   read:  loads  host ns\n");
+    report("bus8", bus8);
+    report("bus16", bus16);
+    report("nc", bus_nc);
+
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All tests passed\n");
+    return 0;
+}
@@ -0,0 +1,5 @@
+/* Host stand-in for the target PeripheralNames.h */
+#ifndef BUS_PORT_TEST_PERIPHERALNAMES_H
+#define BUS_PORT_TEST_PERIPHERALNAMES_H
+
+#endif
@@ -0,0 +1,36 @@
+/* Host stand-in for the target PinNames.h, with the STM32 pin encoding */
+#ifndef BUS_PORT_TEST_PINNAMES_H
+#define BUS_PORT_TEST_PINNAMES_H
+
+#include <stdint.h>
+
+typedef enum {
+    PIN_INPUT,
+    PIN_OUTPUT
+} PinDirection;
+
+typedef enum {
+    PA_0 = 0x00, PA_1, PA_2, PA_3, PA_4, PA_5, PA_6, PA_7,
+    PA_8, PA_9, PA_10, PA_11, PA_12, PA_13, PA_14, PA_15,
+    PB_0 = 0x10, PB_1, PB_2, PB_3, PB_4, PB_5, PB_6, PB_7,
+    PB_8, PB_9, PB_10, PB_11, PB_12, PB_13, PB_14, PB_15,
+    PC_0 = 0x20, PC_1, PC_2, PC_3, PC_4, PC_5, PC_6, PC_7,
+    PC_8, PC_9, PC_10, PC_11, PC_12, PC_13, PC_14, PC_15,
+    NC = (int)0xFFFFFFFF
+} PinName;
+
+typedef enum {
+    PullNone = 0,
+    PullUp = 1,
+    PullDown = 2,
+    PullDefault = PullNone
+} PinMode;
+
+#define STM_PORT(X)                 (((uint32_t)(X) >> 4) & 0xF)
+#define STM_PIN(X)                  ((uint32_t)(X) & 0xF)
+#define STM_MODE_INPUT              0
+#define STM_MODE_OUTPUT_PP          1
+#define GPIO_NOPULL                 0
+#define STM_PIN_DATA(MODE, PUPD, AFNUM)  ((int)(((AFNUM) << 7) | ((PUPD) << 4) | (MODE)))
+
+#endif
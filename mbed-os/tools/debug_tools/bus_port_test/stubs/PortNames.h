@@ -0,0 +1,11 @@
+/* Host stand-in for targets/TARGET_STM/PortNames.h */
+#ifndef BUS_PORT_TEST_PORTNAMES_H
+#define BUS_PORT_TEST_PORTNAMES_H
+
+typedef enum {
+    PortA = 0,
+    PortB = 1,
+    PortC = 2
+} PortName;
+
+#endif
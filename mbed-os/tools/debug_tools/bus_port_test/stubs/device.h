@@ -0,0 +1,82 @@
+/* Host stand-in for the target device.h
+ *
+ * The GPIO registers are objects counting their accesses. A store to BSRR or
+ * BRR updates ODR like the STM32 GPIO, and IDR reads the levels set by the test.
+ */
+#ifndef BUS_PORT_TEST_DEVICE_H
+#define BUS_PORT_TEST_DEVICE_H
+
+#include <stdint.h>
+#include "PinNames.h"
+#include "PortNames.h"
+
+#define __IO
+
+enum {
+    GPIO_REG_IDR,
+    GPIO_REG_ODR,
+    GPIO_REG_BSRR,
+    GPIO_REG_BRR
+};
+
+struct gpio_reg {
+    uint32_t value;
+    int role;
+    int port;
+
+    operator uint32_t() const;
+    gpio_reg &operator=(uint32_t value);
+};
+
+typedef struct {
+    gpio_reg IDR;
+    gpio_reg ODR;
+    gpio_reg BSRR;
+    gpio_reg BRR;
+} GPIO_TypeDef;
+
+/* Copy of targets/TARGET_STM/gpio_object.h */
+typedef struct {
+    uint32_t mask;
+    gpio_reg *reg_in;
+    gpio_reg *reg_set;
+    gpio_reg *reg_clr;
+    PinName  pin;
+    GPIO_TypeDef *gpio;
+    uint32_t ll_pin;
+} gpio_t;
+
+extern "C" {
+
+static inline void gpio_write(gpio_t *obj, int value)
+{
+    if (value) {
+        *obj->reg_set = obj->mask;
+    } else {
+        *obj->reg_clr = obj->mask;
+    }
+}
+
+static inline int gpio_read(gpio_t *obj)
+{
+    return ((*obj->reg_in & obj->mask) ? 1 : 0);
+}
+
+static inline int gpio_is_connected(const gpio_t *obj)
+{
+    return obj->pin != (PinName)NC;
+}
+
+}
+
+/* Copy of the STM32L4 struct port_s */
+struct port_s {
+    PortName port;
+    uint32_t mask;
+    PinDirection direction;
+    __IO gpio_reg *reg_in;
+    __IO gpio_reg *reg_out;
+    __IO gpio_reg *reg_set;
+};
+
+#endif
@@ -0,0 +1,7 @@
+/* Host stand-in for mbed_error.h */
+#ifndef BUS_PORT_TEST_MBED_ERROR_H
+#define BUS_PORT_TEST_MBED_ERROR_H
+
+void error(const char *format, ...);
+
+#endif
@@ -0,0 +1,322 @@
+/* Host test of the Duration and TimePoint types of platform/Duration.h, and of
+ * the duration overloads of Timer and Ticker against a mocked us ticker
+ *
+ * Built as C++98, like the mbed profiles. With EXPECT_COMPILE_ERROR, it must
+ * fail to compile: a truncating conversion written without duration_cast.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "platform/Duration.h"
+#include "drivers/Timer.h"
+#include "drivers/Ticker.h"
+#include "drivers/Timeout.h"
+
+using namespace mbed;
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+#if EXPECT_COMPILE_ERROR
+static Milliseconds narrowing()
+{
+    return Microseconds(1500);
+}
+#endif
+
+/* Mocked us ticker */
+
+static ticker_data_t us_ticker_data;
+static us_timestamp_t ticker_now;
+
+static struct {
+    int inserted;
+    us_timestamp_t timestamp;
+    int removed;
+} ticker_events;
+
+extern "C" {
+
+const ticker_data_t *get_us_ticker_data(void)
+{
+    return &us_ticker_data;
+}
+
+us_timestamp_t ticker_read_us(const ticker_data_t *const ticker)
+{
+    (void)ticker;
+    return ticker_now;
+}
+
+void sleep_manager_lock_deep_sleep_internal(void)
+{
+}
+
+void sleep_manager_unlock_deep_sleep_internal(void)
+{
+}
+
+void core_util_critical_section_enter(void)
+{
+}
+
+void core_util_critical_section_exit(void)
+{
+}
+
+void mbed_assert_internal(const char *expr, const char *file, int line)
+{
+    printf("assertion failed: %s, %s:%d\n", expr, file, line);
+    exit(1);
+}
+
+}
+
+/* TimerEvent stand-ins, recording the event of the ticker */
+
+TimerEvent::TimerEvent() : event(), _ticker_data(get_us_ticker_data())
+{
+}
+
+TimerEvent::~TimerEvent()
+{
+}
+
+void TimerEvent::insert_absolute(us_timestamp_t timestamp)
+{
+    event.timestamp = timestamp;
+    ticker_events.inserted++;
+    ticker_events.timestamp = timestamp;
+}
+
+void TimerEvent::remove()
+{
+    ticker_events.removed++;
+}
+
+/* A Ticker firing its handler like the ticker interrupt would */
+class TestTicker : public Ticker {
+public:
+    void fire()
+    {
+        ticker_now = event.timestamp;
+        handler();
+    }
+};
+
+class TestTimeout : public Timeout {
+public:
+    void fire()
+    {
+        ticker_now = event.timestamp;
+        handler();
+    }
+};
+
+static int calls;
+
+static void count_call(void)
+{
+    calls++;
+}
+
+/* A clock for the time points, read from the mocked ticker */
+struct TestClock {
+    typedef Microseconds duration;
+    typedef TimePoint<TestClock> time_point;
+
+    static time_point now()
+    {
+        return time_point(Microseconds(ticker_now));
+    }
+};
+
+/* Tests */
+
+static void test_conversions(void)
+{
+    // Exact conversions to finer periods are implicit
+    Milliseconds ms = Seconds(3);
+    Microseconds us = ms;
+
+    CHECK(ms.count() == 3000);
+    CHECK(us.count() == 3000000);
+    CHECK(Microseconds(Seconds(-2)).count() == -2000000);
+    CHECK(Milliseconds().count() == 0);
+    CHECK(Seconds::zero().count() == 0);
+
+    // Coarser ones truncate toward zero
+    CHECK(duration_cast<Milliseconds>(Microseconds(1999)).count() == 1);
+    CHECK(duration_cast<Milliseconds>(Microseconds(-1999)).count() == -1);
+    CHECK(duration_cast<Seconds>(Milliseconds(59999)).count() == 59);
+    CHECK(duration_cast<Seconds>(Seconds(7)).count() == 7);
+    CHECK(duration_cast<Microseconds>(Seconds(5)).count() == 5000000);
+
+    // Periods that do not divide each other
+    typedef Duration<3000> Ticks3ms;
+    typedef Duration<2000> Ticks2ms;
+    CHECK(duration_cast<Ticks2ms>(Ticks3ms(5)).count() == 7);
+    CHECK((Ticks3ms(1) + Ticks2ms(1)).count() == 5);
+    CHECK((Ticks3ms(1) + Ticks2ms(1)) == Milliseconds(5));
+
+    // Periods are compile time constants
+    CHECK(Microseconds::period == 1);
+    CHECK(Milliseconds::period == 1000);
+    CHECK(Seconds::period == 1000000);
+}
+
+static void test_arithmetic(void)
+{
+    Milliseconds ms(1500);
+
+    // Mixed units compute in the finer one
+    CHECK((Seconds(2) + Milliseconds(500)).count() == 2500);
+    CHECK((Milliseconds(500) + Microseconds(1)).count() == 500001);
+    CHECK((Seconds(1) - Milliseconds(1500)).count() == -500);
+    CHECK((-Seconds(1)).count() == -1);
+
+    CHECK((ms * 3).count() == 4500);
+    CHECK((3 * ms).count() == 4500);
+    CHECK((ms / 4).count() == 375);
+    CHECK((Milliseconds(-7) / 2).count() == -3);
+    CHECK(Seconds(1) / Milliseconds(300) == 3);
+    CHECK((Seconds(1) % Milliseconds(300)).count() == 100);
+
+    ms += Seconds(1);
+    CHECK(ms.count() == 2500);
+    ms -= Milliseconds(500);
+    CHECK(ms.count() == 2000);
+    ms *= 2;
+    CHECK(ms.count() == 4000);
+    ms /= 3;
+    CHECK(ms.count() == 1333);
+
+    // Comparisons across units
+    CHECK(Seconds(1) == Milliseconds(1000));
+    CHECK(Seconds(1) != Microseconds(999999));
+    CHECK(Milliseconds(999) < Seconds(1));
+    CHECK(Seconds(1) > Microseconds(999999));
+    CHECK(Seconds(1) <= Milliseconds(1000));
+    CHECK(Milliseconds(1001) >= Seconds(1));
+    CHECK(Microseconds(-1) < Microseconds::zero());
+
+    // No wrap where 32 bits would: an int of microseconds wraps after 35 minutes, of milliseconds after 24 days
+    Microseconds hour = Seconds(3600);
+    CHECK(hour.count() == 3600000000LL);
+    CHECK((hour * 24 * 365).count() == 31536000000000LL);
+    CHECK(duration_cast<Milliseconds>(hour * 24 * 50).count() == 4320000000LL);
+    CHECK(hour + hour > hour);
+    CHECK(Microseconds::max().count() == 9223372036854775807LL);
+    CHECK(Microseconds::max() > Seconds(9000000000LL));
+}
+
+static void test_time_points(void)
+{
+    TestClock::time_point start, later;
+
+    ticker_now = 4000000000ULL;
+    start = TestClock::now();
+    CHECK(start.time_since_epoch() == Seconds(4000));
+
+    // Time points move by durations, coarser ones included
+    later = start + Seconds(10);
+    CHECK(later - start == Seconds(10));
+    CHECK(start - later == Seconds(-10));
+    CHECK((Milliseconds(5) + start).time_since_epoch().count() == 4000005000LL);
+    CHECK((later - Milliseconds(1)) < later);
+    CHECK(later > start);
+    CHECK(later >= later);
+    CHECK(start <= later);
+    CHECK(start != later);
+    later -= Seconds(10);
+    CHECK(later == start);
+    later += Microseconds(1);
+    CHECK(later - start == Microseconds(1));
+    CHECK(TestClock::time_point().time_since_epoch() == Microseconds::zero());
+}
+
+static void test_timer(void)
+{
+    ticker_now = 1000;
+    Timer timer;
+
+    timer.start();
+    ticker_now += 1234567;
+    CHECK(timer.elapsed_time() == Microseconds(1234567));
+    CHECK(timer.read_us() == 1234567);
+
+    // Past 2^31 us, read_us() wraps and elapsed_time() does not
+    ticker_now += 3600000000ULL;
+    CHECK(timer.elapsed_time() == Microseconds(3601234567LL));
+    CHECK(timer.read_us() != 3601234567LL);
+    CHECK(duration_cast<Seconds>(timer.elapsed_time()) == Seconds(3601));
+    // read() no longer goes through the wrapping read_us()
+    CHECK(timer.read() > 3601.0f && timer.read() < 3602.0f);
+
+    // Stopped slices add up
+    timer.stop();
+    ticker_now += 1000000;
+    CHECK(timer.elapsed_time() == Microseconds(3601234567LL));
+    timer.start();
+    ticker_now += 5;
+    CHECK(timer.elapsed_time() == Microseconds(3601234572LL));
+    timer.reset();
+    CHECK(timer.elapsed_time() == Microseconds::zero());
+}
+
+static void test_ticker(void)
+{
+    TestTicker ticker;
+    TestTimeout timeout;
+
+    ticker_now = 5000;
+    calls = 0;
+
+    ticker.attach(count_call, Milliseconds(250));
+    CHECK(ticker_events.timestamp == 5000 + 250000);
+    ticker.fire();
+    CHECK(calls == 1);
+    CHECK(ticker_events.timestamp == 5000 + 500000);
+
+    // Longer than 2^32 us, which the float seconds of attach() would round
+    ticker.attach(count_call, Seconds(5000) + Microseconds(1));
+    CHECK(ticker_events.timestamp == ticker_now + 5000000001ULL);
+    ticker.fire();
+    CHECK(calls == 2);
+    CHECK(ticker_events.timestamp == ticker_now + 5000000001ULL);
+
+    // The other overloads still resolve
+    ticker.attach(count_call, 2);
+    CHECK(ticker_events.timestamp == ticker_now + 2000000);
+    ticker.attach_us(count_call, 10);
+    CHECK(ticker_events.timestamp == ticker_now + 10);
+    ticker.detach();
+
+    // Timeout and LowPowerTicker inherit the overload
+    timeout.attach(count_call, Microseconds(42));
+    CHECK(ticker_events.timestamp == ticker_now + 42);
+    timeout.fire();
+    CHECK(calls == 3);
+}
+
+int main(void)
+{
+    test_conversions();
+    test_arithmetic();
+    test_time_points();
+    test_timer();
+    test_ticker();
+
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All tests passed\n");
+    return 0;
+}
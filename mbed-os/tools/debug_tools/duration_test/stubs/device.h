@@ -0,0 +1,11 @@
+/* Host stand-in for the target device.h, without peripherals */
+#ifndef DURATION_TEST_DEVICE_H
+#define DURATION_TEST_DEVICE_H
+
+#include <stdint.h>
+
+static inline void NVIC_SystemReset(void)
+{
+}
+
+#endif
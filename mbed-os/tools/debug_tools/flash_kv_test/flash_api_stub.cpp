@@ -0,0 +1,147 @@
+/* Flash HAL of the host, see flash_api_stub.h
+ *
+ * Programming follows the rules of the internal NOR flash: a double word can
+ * only be programmed once after an erase, otherwise the program fails as
+ * with the PROGERR flag of the STM32L4.
+ */
+#include <string.h>
+
+#include "hal/flash_api.h"
+#include "flash_api_stub.h"
+
+uint8_t flash_stub_memory[FLASH_STUB_SIZE];
+flash_stub_stats_t flash_stub_stats;
+
+static int program_countdown = -1;
+static int erase_countdown = -1;
+static bool powered_off;
+
+void flash_stub_reset(void)
+{
+    memset(flash_stub_memory, 0xFF, sizeof(flash_stub_memory));
+    flash_stub_clear_stats();
+    flash_stub_power_on();
+}
+
+void flash_stub_clear_stats(void)
+{
+    memset(&flash_stub_stats, 0, sizeof(flash_stub_stats));
+}
+
+void flash_stub_fail_program_after(int pages)
+{
+    program_countdown = pages;
+}
+
+void flash_stub_fail_erase_after(int sectors)
+{
+    erase_countdown = sectors;
+}
+
+void flash_stub_power_on(void)
+{
+    program_countdown = -1;
+    erase_countdown = -1;
+    powered_off = false;
+}
+
+static bool in_flash(uint32_t address, uint32_t size)
+{
+    return (address >= FLASH_STUB_START) && (size <= FLASH_STUB_SIZE) &&
+           (address - FLASH_STUB_START <= FLASH_STUB_SIZE - size);
+}
+
+int32_t flash_init(flash_t *obj)
+{
+    return 0;
+}
+
+int32_t flash_free(flash_t *obj)
+{
+    return 0;
+}
+
+int32_t flash_erase_sector(flash_t *obj, uint32_t address)
+{
+    if (powered_off || !in_flash(address, FLASH_STUB_SECTOR_SIZE) || (address % FLASH_STUB_SECTOR_SIZE)) {
+        return -1;
+    }
+
+    uint32_t sector = (address - FLASH_STUB_START) / FLASH_STUB_SECTOR_SIZE;
+    uint8_t *data = &flash_stub_memory[address - FLASH_STUB_START];
+    if (erase_countdown == 0) {
+        memset(data, 0xFF, FLASH_STUB_SECTOR_SIZE / 2);
+        powered_off = true;
+        return -1;
+    }
+    if (erase_countdown > 0) {
+        erase_countdown--;
+    }
+
+    memset(data, 0xFF, FLASH_STUB_SECTOR_SIZE);
+    flash_stub_stats.erases++;
+    flash_stub_stats.sector_erases[sector]++;
+    flash_stub_stats.time_us += FLASH_STUB_ERASE_US;
+    return 0;
+}
+
+int32_t flash_read(flash_t *obj, uint32_t address, uint8_t *data, uint32_t size)
+{
+    if (!in_flash(address, size)) {
+        return -1;
+    }
+    memcpy(data, &flash_stub_memory[address - FLASH_STUB_START], size);
+    flash_stub_stats.bytes_read += size;
+    return 0;
+}
+
+int32_t flash_program_page(flash_t *obj, uint32_t address, const uint8_t *data, uint32_t size)
+{
+    if (powered_off || !in_flash(address, size) || (address % FLASH_STUB_PAGE_SIZE) || (size % FLASH_STUB_PAGE_SIZE)) {
+        return -1;
+    }
+
+    for (uint32_t offset = 0; offset < size; offset += FLASH_STUB_PAGE_SIZE) {
+        uint8_t *page = &flash_stub_memory[address - FLASH_STUB_START + offset];
+
+        for (int i = 0; i < FLASH_STUB_PAGE_SIZE; i++) {
+            if (page[i] != 0xFF) {
+                flash_stub_stats.program_errors++;
+                return -1;
+            }
+        }
+        if (program_countdown == 0) {
+            memcpy(page, data + offset, FLASH_STUB_PAGE_SIZE / 2);
+            powered_off = true;
+            return -1;
+        }
+        if (program_countdown > 0) {
+            program_countdown--;
+        }
+
+        memcpy(page, data + offset, FLASH_STUB_PAGE_SIZE);
+        flash_stub_stats.programs++;
+        flash_stub_stats.time_us += FLASH_STUB_PROGRAM_US;
+    }
+    return 0;
+}
+
+uint32_t flash_get_sector_size(const flash_t *obj, uint32_t address)
+{
+    return in_flash(address, 1) ? FLASH_STUB_SECTOR_SIZE : MBED_FLASH_INVALID_SIZE;
+}
+
+uint32_t flash_get_page_size(const flash_t *obj)
+{
+    return FLASH_STUB_PAGE_SIZE;
+}
+
+uint32_t flash_get_start_address(const flash_t *obj)
+{
+    return FLASH_STUB_START;
+}
+
+uint32_t flash_get_size(const flash_t *obj)
+{
+    return FLASH_STUB_SIZE;
+}
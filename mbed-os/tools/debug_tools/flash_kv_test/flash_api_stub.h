@@ -0,0 +1,53 @@
+/* Flash HAL of the host, a byte array with the geometry and the typical
+ * timings of the STM32L443 internal flash
+ */
+#ifndef FLASH_API_STUB_H
+#define FLASH_API_STUB_H
+
+#include <stdint.h>
+
+#define FLASH_STUB_START        0x08000000
+#define FLASH_STUB_SIZE         (256 * 1024)
+#define FLASH_STUB_SECTOR_SIZE  2048
+#define FLASH_STUB_PAGE_SIZE    8           // Double word programming
+#define FLASH_STUB_SECTORS      (FLASH_STUB_SIZE / FLASH_STUB_SECTOR_SIZE)
+
+#define FLASH_STUB_ERASE_US     22020       // Page erase, typical of the datasheet
+#define FLASH_STUB_PROGRAM_US   82          // Double word program, typical of the datasheet
+
+typedef struct {
+    uint64_t time_us;                       // Time spent erasing and programming
+    uint32_t erases;
+    uint32_t programs;                      // Double words programmed
+    uint32_t program_errors;                // Programs of double words not erased
+    uint64_t bytes_read;
+    uint32_t sector_erases[FLASH_STUB_SECTORS];
+} flash_stub_stats_t;
+
+extern uint8_t flash_stub_memory[FLASH_STUB_SIZE];
+extern flash_stub_stats_t flash_stub_stats;
+
+/** Erase the whole flash and clear the counters */
+void flash_stub_reset(void);
+
+/** Clear the counters, keeping the flash content */
+void flash_stub_clear_stats(void);
+
+/** Make a program fail after the given number of double words, -1 for none
+ *
+ *  The failing double word is half programmed, as cut by a power loss, and
+ *  every program and erase fails afterwards until flash_stub_power_on().
+ */
+void flash_stub_fail_program_after(int pages);
+
+/** Make an erase fail after the given number of sectors, -1 for none
+ *
+ *  The failing sector is left half erased, as cut by a power loss, and every
+ *  program and erase fails afterwards until flash_stub_power_on().
+ */
+void flash_stub_fail_erase_after(int sectors);
+
+/** Restart after a power loss, the flash keeps its content */
+void flash_stub_power_on(void);
+
+#endif
@@ -0,0 +1,442 @@
+/* Host test of the key/value store of drivers/FlashKVStore.cpp
+ *
+ * FlashIAP and the store run on flash_api_stub.cpp, a RAM flash following
+ * the rules of the internal NOR flash, with erase and program timings and
+ * an erase counter per sector. Power losses are injected in the middle of
+ * programs and erases, then the store is initialized again from the flash.
+ * The write latency, boot scan and erases per 10k updates are then measured
+ * against a config block rewritten in place at each save.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "drivers/FlashKVStore.h"
+#include "flash_api_stub.h"
+
+using namespace mbed;
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+// The application image ends at MBED_APP_START + MBED_APP_SIZE, given in the Makefile
+#define KV_ADDRESS      (MBED_APP_START + MBED_APP_SIZE)
+
+void mbed_assert_internal(const char *expr, const char *file, int line)
+{
+    printf("%s:%d: assertion failed: %s\n", file, line, expr);
+    exit(1);
+}
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void)
+{
+    // xorshift32
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* Settings of a node, the first ones updated more often */
+#define KEY_COUNT   5
+static const char *const keys[KEY_COUNT] = {"interval", "data_rate", "tx_power", "app_key", "dev_eui"};
+static const uint32_t key_sizes[KEY_COUNT] = {4, 1, 1, 16, 8};
+
+typedef struct {
+    uint8_t value[KEY_COUNT][16];
+    bool present[KEY_COUNT];
+} shadow_t;
+
+static int pick_key(void)
+{
+    uint32_t r = rng() % 100;
+
+    return (r < 50) ? 0 : (r < 75) ? 1 : (r < 95) ? 2 : (r < 98) ? 3 : 4;
+}
+
+static void random_value(int key, uint8_t *value)
+{
+    for (uint32_t i = 0; i < key_sizes[key]; i++) {
+        value[i] = rng();
+    }
+}
+
+static bool matches(FlashKVStore &kv, const shadow_t &shadow)
+{
+    for (int k = 0; k < KEY_COUNT; k++) {
+        uint8_t value[16];
+        uint32_t size = 0;
+        int ret = kv.get(keys[k], value, sizeof(value), &size);
+
+        if (!shadow.present[k]) {
+            if (ret != FLASHKV_ERROR_NOT_FOUND) {
+                return false;
+            }
+        } else if ((ret != FLASHKV_ERROR_OK) || (size != key_sizes[k]) || memcmp(value, shadow.value[k], size)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void test_placement(void)
+{
+    flash_stub_reset();
+
+    // No address, given by the drivers.flash-kv-address option, is no store
+    {
+        FlashKVStore kv;
+        uint32_t value = 1;
+
+        CHECK(kv.init() == FLASHKV_ERROR_INVALID_ARGUMENT);
+        CHECK(kv.set("interval", &value, sizeof(value)) == FLASHKV_ERROR_NOT_INITIALIZED);
+    }
+
+    // Areas out of the flash, not aligned or in the application image
+    {
+        FlashKVStore before(FLASH_STUB_START - FLASH_STUB_SECTOR_SIZE);
+        FlashKVStore past(FLASH_STUB_START + FLASH_STUB_SIZE - FLASH_STUB_SECTOR_SIZE);
+        FlashKVStore unaligned(KV_ADDRESS + FLASH_STUB_PAGE_SIZE);
+        FlashKVStore odd_size(KV_ADDRESS, FLASH_STUB_SECTOR_SIZE + FLASH_STUB_PAGE_SIZE);
+        FlashKVStore too_large(KV_ADDRESS, (FLASH_STUB_START + FLASH_STUB_SIZE - KV_ADDRESS) / 2 + FLASH_STUB_SECTOR_SIZE);
+        FlashKVStore application(KV_ADDRESS - FLASH_STUB_SECTOR_SIZE);
+
+        CHECK(before.init() == FLASHKV_ERROR_INVALID_ARGUMENT);
+        CHECK(past.init() == FLASHKV_ERROR_INVALID_ARGUMENT);
+        CHECK(unaligned.init() == FLASHKV_ERROR_INVALID_ARGUMENT);
+        CHECK(odd_size.init() == FLASHKV_ERROR_INVALID_ARGUMENT);
+        CHECK(too_large.init() == FLASHKV_ERROR_INVALID_ARGUMENT);
+        CHECK(application.init() == FLASHKV_ERROR_INVALID_ARGUMENT);
+    }
+
+    // Nothing was erased nor programmed
+    CHECK(flash_stub_stats.erases == 0 && flash_stub_stats.programs == 0);
+
+    // The last two sectors of the flash, past the application image
+    {
+        FlashKVStore kv(FLASH_STUB_START + FLASH_STUB_SIZE - 2 * FLASH_STUB_SECTOR_SIZE);
+
+        CHECK(kv.init() == FLASHKV_ERROR_OK);
+        CHECK(flash_stub_stats.sector_erases[FLASH_STUB_SECTORS - 2] == 1);
+    }
+}
+
+static void test_basic(void)
+{
+    uint8_t value[16];
+    uint32_t size, programs;
+
+    flash_stub_reset();
+    {
+        FlashKVStore kv(KV_ADDRESS);
+        uint32_t interval = 60;
+
+        CHECK(kv.init() == FLASHKV_ERROR_OK);
+        CHECK(kv.get_key_count() == 0);
+        CHECK(kv.get("interval", value, sizeof(value)) == FLASHKV_ERROR_NOT_FOUND);
+        CHECK(kv.set("interval", &interval, sizeof(interval)) == FLASHKV_ERROR_OK);
+        CHECK(kv.set("dev_eui", "\x01\x02\x03\x04\x05\x06\x07\x08", 8) == FLASHKV_ERROR_OK);
+        CHECK(kv.get_key_count() == 2);
+
+        // The same value is not written again
+        programs = flash_stub_stats.programs;
+        CHECK(kv.set("interval", &interval, sizeof(interval)) == FLASHKV_ERROR_OK);
+        CHECK(flash_stub_stats.programs == programs);
+        interval = 300;
+        CHECK(kv.set("interval", &interval, sizeof(interval)) == FLASHKV_ERROR_OK);
+        CHECK(flash_stub_stats.programs > programs);
+
+        // A value larger than the buffer is truncated
+        CHECK(kv.get("dev_eui", value, 3, &size) == FLASHKV_ERROR_OK);
+        CHECK(size == 8 && memcmp(value, "\x01\x02\x03", 3) == 0);
+
+        CHECK(kv.remove("dev_eui") == FLASHKV_ERROR_OK);
+        CHECK(kv.remove("dev_eui") == FLASHKV_ERROR_NOT_FOUND);
+        CHECK(kv.get_key_count() == 1);
+
+        // Invalid arguments
+        CHECK(kv.set("", value, 1) == FLASHKV_ERROR_INVALID_ARGUMENT);
+        CHECK(kv.set("a_key_longer_than_16", value, 1) == FLASHKV_ERROR_INVALID_ARGUMENT);
+        CHECK(kv.set("big", value, MBED_CONF_DRIVERS_FLASH_KV_MAX_DATA_SIZE + 1) == FLASHKV_ERROR_INVALID_ARGUMENT);
+        CHECK(kv.set("null", NULL, 1) == FLASHKV_ERROR_INVALID_ARGUMENT);
+    }
+
+    // The values come back from the flash at the next boot
+    {
+        FlashKVStore kv(KV_ADDRESS);
+        uint32_t interval = 0;
+
+        CHECK(kv.init() == FLASHKV_ERROR_OK);
+        CHECK(kv.get_key_count() == 1);
+        CHECK(kv.get("interval", &interval, sizeof(interval), &size) == FLASHKV_ERROR_OK);
+        CHECK(interval == 300 && size == 4);
+        CHECK(kv.get("dev_eui", value, sizeof(value)) == FLASHKV_ERROR_NOT_FOUND);
+
+        // The index is full at MBED_CONF_DRIVERS_FLASH_KV_MAX_KEYS keys
+        for (int i = 1; i < MBED_CONF_DRIVERS_FLASH_KV_MAX_KEYS; i++) {
+            char key[16];
+
+            snprintf(key, sizeof(key), "key%d", i);
+            CHECK(kv.set(key, &i, sizeof(i)) == FLASHKV_ERROR_OK);
+        }
+        CHECK(kv.set("one_more", value, 1) == FLASHKV_ERROR_FULL);
+        CHECK(kv.set("interval", value, 4) == FLASHKV_ERROR_OK);
+
+        CHECK(kv.reset() == FLASHKV_ERROR_OK);
+        CHECK(kv.get_key_count() == 0);
+    }
+    {
+        FlashKVStore kv(KV_ADDRESS);
+
+        CHECK(kv.init() == FLASHKV_ERROR_OK);
+        CHECK(kv.get_key_count() == 0);
+    }
+    CHECK(flash_stub_stats.program_errors == 0);
+}
+
+static void test_wear(void)
+{
+    const uint32_t first = (KV_ADDRESS - FLASH_STUB_START) / FLASH_STUB_SECTOR_SIZE;
+    shadow_t shadow;
+    int mismatches = 0;
+
+    flash_stub_reset();
+    memset(&shadow, 0, sizeof(shadow));
+    {
+        FlashKVStore kv(KV_ADDRESS);
+
+        CHECK(kv.init() == FLASHKV_ERROR_OK);
+        for (int i = 0; i < 10000; i++) {
+            int k = pick_key();
+
+            random_value(k, shadow.value[k]);
+            shadow.present[k] = true;
+            CHECK(kv.set(keys[k], shadow.value[k], key_sizes[k]) == FLASHKV_ERROR_OK);
+            if ((i % 97) == 0 && !matches(kv, shadow)) {
+                mismatches++;
+            }
+        }
+        CHECK(matches(kv, shadow));
+        CHECK(kv.get_erase_count() == flash_stub_stats.sector_erases[first + (flash_stub_stats.erases % 2 ? 0 : 1)]);
+    }
+    CHECK(mismatches == 0);
+
+    // The erases alternate between the two areas, and no other sector is erased
+    CHECK(flash_stub_stats.sector_erases[first] + flash_stub_stats.sector_erases[first + 1] == flash_stub_stats.erases);
+    CHECK(abs((int)flash_stub_stats.sector_erases[first] - (int)flash_stub_stats.sector_erases[first + 1]) <= 1);
+    CHECK(flash_stub_stats.program_errors == 0);
+
+    {
+        FlashKVStore kv(KV_ADDRESS);
+
+        CHECK(kv.init() == FLASHKV_ERROR_OK);
+        CHECK(matches(kv, shadow));
+    }
+}
+
+/* Cut the power during a run of updates, after the given number of double
+ * words programmed or sectors erased, then check at the next boot that every
+ * key holds its last value, or for the key being written its previous one. */
+static bool power_loss(int cut, bool erase, int *cuts)
+{
+    shadow_t shadow, previous;
+    bool ok = true;
+
+    flash_stub_reset();
+    memset(&shadow, 0, sizeof(shadow));
+    {
+        FlashKVStore kv(KV_ADDRESS);
+
+        kv.init();
+        for (int k = 0; k < KEY_COUNT; k++) {
+            random_value(k, shadow.value[k]);
+            shadow.present[k] = true;
+            kv.set(keys[k], shadow.value[k], key_sizes[k]);
+        }
+    }
+
+    previous = shadow;
+    if (erase) {
+        flash_stub_fail_erase_after(cut);
+    } else {
+        flash_stub_fail_program_after(cut);
+    }
+    {
+        FlashKVStore kv(KV_ADDRESS);
+
+        if (kv.init() != FLASHKV_ERROR_OK) {
+            (*cuts)++;
+        } else {
+            for (int i = 0; i < 800; i++) {
+                int k = pick_key();
+
+                previous = shadow;
+                random_value(k, shadow.value[k]);
+                if ((i % 50) == 49) {
+                    shadow.present[k] = false;
+                    if (kv.remove(keys[k]) != FLASHKV_ERROR_OK) {
+                        (*cuts)++;
+                        break;
+                    }
+                } else {
+                    shadow.present[k] = true;
+                    if (kv.set(keys[k], shadow.value[k], key_sizes[k]) != FLASHKV_ERROR_OK) {
+                        (*cuts)++;
+                        break;
+                    }
+                }
+                previous = shadow;
+            }
+        }
+    }
+
+    flash_stub_power_on();
+    {
+        FlashKVStore kv(KV_ADDRESS);
+        uint32_t interval = 1234, read = 0;
+
+        ok = (kv.init() == FLASHKV_ERROR_OK) && (matches(kv, shadow) || matches(kv, previous));
+
+        // The store goes on after the power loss
+        ok = ok && (kv.set("interval", &interval, sizeof(interval)) == FLASHKV_ERROR_OK) &&
+             (kv.get("interval", &read, sizeof(read)) == FLASHKV_ERROR_OK) && (read == interval);
+    }
+    return ok && (flash_stub_stats.program_errors == 0);
+}
+
+static void test_power_loss(void)
+{
+    int lost = 0, cuts = 0;
+
+    for (int cut = 0; cut < 1500; cut++) {
+        if (!power_loss(cut, false, &cuts)) {
+            if (lost++ < 5) {
+                printf("values lost after a program cut at %d\n", cut);
+            }
+        }
+    }
+    for (int cut = 0; cut < 4; cut++) {
+        if (!power_loss(cut, true, &cuts)) {
+            if (lost++ < 5) {
+                printf("values lost after an erase cut at %d\n", cut);
+            }
+        }
+    }
+    CHECK(lost == 0);
+
+    // The runs are long enough for every cut to happen, in records and in garbage collections
+    CHECK(cuts == 1500 + 4);
+}
+
+/* Benchmark */
+
+#define UPDATES 10000
+
+static void benchmark_store(const char *name, uint32_t area_size)
+{
+    uint64_t max_us = 0, scan_us = 0;
+    uint64_t scan_bytes = 0;
+    int scans = 0;
+    uint8_t value[16];
+
+    flash_stub_reset();
+    rng_state = 1;
+    {
+        FlashKVStore kv(KV_ADDRESS, area_size);
+
+        kv.init();
+        for (int k = 0; k < KEY_COUNT; k++) {
+            random_value(k, value);
+            kv.set(keys[k], value, key_sizes[k]);
+        }
+    }
+    flash_stub_clear_stats();
+
+    FlashKVStore *kv = new FlashKVStore(KV_ADDRESS, area_size);
+    kv->init();
+    for (int i = 0; i < UPDATES; i++) {
+        int k = pick_key();
+        uint64_t start = flash_stub_stats.time_us;
+
+        random_value(k, value);
+        kv->set(keys[k], value, key_sizes[k]);
+        if (flash_stub_stats.time_us - start > max_us) {
+            max_us = flash_stub_stats.time_us - start;
+        }
+
+        // Boot scans along the way, at every fill of the area
+        if ((i % 250) == 0) {
+            uint64_t bytes = flash_stub_stats.bytes_read;
+            uint64_t start_us = now_us();
+
+            delete kv;
+            kv = new FlashKVStore(KV_ADDRESS, area_size);
+            kv->init();
+            scan_us += now_us() - start_us;
+            scan_bytes = (flash_stub_stats.bytes_read - bytes > scan_bytes) ? flash_stub_stats.bytes_read - bytes : scan_bytes;
+            scans++;
+        }
+    }
+    delete kv;
+
+    printf("%-26s %9u %12.0f %12.0f %12.1f %12u\n", name, (unsigned)flash_stub_stats.erases,
+           (double)flash_stub_stats.time_us / UPDATES, (double)max_us, (double)scan_us / scans, (unsigned)scan_bytes);
+}
+
+static void benchmark(void)
+{
+    uint32_t block = 0;
+
+    for (int k = 0; k < KEY_COUNT; k++) {
+        block += key_sizes[k];
+    }
+    block = (block + FLASH_STUB_PAGE_SIZE - 1) / FLASH_STUB_PAGE_SIZE * FLASH_STUB_PAGE_SIZE;
+
+    printf("\n%d updates of %d keys, %d byte sectors\n", UPDATES, KEY_COUNT, FLASH_STUB_SECTOR_SIZE);
+    printf("%-26s %9s %12s %12s %12s %12s\n", "", "erases", "mean us", "max us", "scan host us", "scan bytes");
+
+    // The config block erased and programmed at each save
+    printf("%-26s %9u %12u %12u %12s %12s\n", "block rewritten in place", UPDATES,
+           FLASH_STUB_ERASE_US + block / FLASH_STUB_PAGE_SIZE * FLASH_STUB_PROGRAM_US,
+           FLASH_STUB_ERASE_US + block / FLASH_STUB_PAGE_SIZE * FLASH_STUB_PROGRAM_US, "-", "-");
+
+    for (uint32_t sectors = 1; sectors <= 4; sectors *= 2) {
+        char name[32];
+
+        snprintf(name, sizeof(name), "FlashKVStore, %u sector areas", (unsigned)sectors);
+        benchmark_store(name, sectors * FLASH_STUB_SECTOR_SIZE);
+    }
+}
+
+int main(void)
+{
+    test_placement();
+    test_basic();
+    test_wear();
+    test_power_loss();
+
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All tests passed\n");
+    benchmark();
+    return 0;
+}
@@ -0,0 +1,11 @@
+/* Host stand-in for the target device.h, with the flash of flash_api_stub.cpp */
+#ifndef FLASH_KV_TEST_DEVICE_H
+#define FLASH_KV_TEST_DEVICE_H
+
+#include <stdint.h>
+
+struct flash_s {
+    uint32_t dummy;
+};
+
+#endif
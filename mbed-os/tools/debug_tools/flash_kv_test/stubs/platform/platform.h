@@ -0,0 +1,10 @@
+/* Host stand-in for platform/platform.h */
+#ifndef FLASH_KV_TEST_PLATFORM_H
+#define FLASH_KV_TEST_PLATFORM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "platform/mbed_toolchain.h"
+#include "device.h"
+
+#endif
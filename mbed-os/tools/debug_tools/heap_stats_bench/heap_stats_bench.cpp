@@ -0,0 +1,414 @@
+/* Host test and benchmark of the heap statistics of platform/mbed_alloc_wrappers.cpp
+ *
+ * The GCC wrappers are built with MBED_HEAP_STATS_ENABLED over a mock
+ * __real__malloc_r, a stack allocator per thread which costs a few cycles, so
+ * that the benchmark measures the cost of the statistics. The statistics are
+ * checked, then the malloc and free pairs are timed with the statistics off,
+ * under the mutex of the previous wrappers and with the atomic counters.
+ */
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+// The wrappers call malloc and free, sent to them by the --wrap of the target link
+extern "C" {
+    void * __wrap__malloc_r(struct _reent * r, size_t size);
+    void __wrap__free_r(struct _reent * r, void * ptr);
+}
+#define malloc(size)    __wrap__malloc_r(NULL, size)
+#define free(ptr)       __wrap__free_r(NULL, ptr)
+
+#include "../../../platform/mbed_alloc_wrappers.cpp"
+
+#undef malloc
+#undef free
+
+#include "locked_wrappers.h"
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+/* Mock allocator: blocks are taken from the top of an arena of the thread and
+ * the top goes down once the blocks above it are freed. */
+
+#define ARENA_SIZE      (64 * 1024)
+#define ARENA_BLOCKS    64
+
+struct mock_heap {
+    char *base;
+    size_t top;
+    int depth;
+    size_t tops[ARENA_BLOCKS];
+    bool freed[ARENA_BLOCKS];
+};
+
+static __thread mock_heap heap;
+
+uint32_t mbed_heap_size = ARENA_SIZE;
+
+extern "C" void * __real__malloc_r(struct _reent * r, size_t size)
+{
+    (void)r;
+    if (heap.base == NULL) {
+        heap.base = (char *)malloc(ARENA_SIZE);
+    }
+    size = (size + 7) & ~(size_t)7;
+    if (heap.depth == ARENA_BLOCKS || size > ARENA_SIZE - heap.top) {
+        return NULL;
+    }
+    heap.tops[heap.depth] = heap.top;
+    heap.freed[heap.depth] = false;
+    heap.depth++;
+    heap.top += size;
+    return heap.base + heap.tops[heap.depth - 1];
+}
+
+extern "C" void __real__free_r(struct _reent * r, void * ptr)
+{
+    (void)r;
+    if (ptr == NULL) {
+        return;
+    }
+    for (int i = heap.depth - 1; ; i--) {
+        if (i < 0) {
+            printf("free of %p, not allocated\n", ptr);
+            exit(1);
+        }
+        if (heap.base + heap.tops[i] == ptr && !heap.freed[i]) {
+            heap.freed[i] = true;
+            break;
+        }
+    }
+    while (heap.depth > 0 && heap.freed[heap.depth - 1]) {
+        heap.depth--;
+        heap.top = heap.tops[heap.depth];
+    }
+}
+
+extern "C" void * __real__realloc_r(struct _reent * r, void * ptr, size_t size)
+{
+    (void)r;
+    (void)ptr;
+    (void)size;
+    printf("__real__realloc_r called\n");
+    exit(1);
+}
+
+extern "C" void * __real__calloc_r(struct _reent * r, size_t nmemb, size_t size)
+{
+    (void)r;
+    (void)nmemb;
+    (void)size;
+    printf("__real__calloc_r called\n");
+    exit(1);
+}
+
+extern "C" void * __real__memalign_r(struct _reent * r, size_t alignment, size_t bytes)
+{
+    (void)r;
+    (void)alignment;
+    (void)bytes;
+    printf("__real__memalign_r called\n");
+    exit(1);
+}
+
+/* Host atomics, as implemented with exclusive accesses on the target */
+
+bool core_util_atomic_cas_u32(volatile uint32_t *ptr, uint32_t *expectedCurrentValue, uint32_t desiredValue)
+{
+    return __atomic_compare_exchange_n(ptr, expectedCurrentValue, desiredValue, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+uint32_t core_util_atomic_incr_u32(volatile uint32_t *valuePtr, uint32_t delta)
+{
+    return __atomic_add_fetch(valuePtr, delta, __ATOMIC_SEQ_CST);
+}
+
+uint32_t core_util_atomic_decr_u32(volatile uint32_t *valuePtr, uint32_t delta)
+{
+    return __atomic_sub_fetch(valuePtr, delta, __ATOMIC_SEQ_CST);
+}
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void)
+{
+    // xorshift32
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static uint64_t cycles(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+#endif
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static uint32_t live_count(const mbed_stats_heap_histogram_t *histogram)
+{
+    uint32_t count = 0;
+
+    for (int i = 0; i < MBED_STATS_HEAP_SIZE_CLASSES; i++) {
+        count += histogram->live_cnt[i];
+    }
+    return count;
+}
+
+static uint32_t total_count(const mbed_stats_heap_histogram_t *histogram)
+{
+    uint32_t count = 0;
+
+    for (int i = 0; i < MBED_STATS_HEAP_SIZE_CLASSES; i++) {
+        count += histogram->total_cnt[i];
+    }
+    return count;
+}
+
+static void test_stats(void)
+{
+    mbed_stats_heap_t stats;
+    mbed_stats_heap_histogram_t histogram;
+    void *a, *b, *c;
+
+    // Requested sizes are accounted, not the rounded sizes of the allocator
+    a = __wrap__malloc_r(NULL, 100);
+    CHECK(a != NULL);
+    mbed_stats_heap_get(&stats);
+    CHECK(stats.current_size == 100);
+    CHECK(stats.max_size == 100);
+    CHECK(stats.total_size == 100);
+    CHECK(stats.alloc_cnt == 1);
+    CHECK(stats.reserved_size == ARENA_SIZE);
+    mbed_stats_heap_histogram_get(&histogram);
+    CHECK(histogram.live_cnt[6] == 1);
+    CHECK(histogram.total_cnt[6] == 1);
+    CHECK(live_count(&histogram) == 1);
+
+    // Realloc allocates the new block before it frees the old one
+    a = __wrap__realloc_r(NULL, a, 300);
+    CHECK(a != NULL);
+    mbed_stats_heap_get(&stats);
+    CHECK(stats.current_size == 300);
+    CHECK(stats.max_size == 400);
+    CHECK(stats.total_size == 400);
+    CHECK(stats.alloc_cnt == 1);
+    mbed_stats_heap_histogram_get(&histogram);
+    CHECK(histogram.live_cnt[6] == 0);
+    CHECK(histogram.live_cnt[8] == 1);
+    CHECK(histogram.total_cnt[8] == 1);
+
+    // Empty blocks in class 0, the largest ones in the last class
+    b = __wrap__malloc_r(NULL, 0);
+    c = __wrap__malloc_r(NULL, 40000);
+    CHECK(b != NULL && c != NULL);
+    mbed_stats_heap_histogram_get(&histogram);
+    CHECK(histogram.live_cnt[0] == 1);
+    CHECK(histogram.live_cnt[MBED_STATS_HEAP_SIZE_CLASSES - 1] == 1);
+    CHECK(live_count(&histogram) == 3);
+
+    // A failure is counted and changes nothing else
+    CHECK(__wrap__malloc_r(NULL, ARENA_SIZE) == NULL);
+    mbed_stats_heap_get(&stats);
+    CHECK(stats.alloc_fail_cnt == 1);
+    CHECK(stats.current_size == 40300);
+    CHECK(stats.alloc_cnt == 3);
+
+    __wrap__free_r(NULL, NULL);
+    __wrap__free_r(NULL, c);
+    __wrap__free_r(NULL, b);
+    __wrap__free_r(NULL, a);
+    mbed_stats_heap_get(&stats);
+    CHECK(stats.current_size == 0);
+    CHECK(stats.max_size == 40300);
+    CHECK(stats.total_size == 40400);
+    CHECK(stats.alloc_cnt == 0);
+    mbed_stats_heap_histogram_get(&histogram);
+    CHECK(live_count(&histogram) == 0);
+    CHECK(total_count(&histogram) == 4);
+    CHECK(heap.depth == 0);
+}
+
+/* Benchmark: each thread allocates batches of blocks of random sizes and frees
+ * them in the reverse order. */
+
+#define BATCH           8
+#define SIZES           1024
+#define PAIRS           2000000
+#define THREADS         4
+
+typedef void *(*malloc_func_t)(struct _reent *r, size_t size);
+typedef void (*free_func_t)(struct _reent *r, void *ptr);
+
+static const struct {
+    const char *name;
+    malloc_func_t malloc_func;
+    free_func_t free_func;
+} variants[] = {
+    {"stats off", __real__malloc_r, __real__free_r},
+    {"mutex", locked_malloc_wrapper, locked_free_wrapper},
+    {"atomics", __wrap__malloc_r, __wrap__free_r},
+};
+
+#define VARIANTS        (sizeof(variants) / sizeof(variants[0]))
+
+static uint32_t sizes[SIZES];
+
+struct bench_run {
+    int variant;
+    int pairs;
+    uint32_t size_sum;
+    int failed;
+};
+
+static void *bench_thread(void *arg)
+{
+    bench_run *run = (bench_run *)arg;
+    malloc_func_t malloc_func = variants[run->variant].malloc_func;
+    free_func_t free_func = variants[run->variant].free_func;
+    void *blocks[BATCH];
+    int next = 0;
+
+    run->size_sum = 0;
+    run->failed = 0;
+    for (int i = 0; i < run->pairs; i += BATCH) {
+        for (int j = 0; j < BATCH; j++) {
+            uint32_t size = sizes[next++ % SIZES];
+
+            blocks[j] = malloc_func(NULL, size);
+            run->failed += (blocks[j] == NULL);
+            run->size_sum += size;
+        }
+        for (int j = BATCH - 1; j >= 0; j--) {
+            free_func(NULL, blocks[j]);
+        }
+    }
+    return NULL;
+}
+
+static double bench_cycles(int variant)
+{
+    bench_run run = {variant, PAIRS / 4, 0, 0};
+    uint64_t start = cycles();
+
+    bench_thread(&run);
+    return (double)(cycles() - start) / run.pairs;
+}
+
+static double bench_threads(int variant, int threads)
+{
+    pthread_t ids[THREADS];
+    bench_run runs[THREADS];
+    mbed_stats_heap_t before, after;
+    mbed_stats_heap_histogram_t histogram_before, histogram_after;
+    uint32_t size_sum = 0;
+    uint64_t start;
+    double ns;
+
+    if (variant == 1) {
+        locked_stats_heap_get(&before);
+    } else {
+        mbed_stats_heap_get(&before);
+    }
+    mbed_stats_heap_histogram_get(&histogram_before);
+
+    start = now_ns();
+    for (int i = 0; i < threads; i++) {
+        runs[i].variant = variant;
+        runs[i].pairs = PAIRS / threads;
+        pthread_create(&ids[i], NULL, bench_thread, &runs[i]);
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_join(ids[i], NULL);
+        CHECK(runs[i].failed == 0);
+        size_sum += runs[i].size_sum;
+    }
+    ns = (double)(now_ns() - start) / PAIRS;
+
+    // Concurrent updates are not lost
+    if (variant == 1) {
+        locked_stats_heap_get(&after);
+    } else {
+        mbed_stats_heap_get(&after);
+    }
+    mbed_stats_heap_histogram_get(&histogram_after);
+    if (variant != 0) {
+        CHECK(after.current_size == before.current_size);
+        CHECK(after.alloc_cnt == before.alloc_cnt);
+        CHECK(after.total_size - before.total_size == size_sum);
+    }
+    if (variant == 2) {
+        CHECK(live_count(&histogram_after) == live_count(&histogram_before));
+        CHECK(total_count(&histogram_after) - total_count(&histogram_before) == (uint32_t)PAIRS);
+    }
+    return ns;
+}
+
+static void benchmark(void)
+{
+    // Mostly small blocks, as allocated by the drivers and the network stacks
+    for (int i = 0; i < SIZES; i++) {
+        sizes[i] = 4 + rng() % (8u << (rng() % 7));
+    }
+
+    printf("\nmalloc and free pair, %s\n", (sizeof(void *) == 4) ? "32-bit host" : "64-bit host");
+    printf("%-10s %8s %16s %16s\n", "stats", "cycles", "ns, 1 thread", "ns, 4 threads");
+    for (unsigned v = 0; v < VARIANTS; v++) {
+        double c = 1e9, one = 1e9, four = 1e9;
+
+        // Warm up, then the best of 3 runs
+        bench_cycles(v);
+        for (int run = 0; run < 3; run++) {
+            double r;
+
+            r = bench_cycles(v);
+            c = (r < c) ? r : c;
+            r = bench_threads(v, 1);
+            one = (r < one) ? r : one;
+            r = bench_threads(v, THREADS);
+            four = (r < four) ? r : four;
+        }
+        printf("%-10s %8.1f %16.1f %16.1f\n", variants[v].name, c, one, four);
+    }
+}
+
+int main(void)
+{
+    test_stats();
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    benchmark();
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All tests passed\n");
+    return 0;
+}
@@ -0,0 +1,62 @@
+/* GCC heap statistics wrappers of mbed OS before the atomic counters
+ *
+ * malloc_wrapper and free_wrapper of platform/mbed_alloc_wrappers.cpp, which
+ * updated the statistics under malloc_stats_mutex, renamed to be linked with
+ * the current ones. A pthread mutex stands for the PlatformMutex.
+ */
+#include <pthread.h>
+#include <string.h>
+
+#include "locked_wrappers.h"
+
+/* Size must be a multiple of 8 to keep alignment */
+typedef struct {
+    uint32_t size;
+    uint32_t pad;
+} alloc_info_t;
+
+static pthread_mutex_t malloc_stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+static mbed_stats_heap_t heap_stats = {0, 0, 0, 0, 0};
+
+void locked_stats_heap_get(mbed_stats_heap_t *stats)
+{
+    pthread_mutex_lock(&malloc_stats_mutex);
+    memcpy(stats, &heap_stats, sizeof(mbed_stats_heap_t));
+    pthread_mutex_unlock(&malloc_stats_mutex);
+}
+
+void *locked_malloc_wrapper(struct _reent *r, size_t size)
+{
+    void *ptr = NULL;
+
+    pthread_mutex_lock(&malloc_stats_mutex);
+    alloc_info_t *alloc_info = (alloc_info_t*)__real__malloc_r(r, size + sizeof(alloc_info_t));
+    if (alloc_info != NULL) {
+        alloc_info->size = size;
+        ptr = (void*)(alloc_info + 1);
+        heap_stats.current_size += size;
+        heap_stats.total_size += size;
+        heap_stats.alloc_cnt += 1;
+        if (heap_stats.current_size > heap_stats.max_size) {
+            heap_stats.max_size = heap_stats.current_size;
+        }
+    } else {
+        heap_stats.alloc_fail_cnt += 1;
+    }
+    pthread_mutex_unlock(&malloc_stats_mutex);
+    return ptr;
+}
+
+void locked_free_wrapper(struct _reent *r, void *ptr)
+{
+    alloc_info_t *alloc_info = NULL;
+
+    pthread_mutex_lock(&malloc_stats_mutex);
+    if (ptr != NULL) {
+        alloc_info = ((alloc_info_t*)ptr) - 1;
+        heap_stats.current_size -= alloc_info->size;
+        heap_stats.alloc_cnt -= 1;
+    }
+    __real__free_r(r, (void*)alloc_info);
+    pthread_mutex_unlock(&malloc_stats_mutex);
+}
@@ -0,0 +1,18 @@
+/* GCC heap statistics wrappers of mbed OS before the atomic counters */
+#ifndef HEAP_STATS_BENCH_LOCKED_WRAPPERS_H
+#define HEAP_STATS_BENCH_LOCKED_WRAPPERS_H
+
+#include <stddef.h>
+
+#include "platform/mbed_stats.h"
+
+extern "C" {
+    void * __real__malloc_r(struct _reent * r, size_t size);
+    void __real__free_r(struct _reent * r, void * ptr);
+}
+
+void locked_stats_heap_get(mbed_stats_heap_t *stats);
+void *locked_malloc_wrapper(struct _reent *r, size_t size);
+void locked_free_wrapper(struct _reent *r, void *ptr);
+
+#endif
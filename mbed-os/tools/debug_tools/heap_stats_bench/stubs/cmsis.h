@@ -0,0 +1,12 @@
+/* Host stand-in for the target cmsis.h, with the intrinsic used by the heap statistics */
+#ifndef HEAP_STATS_BENCH_CMSIS_H
+#define HEAP_STATS_BENCH_CMSIS_H
+
+#include <stdint.h>
+
+static inline uint32_t __CLZ(uint32_t value)
+{
+    return (value != 0) ? __builtin_clz(value) : 32;
+}
+
+#endif
@@ -0,0 +1,5 @@
+/* Host stand-in for the target device.h, no device is needed by the heap statistics */
+#ifndef HEAP_STATS_BENCH_DEVICE_H
+#define HEAP_STATS_BENCH_DEVICE_H
+
+#endif
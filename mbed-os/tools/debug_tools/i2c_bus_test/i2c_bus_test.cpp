@@ -0,0 +1,456 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Host test of drivers/I2CBus.cpp.
+ *
+ * I2CBus is built against a simulated I2C bus: I2C::transfer computes the
+ * duration of the transfer at 100 kHz and calls the completion callback at
+ * its end, as the I2C interrupt would, from an event queue dispatching on a
+ * simulated time. The bus holds models of the devices of the WISE-1510
+ * sensor board:
+ * - an HDC1510 at 0x80, which starts a conversion when its register 0 is
+ *   written and does not acknowledge reads until the conversion ends.
+ * - an iAQ-Core at 0xB5, which returns 9 bytes on every read.
+ * - an EEPROM at 0xA0, read from the address written before.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "drivers/I2CBus.h"
+#include "platform/mbed_critical.h"
+
+using namespace mbed;
+
+#define BYTE_TIME_US            90      // 9 bits at 100 kHz
+#define HDC1510_ADDRESS         0x80
+#define HDC1510_CONVERSION_US   6500
+#define IAQ_ADDRESS             0xB5
+#define EEPROM_ADDRESS          0xA0
+
+static int failures;
+
+#define CHECK(cond)                                                                 \
+    do {                                                                            \
+        if (!(cond)) {                                                              \
+            printf("  %s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);       \
+            failures++;                                                             \
+        }                                                                           \
+    } while (0)
+
+static events::EventQueue queue;
+
+/* Platform */
+
+const ticker_data_t *get_us_ticker_data(void)
+{
+    return NULL;
+}
+
+us_timestamp_t ticker_read_us(const ticker_data_t *const ticker)
+{
+    (void)ticker;
+    return queue.now();
+}
+
+void core_util_critical_section_enter(void)
+{
+}
+
+void core_util_critical_section_exit(void)
+{
+}
+
+extern "C" void mbed_assert_internal(const char *expr, const char *file, int line)
+{
+    printf("assertion failed: %s, %s:%d\n", expr, file, line);
+    exit(1);
+}
+
+/* Bus model */
+
+struct transfer_record_t {
+    int address;
+    uint64_t start;
+    uint64_t end;
+    int event;
+};
+
+static std::vector<transfer_record_t> transfers;
+static int overlapping_transfers;
+static int unlocked_transfers;
+
+static uint64_t hdc1510_conversion_end;
+static bool hdc1510_converting;
+static uint8_t eeprom[256];
+static uint8_t eeprom_pointer;
+
+static int device_write(int address, const char *data, int length, uint64_t time)
+{
+    switch (address) {
+        case HDC1510_ADDRESS:
+            if ((length >= 1) && (data[0] == 0x00)) {
+                hdc1510_converting = true;
+                hdc1510_conversion_end = time + HDC1510_CONVERSION_US;
+            }
+            return 0;
+        case EEPROM_ADDRESS:
+            if (length >= 1) {
+                eeprom_pointer = data[0];
+            }
+            for (int i = 1; i < length; i++) {
+                eeprom[eeprom_pointer++] = data[i];
+            }
+            return 0;
+        default:
+            return I2C_EVENT_ERROR | I2C_EVENT_ERROR_NO_SLAVE;
+    }
+}
+
+static int device_read(int address, char *data, int length, uint64_t time)
+{
+    static const char iaq_data[9] = { 0x01, (char)0xC2, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7D };
+
+    switch (address) {
+        case HDC1510_ADDRESS:
+            if (hdc1510_converting && (time < hdc1510_conversion_end)) {
+                return I2C_EVENT_ERROR | I2C_EVENT_ERROR_NO_SLAVE;
+            }
+            hdc1510_converting = false;
+            for (int i = 0; i < length; i++) {
+                data[i] = (char)(0x60 + i);
+            }
+            return 0;
+        case IAQ_ADDRESS:
+            memcpy(data, iaq_data, (length < 9) ? length : 9);
+            return 0;
+        case EEPROM_ADDRESS:
+            for (int i = 0; i < length; i++) {
+                data[i] = eeprom[eeprom_pointer++];
+            }
+            return 0;
+        default:
+            return I2C_EVENT_ERROR | I2C_EVENT_ERROR_NO_SLAVE;
+    }
+}
+
+I2C::I2C() : lock_count(0), busy_count(0), active(false)
+{
+}
+
+void I2C::lock(void)
+{
+    lock_count++;
+}
+
+void I2C::unlock(void)
+{
+    lock_count--;
+}
+
+int I2C::transfer(int address, const char *tx_buffer, int tx_length, char *rx_buffer, int rx_length,
+                  const event_callback_t &callback, int event, bool repeated)
+{
+    (void)event;
+    (void)repeated;
+
+    if (busy_count > 0) {
+        busy_count--;
+        return -1;
+    }
+    if (active) {
+        overlapping_transfers++;
+    }
+    if (lock_count == 0) {
+        unlocked_transfers++;
+    }
+    active = true;
+
+    uint64_t start = queue.now();
+    uint64_t write_end = start + (tx_length ? (1 + tx_length) * BYTE_TIME_US : 0);
+    uint64_t end = write_end + (rx_length ? (1 + rx_length) * BYTE_TIME_US : 0);
+    event_callback_t done = callback;
+    I2C *i2c = this;
+
+    // The completion interrupt
+    queue.post_at(end, [ = ] {
+        int error = 0;
+        if (tx_length) {
+            error = device_write(address, tx_buffer, tx_length, write_end);
+        }
+        if (!error && rx_length) {
+            error = device_read(address, rx_buffer, rx_length, end);
+        }
+        int ev = error ? error : I2C_EVENT_TRANSFER_COMPLETE;
+        transfer_record_t record = { address, start, end, ev };
+        transfers.push_back(record);
+        i2c->active = false;
+        done.call(ev);
+    });
+    return 0;
+}
+
+/* Tests */
+
+struct result_t {
+    int event;
+    uint64_t time;
+    int calls;
+
+    void done(int ev)
+    {
+        event = ev;
+        time = queue.now();
+        calls++;
+    }
+};
+
+static void reset_model()
+{
+    transfers.clear();
+    overlapping_transfers = 0;
+    unlocked_transfers = 0;
+    hdc1510_converting = false;
+}
+
+static void test_delayed_read()
+{
+    I2C i2c;
+    I2CBus bus(i2c, &queue);
+    const char reg = 0x00;
+    char data[4] = { 0 };
+    I2CTransaction hdc1510(HDC1510_ADDRESS, &reg, 1, data, 4, 7);
+    result_t result = { 0, 0, 0 };
+    int locks_during_delay = -1;
+
+    printf("write, delay and read\n");
+    reset_model();
+    hdc1510.callback = callback(&result, &result_t::done);
+    uint64_t start = queue.now();
+
+    CHECK(bus.submit(&hdc1510) == 0);
+    CHECK(bus.submit(&hdc1510) == -1);
+    queue.post_at(start + 3000, [&] { locks_during_delay = i2c.lock_count; });
+    queue.dispatch();
+
+    CHECK(result.calls == 1);
+    CHECK(result.event == I2C_EVENT_TRANSFER_COMPLETE);
+    CHECK(data[0] == 0x60 && data[3] == 0x63);
+    CHECK(transfers.size() == 2);
+    CHECK(result.time == start + 2 * BYTE_TIME_US + 7000 + 5 * BYTE_TIME_US);
+    // The bus is released during the conversion
+    CHECK(locks_during_delay == 0);
+    CHECK(i2c.lock_count == 0);
+    CHECK(unlocked_transfers == 0);
+    CHECK(overlapping_transfers == 0);
+
+    // The transaction can be submitted again
+    CHECK(bus.submit(&hdc1510) == 0);
+    queue.dispatch();
+    CHECK(result.calls == 2);
+    CHECK(result.event == I2C_EVENT_TRANSFER_COMPLETE);
+
+    I2CBus::stats_t stats;
+    bus.get_stats(&stats);
+    CHECK(stats.transactions == 2);
+    CHECK(stats.transfers == 4);
+    CHECK(stats.errors == 0);
+    CHECK(stats.busy_time == 2 * 7 * BYTE_TIME_US);
+}
+
+static void test_short_delay()
+{
+    I2C i2c;
+    I2CBus bus(i2c, &queue);
+    const char reg = 0x00;
+    char data[4];
+    I2CTransaction hdc1510(HDC1510_ADDRESS, &reg, 1, data, 4, 3);
+    result_t result = { 0, 0, 0 };
+
+    printf("read before the end of the conversion\n");
+    reset_model();
+    hdc1510.callback = callback(&result, &result_t::done);
+
+    bus.submit(&hdc1510);
+    queue.dispatch();
+
+    CHECK(result.calls == 1);
+    CHECK(result.event & I2C_EVENT_ERROR_NO_SLAVE);
+
+    I2CBus::stats_t stats;
+    bus.get_stats(&stats);
+    CHECK(stats.transactions == 1);
+    CHECK(stats.errors == 1);
+    CHECK(i2c.lock_count == 0);
+}
+
+static void test_shared_bus()
+{
+    I2C i2c;
+    I2CBus bus(i2c, &queue);
+    const char reg = 0x00;
+    char hdc_data[4];
+    char iaq_data[9];
+    I2CTransaction hdc1510(HDC1510_ADDRESS, &reg, 1, hdc_data, 4, 7);
+    I2CTransaction iaq(IAQ_ADDRESS, NULL, 0, iaq_data, 9);
+    result_t hdc_result = { 0, 0, 0 };
+    result_t iaq_result = { 0, 0, 0 };
+
+    printf("transaction during the delay of another\n");
+    reset_model();
+    hdc1510.callback = callback(&hdc_result, &result_t::done);
+    iaq.callback = callback(&iaq_result, &result_t::done);
+    uint64_t start = queue.now();
+
+    bus.submit(&hdc1510);
+    bus.submit(&iaq);
+    queue.dispatch();
+
+    CHECK(hdc_result.event == I2C_EVENT_TRANSFER_COMPLETE);
+    CHECK(iaq_result.event == I2C_EVENT_TRANSFER_COMPLETE);
+    CHECK(iaq_data[0] == 0x01 && iaq_data[1] == (char)0xC2);
+    // The iAQ-Core is read back-to-back after the HDC1510 write, during the conversion
+    CHECK(transfers.size() == 3);
+    CHECK(transfers[1].address == IAQ_ADDRESS);
+    CHECK(transfers[1].start == transfers[0].end);
+    CHECK(iaq_result.time < hdc_result.time);
+    CHECK(hdc_result.time == start + 2 * BYTE_TIME_US + 7000 + 5 * BYTE_TIME_US);
+    CHECK(overlapping_transfers == 0);
+    CHECK(unlocked_transfers == 0);
+
+    I2CBus::stats_t stats;
+    bus.get_stats(&stats);
+    uint64_t busy = (2 + 10 + 5) * BYTE_TIME_US;
+    CHECK(stats.busy_time == busy);
+    CHECK(stats.elapsed == hdc_result.time - start);
+    CHECK(stats.utilization == (uint32_t)(busy * 1000 / stats.elapsed));
+}
+
+static void test_read_priority()
+{
+    I2C i2c;
+    I2CBus bus(i2c, &queue);
+    const char address = 0x10;
+    char eeprom_data[2];
+    char iaq_data[5][9];
+    I2CTransaction eeprom_read(EEPROM_ADDRESS, &address, 1, eeprom_data, 2, 1);
+    I2CTransaction iaq[5];
+
+    printf("read after the delay before queued transactions\n");
+    reset_model();
+    eeprom[0x10] = 0x12;
+    eeprom[0x11] = 0x34;
+
+    bus.submit(&eeprom_read);
+    for (int i = 0; i < 5; i++) {
+        iaq[i] = I2CTransaction(IAQ_ADDRESS, NULL, 0, iaq_data[i], 9);
+        bus.submit(&iaq[i]);
+    }
+    queue.dispatch();
+
+    // write, iAQ, iAQ (the delay expires during the second read), EEPROM read, iAQ x3
+    CHECK(transfers.size() == 7);
+    CHECK(transfers[0].address == EEPROM_ADDRESS);
+    CHECK(transfers[3].address == EEPROM_ADDRESS);
+    CHECK(eeprom_data[0] == 0x12 && eeprom_data[1] == 0x34);
+    for (size_t i = 1; i < transfers.size(); i++) {
+        CHECK(transfers[i].start == transfers[i - 1].end);
+    }
+}
+
+static void test_busy_retry()
+{
+    I2C i2c;
+    I2CBus bus(i2c, &queue);
+    char iaq_data[9];
+    I2CTransaction iaq(IAQ_ADDRESS, NULL, 0, iaq_data, 9);
+    result_t result = { 0, 0, 0 };
+
+    printf("retry while another transfer uses the peripheral\n");
+    reset_model();
+    iaq.callback = callback(&result, &result_t::done);
+    i2c.busy_count = 2;
+    uint64_t start = queue.now();
+
+    bus.submit(&iaq);
+    queue.dispatch();
+
+    CHECK(result.calls == 1);
+    CHECK(result.event == I2C_EVENT_TRANSFER_COMPLETE);
+    CHECK(result.time == start + 2000 + 10 * BYTE_TIME_US);
+    CHECK(i2c.lock_count == 0);
+}
+
+/* Sensor schedule of main.cpp: HDC1510 every second, iAQ-Core every 2 s */
+static void report_utilization()
+{
+    I2C i2c;
+    I2CBus bus(i2c, &queue);
+    const char reg = 0x00;
+    char hdc_data[4];
+    char iaq_data[9];
+    I2CTransaction hdc1510(HDC1510_ADDRESS, &reg, 1, hdc_data, 4, 7);
+    I2CTransaction iaq(IAQ_ADDRESS, NULL, 0, iaq_data, 9);
+    uint64_t start = queue.now();
+    int windows = 0;
+
+    reset_model();
+    for (int s = 0; s < 60; s++) {
+        queue.post_at(start + s * 1000000ULL, [&, s] {
+            bus.submit(&hdc1510);
+            if ((s % 2) == 0) {
+                bus.submit(&iaq);
+            }
+        });
+    }
+    queue.dispatch(start + 60000000ULL);
+
+    // Count the bursts of back-to-back transfers
+    for (size_t i = 0; i < transfers.size(); i++) {
+        if ((i == 0) || (transfers[i].start != transfers[i - 1].end)) {
+            windows++;
+        }
+    }
+
+    I2CBus::stats_t stats;
+    bus.get_stats(&stats);
+    printf("60 s of sensor reads: %lu transactions, %lu transfers in %d bursts, bus busy %lu us, "
+           "utilization %lu.%lu%%\n",
+           (unsigned long)stats.transactions, (unsigned long)stats.transfers, windows,
+           (unsigned long)stats.busy_time, (unsigned long)(stats.utilization / 10),
+           (unsigned long)(stats.utilization % 10));
+    CHECK(stats.transactions == 90);
+    CHECK(stats.errors == 0);
+}
+
+int main()
+{
+    test_delayed_read();
+    test_short_delay();
+    test_shared_bus();
+    test_read_priority();
+    test_busy_retry();
+    report_utilization();
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("all tests passed\n");
+    return 0;
+}
@@ -0,0 +1,33 @@
+/* Host stand-in for drivers/I2C.h, implemented by the bus model of the test */
+#ifndef I2C_BUS_TEST_I2C_H
+#define I2C_BUS_TEST_I2C_H
+
+#include "platform/platform.h"
+#include "platform/Callback.h"
+
+#define I2C_EVENT_ERROR               (1 << 1)
+#define I2C_EVENT_ERROR_NO_SLAVE      (1 << 2)
+#define I2C_EVENT_TRANSFER_COMPLETE   (1 << 3)
+#define I2C_EVENT_TRANSFER_EARLY_NACK (1 << 4)
+#define I2C_EVENT_ALL                 (I2C_EVENT_ERROR |  I2C_EVENT_TRANSFER_COMPLETE | I2C_EVENT_ERROR_NO_SLAVE | I2C_EVENT_TRANSFER_EARLY_NACK)
+
+namespace mbed {
+
+class I2C {
+public:
+    I2C();
+
+    virtual void lock(void);
+    virtual void unlock(void);
+
+    int transfer(int address, const char *tx_buffer, int tx_length, char *rx_buffer, int rx_length,
+                 const event_callback_t &callback, int event = I2C_EVENT_TRANSFER_COMPLETE, bool repeated = false);
+
+    int lock_count;             // current lock depth
+    int busy_count;             // transfer() calls to fail with -1, as if another transfer was in progress
+    bool active;                // a transfer is in progress
+};
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,82 @@
+/* Host stand-in for events/EventQueue.h, dispatching on a simulated time */
+#ifndef I2C_BUS_TEST_EVENTQUEUE_H
+#define I2C_BUS_TEST_EVENTQUEUE_H
+
+#include <stdint.h>
+#include <functional>
+#include <map>
+#include <utility>
+
+namespace events {
+
+class EventQueue {
+public:
+    EventQueue() : _now(0), _seq(0)
+    {
+    }
+
+    template <typename T, typename R>
+    int call(T *obj, R (T::*method)())
+    {
+        return post(0, [ = ] { (obj->*method)(); });
+    }
+
+    template <typename T, typename R, typename B0, typename C0>
+    int call(T *obj, R (T::*method)(B0), C0 c0)
+    {
+        return post(0, [ = ] { (obj->*method)(c0); });
+    }
+
+    template <typename T, typename R>
+    int call_in(int ms, T *obj, R (T::*method)())
+    {
+        return post((uint64_t)ms * 1000, [ = ] { (obj->*method)(); });
+    }
+
+    template <typename T, typename R, typename B0, typename C0>
+    int call_in(int ms, T *obj, R (T::*method)(B0), C0 c0)
+    {
+        return post((uint64_t)ms * 1000, [ = ] { (obj->*method)(c0); });
+    }
+
+    /* Simulation: run a function, event or interrupt, at an absolute time */
+    int post_at(uint64_t time, std::function<void()> f)
+    {
+        _events.insert(std::make_pair(std::make_pair(time, ++_seq), f));
+        return (int)_seq;
+    }
+
+    /* Simulation: run the events in time order until none is left or the time limit */
+    void dispatch(uint64_t until = UINT64_MAX)
+    {
+        while (!_events.empty() && (_events.begin()->first.first <= until)) {
+            auto it = _events.begin();
+            std::function<void()> f = it->second;
+            _now = it->first.first;
+            _events.erase(it);
+            f();
+        }
+        if (until != UINT64_MAX) {
+            _now = until;
+        }
+    }
+
+    uint64_t now() const
+    {
+        return _now;
+    }
+
+private:
+    int post(uint64_t delay, std::function<void()> f)
+    {
+        return post_at(_now + delay, f);
+    }
+
+    uint64_t _now;
+    uint32_t _seq;
+    std::multimap<std::pair<uint64_t, uint32_t>, std::function<void()> > _events;
+};
+
+} // namespace events
+
+#endif
@@ -0,0 +1,12 @@
+/* Host stand-in for platform/platform.h */
+#ifndef I2C_BUS_TEST_PLATFORM_H
+#define I2C_BUS_TEST_PLATFORM_H
+
+#define DEVICE_I2C          1
+#define DEVICE_I2C_ASYNCH   1
+
+#include <stddef.h>
+#include <stdint.h>
+#include "platform/mbed_toolchain.h"
+
+#endif
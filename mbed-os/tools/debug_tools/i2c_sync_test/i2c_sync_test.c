@@ -0,0 +1,464 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Host test of the synchronous transfers of targets/TARGET_STM/i2c_api.c.
+ *
+ * i2c_api.c is built against stand-ins for the STM32 HAL and CMSIS-RTOS2:
+ * starting a transfer schedules the completion or error callback on a
+ * second thread, which stands for the I2C interrupt. The tests check that
+ * i2c_read and i2c_write block on the semaphore instead of polling, and
+ * fall back to polling when the kernel is not running or in a critical
+ * section.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "i2c_api.h"
+#include "pinmap.h"
+#include "cmsis_os2.h"
+
+typedef enum {
+    IRQ_NONE,           // the transfer never ends
+    IRQ_COMPLETE,
+    IRQ_ERROR
+} irq_action_t;
+
+uint32_t SystemCoreClock = 80000000;
+
+static pthread_mutex_t irq_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t irq_cond = PTHREAD_COND_INITIALIZER;
+static I2C_HandleTypeDef *irq_handle;
+static irq_action_t irq_action;
+static bool irq_receive;
+static uint32_t irq_delay_us;
+static bool irq_pending;
+static __thread bool in_isr;
+
+static osKernelState_t kernel_state = osKernelRunning;
+static bool in_critical;
+static volatile uint32_t wait_us_calls;
+static volatile int deep_sleep_locks;
+static volatile int deep_sleep_locks_max;
+static uint32_t semaphores_created;
+
+static int failures;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("  %s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);  \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* Simulated I2C interrupt */
+
+static void *irq_thread(void *arg)
+{
+    (void)arg;
+    in_isr = true;
+
+    pthread_mutex_lock(&irq_mutex);
+    while (true) {
+        while (!irq_pending) {
+            pthread_cond_wait(&irq_cond, &irq_mutex);
+        }
+        irq_pending = false;
+        I2C_HandleTypeDef *handle = irq_handle;
+        irq_action_t action = irq_action;
+        bool receive = irq_receive;
+        uint32_t delay = irq_delay_us;
+        pthread_mutex_unlock(&irq_mutex);
+
+        usleep(delay);
+        if (action == IRQ_COMPLETE) {
+            if (receive) {
+                HAL_I2C_MasterRxCpltCallback(handle);
+            } else {
+                HAL_I2C_MasterTxCpltCallback(handle);
+            }
+        } else if (action == IRQ_ERROR) {
+            HAL_I2C_ErrorCallback(handle);
+        }
+
+        pthread_mutex_lock(&irq_mutex);
+    }
+    return NULL;
+}
+
+static void irq_schedule(I2C_HandleTypeDef *handle, bool receive)
+{
+    pthread_mutex_lock(&irq_mutex);
+    irq_handle = handle;
+    irq_receive = receive;
+    irq_pending = true;
+    pthread_cond_signal(&irq_cond);
+    pthread_mutex_unlock(&irq_mutex);
+}
+
+/* STM32 HAL */
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c)
+{
+    (void)hi2c;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2CEx_ConfigAnalogFilter(I2C_HandleTypeDef *hi2c, uint32_t AnalogFilter)
+{
+    (void)hi2c;
+    (void)AnalogFilter;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Sequential_Transmit_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+                                                        uint16_t Size, uint32_t XferOptions)
+{
+    (void)DevAddress;
+    (void)pData;
+    (void)Size;
+    (void)XferOptions;
+    irq_schedule(hi2c, false);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Sequential_Receive_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+                                                       uint16_t Size, uint32_t XferOptions)
+{
+    (void)DevAddress;
+    (void)pData;
+    (void)Size;
+    (void)XferOptions;
+    irq_schedule(hi2c, true);
+    return HAL_OK;
+}
+
+void HAL_I2C_EV_IRQHandler(I2C_HandleTypeDef *hi2c)
+{
+    (void)hi2c;
+}
+
+void HAL_I2C_ER_IRQHandler(I2C_HandleTypeDef *hi2c)
+{
+    (void)hi2c;
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+    (void)IRQn;
+}
+
+void NVIC_SetVector(IRQn_Type IRQn, uint32_t vector)
+{
+    (void)IRQn;
+    (void)vector;
+}
+
+void NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority)
+{
+    (void)IRQn;
+    (void)priority;
+}
+
+void NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+    (void)IRQn;
+}
+
+/* mbed HAL and platform */
+
+uint32_t pinmap_peripheral(PinName pin, const PinMap *map)
+{
+    (void)pin;
+    (void)map;
+    return I2C_3;
+}
+
+uint32_t pinmap_merge(uint32_t a, uint32_t b)
+{
+    (void)b;
+    return a;
+}
+
+void pinmap_pinout(PinName pin, const PinMap *map)
+{
+    (void)pin;
+    (void)map;
+}
+
+void pin_mode(PinName pin, PinMode mode)
+{
+    (void)pin;
+    (void)mode;
+}
+
+const PinMap PinMap_I2C_SDA[] = { { NC, 0, 0 } };
+const PinMap PinMap_I2C_SCL[] = { { NC, 0, 0 } };
+
+void wait_us(int us)
+{
+    wait_us_calls++;
+    usleep(us);
+}
+
+bool core_util_is_isr_active(void)
+{
+    return in_isr;
+}
+
+bool core_util_in_critical_section(void)
+{
+    return in_critical;
+}
+
+void sleep_manager_lock_deep_sleep_internal(void)
+{
+    int locks = __sync_add_and_fetch(&deep_sleep_locks, 1);
+    if (locks > deep_sleep_locks_max) {
+        deep_sleep_locks_max = locks;
+    }
+}
+
+void sleep_manager_unlock_deep_sleep_internal(void)
+{
+    __sync_sub_and_fetch(&deep_sleep_locks, 1);
+}
+
+void mbed_assert_internal(const char *expr, const char *file, int line)
+{
+    printf("assertion failed: %s, %s:%d\n", expr, file, line);
+    exit(1);
+}
+
+/* CMSIS-RTOS2, with a 1 kHz tick */
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint32_t count;
+    uint32_t max;
+} host_semaphore_t;
+
+osKernelState_t osKernelGetState(void)
+{
+    return kernel_state;
+}
+
+uint32_t osKernelGetTickFreq(void)
+{
+    return 1000;
+}
+
+osSemaphoreId_t osSemaphoreNew(uint32_t max_count, uint32_t initial_count, const osSemaphoreAttr_t *attr)
+{
+    (void)attr;
+    host_semaphore_t *sem = calloc(1, sizeof(*sem));
+    pthread_mutex_init(&sem->mutex, NULL);
+    pthread_cond_init(&sem->cond, NULL);
+    sem->count = initial_count;
+    sem->max = max_count;
+    semaphores_created++;
+    return sem;
+}
+
+osStatus_t osSemaphoreAcquire(osSemaphoreId_t semaphore_id, uint32_t timeout)
+{
+    host_semaphore_t *sem = semaphore_id;
+    struct timespec deadline;
+    osStatus_t status = osOK;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout / 1000;
+    deadline.tv_nsec += (long)(timeout % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&sem->mutex);
+    while (sem->count == 0) {
+        if (pthread_cond_timedwait(&sem->cond, &sem->mutex, &deadline) == ETIMEDOUT) {
+            status = osErrorTimeout;
+            break;
+        }
+    }
+    if (status == osOK) {
+        sem->count--;
+    }
+    pthread_mutex_unlock(&sem->mutex);
+
+    return status;
+}
+
+osStatus_t osSemaphoreRelease(osSemaphoreId_t semaphore_id)
+{
+    host_semaphore_t *sem = semaphore_id;
+    osStatus_t status = osOK;
+
+    pthread_mutex_lock(&sem->mutex);
+    if (sem->count < sem->max) {
+        sem->count++;
+        pthread_cond_signal(&sem->cond);
+    } else {
+        status = osErrorResource;
+    }
+    pthread_mutex_unlock(&sem->mutex);
+
+    return status;
+}
+
+/* Tests */
+
+static i2c_t i2c;
+
+static int transfer(bool read, irq_action_t action, uint32_t delay_us, uint32_t *elapsed_us)
+{
+    char data[9] = { 0 };
+    uint64_t start;
+    int ret;
+
+    irq_action = action;
+    irq_delay_us = delay_us;
+    wait_us_calls = 0;
+
+    start = now_us();
+    if (read) {
+        ret = i2c_read(&i2c, 0xB5, data, sizeof(data), 1);
+    } else {
+        ret = i2c_write(&i2c, 0x80, data, 1, 1);
+    }
+    *elapsed_us = (uint32_t)(now_us() - start);
+
+    return ret;
+}
+
+static void test_blocking(void)
+{
+    uint32_t elapsed;
+    int ret;
+
+    printf("blocking transfers\n");
+    kernel_state = osKernelRunning;
+    in_critical = false;
+
+    ret = transfer(false, IRQ_COMPLETE, 2000, &elapsed);
+    CHECK(ret == 1);
+    CHECK(elapsed >= 2000);
+    CHECK(wait_us_calls == 0);
+    CHECK(semaphores_created == 1);
+
+    ret = transfer(true, IRQ_COMPLETE, 3000, &elapsed);
+    CHECK(ret == 9);
+    CHECK(elapsed >= 3000);
+    CHECK(wait_us_calls == 0);
+    CHECK(semaphores_created == 1);
+
+    // Deep sleep is only locked during the transfer
+    CHECK(deep_sleep_locks == 0);
+    CHECK(deep_sleep_locks_max == 1);
+
+    ret = transfer(true, IRQ_ERROR, 1000, &elapsed);
+    CHECK(ret == I2C_ERROR_BUS_BUSY);
+    CHECK(wait_us_calls == 0);
+    CHECK(deep_sleep_locks == 0);
+}
+
+static void test_timeout(void)
+{
+    uint32_t elapsed;
+    int ret;
+
+    printf("timeout and late completion\n");
+    kernel_state = osKernelRunning;
+    in_critical = false;
+
+    // 1 MHz core clock at 100 kHz: 300 us per byte, the write of 1 byte times out after 2 ticks
+    SystemCoreClock = 1000000;
+    ret = transfer(false, IRQ_NONE, 0, &elapsed);
+    CHECK(ret == I2C_ERROR_BUS_BUSY);
+    CHECK(elapsed >= 1000);
+    CHECK(elapsed < 100000);
+    CHECK(wait_us_calls == 0);
+
+    // A transfer which completes after its timeout leaves a token in the semaphore
+    ret = transfer(false, IRQ_COMPLETE, 10000, &elapsed);
+    CHECK(ret == I2C_ERROR_BUS_BUSY);
+    usleep(20000);
+
+    // The next transfer must not end on that token
+    SystemCoreClock = 80000000;
+    ret = transfer(false, IRQ_COMPLETE, 5000, &elapsed);
+    CHECK(ret == 1);
+    CHECK(elapsed >= 5000);
+    CHECK(deep_sleep_locks == 0);
+}
+
+static void test_polling(void)
+{
+    uint32_t elapsed;
+    int ret;
+
+    printf("polling before the kernel starts and in critical sections\n");
+    kernel_state = osKernelInactive;
+    in_critical = false;
+
+    ret = transfer(true, IRQ_COMPLETE, 2000, &elapsed);
+    CHECK(ret == 9);
+    CHECK(wait_us_calls > 0);
+
+    kernel_state = osKernelRunning;
+    in_critical = true;
+    ret = transfer(false, IRQ_COMPLETE, 2000, &elapsed);
+    CHECK(ret == 1);
+    CHECK(wait_us_calls > 0);
+    in_critical = false;
+}
+
+int main(void)
+{
+    pthread_t thread;
+
+    pthread_create(&thread, NULL, irq_thread, NULL);
+
+    memset(&i2c, 0, sizeof(i2c));
+    i2c_init(&i2c, PC_1, PC_0);
+    i2c_frequency(&i2c, 100000);
+
+    test_blocking();
+    test_timeout();
+    test_polling();
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("all tests passed\n");
+    return 0;
+}
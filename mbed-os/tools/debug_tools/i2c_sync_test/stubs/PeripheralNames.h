@@ -0,0 +1,12 @@
+/* Host stand-in for the target PeripheralNames.h */
+#ifndef I2C_SYNC_TEST_PERIPHERALNAMES_H
+#define I2C_SYNC_TEST_PERIPHERALNAMES_H
+
+#include "cmsis.h"
+
+typedef enum {
+    I2C_1 = (int)I2C1_BASE,
+    I2C_3 = (int)I2C3_BASE
+} I2CName;
+
+#endif
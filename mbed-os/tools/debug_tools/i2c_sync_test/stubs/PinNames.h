@@ -0,0 +1,16 @@
+/* Host stand-in for the target PinNames.h */
+#ifndef I2C_SYNC_TEST_PINNAMES_H
+#define I2C_SYNC_TEST_PINNAMES_H
+
+typedef enum {
+    PC_0 = 0x20,
+    PC_1 = 0x21,
+    NC = (int)0xFFFFFFFF
+} PinName;
+
+typedef enum {
+    PullNone = 0,
+    OpenDrainNoPull = 4
+} PinMode;
+
+#endif
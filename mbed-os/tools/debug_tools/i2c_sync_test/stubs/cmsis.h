@@ -0,0 +1,118 @@
+/* Host stand-in for the STM32 HAL definitions used by i2c_api.c */
+#ifndef I2C_SYNC_TEST_CMSIS_H
+#define I2C_SYNC_TEST_CMSIS_H
+
+#include <stdint.h>
+
+typedef enum {
+    HAL_OK = 0,
+    HAL_ERROR,
+    HAL_BUSY,
+    HAL_TIMEOUT
+} HAL_StatusTypeDef;
+
+typedef enum {
+    I2C1_EV_IRQn = 31,
+    I2C1_ER_IRQn = 32,
+    I2C3_EV_IRQn = 72,
+    I2C3_ER_IRQn = 73
+} IRQn_Type;
+
+typedef struct {
+    volatile uint32_t CR1;
+    volatile uint32_t CR2;
+    volatile uint32_t ISR;
+    volatile uint32_t ICR;
+    volatile uint32_t RXDR;
+    volatile uint32_t TXDR;
+} I2C_TypeDef;
+
+typedef struct {
+    uint32_t Timing;
+    uint32_t OwnAddress1;
+    uint32_t AddressingMode;
+    uint32_t DualAddressMode;
+    uint32_t OwnAddress2;
+    uint32_t OwnAddress2Masks;
+    uint32_t GeneralCallMode;
+    uint32_t NoStretchMode;
+} I2C_InitTypeDef;
+
+typedef struct {
+    I2C_TypeDef *Instance;
+    I2C_InitTypeDef Init;
+    uint32_t ErrorCode;
+    uint32_t State;
+} I2C_HandleTypeDef;
+
+#define I2C1_BASE                   0x40005400UL
+#define I2C3_BASE                   0x40005C00UL
+
+#define I2C_FIRST_FRAME             0x00000000U
+#define I2C_NEXT_FRAME              0x01000000U
+#define I2C_FIRST_AND_LAST_FRAME    0x02000000U
+#define I2C_LAST_FRAME              0x03000000U
+
+#define I2C_ADDRESSINGMODE_7BIT     1
+#define I2C_DUALADDRESS_DISABLE     0
+#define I2C_GENERALCALL_DISABLE     0
+#define I2C_NOSTRETCH_DISABLE       0
+#define I2C_ANALOGFILTER_ENABLE     0
+
+#define I2C_CR1_PE                  (1U << 0)
+#define I2C_CR2_SADD                0x3FFU
+#define I2C_CR2_RD_WRN              (1U << 10)
+#define I2C_CR2_START               (1U << 13)
+#define I2C_CR2_STOP                (1U << 14)
+#define I2C_CR2_NACK                (1U << 15)
+#define I2C_CR2_NBYTES              (0xFFU << 16)
+#define I2C_CR2_RELOAD              (1U << 24)
+#define I2C_CR2_AUTOEND             (1U << 25)
+
+#define I2C_FLAG_TXE                (1U << 0)
+#define I2C_FLAG_RXNE               (1U << 2)
+#define I2C_FLAG_ADDR               (1U << 3)
+#define I2C_FLAG_AF                 (1U << 4)
+#define I2C_FLAG_STOPF              (1U << 5)
+#define I2C_FLAG_TCR                (1U << 7)
+#define I2C_FLAG_BUSY               (1U << 15)
+
+#define I2C_IT_ERRI                 (1U << 7)
+#define I2C_IT_TCI                  (1U << 6)
+#define I2C_IT_STOPI                (1U << 5)
+#define I2C_IT_NACKI                (1U << 4)
+#define I2C_IT_ADDRI                (1U << 3)
+#define I2C_IT_RXI                  (1U << 2)
+#define I2C_IT_TXI                  (1U << 1)
+
+/* The registers are never touched: the I2C_TypeDef pointers are peripheral addresses */
+#define __HAL_I2C_GET_FLAG(handle, flag)    0
+#define __HAL_I2C_CLEAR_FLAG(handle, flag)
+#define __HAL_I2C_DISABLE_IT(handle, it)
+#define __HAL_RCC_I2C1_CLK_ENABLE()
+#define __HAL_RCC_I2C1_FORCE_RESET()
+#define __HAL_RCC_I2C1_RELEASE_RESET()
+#define __HAL_RCC_I2C3_CLK_ENABLE()
+#define __HAL_RCC_I2C3_FORCE_RESET()
+#define __HAL_RCC_I2C3_RELEASE_RESET()
+
+extern uint32_t SystemCoreClock;
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c);
+HAL_StatusTypeDef HAL_I2CEx_ConfigAnalogFilter(I2C_HandleTypeDef *hi2c, uint32_t AnalogFilter);
+HAL_StatusTypeDef HAL_I2C_Master_Sequential_Transmit_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+                                                        uint16_t Size, uint32_t XferOptions);
+HAL_StatusTypeDef HAL_I2C_Master_Sequential_Receive_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData,
+                                                       uint16_t Size, uint32_t XferOptions);
+void HAL_I2C_EV_IRQHandler(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_ER_IRQHandler(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c);
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn);
+void NVIC_SystemReset(void);
+void NVIC_SetVector(IRQn_Type IRQn, uint32_t vector);
+void NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority);
+void NVIC_EnableIRQ(IRQn_Type IRQn);
+
+#endif
@@ -0,0 +1,23 @@
+/* Host stand-in for the target device.h, with the STM32L4 struct i2c_s */
+#ifndef I2C_SYNC_TEST_DEVICE_H
+#define I2C_SYNC_TEST_DEVICE_H
+
+#include "cmsis.h"
+#include "PinNames.h"
+#include "PeripheralNames.h"
+
+struct i2c_s {
+    I2CName  i2c;
+    I2C_HandleTypeDef handle;
+    uint8_t index;
+    int hz;
+    PinName sda;
+    PinName scl;
+    IRQn_Type event_i2cIRQ;
+    IRQn_Type error_i2cIRQ;
+    uint32_t XferOperation;
+    volatile uint8_t event;
+    volatile int pending_start;
+};
+
+#endif
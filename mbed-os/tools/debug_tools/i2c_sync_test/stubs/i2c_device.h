@@ -0,0 +1,16 @@
+/* Host stand-in for the STM32L4 i2c_device.h */
+#ifndef I2C_SYNC_TEST_I2C_DEVICE_H
+#define I2C_SYNC_TEST_I2C_DEVICE_H
+
+#include "cmsis.h"
+
+#define I2C_IP_VERSION_V2
+
+#define I2C_IT_ALL (I2C_IT_ERRI|I2C_IT_TCI|I2C_IT_STOPI|I2C_IT_NACKI|I2C_IT_ADDRI|I2C_IT_RXI|I2C_IT_TXI)
+
+static inline uint32_t get_i2c_timing(int hz)
+{
+    return (uint32_t)hz;
+}
+
+#endif
@@ -0,0 +1,9 @@
+/* Host stand-in for mbed_rtos_storage.h, without rtx_lib.h */
+#ifndef I2C_SYNC_TEST_MBED_RTOS_STORAGE_H
+#define I2C_SYNC_TEST_MBED_RTOS_STORAGE_H
+
+#include "rtx_os.h"
+
+typedef osRtxSemaphore_t mbed_rtos_storage_semaphore_t;
+
+#endif
@@ -0,0 +1,240 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Simulation of the tickless idle loop with duty-cycled workloads.
+ *
+ * Runs the idle governor (mbed_idle_governor.c) against a model of the
+ * STM32L4 low power modes, and compares it with the idle hook without the
+ * governor, which deep sleeps whenever it is allowed, and with sleep only.
+ * Threads wake up at RTX deadlines; interrupts arrive at random and end the
+ * idle period early. Reports the average current and how late the threads
+ * start compared to their deadline.
+ *
+ * usage: idle_governor_sim [seconds] [deep sleep latency in us] [seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include "mbed_idle_governor.h"
+
+/* Current drawn in each state, in microamps */
+#define I_RUN           8000.0
+#define I_SLEEP         2500.0
+#define I_DEEP_SLEEP    2.0
+
+/* Time spent at run current to enter and leave sleep through the sleep manager, and WFI, in microseconds */
+#define SLEEP_OVERHEAD  20
+#define WFI_OVERHEAD    2
+
+#define TICK_US         1000
+
+typedef enum {
+    POLICY_DEEP,        /* idle hook without the governor */
+    POLICY_SLEEP,       /* deep sleep always locked */
+    POLICY_GOVERNOR,
+    POLICIES
+} policy_t;
+
+static const char *policy_names[POLICIES] = { "deep", "sleep", "governor" };
+
+typedef struct {
+    const char *name;
+    uint32_t period_us[2];      /* Periods of two threads, 0 if unused */
+    uint32_t run_us[2];         /* Run time of the threads at each period */
+    uint32_t irq_mean_us;       /* Mean time between interrupts, 0 for none */
+    uint32_t irq_run_us;        /* Run time of an interrupt */
+} workload_t;
+
+static const workload_t workloads[] = {
+    /* Sensor thread waiting 1 s between samples */
+    { "sensor 1 s",        { 1000000, 0 },     { 2000, 0 },  0,      0 },
+    /* node_state_loop polling every 10 ms */
+    { "poll 10 ms",        { 10000, 0 },       { 50, 0 },    0,      0 },
+    /* Both, with radio and UART interrupts */
+    { "sensor+poll+irq",   { 1000000, 10000 }, { 2000, 50 }, 50000,  100 },
+    /* A 2 ms polling loop and frequent interrupts, too short for deep sleep */
+    { "poll 2 ms+irq",     { 2000, 0 },        { 30, 0 },    5000,   20 },
+};
+
+typedef struct {
+    double charge;              /* microamp microseconds */
+    uint64_t time;
+    uint32_t mode_count[MBED_IDLE_MODES];
+    uint32_t deadlines;
+    uint64_t late_total;
+    uint32_t late_max;
+    uint32_t late_count;        /* deadlines missed by more than a tick */
+} result_t;
+
+static uint32_t rng_state;
+static uint32_t deep_latency_us;
+
+static uint32_t rng(void)
+{
+    // xorshift32
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/* Exponentially distributed delay with the given mean */
+static uint32_t random_delay(uint32_t mean)
+{
+    double u = (rng() + 1.0) / 4294967297.0;
+    return (uint32_t)(-log(u) * mean) + 1;
+}
+
+static uint32_t wake_latency(mbed_idle_mode_t mode)
+{
+    /* +-10% of jitter on the deep sleep latency (clock start-up) */
+    switch (mode) {
+        case MBED_IDLE_DEEP_SLEEP:
+            return deep_latency_us - deep_latency_us / 10 + rng() % (deep_latency_us / 5 + 1);
+        case MBED_IDLE_SLEEP:
+            return 5;
+        default:
+            return 1;
+    }
+}
+
+static double mode_current(mbed_idle_mode_t mode)
+{
+    return (mode == MBED_IDLE_DEEP_SLEEP) ? I_DEEP_SLEEP : I_SLEEP;
+}
+
+static void simulate(const workload_t *w, policy_t policy, uint64_t duration, result_t *r)
+{
+    mbed_idle_governor_t gov;
+    uint64_t next_run[2];
+    uint64_t next_irq;
+    uint64_t now = 0;
+
+    memset(r, 0, sizeof(*r));
+    mbed_idle_governor_init(&gov, MBED_CONF_RTOS_IDLE_SLEEP_MIN_US, MBED_CONF_RTOS_IDLE_DEEP_SLEEP_MIN_US,
+                            MBED_CONF_RTOS_IDLE_DEEP_SLEEP_LATENCY_US);
+    for (int i = 0; i < 2; i++) {
+        next_run[i] = w->period_us[i] ? w->period_us[i] : UINT64_MAX;
+    }
+    next_irq = w->irq_mean_us ? random_delay(w->irq_mean_us) : UINT64_MAX;
+
+    while (now < duration) {
+        /* Run every thread whose deadline has passed */
+        int ran = 0;
+        for (int i = 0; i < 2; i++) {
+            if (next_run[i] <= now) {
+                uint32_t late = (uint32_t)(now - next_run[i]);
+                r->deadlines++;
+                r->late_total += late;
+                if (late > r->late_max) {
+                    r->late_max = late;
+                }
+                if (late > TICK_US) {
+                    r->late_count++;
+                }
+                r->charge += I_RUN * w->run_us[i];
+                now += w->run_us[i];
+                next_run[i] += w->period_us[i];
+                ran = 1;
+            }
+        }
+        if (next_irq <= now) {
+            r->charge += I_RUN * w->irq_run_us;
+            now += w->irq_run_us;
+            next_irq = now + random_delay(w->irq_mean_us);
+            ran = 1;
+        }
+        if (ran) {
+            continue;
+        }
+
+        /* Idle: RTX only knows the next thread deadline, in whole ticks */
+        uint64_t deadline = (next_run[0] < next_run[1]) ? next_run[0] : next_run[1];
+        uint32_t ticks = (uint32_t)((deadline - now) / TICK_US);
+        uint64_t tick_time = (now / TICK_US + ticks) * TICK_US;
+        if (tick_time < deadline) {
+            ticks++;
+            tick_time += TICK_US;
+        }
+        uint32_t idle_us = (uint32_t)(tick_time - now);
+
+        mbed_idle_mode_t mode;
+        uint64_t wake = tick_time;
+        switch (policy) {
+            case POLICY_DEEP:
+                mode = MBED_IDLE_DEEP_SLEEP;
+                break;
+            case POLICY_SLEEP:
+                mode = MBED_IDLE_SLEEP;
+                break;
+            default: {
+                mode = mbed_idle_governor_select(&gov, idle_us, true);
+                uint32_t advance_ticks = (mbed_idle_governor_advance(&gov, mode) + 500) / 1000;
+                if (ticks > advance_ticks + 1) {
+                    wake -= (uint64_t)advance_ticks * TICK_US;
+                }
+                break;
+            }
+        }
+        r->mode_count[mode]++;
+
+        uint32_t overhead = (mode == MBED_IDLE_WFI) ? WFI_OVERHEAD : SLEEP_OVERHEAD;
+        r->charge += I_RUN * overhead;
+        now += overhead;
+
+        uint64_t trigger = (next_irq < wake) ? next_irq : wake;
+        if (trigger < now) {
+            trigger = now;
+        }
+        uint32_t latency = wake_latency(mode);
+        r->charge += mode_current(mode) * (double)(trigger - now) + I_RUN * latency;
+        now = trigger + latency;
+
+        if (policy == POLICY_GOVERNOR) {
+            mbed_idle_governor_wake(&gov, mode, (int32_t)(now - wake));
+        }
+    }
+    r->time = now;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t seconds = (argc > 1) ? strtoul(argv[1], NULL, 0) : 600;
+    deep_latency_us = (argc > 2) ? strtoul(argv[2], NULL, 0) : 1500;
+    uint32_t seed = (argc > 3) ? strtoul(argv[3], NULL, 0) : 1;
+
+    printf("%" PRIu32 " s per run, deep sleep wake-up latency %" PRIu32 " us\n\n", seconds, deep_latency_us);
+    printf("%-18s %-9s %10s %9s %9s %9s %10s %10s %8s\n",
+           "workload", "policy", "avg (uA)", "wfi", "sleep", "deep", "late (us)", "max (us)", "> 1 tick");
+
+    for (size_t i = 0; i < sizeof(workloads) / sizeof(workloads[0]); i++) {
+        for (int p = 0; p < POLICIES; p++) {
+            result_t r;
+            rng_state = seed ? seed : 1;
+            simulate(&workloads[i], (policy_t)p, (uint64_t)seconds * 1000000, &r);
+            printf("%-18s %-9s %10.1f %9" PRIu32 " %9" PRIu32 " %9" PRIu32 " %10.1f %10" PRIu32 " %8" PRIu32 "\n",
+                   workloads[i].name, policy_names[p], r.charge / (double)r.time,
+                   r.mode_count[MBED_IDLE_WFI], r.mode_count[MBED_IDLE_SLEEP], r.mode_count[MBED_IDLE_DEEP_SLEEP],
+                   r.deadlines ? (double)r.late_total / r.deadlines : 0.0, r.late_max, r.late_count);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,226 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Replay a dump of the binary memory trace ring (mbed_mem_trace_binary_callback)
+ * and report peak heap usage, fragmentation over time, top allocating callers
+ * and leak candidates.
+ *
+ * usage: mem_trace_analyzer <dump> [samples] [top]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <map>
+#include <vector>
+#include <algorithm>
+
+#include "platform/mbed_mem_trace.h"
+
+struct block_t {
+    uint32_t size;
+    uint32_t caller;
+    uint32_t timestamp;
+};
+
+struct caller_stats_t {
+    uint32_t caller;
+    uint32_t count;
+    uint64_t bytes;
+    uint32_t live_count;
+    uint64_t live_bytes;
+};
+
+typedef std::map<uint32_t, block_t> heap_t;
+
+static std::map<uint32_t, caller_stats_t> callers;
+static heap_t heap;
+static uint64_t live_bytes;
+static uint64_t peak_bytes;
+static uint32_t peak_timestamp;
+static uint32_t unknown_frees;
+
+/* Fragmentation of the span covered by live blocks: 1 - largest hole / total of holes.
+ * 0 means all the free space inside the span is contiguous. */
+static double fragmentation(uint32_t *span)
+{
+    if (heap.empty()) {
+        *span = 0;
+        return 0.0;
+    }
+
+    uint64_t holes = 0;
+    uint64_t largest = 0;
+    uint32_t end = heap.begin()->first;
+    for (heap_t::const_iterator it = heap.begin(); it != heap.end(); ++it) {
+        if (it->first > end) {
+            uint64_t hole = it->first - end;
+            holes += hole;
+            largest = std::max(largest, hole);
+        }
+        end = std::max(end, it->first + it->second.size);
+    }
+    *span = end - heap.begin()->first;
+    return holes ? 1.0 - (double)largest / (double)holes : 0.0;
+}
+
+static void add_block(uint32_t ptr, uint32_t size, uint32_t caller, uint32_t timestamp)
+{
+    block_t block = { size, caller, timestamp };
+    heap[ptr] = block;
+    live_bytes += size;
+    if (live_bytes > peak_bytes) {
+        peak_bytes = live_bytes;
+        peak_timestamp = timestamp;
+    }
+
+    caller_stats_t &stats = callers[caller];
+    stats.caller = caller;
+    stats.count++;
+    stats.bytes += size;
+    stats.live_count++;
+    stats.live_bytes += size;
+}
+
+static void remove_block(uint32_t ptr)
+{
+    heap_t::iterator it = heap.find(ptr);
+    if (it == heap.end()) {
+        unknown_frees++;
+        return;
+    }
+
+    caller_stats_t &stats = callers[it->second.caller];
+    stats.live_count--;
+    stats.live_bytes -= it->second.size;
+    live_bytes -= it->second.size;
+    heap.erase(it);
+}
+
+static void replay(const mbed_mem_trace_record_t &record)
+{
+    switch (record.op) {
+        case MBED_MEM_TRACE_MALLOC:
+        case MBED_MEM_TRACE_CALLOC:
+            if (record.res) {
+                add_block(record.res, record.size, record.caller, record.timestamp);
+            }
+            break;
+
+        case MBED_MEM_TRACE_REALLOC:
+            // A failed realloc leaves the original block untouched
+            if (record.res || !record.size) {
+                if (record.ptr) {
+                    remove_block(record.ptr);
+                }
+                if (record.res) {
+                    add_block(record.res, record.size, record.caller, record.timestamp);
+                }
+            }
+            break;
+
+        case MBED_MEM_TRACE_FREE:
+            if (record.ptr) {
+                remove_block(record.ptr);
+            }
+            break;
+    }
+}
+
+static bool by_bytes(const caller_stats_t &a, const caller_stats_t &b)
+{
+    return a.bytes > b.bytes;
+}
+
+static bool by_live_bytes(const caller_stats_t &a, const caller_stats_t &b)
+{
+    return a.live_bytes > b.live_bytes;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <dump> [samples] [top]\n", argv[0]);
+        return 1;
+    }
+
+    FILE *file = fopen(argv[1], "rb");
+    if (!file) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    std::vector<mbed_mem_trace_record_t> records;
+    mbed_mem_trace_record_t record;
+    while (fread(&record, sizeof(record), 1, file) == 1) {
+        records.push_back(record);
+    }
+    fclose(file);
+
+    size_t samples = (argc > 2) ? strtoul(argv[2], NULL, 0) : 20;
+    size_t top = (argc > 3) ? strtoul(argv[3], NULL, 0) : 10;
+    size_t step = std::max<size_t>(1, records.size() / std::max<size_t>(1, samples));
+
+    printf("%zu records\n\n", records.size());
+    printf("Heap over time:\n");
+    printf("%10s %12s %10s %10s %10s %14s\n", "record", "time (us)", "blocks", "live", "span", "fragmentation");
+    for (size_t i = 0; i < records.size(); i++) {
+        replay(records[i]);
+        if (((i + 1) % step) == 0 || (i + 1) == records.size()) {
+            uint32_t span;
+            double frag = fragmentation(&span);
+            printf("%10zu %12" PRIu32 " %10zu %10" PRIu64 " %10" PRIu32 " %13.1f%%\n",
+                   i + 1, records[i].timestamp, heap.size(), live_bytes, span, frag * 100.0);
+        }
+    }
+
+    printf("\nPeak heap: %" PRIu64 " bytes at %" PRIu32 " us\n", peak_bytes, peak_timestamp);
+    if (unknown_frees) {
+        printf("Frees of untracked blocks: %" PRIu32 " (allocated before tracing or records dropped)\n", unknown_frees);
+    }
+
+    std::vector<caller_stats_t> sorted;
+    for (std::map<uint32_t, caller_stats_t>::const_iterator it = callers.begin(); it != callers.end(); ++it) {
+        sorted.push_back(it->second);
+    }
+
+    printf("\nTop allocating callers:\n");
+    printf("%12s %10s %12s\n", "caller", "count", "bytes");
+    std::sort(sorted.begin(), sorted.end(), by_bytes);
+    for (size_t i = 0; i < std::min(top, sorted.size()); i++) {
+        printf("  0x%08" PRIx32 " %10" PRIu32 " %12" PRIu64 "\n", sorted[i].caller, sorted[i].count, sorted[i].bytes);
+    }
+
+    // Blocks still allocated at the end of the trace, grouped by caller, oldest first
+    printf("\nLeak candidates (live at end of trace):\n");
+    printf("%12s %10s %12s %16s\n", "caller", "blocks", "bytes", "oldest (us)");
+    std::sort(sorted.begin(), sorted.end(), by_live_bytes);
+    for (size_t i = 0; i < std::min(top, sorted.size()); i++) {
+        if (!sorted[i].live_count) {
+            break;
+        }
+        uint32_t oldest = UINT32_MAX;
+        for (heap_t::const_iterator it = heap.begin(); it != heap.end(); ++it) {
+            if (it->second.caller == sorted[i].caller) {
+                oldest = std::min(oldest, it->second.timestamp);
+            }
+        }
+        printf("  0x%08" PRIx32 " %10" PRIu32 " %12" PRIu64 " %16" PRIu32 "\n",
+               sorted[i].caller, sorted[i].live_count, sorted[i].live_bytes, oldest);
+    }
+
+    return 0;
+}
@@ -0,0 +1,451 @@
+/* Host test and benchmark of the minimal printf of platform/mbed_minimal_printf.c
+ *
+ * The output is checked against the printf of the host C library for the
+ * supported conversions. Built twice: with and without 64-bit support.
+ */
+#include <inttypes.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "platform/mbed_minimal_printf.h"
+
+#ifndef MBED_CONF_PLATFORM_MINIMAL_PRINTF_ENABLE_64_BIT
+#define MBED_CONF_PLATFORM_MINIMAL_PRINTF_ENABLE_64_BIT     1
+#endif
+
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF_ENABLE_64_BIT
+#define VARIANT "64-bit"
+#else
+#define VARIANT "32-bit"
+#endif
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+/* Compare with the host snprintf */
+#define CHECK_FORMAT(...) do { \
+    char minimal[256]; \
+    char libc[256]; \
+    int minimal_ret = mbed_minimal_snprintf(minimal, sizeof(minimal), __VA_ARGS__); \
+    int libc_ret = snprintf(libc, sizeof(libc), __VA_ARGS__); \
+    if ((minimal_ret != libc_ret) || strcmp(minimal, libc)) { \
+        printf("%s:%d: %s: \"%s\" (%d), expected \"%s\" (%d)\n", __FILE__, __LINE__, \
+               #__VA_ARGS__, minimal, minimal_ret, libc, libc_ret); \
+        failures++; \
+    } \
+} while (0)
+
+/* Compare with an expected output */
+#define CHECK_OUTPUT(expected, ...) do { \
+    char minimal[256]; \
+    int minimal_ret = mbed_minimal_snprintf(minimal, sizeof(minimal), __VA_ARGS__); \
+    if ((minimal_ret != (int)strlen(expected)) || strcmp(minimal, expected)) { \
+        printf("%s:%d: %s: \"%s\" (%d), expected \"%s\"\n", __FILE__, __LINE__, \
+               #__VA_ARGS__, minimal, minimal_ret, expected); \
+        failures++; \
+    } \
+} while (0)
+
+static void test_integers(void)
+{
+    CHECK_FORMAT("%d %d %d", 0, 42, -42);
+    CHECK_FORMAT("%i|%u|%x|%X|%o", -7, 4000000000U, 0xBEEFu, 0xBEEFu, 0755);
+    CHECK_FORMAT("%d %d", INT_MAX, INT_MIN);
+    CHECK_FORMAT("%u %x", UINT_MAX, UINT_MAX);
+
+    // Flags and width
+    CHECK_FORMAT("[%5d][%-5d][%05d][%+d][% d][%+d][% d]", 42, 42, 42, 42, 42, -42, -42);
+    CHECK_FORMAT("[%+05d][% 05d][%05d]", 42, 42, -42);
+    CHECK_OUTPUT("[42   ]", "[%-05d]", 42);
+    CHECK_FORMAT("[%#x][%#X][%#o][%#x][%#o]", 255, 255, 8, 0, 0);
+    CHECK_FORMAT("[%#08x][%-#8x][%08X]", 0x1F, 0x1F, 0xABCDu);
+    CHECK_FORMAT("[%1d][%2d]", 123, 123);
+
+    // Precision
+    CHECK_FORMAT("[%.3d][%.3d][%8.3d][%-8.3d]", 7, -7, 7, 7);
+    // The 0 flag is ignored with a precision
+    CHECK_OUTPUT("[     007]", "[%08.3d]", 7);
+    CHECK_FORMAT("[%.0d][%.0x][%5.0d][%#.0o][%.0u]", 0, 0, 0, 0, 0);
+    CHECK_FORMAT("[%.5x][%#.5x][%#.3o][%#.1o]", 0xAB, 0xAB, 8, 8);
+
+    // Width and precision from the arguments
+    CHECK_FORMAT("[%*d][%-*d][%*d][%.*d][%.*d]", 6, 42, 6, 42, -6, 42, 4, 42, -1, 42);
+    CHECK_FORMAT("[%*.*x]", 8, 4, 0x12);
+
+    // Length modifiers
+    CHECK_FORMAT("%hhd %hhu %hhx", 300, 300, 0x1FF);
+    CHECK_FORMAT("%hd %hu %hx", 70000, 70000, 0x12345);
+    CHECK_FORMAT("%ld %lu %lx", -123456789L, 123456789UL, 0x7FFFFFFFUL);
+    CHECK_FORMAT("%zu %zx %td", (size_t)65536, (size_t)0xFFFF, (ptrdiff_t)-3);
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF_ENABLE_64_BIT
+    CHECK_FORMAT("%lld %llu %llx", LLONG_MIN, ULLONG_MAX, 0x123456789ABCDEFULL);
+    CHECK_FORMAT("%jd %ju %20lld %-20llu|", INTMAX_MIN, UINTMAX_MAX, 10000000000LL, 10000000000ULL);
+    CHECK_FORMAT("%llo %#llX", ULLONG_MAX, 0xFEDCBA9876543210ULL);
+#else
+    // 64-bit arguments are consumed, and printed on 32 bits
+    CHECK_OUTPUT("-2147483648 4294967295 89abcdef 9", "%lld %llu %llx %d", (long long)INT32_MIN,
+                 ULLONG_MAX, 0x0123456789ABCDEFULL, 9);
+    CHECK_OUTPUT("1410065408 1", "%jd %d", (intmax_t)10000000000LL, 1);
+#endif
+}
+
+static void test_characters(void)
+{
+    const char *null_string = NULL;
+    char unterminated[4] = {'a', 'b', 'c', 'd'};
+
+    CHECK_FORMAT("[%s][%10s][%-10s][%.2s][%10.2s][%-10.2s]", "hello", "hello", "hello", "hello", "hello", "hello");
+    CHECK_FORMAT("[%*s][%.*s][%s]", -7, "ab", 3, "abcdef", "");
+    CHECK_FORMAT("[%c][%3c][%-3c][%c]", 'A', 'B', 'C', 0xC8);
+    CHECK_FORMAT("100%% [%%]");
+    CHECK_FORMAT("%s", "no conversion");
+    CHECK_OUTPUT("(null)", "%s", null_string);
+    // The precision bounds the read of the string
+    CHECK_OUTPUT("abcd", "%.4s", unterminated);
+
+    // A null character is written and counted
+    {
+        char buffer[8];
+        CHECK(mbed_minimal_snprintf(buffer, sizeof(buffer), "a%cb", 0) == 3);
+        CHECK(memcmp(buffer, "a\0b\0", 4) == 0);
+    }
+}
+
+static void test_pointers(void)
+{
+    char expected[32];
+    int object;
+
+#if MBED_CONF_PLATFORM_MINIMAL_PRINTF_ENABLE_64_BIT
+    snprintf(expected, sizeof(expected), "0x%" PRIxPTR, (uintptr_t)&object);
+#else
+    // Printed on 32 bits, the size of the pointers of the target
+    snprintf(expected, sizeof(expected), "0x%" PRIx32, (uint32_t)(uintptr_t)&object);
+#endif
+    CHECK_OUTPUT(expected, "%p", (void *)&object);
+    CHECK_OUTPUT("0x0", "%p", NULL);
+    CHECK_OUTPUT("    0x1f", "%8p", (void *)0x1F);
+}
+
+static void test_unsupported(void)
+{
+    int written = 5;
+
+    // No floating point: the conversion is copied, its argument consumed
+    CHECK_OUTPUT("%f 7", "%f %d", 1.5, 7);
+    CHECK_OUTPUT("%8.3e|%g|%Lf|8", "%8.3e|%g|%Lf|%d", 1.5, 2.5, (long double)3.5, 8);
+    // Unknown conversions are copied
+    CHECK_OUTPUT("%k %y 3", "%k %y %d", 3);
+    CHECK_OUTPUT("end %-5", "end %-5");
+    CHECK_OUTPUT("end %", "end %");
+    // %n is ignored
+    CHECK_OUTPUT("ab 4", "ab%n %d", &written, 4);
+    CHECK(written == 5);
+}
+
+static void test_truncation(void)
+{
+    char buffer[16];
+    int length;
+
+    memset(buffer, 'x', sizeof(buffer));
+    CHECK(mbed_minimal_snprintf(buffer, 0, "%d", 12345) == 5);
+    CHECK(buffer[0] == 'x');
+    CHECK(mbed_minimal_snprintf(buffer, 1, "%d", 12345) == 5);
+    CHECK(buffer[0] == '\0');
+    CHECK(mbed_minimal_snprintf(buffer, 4, "%s-%d", "abc", 12345) == 9);
+    CHECK(strcmp(buffer, "abc") == 0);
+    CHECK(buffer[4] == 'x');
+
+    // Every size gives the same prefix as the host
+    for (length = 0; length <= 12; length++) {
+        char minimal[16];
+        char libc[16];
+
+        memset(minimal, 'x', sizeof(minimal));
+        memset(libc, 'x', sizeof(libc));
+        CHECK(mbed_minimal_snprintf(minimal, length, "%05d|%-4s|", -42, "ab") ==
+              snprintf(libc, length, "%05d|%-4s|", -42, "ab"));
+        CHECK(memcmp(minimal, libc, sizeof(minimal)) == 0);
+    }
+}
+
+/* Sink collecting the chunks */
+typedef struct {
+    char data[1024];
+    size_t length;
+    int calls;
+    size_t largest;
+    int fail_at;
+} collector_t;
+
+static int collect(void *context, const char *data, size_t length)
+{
+    collector_t *collector = (collector_t *)context;
+
+    collector->calls++;
+    if (length > collector->largest) {
+        collector->largest = length;
+    }
+    if (collector->calls == collector->fail_at) {
+        return -1;
+    }
+    memcpy(collector->data + collector->length, data, length);
+    collector->length += length;
+    return 0;
+}
+
+static int sink_printf(collector_t *collector, const char *format, ...)
+{
+    va_list arguments;
+    int ret;
+
+    va_start(arguments, format);
+    ret = mbed_minimal_vxprintf(collect, collector, format, arguments);
+    va_end(arguments);
+    return ret;
+}
+
+static void test_sink(void)
+{
+    collector_t collector;
+    char expected[1024];
+    int length;
+
+    // Long output is passed in chunks of the stack buffer size
+    memset(&collector, 0, sizeof(collector));
+    length = snprintf(expected, sizeof(expected), "%200s|%d|%-150s|%x", "right", 12345, "left", 0xABCDu);
+    CHECK(sink_printf(&collector, "%200s|%d|%-150s|%x", "right", 12345, "left", 0xABCDu) == length);
+    CHECK(collector.length == (size_t)length);
+    CHECK(memcmp(collector.data, expected, length) == 0);
+    CHECK(collector.largest == MBED_MINIMAL_PRINTF_CHUNK_SIZE);
+    CHECK(collector.calls == (length + MBED_MINIMAL_PRINTF_CHUNK_SIZE - 1) / MBED_MINIMAL_PRINTF_CHUNK_SIZE);
+
+    // Nothing to write, no call
+    memset(&collector, 0, sizeof(collector));
+    CHECK(sink_printf(&collector, "%s", "") == 0);
+    CHECK(collector.calls == 0);
+
+    // An error is returned, and the sink is not called again
+    memset(&collector, 0, sizeof(collector));
+    collector.fail_at = 2;
+    CHECK(sink_printf(&collector, "%300d", 1) == -1);
+    CHECK(collector.calls == 2);
+}
+
+static int file_printf(FILE *file, const char *format, ...)
+{
+    va_list arguments;
+    int ret;
+
+    va_start(arguments, format);
+    ret = mbed_minimal_vfprintf(file, format, arguments);
+    va_end(arguments);
+    return ret;
+}
+
+static void test_file(void)
+{
+    char expected[256];
+    char read[256];
+    FILE *file = tmpfile();
+    int length;
+
+    length = snprintf(expected, sizeof(expected), "Error Status: 0x%x Code: %d Module: %d\n%100s.",
+                      0x80FF0100u, 256, 1, "end");
+    CHECK(file_printf(file, "Error Status: 0x%x Code: %d Module: %d\n%100s.", 0x80FF0100u, 256, 1, "end") == length);
+    rewind(file);
+    CHECK(fread(read, 1, sizeof(read), file) == (size_t)length);
+    CHECK(memcmp(read, expected, length) == 0);
+    fclose(file);
+}
+
+static void test_hexdump(void)
+{
+    const uint8_t bytes[] = {0x00, 0x01, 0x7F, 0x80, 0xAB, 0xFF};
+    char buffer[32];
+
+    CHECK(mbed_minimal_hexdump(buffer, sizeof(buffer), bytes, sizeof(bytes), ' ') == 18);
+    CHECK(strcmp(buffer, "00 01 7F 80 AB FF ") == 0);
+    CHECK(mbed_minimal_hexdump(buffer, sizeof(buffer), bytes, sizeof(bytes), 0) == 12);
+    CHECK(strcmp(buffer, "00017F80ABFF") == 0);
+    CHECK(mbed_minimal_hexdump(buffer, sizeof(buffer), bytes, 0, ' ') == 0);
+    CHECK(buffer[0] == '\0');
+
+    // Only whole bytes are written
+    CHECK(mbed_minimal_hexdump(buffer, 9, bytes, sizeof(bytes), ' ') == 6);
+    CHECK(strcmp(buffer, "00 01 ") == 0);
+    CHECK(mbed_minimal_hexdump(buffer, 10, bytes, sizeof(bytes), ' ') == 9);
+    CHECK(mbed_minimal_hexdump(buffer, 5, bytes, sizeof(bytes), 0) == 4);
+    CHECK(strcmp(buffer, "0001") == 0);
+    CHECK(mbed_minimal_hexdump(buffer, 0, bytes, sizeof(bytes), 0) == 0);
+}
+
+/* Threads formatting at the same time */
+static void *format_thread(void *argument)
+{
+    intptr_t id = (intptr_t)argument;
+    intptr_t errors = 0;
+    int i;
+
+    for (i = 0; i < 100000; i++) {
+        char minimal[64];
+        char libc[64];
+
+        mbed_minimal_snprintf(minimal, sizeof(minimal), "%ld:%08x:%-6s:%d", (long)id, i * 2654435761u, "thr", -i);
+        snprintf(libc, sizeof(libc), "%ld:%08x:%-6s:%d", (long)id, i * 2654435761u, "thr", -i);
+        if (strcmp(minimal, libc)) {
+            errors++;
+        }
+    }
+    return (void *)errors;
+}
+
+static void test_reentrancy(void)
+{
+    pthread_t threads[4];
+    intptr_t i;
+
+    for (i = 0; i < 4; i++) {
+        CHECK(pthread_create(&threads[i], NULL, format_thread, (void *)i) == 0);
+    }
+    for (i = 0; i < 4; i++) {
+        void *errors;
+
+        pthread_join(threads[i], &errors);
+        CHECK(errors == NULL);
+    }
+}
+
+/* Benchmark */
+
+#define BENCH_CALLS     1000000
+
+typedef int (*formatter_t)(char *buffer, size_t size, const char *format, va_list arguments);
+
+static volatile int bench_sink;
+
+static double now_ns(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec * 1e9 + time.tv_nsec;
+}
+
+static void bench_call(formatter_t formatter, char *buffer, const char *format, ...)
+{
+    va_list arguments;
+
+    va_start(arguments, format);
+    bench_sink += formatter(buffer, 128, format, arguments);
+    va_end(arguments);
+}
+
+static int libc_vsnprintf(char *buffer, size_t size, const char *format, va_list arguments)
+{
+    return vsnprintf(buffer, size, format, arguments);
+}
+
+static double bench_line(formatter_t formatter, int line)
+{
+    char buffer[128];
+    double start = now_ns();
+    int n;
+
+    for (n = 0; n < BENCH_CALLS; n++) {
+        switch (line) {
+            case 0:
+                bench_call(formatter, buffer, "\r\n(Length: %d, Port%d)\r\n", n & 0xFF, 5);
+                break;
+            case 1:
+                bench_call(formatter, buffer, "AT+DTX=%d,\"%s\"\r\n", 11, "0102030405");
+                break;
+            case 2:
+                bench_call(formatter, buffer, "\nLocation: 0x%x\n", 0x0800ABCDu + n);
+                break;
+            case 3:
+                bench_call(formatter, buffer, "%-10s|%5u|%08lx|%c", "sensor", (unsigned)n, 0xDEADBEEFUL, 'k');
+                break;
+            default:
+                bench_call(formatter, buffer, "%s", "Node: Joined\r\n");
+                break;
+        }
+    }
+    return (now_ns() - start) / BENCH_CALLS;
+}
+
+/* 16 bytes as "%02X " per byte, as the node printed its frames, or in one hex dump */
+static double bench_dump(int hexdump)
+{
+    uint8_t frame[16];
+    char buffer[64];
+    double start;
+    int n;
+    int i;
+
+    for (i = 0; i < 16; i++) {
+        frame[i] = (uint8_t)(i * 37);
+    }
+    start = now_ns();
+    for (n = 0; n < BENCH_CALLS / 10; n++) {
+        frame[0] = (uint8_t)n;
+        if (hexdump) {
+            bench_sink += (int)mbed_minimal_hexdump(buffer, sizeof(buffer), frame, sizeof(frame), ' ');
+        } else {
+            for (i = 0; i < 16; i++) {
+                bench_sink += mbed_minimal_snprintf(buffer + 3 * i, 4, "%02X ", frame[i]);
+            }
+        }
+    }
+    return (now_ns() - start) / (BENCH_CALLS / 10);
+}
+
+static void benchmark(void)
+{
+    static const char *lines[] = {"rx length", "at command", "error hex", "flags", "string"};
+    int line;
+
+    printf("%-12s  minimal ns  host libc ns\n", VARIANT);
+    for (line = 0; line < 5; line++) {
+        double minimal = bench_line(mbed_minimal_vsnprintf, line);
+        double libc = bench_line(libc_vsnprintf, line);
+
+        printf("%-12s  %10.1f  %12.1f\n", lines[line], minimal, libc);
+    }
+    printf("16 bytes: %%02X per byte %.1f ns, hex dump %.1f ns\n", bench_dump(0), bench_dump(1));
+}
+
+int main(void)
+{
+    test_integers();
+    test_characters();
+    test_pointers();
+    test_unsupported();
+    test_truncation();
+    test_sink();
+    test_file();
+    test_hexdump();
+    test_reentrancy();
+
+    benchmark();
+
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All tests passed\n");
+    return 0;
+}
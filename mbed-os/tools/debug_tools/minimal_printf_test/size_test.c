@@ -0,0 +1,32 @@
+/* Smallest program formatting a log line, to compare the flash used by the
+ * minimal printf (MINIMAL_PRINTF defined) with the printf of newlib-nano
+ */
+#include <stdarg.h>
+#include <stdio.h>
+
+#if MINIMAL_PRINTF
+#include "platform/mbed_minimal_printf.h"
+#define VSNPRINTF   mbed_minimal_vsnprintf
+#else
+#define VSNPRINTF   vsnprintf
+#endif
+
+static char line[128];
+
+static int log_line(const char *format, ...)
+{
+    va_list arguments;
+    int ret;
+
+    va_start(arguments, format);
+    ret = VSNPRINTF(line, sizeof(line), format, arguments);
+    va_end(arguments);
+    return ret;
+}
+
+int main(void)
+{
+    volatile int value = 1234;
+
+    return log_line("%d %u %5x %-8s %c %.3d\r\n", value, (unsigned)value, value, "node", 'k', value);
+}
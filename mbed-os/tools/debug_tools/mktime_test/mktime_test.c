@@ -0,0 +1,250 @@
+/* Host test of the civil date conversions of platform/mbed_mktime.c
+ *
+ * Every day from 1970 to 2106 is converted both ways and checked against
+ * gmtime_r() of the host for RTCs with full leap year support, and against
+ * the previous implementation for RTCs with 4-year leap years only. The
+ * cycles per conversion of both implementations are then measured.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#include "mbed_mktime.h"
+
+bool loop_rtc_maketime(const struct tm* time, time_t * seconds, rtc_leap_year_support_t leap_year_support);
+bool loop_rtc_localtime(time_t timestamp, struct tm* time_info, rtc_leap_year_support_t leap_year_support);
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+#define SECONDS_BY_DAY  86400
+#define LAST_DAY        (UINT32_MAX / SECONDS_BY_DAY)   // 7th of February 2106
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void)
+{
+    // xorshift32
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static uint64_t cycles(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+#endif
+}
+
+static int same_date(const struct tm *a, const struct tm *b)
+{
+    return a->tm_sec == b->tm_sec && a->tm_min == b->tm_min && a->tm_hour == b->tm_hour &&
+           a->tm_mday == b->tm_mday && a->tm_mon == b->tm_mon && a->tm_year == b->tm_year &&
+           a->tm_wday == b->tm_wday && a->tm_yday == b->tm_yday;
+}
+
+/* A time of each day, spread over the day so that every hour, minute and second comes up */
+static uint32_t time_of_day(uint32_t day)
+{
+    uint64_t t = (uint64_t)day * SECONDS_BY_DAY + (day * 12347u) % SECONDS_BY_DAY;
+
+    return (t > UINT32_MAX) ? UINT32_MAX : (uint32_t)t;
+}
+
+static void test_full_leap_years(void)
+{
+    int mismatches = 0;
+
+    for (uint32_t day = 0; day <= LAST_DAY; day++) {
+        uint32_t t = time_of_day(day);
+        time_t host_t = (time_t)t, back;
+        struct tm expected, tm;
+
+        gmtime_r(&host_t, &expected);
+        memset(&tm, 0, sizeof(tm));
+        CHECK(_rtc_localtime(t, &tm, RTC_FULL_LEAP_YEAR_SUPPORT));
+        if (!same_date(&tm, &expected)) {
+            if (mismatches++ < 5) {
+                printf("%u: %d-%d-%d, expected %d-%d-%d\n", (unsigned)t, tm.tm_year, tm.tm_mon, tm.tm_mday,
+                       expected.tm_year, expected.tm_mon, expected.tm_mday);
+            }
+        }
+
+        CHECK(_rtc_days_from_civil(expected.tm_year, expected.tm_mon, expected.tm_mday, RTC_FULL_LEAP_YEAR_SUPPORT) == day);
+        CHECK(_rtc_maketime(&expected, &back, RTC_FULL_LEAP_YEAR_SUPPORT) && (uint32_t)back == t);
+    }
+    CHECK(mismatches == 0);
+}
+
+static void test_4_year_leap_years(void)
+{
+    int mismatches = 0;
+
+    for (uint32_t day = 0; day <= LAST_DAY; day++) {
+        uint32_t t = time_of_day(day);
+        time_t back, loop_back;
+        struct tm expected, tm;
+        bool valid;
+
+        memset(&expected, 0, sizeof(expected));
+        memset(&tm, 0, sizeof(tm));
+        CHECK(loop_rtc_localtime(t, &expected, RTC_4_YEAR_LEAP_YEAR_SUPPORT));
+        CHECK(_rtc_localtime(t, &tm, RTC_4_YEAR_LEAP_YEAR_SUPPORT));
+        if (!same_date(&tm, &expected)) {
+            if (mismatches++ < 5) {
+                printf("%u: %d-%d-%d, expected %d-%d-%d\n", (unsigned)t, tm.tm_year, tm.tm_mon, tm.tm_mday,
+                       expected.tm_year, expected.tm_mon, expected.tm_mday);
+            }
+        }
+
+        CHECK(_rtc_days_from_civil(tm.tm_year, tm.tm_mon, tm.tm_mday, RTC_4_YEAR_LEAP_YEAR_SUPPORT) == day);
+
+        // The range ends a day earlier, at the 6th of February 2106
+        valid = loop_rtc_maketime(&expected, &loop_back, RTC_4_YEAR_LEAP_YEAR_SUPPORT);
+        CHECK(_rtc_maketime(&tm, &back, RTC_4_YEAR_LEAP_YEAR_SUPPORT) == valid);
+        CHECK(!valid || ((uint32_t)back == t && back == loop_back));
+    }
+    CHECK(mismatches == 0);
+}
+
+static void test_edges(void)
+{
+    struct tm tm;
+    time_t t;
+
+    // The 29th of February 2100 exists only for RTCs with 4-year leap years
+    memset(&tm, 0, sizeof(tm));
+    tm.tm_year = 200;
+    tm.tm_mon = 1;
+    tm.tm_mday = 29;
+    CHECK(_rtc_maketime(&tm, &t, RTC_4_YEAR_LEAP_YEAR_SUPPORT));
+    CHECK(_rtc_localtime(t, &tm, RTC_4_YEAR_LEAP_YEAR_SUPPORT));
+    CHECK(tm.tm_mon == 1 && tm.tm_mday == 29 && tm.tm_yday == 59);
+    CHECK(_rtc_localtime(t, &tm, RTC_FULL_LEAP_YEAR_SUPPORT));
+    CHECK(tm.tm_mon == 2 && tm.tm_mday == 1 && tm.tm_yday == 59);
+
+    // The last second of the 32-bit range
+    CHECK(_rtc_localtime((time_t)UINT32_MAX, &tm, RTC_FULL_LEAP_YEAR_SUPPORT));
+    CHECK(tm.tm_year == 206 && tm.tm_mon == 1 && tm.tm_mday == 7);
+    CHECK(tm.tm_hour == 6 && tm.tm_min == 28 && tm.tm_sec == 15);
+    CHECK(_rtc_maketime(&tm, &t, RTC_FULL_LEAP_YEAR_SUPPORT) && (uint32_t)t == UINT32_MAX);
+    tm.tm_sec++;
+    CHECK(!_rtc_maketime(&tm, &t, RTC_FULL_LEAP_YEAR_SUPPORT));
+    CHECK(_rtc_localtime((time_t)UINT32_MAX, &tm, RTC_4_YEAR_LEAP_YEAR_SUPPORT));
+    CHECK(tm.tm_year == 206 && tm.tm_mon == 1 && tm.tm_mday == 6);
+
+    // Out of range and null arguments
+    tm.tm_year = 69;
+    CHECK(!_rtc_maketime(&tm, &t, RTC_FULL_LEAP_YEAR_SUPPORT));
+    tm.tm_year = 207;
+    CHECK(!_rtc_maketime(&tm, &t, RTC_FULL_LEAP_YEAR_SUPPORT));
+    CHECK(!_rtc_maketime(NULL, &t, RTC_FULL_LEAP_YEAR_SUPPORT));
+    CHECK(!_rtc_maketime(&tm, NULL, RTC_FULL_LEAP_YEAR_SUPPORT));
+    CHECK(!_rtc_localtime(0, NULL, RTC_FULL_LEAP_YEAR_SUPPORT));
+}
+
+#define BENCH_COUNT 1000000
+
+static uint32_t bench_times[BENCH_COUNT];
+static struct tm bench_dates[BENCH_COUNT];
+
+typedef bool (*localtime_fn)(time_t, struct tm *, rtc_leap_year_support_t);
+typedef bool (*maketime_fn)(const struct tm *, time_t *, rtc_leap_year_support_t);
+
+static double bench_localtime(localtime_fn fn)
+{
+    struct tm tm;
+    volatile int sink = 0;
+    uint64_t start = cycles();
+
+    for (int i = 0; i < BENCH_COUNT; i++) {
+        fn(bench_times[i], &tm, RTC_4_YEAR_LEAP_YEAR_SUPPORT);
+        sink += tm.tm_mday;
+    }
+    return (double)(cycles() - start) / BENCH_COUNT;
+}
+
+static double bench_maketime(maketime_fn fn)
+{
+    time_t t;
+    volatile uint32_t sink = 0;
+    uint64_t start = cycles();
+
+    for (int i = 0; i < BENCH_COUNT; i++) {
+        fn(&bench_dates[i], &t, RTC_4_YEAR_LEAP_YEAR_SUPPORT);
+        sink += (uint32_t)t;
+    }
+    return (double)(cycles() - start) / BENCH_COUNT;
+}
+
+static void benchmark(void)
+{
+    static const struct {
+        const char *name;
+        uint32_t first;
+        uint32_t last;
+    } ranges[] = {
+        {"1970-1979", 0, 315532799u},
+        {"2018-2027", 1514764800u, 1830297599u},
+        {"2090-2106", 3786825600u, 4102444799u},
+    };
+
+    printf("\nCycles per conversion, %s\n", (sizeof(void *) == 4) ? "32-bit host" : "64-bit host");
+    printf("%-10s %16s %16s %16s %16s\n", "years", "localtime loop", "localtime O(1)", "maketime before", "maketime after");
+    for (unsigned r = 0; r < sizeof(ranges) / sizeof(ranges[0]); r++) {
+        double loop_local, local, loop_make, make;
+
+        for (int i = 0; i < BENCH_COUNT; i++) {
+            bench_times[i] = ranges[r].first + rng() % (ranges[r].last - ranges[r].first);
+            loop_rtc_localtime(bench_times[i], &bench_dates[i], RTC_4_YEAR_LEAP_YEAR_SUPPORT);
+        }
+        // Warm up, then the best of 3 runs
+        bench_localtime(_rtc_localtime);
+        loop_local = local = loop_make = make = 1e9;
+        for (int run = 0; run < 3; run++) {
+            double c;
+
+            c = bench_localtime(loop_rtc_localtime);
+            loop_local = (c < loop_local) ? c : loop_local;
+            c = bench_localtime(_rtc_localtime);
+            local = (c < local) ? c : local;
+            c = bench_maketime(loop_rtc_maketime);
+            loop_make = (c < loop_make) ? c : loop_make;
+            c = bench_maketime(_rtc_maketime);
+            make = (c < make) ? c : make;
+        }
+        printf("%-10s %16.1f %16.1f %16.1f %16.1f\n", ranges[r].name, loop_local, local, loop_make, make);
+    }
+}
+
+int main(void)
+{
+    test_full_leap_years();
+    test_4_year_leap_years();
+    test_edges();
+
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All %u days from 1970 to 2106 checked\n", (unsigned)LAST_DAY + 1);
+    benchmark();
+    return 0;
+}
@@ -0,0 +1,363 @@
+/* Host test of the time on air and duty cycle budget of node_airtime.cpp
+ *
+ * The time on air is checked against the floating point formula of the
+ * Semtech SX1272/76 datasheets, and the region tables and budgets against the
+ * Regional Parameters. A simulation then runs a day of sensor reports in each
+ * region, sent as read, planned on the budget, or planned and packed.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "node_airtime.h"
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+/* Reference: the time on air formula of the SX1272/76 datasheets, in floating point */
+static double reference_ms(int sf, double bw_hz, int cr, int preamble, int ih, int crc, int de, int len)
+{
+    double tsym = pow(2, sf) / bw_hz * 1000.0;
+    double tpreamble = (preamble + 4.25) * tsym;
+    double payload = 8 + fmax(ceil((8.0 * len - 4.0 * sf + 28 + 16 * crc - 20 * ih) / (4.0 * (sf - 2 * de))) * (cr + 4), 0);
+
+    return tpreamble + payload * tsym;
+}
+
+static void test_lora(void)
+{
+    static const unsigned int bws[] = {125000, 250000, 500000};
+    node_airtime_lora_t lora;
+    int mismatches = 0;
+
+    // Every setting against the reference, to the us
+    for (int sf = 6; sf <= 12; sf++) {
+        for (size_t b = 0; b < sizeof(bws) / sizeof(bws[0]); b++) {
+            for (int cr = 1; cr <= 4; cr++) {
+                for (int flags = 0; flags < 8; flags++) {
+                    for (int len = 0; len <= 255; len++) {
+                        double ms;
+
+                        lora.sf = sf;
+                        lora.bw_hz = bws[b];
+                        lora.cr = cr;
+                        lora.preamble = (flags & 4) ? 12 : 8;
+                        lora.implicit_header = flags & 1;
+                        lora.crc = (flags >> 1) & 1;
+                        lora.low_dr_optimize = (sf >= 11 && (flags & 4)) ? 1 : 0;
+                        ms = reference_ms(sf, bws[b], cr, lora.preamble, lora.implicit_header, lora.crc,
+                                          lora.low_dr_optimize, len);
+                        if (fabs(node_airtime_lora_us(&lora, len) - ms * 1000.0) > 0.5) {
+                            mismatches++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    CHECK(mismatches == 0);
+
+    // LoRaWAN frames: an empty and a 51-byte payload at SF7 and SF12
+    lora.bw_hz = 125000;
+    lora.cr = 1;
+    lora.preamble = 8;
+    lora.implicit_header = 0;
+    lora.crc = 1;
+    lora.sf = 7;
+    lora.low_dr_optimize = 0;
+    CHECK(node_airtime_lora_us(&lora, 13) == 46336);
+    CHECK(node_airtime_lora_us(&lora, 64) == 118016);
+    lora.sf = 12;
+    lora.low_dr_optimize = 1;
+    CHECK(node_airtime_lora_us(&lora, 13) == 1155072);
+    CHECK(node_airtime_lora_us(&lora, 64) == 2793472);
+
+    CHECK(node_airtime_fsk_us(13) == 24 * 160);
+}
+
+static void test_regions(void)
+{
+    const node_airtime_region_t *eu = node_airtime_get_region(NODE_REGION_EU);
+    const node_airtime_region_t *us = node_airtime_get_region(NODE_REGION_US);
+    const node_airtime_region_t *jp = node_airtime_get_region(NODE_REGION_JP);
+    const node_airtime_region_t *au = node_airtime_get_region(NODE_REGION_AU);
+
+    CHECK(node_airtime_get_region(0) == NULL);
+    CHECK(node_airtime_get_region(7) == NULL);
+    for (int r = NODE_REGION_AU; r <= NODE_REGION_US; r++) {
+        CHECK(node_airtime_get_region(r) != NULL);
+        CHECK(node_airtime_get_region(r)->band_count <= NODE_AIRTIME_MAX_BANDS);
+    }
+
+    // EU868: the payload limits, the LoRaWAN overhead and the FSK data rate
+    node_airtime_init(eu, 0);
+    CHECK(node_airtime_frame_us(0, 51) == 2793472);
+    CHECK(node_airtime_frame_us(5, 51) == 118016);
+    CHECK(node_airtime_frame_us(7, 0) == node_airtime_fsk_us(13));
+    CHECK(node_airtime_frame_us(8, 0) == 0);
+    CHECK(node_airtime_max_payload(0) == 51);
+    CHECK(node_airtime_max_payload(3) == 115);
+    CHECK(node_airtime_max_payload(7) == 222);
+    CHECK(node_airtime_max_payload(-1) == -1);
+    CHECK(node_airtime_safe_payload() == 51);
+    CHECK(node_airtime_band(868100000) == 0);
+    CHECK(node_airtime_band(868500000) == 0);
+    CHECK(node_airtime_band(869525000) == 3);
+    CHECK(node_airtime_band(868650000) == -1);
+    CHECK(node_airtime_band(915000000) == -1);
+
+    // US915: 400 ms of dwell time
+    node_airtime_init(us, 0);
+    CHECK(node_airtime_max_payload(0) == 11);
+    CHECK(node_airtime_frame_us(0, 11) == 370688);
+    CHECK(node_airtime_frame_us(0, 12) > 400000);
+    CHECK(node_airtime_max_payload(4) == 242);
+    CHECK(node_airtime_safe_payload() == 11);
+    unsigned int sf8_500_us = node_airtime_frame_us(4, 51);
+    CHECK(node_airtime_until(0, 0, 11, 0) == 0);
+    CHECK(node_airtime_until(0, 0, 12, 0) == -1);
+    CHECK(node_airtime_until(5, 0, 1, 0) == -1);
+    CHECK(node_airtime_budget_us(0, 0) == -1);
+
+    // AU915: SF12 to SF7 at 125 kHz, then SF8 at 500 kHz, without dwell time
+    node_airtime_init(au, 0);
+    CHECK(au->dr_count == 7);
+    CHECK(node_airtime_max_payload(0) == 51);
+    CHECK(node_airtime_frame_us(0, 51) == 2793472);
+    CHECK(node_airtime_max_payload(3) == 115);
+    CHECK(node_airtime_max_payload(4) == 242);
+    CHECK(node_airtime_frame_us(5, 51) == 118016);
+    CHECK(node_airtime_max_payload(6) == 242);
+    CHECK(node_airtime_frame_us(6, 51) == sf8_500_us);
+    CHECK(node_airtime_max_payload(7) == -1);
+    CHECK(node_airtime_safe_payload() == 51);
+
+    // AS923: DR0 and DR1 are too long for the dwell time
+    node_airtime_init(jp, 0);
+    CHECK(node_airtime_max_payload(0) == -1);
+    CHECK(node_airtime_max_payload(1) == -1);
+    CHECK(node_airtime_max_payload(2) == 11);
+    CHECK(node_airtime_safe_payload() == 11);
+    for (int dr = 2; dr < jp->dr_count; dr++) {
+        CHECK(node_airtime_frame_us(dr, node_airtime_max_payload(dr)) <= 400000);
+    }
+    CHECK(node_airtime_band(923200000) == 0);
+}
+
+static void test_pack(void)
+{
+    node_airtime_init(node_airtime_get_region(NODE_REGION_EU), 0);
+
+    // The packed length takes as long, and one more byte takes longer
+    for (int dr = 0; dr <= 7; dr++) {
+        for (int len = 0; len <= node_airtime_max_payload(dr); len++) {
+            int packed = node_airtime_pack(dr, len);
+
+            CHECK(packed >= len && packed <= node_airtime_max_payload(dr));
+            CHECK(node_airtime_frame_us(dr, packed) == node_airtime_frame_us(dr, len));
+            if (packed < node_airtime_max_payload(dr)) {
+                CHECK(node_airtime_frame_us(dr, packed + 1) > node_airtime_frame_us(dr, len));
+            }
+        }
+    }
+    // SF12 blocks are 5 bytes long past the header, FSK bytes are not free
+    CHECK(node_airtime_pack(0, 11) == 12);
+    CHECK(node_airtime_pack(0, 13) == 17);
+    CHECK(node_airtime_pack(7, 11) == 11);
+    CHECK(node_airtime_pack(0, 52) == -1);
+}
+
+static void test_budget(void)
+{
+    const node_airtime_region_t *eu = node_airtime_get_region(NODE_REGION_EU);
+    unsigned int frame_us, now;
+    int sent, wait;
+
+    // EU868 g1 at 1 %: the budget holds 36 s of airtime
+    node_airtime_init(eu, 1000);
+    CHECK(node_airtime_budget_us(0, 1000) == 36000000);
+    CHECK(node_airtime_budget_us(2, 1000) == 3600000);
+    CHECK(node_airtime_budget_us(3, 1000) == 360000000);
+
+    frame_us = node_airtime_frame_us(0, 51);
+    for (sent = 0; node_airtime_until(0, 0, 51, 1000) == 0; sent++) {
+        node_airtime_commit(0, 0, 51, 1000);
+    }
+    CHECK(sent == (int)(36000000 / frame_us));
+
+    // Then a frame every 100 times its airtime
+    wait = node_airtime_until(0, 0, 51, 1000);
+    CHECK(wait > 0 && wait <= (int)(frame_us * 100 / 1000) + 1);
+    now = 1000 + wait;
+    CHECK(node_airtime_until(0, 0, 51, now - 1) > 0);
+    CHECK(node_airtime_until(0, 0, 51, now) == 0);
+    node_airtime_commit(0, 0, 51, now);
+    wait = node_airtime_until(0, 0, 51, now);
+    CHECK(wait > 0 && wait <= (int)((frame_us * 100 + 999) / 1000));
+
+    // The other sub-bands keep their budgets
+    CHECK(node_airtime_until(0, 4, 51, now) == 0);
+    CHECK(node_airtime_budget_us(4, now) == 36000000);
+
+    // The budget refills to its cap, also across the wrap of the ms counter
+    node_airtime_init(eu, 0xFFFFF000);
+    node_airtime_commit(0, 0, 51, 0xFFFFF000);
+    CHECK(node_airtime_budget_us(0, 0xFFFFF000) == 36000000 - frame_us);
+    CHECK(node_airtime_budget_us(0, 0x1000) == 36000000 - frame_us + 0x2000 * 10);
+    CHECK(node_airtime_budget_us(0, 0x1000 + 3600000) == 36000000);
+
+    // A frame sent early leaves a debt
+    node_airtime_init(eu, 0);
+    for (sent = 0; sent < 20; sent++) {
+        node_airtime_commit(0, 0, 51, 0);
+    }
+    CHECK(node_airtime_budget_us(0, 0) < 0);
+
+    // JP at 10 %, over the hour
+    node_airtime_init(node_airtime_get_region(NODE_REGION_JP), 0);
+    CHECK(node_airtime_budget_us(0, 0) == 360000000);
+    CHECK(node_airtime_until(5, 1, 10, 0) == -1);
+}
+
+/* A day of sensor reports */
+
+#define SIM_PERIOD_MS       60000   // Report interval
+#define SIM_READING         11      // Bytes of a reading, the TLVs of main.cpp
+#define SIM_DAY_MS          (24U * 3600000U)
+
+typedef struct {
+    int region;
+    int dr;
+} sim_case_t;
+
+typedef struct {
+    unsigned int readings;
+    unsigned int delivered;
+    unsigned int frames;
+    unsigned int refused;           // Frames sent over the budget, which the stack refuses
+    unsigned long long airtime_us;
+    unsigned long long delay_ms;
+} sim_result_t;
+
+/* Send each reading as it is read */
+static void sim_direct(const sim_case_t *c, sim_result_t *r)
+{
+    node_airtime_init(node_airtime_get_region(c->region), 0);
+    for (unsigned int now = 0; now < SIM_DAY_MS; now += SIM_PERIOD_MS) {
+        r->readings++;
+        if (node_airtime_until(c->dr, 0, SIM_READING, now) != 0) {
+            r->refused++;
+            continue;
+        }
+        node_airtime_commit(c->dr, 0, SIM_READING, now);
+        r->frames++;
+        r->delivered++;
+        r->airtime_us += node_airtime_frame_us(c->dr, SIM_READING);
+    }
+}
+
+/* Send the readings at the earliest legal time, up to pack of them per frame; the oldest are dropped past that */
+static void sim_planned(const sim_case_t *c, sim_result_t *r, int pack)
+{
+    unsigned int pending[16], count = 0, next_ms = 0;
+
+    node_airtime_init(node_airtime_get_region(c->region), 0);
+    for (unsigned int now = 0; now < SIM_DAY_MS; now += 1000) {
+        if (now % SIM_PERIOD_MS == 0) {
+            r->readings++;
+            if (count == (unsigned int)pack) {
+                memmove(pending, pending + 1, (count - 1) * sizeof(pending[0]));
+                count--;
+            }
+            pending[count++] = now;
+        }
+        if (count == 0 || now < next_ms) {
+            continue;
+        }
+
+        int len = count * SIM_READING;
+        int wait = node_airtime_until(c->dr, 0, len, now);
+
+        if (wait > 0) {
+            next_ms = now + wait;
+            continue;
+        }
+        node_airtime_commit(c->dr, 0, len, now);
+        r->frames++;
+        r->airtime_us += node_airtime_frame_us(c->dr, len);
+        for (unsigned int i = 0; i < count; i++) {
+            r->delivered++;
+            r->delay_ms += now - pending[i];
+        }
+        count = 0;
+    }
+}
+
+static void sim_print(const char *mode, const sim_result_t *r)
+{
+    printf("  %-8s %5u frames  %5u refused  %5u of %u readings  %6.1f s on air (%5.2f %%)  %6.1f s mean delay\n",
+           mode, r->frames, r->refused, r->delivered, r->readings, r->airtime_us / 1e6,
+           r->airtime_us / 1e3 * 100.0 / SIM_DAY_MS, r->delivered ? r->delay_ms / 1000.0 / r->delivered : 0.0);
+}
+
+static void simulate(void)
+{
+    static const sim_case_t cases[] = {
+        {NODE_REGION_EU, 0}, {NODE_REGION_EU, 3}, {NODE_REGION_EU, 5},
+        {NODE_REGION_JP, 2}, {NODE_REGION_TW, 2},
+        {NODE_REGION_US, 0}, {NODE_REGION_AU, 0}, {NODE_REGION_CN470, 0},
+    };
+
+    printf("A %d-byte reading every %d s for a day, on the default channels\n", SIM_READING, SIM_PERIOD_MS / 1000);
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const sim_case_t *c = &cases[i];
+        sim_result_t direct, planned, packed;
+        int pack;
+
+        memset(&direct, 0, sizeof(direct));
+        memset(&planned, 0, sizeof(planned));
+        memset(&packed, 0, sizeof(packed));
+
+        node_airtime_init(node_airtime_get_region(c->region), 0);
+        pack = node_airtime_max_payload(c->dr) / SIM_READING;
+        if (pack > 16) {
+            pack = 16;
+        }
+        printf("%s DR%d: %u us per reading, %d readings per frame\n", node_airtime_get_region(c->region)->name,
+               c->dr, node_airtime_frame_us(c->dr, SIM_READING), pack);
+
+        sim_direct(c, &direct);
+        sim_print("direct", &direct);
+        sim_planned(c, &planned, 1);
+        sim_print("planned", &planned);
+        sim_planned(c, &packed, pack);
+        sim_print("packed", &packed);
+
+        // Planning never goes over the budget, and packing delivers at least as many readings
+        CHECK(planned.airtime_us <= SIM_DAY_MS * 1000ULL / 100 + 36000000ULL || c->region != NODE_REGION_EU);
+        CHECK(packed.delivered >= planned.delivered);
+    }
+}
+
+int main(void)
+{
+    test_lora();
+    test_regions();
+    test_pack();
+    test_budget();
+    simulate();
+
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All tests passed\n");
+    return 0;
+}
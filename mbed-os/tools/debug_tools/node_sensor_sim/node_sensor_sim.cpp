@@ -0,0 +1,259 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Host simulation of the sensor sampling of main.cpp.
+ *
+ * Compares, over one simulated hour, the wake-ups of the core caused by
+ * sampling the sensors:
+ * - with one thread per sensor, looping on a blocking write, Thread::wait
+ *   for the conversion, a blocking read and Thread::wait for the period.
+ * - with node_sensor.cpp sampling every sensor from one event queue, on the
+ *   I2CBus scheduler.
+ * A wake-up is a time at which a timer expires or an I2C transfer ends with
+ * the core otherwise asleep. Events at the same time share a wake-up.
+ *
+ * It also prints the RAM used by each design on the Cortex-M4.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "node_sensor.h"
+#include "platform/mbed_critical.h"
+
+using namespace mbed;
+
+#define BYTE_TIME_US            90      // 9 bits at 100 kHz
+#define SIM_TIME_US             (3600ULL * 1000000)
+
+/* Sizes on the Cortex-M4 */
+#define THREAD_STACK_SIZE       4096    // MBED_CONF_APP_THREAD_STACK_SIZE, stack of new Thread()
+#define THREAD_CB_SIZE          72      // osRtxThread_t
+#define EVENT_SIZE              48      // EVENTS_EVENT_SIZE
+#define I2CBUS_SIZE             56      // I2CBus
+#define SENSOR_SIZE             76      // node_sensor_t
+
+static events::EventQueue queue;
+static uint32_t transfers;
+
+/* Platform */
+
+const ticker_data_t *get_us_ticker_data(void)
+{
+    return NULL;
+}
+
+us_timestamp_t ticker_read_us(const ticker_data_t *const ticker)
+{
+    (void)ticker;
+    return queue.now();
+}
+
+void core_util_critical_section_enter(void)
+{
+}
+
+void core_util_critical_section_exit(void)
+{
+}
+
+extern "C" void mbed_assert_internal(const char *expr, const char *file, int line)
+{
+    printf("assertion failed: %s, %s:%d\n", expr, file, line);
+    exit(1);
+}
+
+/* Bus model: every device acknowledges, the completion interrupt comes at the end of the transfer */
+
+static uint64_t transfer_time(int tx_length, int rx_length)
+{
+    return (tx_length ? (1 + tx_length) * BYTE_TIME_US : 0) + (rx_length ? (1 + rx_length) * BYTE_TIME_US : 0);
+}
+
+int I2C::transfer(int address, const char *tx_buffer, int tx_length, char *rx_buffer, int rx_length,
+                  const event_callback_t &callback, int event, bool repeated)
+{
+    (void)address;
+    (void)tx_buffer;
+    (void)event;
+    (void)repeated;
+
+    event_callback_t done = callback;
+
+    memset(rx_buffer, 0, rx_length);
+    transfers++;
+    queue.post_at(queue.now() + transfer_time(tx_length, rx_length), [ = ] {
+        done.call(I2C_EVENT_TRANSFER_COMPLETE);
+    });
+    return 0;
+}
+
+/* Sensors */
+
+struct sensor_def_t {
+    const char *name;
+    unsigned int period_ms;
+    unsigned int jitter_ms;
+    unsigned int latency_ms;
+    int address;
+    int cmd_len;
+    int data_len;
+    unsigned int thread_start_ms;       // first sample of the sensor thread
+};
+
+static const sensor_def_t hdc1510 = { "HDC1510", 1000, 100, 50, 0x80, 1, 4, 1000 };
+static const sensor_def_t iaq_core = { "iAQ-Core", 2000, 0, 0, 0xB5, 0, 9, 0 };
+static const sensor_def_t light = { "1.5 s sensor", 1500, 500, 0, 0x52, 0, 2, 0 };
+
+struct scenario_t {
+    const char *name;
+    const sensor_def_t *sensors[3];
+    int count;
+};
+
+static const scenario_t scenarios[] = {
+    { "HDC1510 (main.cpp default)", { &hdc1510 }, 1 },
+    { "HDC1510 + iAQ-Core", { &hdc1510, &iaq_core }, 2 },
+    { "HDC1510 + iAQ-Core + 1.5 s sensor", { &hdc1510, &iaq_core, &light }, 3 },
+};
+
+/* One thread per sensor: blocking transfers and Thread::wait */
+
+struct sensor_thread_t {
+    const sensor_def_t *def;
+    uint32_t samples;
+};
+
+static void thread_read(sensor_thread_t *thread);
+
+static void thread_sample(sensor_thread_t *thread)
+{
+    const sensor_def_t *def = thread->def;
+
+    thread->samples++;
+    transfers++;
+    if (def->cmd_len == 0) {
+        thread_read(thread);
+        return;
+    }
+    // Write, then Thread::wait(latency) once the transfer interrupt wakes the thread
+    queue.post_at(queue.now() + transfer_time(def->cmd_len, 0), [ = ] {
+        queue.post_at(queue.now() + def->latency_ms * 1000ULL, [ = ] {
+            transfers++;
+            thread_read(thread);
+        });
+    });
+}
+
+static void thread_read(sensor_thread_t *thread)
+{
+    const sensor_def_t *def = thread->def;
+
+    // Read, then Thread::wait(period)
+    queue.post_at(queue.now() + transfer_time(0, def->data_len), [ = ] {
+        queue.post_at(queue.now() + def->period_ms * 1000ULL, [ = ] { thread_sample(thread); });
+    });
+}
+
+static void run_threads(const scenario_t *scenario)
+{
+    sensor_thread_t threads[3];
+    uint32_t samples = 0;
+
+    for (int i = 0; i < scenario->count; i++) {
+        threads[i].def = scenario->sensors[i];
+        threads[i].samples = 0;
+        queue.post_at(threads[i].def->thread_start_ms * 1000ULL, [ =, &threads] { thread_sample(&threads[i]); });
+    }
+    queue.dispatch(SIM_TIME_US);
+
+    for (int i = 0; i < scenario->count; i++) {
+        samples += threads[i].samples;
+    }
+    unsigned ram = scenario->count * (THREAD_STACK_SIZE + THREAD_CB_SIZE);
+    printf("  %-14s %6u samples %6u transfers %7u wake-ups/h %6u bytes of RAM\n",
+           "threads", samples, transfers, queue.wakeups(), ram);
+}
+
+/* One event queue: node_sensor.cpp */
+
+static void sensor_read(node_sensor_t *sensor, int event)
+{
+    (void)sensor;
+    (void)event;
+}
+
+static void run_node_sensor(const scenario_t *scenario, bool jitter)
+{
+    I2C i2c;
+    I2CBus bus(i2c, &queue);
+    node_sensor_t sensors[3];
+    static const char cmd[1] = { 0 };
+    static char data[3][16];
+    node_sensor_stats_t stats;
+
+    for (int i = 0; i < scenario->count; i++) {
+        const sensor_def_t *def = scenario->sensors[i];
+        node_sensor_t sensor = {
+            def->name, def->period_ms, jitter ? def->jitter_ms : 0, def->latency_ms, def->address,
+            def->cmd_len ? cmd : NULL, def->cmd_len, data[i], def->data_len, sensor_read
+        };
+        sensors[i] = sensor;
+        node_sensor_register(&sensors[i]);
+    }
+    node_sensor_start(&queue, &bus);
+    queue.dispatch(SIM_TIME_US);
+
+    node_sensor_get_stats(&stats);
+    unsigned ram = NODE_SENSOR_STACK_SIZE + THREAD_CB_SIZE + NODE_SENSOR_QUEUE_EVENTS * EVENT_SIZE +
+                   I2CBUS_SIZE + scenario->count * SENSOR_SIZE;
+    printf("  %-14s %6u samples %6u transfers %7u wake-ups/h %6u bytes of RAM\n",
+           jitter ? "queue" : "queue, exact", stats.samples, transfers, queue.wakeups(), ram);
+    if (stats.errors || stats.overruns) {
+        printf("  %u errors, %u overruns\n", stats.errors, stats.overruns);
+    }
+}
+
+/* node_sensor.cpp keeps its sensors in static state: run each case in a child process */
+template <typename F>
+static void run(F f)
+{
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        f();
+        fflush(stdout);
+        _exit(0);
+    }
+    waitpid(pid, NULL, 0);
+}
+
+int main()
+{
+    printf("Sensor sampling over one hour\n");
+    for (unsigned i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        const scenario_t *scenario = &scenarios[i];
+
+        printf("%s\n", scenario->name);
+        run([ = ] { run_threads(scenario); });
+        run([ = ] { run_node_sensor(scenario, false); });
+        run([ = ] { run_node_sensor(scenario, true); });
+    }
+    return 0;
+}
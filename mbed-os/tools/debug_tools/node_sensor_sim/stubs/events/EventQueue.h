@@ -0,0 +1,109 @@
+/* Host stand-in for events/EventQueue.h, dispatching on a simulated time */
+#ifndef NODE_SENSOR_SIM_EVENTQUEUE_H
+#define NODE_SENSOR_SIM_EVENTQUEUE_H
+
+#include <stdint.h>
+#include <functional>
+#include <map>
+#include <utility>
+
+namespace events {
+
+class EventQueue {
+public:
+    EventQueue() : _now(0), _seq(0), _wakeups(0), _last(UINT64_MAX)
+    {
+    }
+
+    template <typename F>
+    int call(F f)
+    {
+        return post(0, [ = ] { f(); });
+    }
+
+    template <typename T, typename R>
+    int call(T *obj, R (T::*method)())
+    {
+        return post(0, [ = ] { (obj->*method)(); });
+    }
+
+    template <typename T, typename R, typename B0, typename C0>
+    int call(T *obj, R (T::*method)(B0), C0 c0)
+    {
+        return post(0, [ = ] { (obj->*method)(c0); });
+    }
+
+    template <typename F>
+    int call_in(int ms, F f)
+    {
+        return post((uint64_t)ms * 1000, [ = ] { f(); });
+    }
+
+    template <typename T, typename R>
+    int call_in(int ms, T *obj, R (T::*method)())
+    {
+        return post((uint64_t)ms * 1000, [ = ] { (obj->*method)(); });
+    }
+
+    template <typename T, typename R, typename B0, typename C0>
+    int call_in(int ms, T *obj, R (T::*method)(B0), C0 c0)
+    {
+        return post((uint64_t)ms * 1000, [ = ] { (obj->*method)(c0); });
+    }
+
+    unsigned tick()
+    {
+        return (unsigned)(_now / 1000);
+    }
+
+    /* Simulation: run a function, event or interrupt, at an absolute time */
+    int post_at(uint64_t time, std::function<void()> f)
+    {
+        _events.insert(std::make_pair(std::make_pair(time, ++_seq), f));
+        return (int)_seq;
+    }
+
+    /* Simulation: run the events in time order until the time limit. Events
+     * at a time with nothing else running count as a wake-up of the core. */
+    void dispatch(uint64_t until)
+    {
+        while (!_events.empty() && (_events.begin()->first.first <= until)) {
+            auto it = _events.begin();
+            std::function<void()> f = it->second;
+            _now = it->first.first;
+            _events.erase(it);
+            if (_now != _last) {
+                _wakeups++;
+                _last = _now;
+            }
+            f();
+        }
+        _now = until;
+    }
+
+    uint64_t now() const
+    {
+        return _now;
+    }
+
+    uint32_t wakeups() const
+    {
+        return _wakeups;
+    }
+
+private:
+    int post(uint64_t delay, std::function<void()> f)
+    {
+        return post_at(_now + delay, f);
+    }
+
+    uint64_t _now;
+    uint32_t _seq;
+    uint32_t _wakeups;
+    uint64_t _last;
+    std::multimap<std::pair<uint64_t, uint32_t>, std::function<void()> > _events;
+};
+
+} // namespace events
+
+#endif
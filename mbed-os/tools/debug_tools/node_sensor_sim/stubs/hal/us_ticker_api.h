@@ -0,0 +1,13 @@
+/* Host stand-in for hal/us_ticker_api.h, on the simulated time */
+#ifndef NODE_SENSOR_SIM_US_TICKER_API_H
+#define NODE_SENSOR_SIM_US_TICKER_API_H
+
+#include <stdint.h>
+
+typedef uint64_t us_timestamp_t;
+typedef struct ticker_data_s ticker_data_t;
+
+const ticker_data_t *get_us_ticker_data(void);
+us_timestamp_t ticker_read_us(const ticker_data_t *const ticker);
+
+#endif
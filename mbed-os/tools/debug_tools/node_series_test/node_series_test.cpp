@@ -0,0 +1,452 @@
+/* Host test of the sensor series packing of node_series.cpp
+ *
+ * The frames are checked byte for byte and through the decoder, then sensor
+ * traces are packed at the largest payloads of a few data rates, and the
+ * bytes and time on air compared with a TLV frame per reading.
+ */
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "node_series.h"
+#include "node_airtime.h"
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+#define FRAME_SIZE      64      // NODE_UPLINK_FRAME_SIZE of node_uplink.h
+#define TRACE_MAX       8640    // A day of readings every 10 s
+
+static const unsigned char types[] = {1, 2, 3, 4};
+
+static int decode_ok(const char *frame, int len, node_series_t *series)
+{
+    memset(series, 0, sizeof(*series));
+    return node_series_decode(frame, len, series) == 0;
+}
+
+static void test_frame(void)
+{
+    static const unsigned char expected[] = {
+        20, NODE_SERIES_TYPE, 0x5b, 0xa0, 0x00, 0x00, 60, 3,
+        1, 0xc4, 0x27, 0x02, 0x01,      // 2530, +1, -1
+        2, 0xc0, 0x3e, 0x13, 0x00,      // 4000, -10, 0
+        5, 0x00, 0x02, 0x01,            // 0, +1, -1
+    };
+    const unsigned char channels[] = {1, 2, 5};
+    char frame[FRAME_SIZE];
+    int values[3];
+    node_series_t series;
+
+    CHECK(node_series_init(channels, 3, 60, 3, FRAME_SIZE) == 0);
+    values[0] = 2530; values[1] = 4000; values[2] = 0;
+    CHECK(node_series_add(0x5ba00000, values, frame) == 0);
+    values[0] = 2531; values[1] = 3990; values[2] = 1;
+    CHECK(node_series_add(0x5ba00000 + 60, values, frame) == 0);
+    CHECK(node_series_count() == 2);
+    values[0] = 2530; values[1] = 3990; values[2] = 0;
+    CHECK(node_series_add(0x5ba00000 + 121, values, frame) == (int)sizeof(expected));
+    CHECK(memcmp(frame, expected, sizeof(expected)) == 0);
+    CHECK(node_series_count() == 0);
+
+    CHECK(decode_ok(frame, sizeof(expected), &series));
+    CHECK(series.time_s == 0x5ba00000);
+    CHECK(series.period_s == 60);
+    CHECK(series.samples == 3);
+    CHECK(series.channels == 3);
+    CHECK(series.types[1] == 2 && series.types[2] == 5);
+    CHECK(series.values[0][0] == 2530 && series.values[0][1] == 2531 && series.values[0][2] == 2530);
+    CHECK(series.values[1][1] == 3990 && series.values[2][1] == 1);
+
+    // Invalid settings
+    CHECK(node_series_init(channels, 0, 60, 3, FRAME_SIZE) == -1);
+    CHECK(node_series_init(channels, NODE_SERIES_MAX_CHANNELS + 1, 60, 3, FRAME_SIZE) == -1);
+    CHECK(node_series_init(channels, 3, 0, 3, FRAME_SIZE) == -1);
+    CHECK(node_series_init(channels, 3, 60, 1, FRAME_SIZE) == -1);
+    CHECK(node_series_init(channels, 3, 60, NODE_SERIES_MAX_SAMPLES + 1, FRAME_SIZE) == -1);
+}
+
+static void test_extremes(void)
+{
+    static const int extremes[] = {0, 1, -1, 63, -64, 64, -65, 8191, -8192, INT_MAX, INT_MIN, INT_MAX, 0, INT_MIN};
+    const int count = sizeof(extremes) / sizeof(extremes[0]);
+    char frame[257];
+    int values[2], len;
+    node_series_t series;
+
+    // Differences over 32 bits wrap, and come back through the decoder
+    CHECK(node_series_init(types, 2, 1, count, 257) == 0);
+    for (int i = 0; i < count; i++) {
+        values[0] = extremes[i];
+        values[1] = -extremes[i];
+        len = node_series_add(1000 + i, values, frame);
+        CHECK(len == ((i == count - 1) ? len : 0));
+    }
+    CHECK(len > 0 && len <= 2 + 8 + 2 * 5 * count);
+    CHECK(decode_ok(frame, len, &series));
+    CHECK(series.samples == count);
+    for (int i = 0; i < count; i++) {
+        CHECK(series.values[0][i] == extremes[i]);
+        CHECK(series.values[1][i] == (int)(0U - (unsigned int)extremes[i]));
+    }
+
+    // Each value takes 1 byte from -64 to 63
+    CHECK(node_series_init(types, 1, 1, 3, FRAME_SIZE) == 0);
+    values[0] = -64;
+    node_series_add(0, values, frame);
+    values[0] = -1;
+    node_series_add(1, values, frame);
+    values[0] = -66;
+    CHECK(node_series_add(2, values, frame) == 8 + 1 + 1 + 1 + 2);
+}
+
+static void test_closing(void)
+{
+    char frame[FRAME_SIZE];
+    int values[2] = {2500, 5000}, len;
+    node_series_t series;
+
+    // A late reading, or one missing, closes the series; half a period early or late is on time
+    CHECK(node_series_init(types, 2, 60, 8, FRAME_SIZE) == 0);
+    CHECK(node_series_add(1000, values, frame) == 0);
+    CHECK(node_series_add(1030, values, frame) == 0);
+    CHECK(node_series_add(1149, values, frame) == 0);
+    CHECK(node_series_count() == 3);
+    len = node_series_add(1240, values, frame);
+    CHECK(len > 0);
+    CHECK(node_series_count() == 1);
+    CHECK(decode_ok(frame, len, &series));
+    CHECK(series.time_s == 1000 && series.samples == 3);
+    len = node_series_add(1000, values, frame);
+    CHECK(len > 0);
+    CHECK(decode_ok(frame, len, &series));
+    CHECK(series.time_s == 1240 && series.samples == 1);
+    CHECK(node_series_flush(frame) > 0);
+    CHECK(node_series_flush(frame) == 0);
+
+    // A reading past the largest frame length closes the series without it
+    CHECK(node_series_init(types, 2, 10, NODE_SERIES_MAX_SAMPLES, 19) == 0);
+    node_series_add(0, values, frame);          // 8 + 3 + 3 bytes
+    values[0] += 100;
+    values[1] -= 200;
+    CHECK(node_series_add(10, values, frame) == 0);     // + 2 + 2 bytes
+    values[0] += 1;
+    len = node_series_add(20, values, frame);
+    CHECK(len == 18);
+    CHECK(decode_ok(frame, len, &series));
+    CHECK(series.samples == 2 && series.values[1][1] == 4800);
+    CHECK(node_series_count() == 1);
+
+    // US915 DR0: a reading of two channels does not fit in 11 bytes, one of one channel does
+    CHECK(node_series_init(types, 2, 10, 8, 11) == 0);
+    CHECK(node_series_add(0, values, frame) == -1);
+    CHECK(node_series_count() == 0);
+    CHECK(node_series_init(types, 1, 10, 8, 11) == 0);
+    values[0] = 20;
+    CHECK(node_series_add(0, values, frame) == 0);
+    CHECK(node_series_add(10, values, frame) == 0);
+    CHECK(node_series_add(20, values, frame) == 11);
+}
+
+static void test_decode_errors(void)
+{
+    char frame[FRAME_SIZE], bad[FRAME_SIZE];
+    int values[2] = {2500, 5000}, len;
+    node_series_t series;
+
+    CHECK(node_series_init(types, 2, 300, 4, FRAME_SIZE) == 0);
+    for (int i = 0; i < 4; i++) {
+        values[0] += 300;
+        len = node_series_add(i * 300, values, frame);
+    }
+    CHECK(len > 0);
+    CHECK(decode_ok(frame, len, &series));
+
+    // Every cut frame; with its length byte fixed, a frame cut between channels holds the first ones
+    for (int cut = 0; cut < len; cut++) {
+        memcpy(bad, frame, cut);
+        CHECK(node_series_decode(bad, cut, &series) == -1);
+        if (cut >= 2) {
+            bad[0] = cut - 2;
+            CHECK(node_series_decode(bad, cut, &series) == -1 || series.channels < 2);
+        }
+    }
+
+    memcpy(bad, frame, len);
+    bad[1] = 0x0c;
+    CHECK(node_series_decode(bad, len, &series) == -1);
+    memcpy(bad, frame, len);
+    bad[8] = 0;     // After the 2-byte period
+    CHECK(node_series_decode(bad, len, &series) == -1);
+    bad[8] = NODE_SERIES_MAX_SAMPLES + 1;
+    CHECK(node_series_decode(bad, len, &series) == -1);
+
+    // A varint over 32 bits
+    static const unsigned char wide[] = {12, NODE_SERIES_TYPE, 0, 0, 0, 0, 1, 1, 1, 0xff, 0xff, 0xff, 0xff, 0x1f};
+    CHECK(node_series_decode((const char *)wide, sizeof(wide), &series) == -1);
+
+    // More channels than a series holds
+    unsigned char many[2 + 6 + 2 * (NODE_SERIES_MAX_CHANNELS + 1)];
+    memset(many, 0, sizeof(many));
+    many[0] = sizeof(many) - 2;
+    many[1] = NODE_SERIES_TYPE;
+    many[6] = 1;
+    many[7] = 1;
+    CHECK(node_series_decode((const char *)many, sizeof(many), &series) == -1);
+    many[0] -= 2;
+    CHECK(node_series_decode((const char *)many, sizeof(many) - 2, &series) == 0);
+    CHECK(series.channels == NODE_SERIES_MAX_CHANNELS);
+
+    // Random frames never read past their end
+    srand(1);
+    int decoded = 0;
+    for (int i = 0; i < 100000; i++) {
+        int n = 2 + rand() % 30;
+        char *buf = (char *)malloc(n);
+
+        for (int j = 0; j < n; j++) {
+            buf[j] = (rand() % 4) ? rand() % 4 : rand();
+        }
+        buf[0] = n - 2;
+        buf[1] = NODE_SERIES_TYPE;
+        decoded += node_series_decode(buf, n, &series) == 0;
+        free(buf);
+    }
+    CHECK(decoded > 0);
+}
+
+/* Sensor trace: readings of up to 4 channels, a reading missing where its time is 0 */
+typedef struct {
+    const char *name;
+    unsigned int period_s;
+    int count;
+    int channels;
+    unsigned int time_s[TRACE_MAX];
+    int values[TRACE_MAX][4];
+} trace_t;
+
+static trace_t trace;
+
+static double noise(double sigma)
+{
+    // Sum of 3 uniform numbers, close enough to a normal distribution
+    double sum = 0;
+
+    for (int i = 0; i < 3; i++) {
+        sum += (double)rand() / RAND_MAX - 0.5;
+    }
+    return sum * 2 * sigma;
+}
+
+/* A day of readings: a daily cycle, slow drifts and the noise of the sensors, in their TLV units */
+static void trace_model(const char *name, unsigned int period_s, int channels, double temp_min, double temp_max,
+                        int gaps)
+{
+    double drift_t = 0, drift_h = 0, co2 = 450;
+
+    srand(period_s * 7 + channels);
+    trace.name = name;
+    trace.period_s = period_s;
+    trace.channels = channels;
+    trace.count = 86400 / period_s;
+    for (int i = 0; i < trace.count; i++) {
+        double hour = i * period_s / 3600.0;
+        double day = sin((hour - 9) * M_PI / 12);
+        double temp, hum;
+
+        drift_t += noise(0.01 * sqrt(period_s / 10.0));
+        drift_h += noise(0.05 * sqrt(period_s / 10.0));
+        drift_t *= 0.999;
+        drift_h *= 0.999;
+        temp = (temp_min + temp_max) / 2 + (temp_max - temp_min) / 2 * day + drift_t + noise(0.015);
+        hum = 55 - 15 * day + drift_h + noise(0.1);
+
+        trace.time_s[i] = 1538352000 + i * period_s;
+        trace.values[i][0] = (int)floor(temp * 100 + 0.5);     // 0.01 C
+        trace.values[i][1] = (int)floor(hum * 100 + 0.5);      // 0.01 %RH
+        if (channels > 2) {
+            // Occupied from 8 to 18 h: CO2 rises and falls, TVOC follows
+            co2 += (hour >= 8 && hour < 18) ? (1100 - co2) * 0.0005 * period_s : (420 - co2) * 0.0003 * period_s;
+            trace.values[i][2] = (int)floor(co2 + noise(8) + 0.5);                     // ppm
+            trace.values[i][3] = (int)floor((co2 - 400) * 0.4 + noise(5) + 0.5);       // ppb
+        }
+    }
+
+    // Readings lost to I2C errors or resets
+    for (int g = 0; g < gaps; g++) {
+        trace.time_s[(g + 1) * trace.count / (gaps + 1)] = 0;
+    }
+}
+
+/* A recorded trace: one reading per line, time in s then the values of up to 4 channels, in their TLV units */
+static int trace_load(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[256];
+
+    if (f == NULL) {
+        printf("Cannot open %s\n", path);
+        return -1;
+    }
+    trace.name = path;
+    trace.count = 0;
+    trace.channels = 0;
+    while (fgets(line, sizeof(line), f) != NULL && trace.count < TRACE_MAX) {
+        unsigned int t;
+        int v[4];
+        int n = sscanf(line, "%u,%d,%d,%d,%d", &t, &v[0], &v[1], &v[2], &v[3]);
+
+        if (n < 2) {
+            continue;
+        }
+        if (trace.channels == 0) {
+            trace.channels = n - 1;
+        }
+        trace.time_s[trace.count] = t;
+        memcpy(trace.values[trace.count], v, sizeof(v));
+        trace.count++;
+    }
+    fclose(f);
+    trace.period_s = (trace.count > 1) ? trace.time_s[1] - trace.time_s[0] : 0;
+    return (trace.count > 1 && trace.period_s > 0) ? 0 : -1;
+}
+
+/* Length of the TLV frame of a reading in main.cpp: 5 bytes of temperature, 4 of each other channel */
+static int tlv_len(int channels)
+{
+    return 2 + 5 + 4 * (channels - 1);
+}
+
+typedef struct {
+    int region;
+    int dr;
+    int samples;
+} pack_case_t;
+
+/* Pack the trace as main.cpp does, a reading not fitting alone going as a TLV frame */
+static void pack_trace(const pack_case_t *c)
+{
+    char frame[257];
+    unsigned long long tlv_us = 0, series_us = 0;
+    unsigned int tlv_bytes = 0, series_bytes = 0, frames = 0, readings = 0, decoded = 0, fallback = 0;
+    int limit, len, mismatches = 0, pending[NODE_SERIES_MAX_SAMPLES + 1], held = 0;
+    node_series_t series;
+
+    node_airtime_init(node_airtime_get_region(c->region), 0);
+    limit = node_airtime_max_payload(c->dr);
+    if (limit > FRAME_SIZE) {
+        limit = FRAME_SIZE;
+    }
+    CHECK(node_series_init(types, trace.channels, trace.period_s, c->samples, limit) == 0);
+
+    for (int i = 0; i <= trace.count; i++) {
+        if (i < trace.count) {
+            if (trace.time_s[i] == 0) {
+                continue;
+            }
+            readings++;
+            tlv_bytes += tlv_len(trace.channels);
+            tlv_us += node_airtime_frame_us(c->dr, tlv_len(trace.channels));
+            pending[held++] = i;
+            len = node_series_add(trace.time_s[i], trace.values[i], frame);
+        } else {
+            len = node_series_flush(frame);
+        }
+
+        if (len < 0) {
+            held--;
+            fallback++;
+            frames++;
+            series_bytes += tlv_len(trace.channels);
+            series_us += node_airtime_frame_us(c->dr, tlv_len(trace.channels));
+            continue;
+        }
+        if (len == 0) {
+            continue;
+        }
+
+        CHECK(len <= limit);
+        frames++;
+        series_bytes += len;
+        series_us += node_airtime_frame_us(c->dr, len);
+
+        // Each frame decodes to the first readings held
+        CHECK(decode_ok(frame, len, &series));
+        CHECK(series.samples <= held && series.time_s == trace.time_s[pending[0]]);
+        for (int s = 0; s < series.samples && s < held; s++) {
+            for (int ch = 0; ch < trace.channels; ch++) {
+                mismatches += (series.values[ch][s] != trace.values[pending[s]][ch]);
+            }
+        }
+        held -= series.samples;
+        memmove(pending, pending + series.samples, held * sizeof(pending[0]));
+        decoded += series.samples;
+    }
+    CHECK(mismatches == 0);
+    CHECK(decoded + fallback == readings);
+
+    printf("  %-8s DR%d %3d B %2d per series  %5u frames %5.1f B/reading  x%4.2f bytes  %6.1f s on air  %5.1f %% saved\n",
+           node_airtime_get_region(c->region)->name, c->dr, limit, c->samples, frames,
+           (double)series_bytes / readings, (double)tlv_bytes / series_bytes, series_us / 1e6,
+           100.0 - series_us * 100.0 / tlv_us);
+}
+
+static void report(void)
+{
+    static const pack_case_t cases[] = {
+        {NODE_REGION_EU, 0, 6}, {NODE_REGION_EU, 0, NODE_SERIES_MAX_SAMPLES},
+        {NODE_REGION_EU, 5, 6}, {NODE_REGION_EU, 5, NODE_SERIES_MAX_SAMPLES},
+        {NODE_REGION_US, 0, 6}, {NODE_REGION_US, 3, NODE_SERIES_MAX_SAMPLES},
+    };
+
+    int missing = 0;
+
+    for (int i = 0; i < trace.count; i++) {
+        missing += (trace.time_s[i] == 0);
+    }
+    printf("%s: %d readings of %d channels every %u s, %d missing, %d bytes each as a TLV frame\n",
+           trace.name, trace.count, trace.channels, trace.period_s, missing, tlv_len(trace.channels));
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        pack_trace(&cases[i]);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    test_frame();
+    test_extremes();
+    test_closing();
+    test_decode_errors();
+
+    if (argc > 1) {
+        if (trace_load(argv[1]) != 0) {
+            printf("%s: no trace\n", argv[1]);
+            return 1;
+        }
+        report();
+    } else {
+        trace_model("office", 60, 2, 21.5, 24.5, 0);
+        report();
+        trace_model("outdoor", 300, 2, 8, 22, 3);
+        report();
+        trace_model("fast", 10, 2, 22, 23, 0);
+        report();
+        trace_model("indoor air", 60, 4, 21, 24, 2);
+        report();
+    }
+
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All tests passed\n");
+    return 0;
+}
@@ -0,0 +1,636 @@
+/* Host test of the uplink queue of node_uplink.cpp, against a node API stand-in
+ * injecting refused sends and failed TX done
+ *
+ * The checks cover the send order, the backoff, the coalescing, the full queue
+ * and the spill store. The simulation then compares the delivery ratio and the
+ * latency of the sensor readings with the former direct sends of main.cpp.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mbed.h"
+#include "node_api.h"
+#include "node_uplink.h"
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+/* Node API stand-in */
+
+#define API_NORMAL          0
+#define API_HIGH_PRI        1
+#define API_CONFIRMED       2
+#define API_HIGH_PRI_CONFIRMED 3
+
+static struct {
+    int calls[4];               // Sends by function
+    int function;               // Function of the last send
+    unsigned char port;
+    char data[NODE_UPLINK_FRAME_SIZE];
+    unsigned short len;
+    unsigned short result;      // Result of the next sends
+    unsigned int refuse_pct;    // Percentage of sends refused at random
+} api;
+
+static unsigned short api_send(int function, unsigned char port, char *data, unsigned short len)
+{
+    api.calls[function]++;
+    api.function = function;
+    api.port = port;
+    api.len = len;
+    memcpy(api.data, data, len);
+
+    if (api.result != NODE_API_OK) {
+        return api.result;
+    }
+    if ((unsigned int)(rand() % 100) < api.refuse_pct) {
+        return NODE_API_NOK;
+    }
+    return NODE_API_OK;
+}
+
+unsigned short nodeApiSendData(unsigned char port, char *data, unsigned short data_len)
+{
+    return api_send(API_NORMAL, port, data, data_len);
+}
+
+unsigned short nodeApiSendDataHighPri(unsigned char port, char *data, unsigned short data_len)
+{
+    return api_send(API_HIGH_PRI, port, data, data_len);
+}
+
+unsigned short nodeApiSendDataConfirm(unsigned char port, char *data, unsigned short data_len)
+{
+    return api_send(API_CONFIRMED, port, data, data_len);
+}
+
+unsigned short nodeApiSendDataHighPriConfirm(unsigned char port, char *data, unsigned short data_len)
+{
+    return api_send(API_HIGH_PRI_CONFIRMED, port, data, data_len);
+}
+
+static void api_reset(void)
+{
+    memset(&api, 0, sizeof(api));
+}
+
+/* Spill store stand-in, a FIFO */
+
+#define SPILL_SIZE 512
+
+static node_uplink_frame_t spill_frames[SPILL_SIZE];
+static int spill_head, spill_count;
+static bool spill_full;
+
+static int spill_store(const node_uplink_frame_t *frame)
+{
+    if (spill_full || spill_count == SPILL_SIZE) {
+        return -1;
+    }
+    spill_frames[(spill_head + spill_count++) % SPILL_SIZE] = *frame;
+    return 0;
+}
+
+static int spill_load(node_uplink_frame_t *frame)
+{
+    if (spill_count == 0) {
+        return -1;
+    }
+    *frame = spill_frames[spill_head];
+    spill_head = (spill_head + 1) % SPILL_SIZE;
+    spill_count--;
+    return 0;
+}
+
+static const node_uplink_spill_t spill = {spill_store, spill_load};
+
+/* Checks */
+
+static int push_byte(char byte, unsigned char flags, unsigned char key, unsigned int now)
+{
+    return node_uplink_push(1, &byte, 1, flags, key, now);
+}
+
+/* Send the next frame and end it at once, returning its first byte or -1 */
+static int deliver(unsigned int now)
+{
+    const node_uplink_frame_t *frame;
+
+    if (node_uplink_send(now, &frame) != NODE_UPLINK_SENT) {
+        return -1;
+    }
+    node_uplink_tx_done(NODE_API_OK, now);
+    return api.data[0];
+}
+
+static void test_send(void)
+{
+    const node_uplink_frame_t *frame;
+    node_uplink_stats_t stats;
+    char data[NODE_UPLINK_FRAME_SIZE + 1];
+
+    api_reset();
+    node_uplink_init(1);
+    memset(data, 0x5A, sizeof(data));
+
+    CHECK(node_uplink_send(0, &frame) == NODE_UPLINK_IDLE);
+    CHECK(frame == NULL);
+    CHECK(node_uplink_until_due(0) == -1);
+    CHECK(node_uplink_push(2, data, NODE_UPLINK_FRAME_SIZE + 1, 0, 0, 0) == -1);
+
+    CHECK(node_uplink_push(7, data, NODE_UPLINK_FRAME_SIZE, 0, 0, 1000) == 0);
+    CHECK(node_uplink_count() == 1);
+    CHECK(node_uplink_until_due(1000) == 0);
+    CHECK(node_uplink_peek(1000) != NULL && node_uplink_peek(1000)->port == 7);
+    CHECK(api.calls[API_NORMAL] == 0);
+    CHECK(node_uplink_send(1500, &frame) == NODE_UPLINK_SENT);
+    CHECK(frame != NULL && frame->len == NODE_UPLINK_FRAME_SIZE && frame->port == 7);
+    CHECK(api.calls[API_NORMAL] == 1 && api.port == 7 && api.len == NODE_UPLINK_FRAME_SIZE);
+    CHECK(memcmp(api.data, data, NODE_UPLINK_FRAME_SIZE) == 0);
+    CHECK(node_uplink_busy());
+
+    // One frame in flight at a time
+    CHECK(push_byte(1, 0, 0, 1500) == 0);
+    CHECK(node_uplink_send(1600, &frame) == NODE_UPLINK_IDLE);
+    CHECK(node_uplink_until_due(1600) == -1);
+    CHECK(node_uplink_peek(1600) == NULL);
+
+    node_uplink_tx_done(NODE_API_OK, 4000);
+    CHECK(!node_uplink_busy());
+    CHECK(node_uplink_count() == 1);
+    CHECK(deliver(4000) == 1);
+    CHECK(node_uplink_count() == 0);
+
+    // A TX done without a frame in flight is ignored
+    node_uplink_tx_done(NODE_API_OK, 5000);
+
+    node_uplink_get_stats(&stats);
+    CHECK(stats.queued == 2 && stats.sent == 2 && stats.delivered == 2);
+    CHECK(stats.latency_max_ms == 3000);
+    CHECK(stats.latency_sum_ms == 3000 + 2500);
+}
+
+static void test_priority(void)
+{
+    api_reset();
+    node_uplink_init(1);
+
+    CHECK(push_byte(1, 0, 0, 0) == 0);
+    CHECK(push_byte(2, NODE_UPLINK_CONFIRMED, 0, 0) == 0);
+    CHECK(push_byte(3, NODE_UPLINK_HIGH_PRI, 0, 0) == 0);
+    CHECK(push_byte(4, 0, 0, 0) == 0);
+    CHECK(push_byte(5, NODE_UPLINK_HIGH_PRI | NODE_UPLINK_CONFIRMED, 0, 0) == 0);
+    CHECK(push_byte(6, NODE_UPLINK_CONFIRMED, 0, 0) == 0);
+
+    // By priority, then by arrival, each with its send function
+    CHECK(deliver(10) == 5 && api.function == API_HIGH_PRI_CONFIRMED);
+    CHECK(deliver(10) == 2 && api.function == API_CONFIRMED);
+    CHECK(deliver(10) == 6 && api.function == API_CONFIRMED);
+    CHECK(deliver(10) == 3 && api.function == API_HIGH_PRI);
+    CHECK(deliver(10) == 1 && api.function == API_NORMAL);
+    CHECK(deliver(10) == 4 && api.function == API_NORMAL);
+    CHECK(deliver(10) == -1);
+}
+
+static void test_backoff(void)
+{
+    node_uplink_stats_t stats;
+    unsigned int now = 0, delay = NODE_UPLINK_BACKOFF_MIN_MS;
+    int attempt;
+
+    api_reset();
+    node_uplink_init(1);
+
+    // Refused sends back off, doubling up to the longest backoff, then the frame is dropped
+    api.result = NODE_API_NOK;
+    CHECK(push_byte(1, 0, 0, now) == 0);
+    for (attempt = 1; attempt <= NODE_UPLINK_MAX_ATTEMPTS; attempt++) {
+        int until;
+
+        CHECK(node_uplink_send(now, NULL) == NODE_UPLINK_REFUSED);
+        if (attempt == NODE_UPLINK_MAX_ATTEMPTS) {
+            break;
+        }
+        until = node_uplink_until_due(now);
+        CHECK(until >= (int)delay / 2 && until <= (int)delay);
+        CHECK(node_uplink_send(now + until - 1, NULL) == NODE_UPLINK_IDLE);
+        now += until;
+        delay = (delay * 2 > NODE_UPLINK_BACKOFF_MAX_MS) ? NODE_UPLINK_BACKOFF_MAX_MS : delay * 2;
+    }
+    CHECK(delay == NODE_UPLINK_BACKOFF_MAX_MS);
+    CHECK(node_uplink_count() == 0);
+    node_uplink_get_stats(&stats);
+    CHECK(stats.refused == NODE_UPLINK_MAX_ATTEMPTS && stats.expired == 1 && stats.sent == 0);
+
+    // A failed TX done backs off too, and other frames go meanwhile
+    api.result = NODE_API_OK;
+    CHECK(push_byte(2, 0, 0, now) == 0);
+    CHECK(push_byte(3, 0, 0, now) == 0);
+    CHECK(node_uplink_send(now, NULL) == NODE_UPLINK_SENT);
+    node_uplink_tx_done(NODE_API_NOK, now);
+    CHECK(node_uplink_until_due(now) == 0);
+    CHECK(deliver(now) == 3);
+    CHECK(node_uplink_until_due(now) > 0);
+    now += node_uplink_until_due(now);
+    CHECK(deliver(now) == 2);
+
+    // A frame without TX done is taken as lost after the timeout, and the next one waits for its TX done as long
+    CHECK(push_byte(4, 0, 0, now) == 0);
+    CHECK(push_byte(5, 0, 0, now) == 0);
+    CHECK(node_uplink_send(now, NULL) == NODE_UPLINK_SENT);
+    CHECK(node_uplink_send(now + NODE_UPLINK_TX_TIMEOUT_MS - 1, NULL) == NODE_UPLINK_IDLE);
+    now += NODE_UPLINK_TX_TIMEOUT_MS;
+    CHECK(node_uplink_expire(now) == 1);
+    CHECK(node_uplink_peek(now) == NULL && node_uplink_until_due(now) == NODE_UPLINK_TX_TIMEOUT_MS);
+    CHECK(node_uplink_send(now + NODE_UPLINK_TX_TIMEOUT_MS - 1, NULL) == NODE_UPLINK_IDLE);
+    CHECK(node_uplink_send(now + NODE_UPLINK_TX_TIMEOUT_MS, NULL) == NODE_UPLINK_SENT);
+    CHECK(api.data[0] == 4);
+    node_uplink_get_stats(&stats);
+    CHECK(stats.failed == 2 && stats.late == 0);
+    unsigned int delivered = stats.delivered;
+
+    // The timeout alone ends the frame in flight, for the loop of WISE link 2.0 which sends at the beacons
+    now += NODE_UPLINK_TX_TIMEOUT_MS;
+    CHECK(node_uplink_expire(now + NODE_UPLINK_TX_TIMEOUT_MS - 1) == 0);
+    CHECK(node_uplink_busy());
+    now += NODE_UPLINK_TX_TIMEOUT_MS;
+    CHECK(node_uplink_expire(now) == 1);
+    CHECK(!node_uplink_busy() && node_uplink_count() == 2);
+
+    // Its late TX done is dropped, then the next frame goes at once, and its TX done ends it
+    node_uplink_tx_done(NODE_API_OK, now + 1000);
+    node_uplink_get_stats(&stats);
+    CHECK(stats.failed == 3 && stats.late == 1 && stats.delivered == delivered && node_uplink_count() == 2);
+    CHECK(node_uplink_send(now + 1000, NULL) == NODE_UPLINK_SENT);
+    CHECK(api.data[0] == 5);
+    node_uplink_tx_done(NODE_API_OK, now + 2000);
+    node_uplink_get_stats(&stats);
+    CHECK(stats.delivered == delivered + 1 && node_uplink_count() == 1);
+
+    // A TX done without a send is dropped, and not owed to the next one
+    now += 2000;
+    node_uplink_tx_done(NODE_API_OK, now);
+    now += node_uplink_until_due(now);
+    CHECK(node_uplink_send(now, NULL) == NODE_UPLINK_SENT);
+    node_uplink_tx_done(NODE_API_NOK, now + 1000);
+    node_uplink_get_stats(&stats);
+    CHECK(stats.failed == 4 && stats.late == 1 && node_uplink_count() == 1);
+
+    // The backoffs of nodes of different seeds differ
+    int differ = 0;
+    for (unsigned int seed = 1; seed <= 8; seed++) {
+        int first;
+
+        node_uplink_init(seed);
+        api.result = NODE_API_NOK;
+        push_byte(1, 0, 0, 0);
+        node_uplink_send(0, NULL);
+        first = node_uplink_until_due(0);
+        node_uplink_init(seed + 100);
+        push_byte(1, 0, 0, 0);
+        node_uplink_send(0, NULL);
+        differ += (node_uplink_until_due(0) != first);
+    }
+    CHECK(differ >= 6);
+    api.result = NODE_API_OK;
+}
+
+static void test_coalesce(void)
+{
+    node_uplink_stats_t stats;
+
+    api_reset();
+    node_uplink_init(1);
+
+    // Readings younger than NODE_UPLINK_STALE_MS are kept
+    CHECK(push_byte(1, 0, 1, 0) == 0);
+    CHECK(push_byte(2, 0, 1, NODE_UPLINK_STALE_MS / 2) == 0);
+    CHECK(node_uplink_count() == 2);
+
+    // An older one gives way to the new reading of its key and port
+    CHECK(push_byte(3, 0, 2, 0) == 0);
+    CHECK(node_uplink_push(2, "x", 1, 0, 1, 0) == 0);
+    CHECK(push_byte(4, 0, 1, NODE_UPLINK_STALE_MS) == 0);
+    CHECK(node_uplink_count() == 4);
+    node_uplink_get_stats(&stats);
+    CHECK(stats.coalesced == 1);
+
+    // Not the one in flight, nor the frames without key
+    CHECK(push_byte(5, 0, 0, NODE_UPLINK_STALE_MS) == 0);
+    CHECK(node_uplink_send(NODE_UPLINK_STALE_MS, NULL) == NODE_UPLINK_SENT);
+    CHECK(api.data[0] == 2);
+    CHECK(push_byte(6, 0, 2, 3 * NODE_UPLINK_STALE_MS) == 0);
+    CHECK(push_byte(7, 0, 0, 3 * NODE_UPLINK_STALE_MS) == 0);
+    CHECK(push_byte(8, 0, 1, 3 * NODE_UPLINK_STALE_MS) == 0);
+    node_uplink_tx_done(NODE_API_OK, 3 * NODE_UPLINK_STALE_MS);
+    node_uplink_get_stats(&stats);
+    CHECK(stats.delivered == 1);
+
+    CHECK(deliver(3 * NODE_UPLINK_STALE_MS) == 'x');
+    CHECK(deliver(3 * NODE_UPLINK_STALE_MS) == 5);
+    CHECK(deliver(3 * NODE_UPLINK_STALE_MS) == 6);
+    CHECK(deliver(3 * NODE_UPLINK_STALE_MS) == 7);
+    CHECK(deliver(3 * NODE_UPLINK_STALE_MS) == 8);
+    CHECK(deliver(3 * NODE_UPLINK_STALE_MS) == -1);
+    node_uplink_get_stats(&stats);
+    CHECK(stats.coalesced == 3);
+}
+
+static void test_full(void)
+{
+    node_uplink_stats_t stats;
+    int i;
+
+    api_reset();
+    node_uplink_init(1);
+
+    // The oldest frame of the lowest priority makes room
+    CHECK(push_byte(100, NODE_UPLINK_CONFIRMED, 0, 0) == 0);
+    for (i = 1; i < NODE_UPLINK_QUEUE_SIZE; i++) {
+        CHECK(push_byte(i, 0, 0, 0) == 0);
+    }
+    CHECK(push_byte(NODE_UPLINK_QUEUE_SIZE, 0, 0, 0) == 0);
+    CHECK(node_uplink_count() == NODE_UPLINK_QUEUE_SIZE);
+    CHECK(deliver(0) == 100);
+    for (i = 2; i <= NODE_UPLINK_QUEUE_SIZE; i++) {
+        CHECK(deliver(0) == i);
+    }
+    node_uplink_get_stats(&stats);
+    CHECK(stats.dropped == 1);
+
+    // A new frame lower than all the queued ones is dropped
+    for (i = 0; i < NODE_UPLINK_QUEUE_SIZE; i++) {
+        CHECK(push_byte(i, NODE_UPLINK_CONFIRMED, 0, 0) == 0);
+    }
+    CHECK(push_byte(50, 0, 0, 0) == -1);
+    CHECK(push_byte(51, NODE_UPLINK_HIGH_PRI | NODE_UPLINK_CONFIRMED, 0, 0) == 0);
+    CHECK(deliver(0) == 51);
+    CHECK(deliver(0) == 1);
+    node_uplink_get_stats(&stats);
+    CHECK(stats.dropped == 3);
+
+    // The frame in flight is never evicted
+    node_uplink_init(1);
+    for (i = 0; i < NODE_UPLINK_QUEUE_SIZE; i++) {
+        CHECK(push_byte(i, 0, 0, 0) == 0);
+    }
+    CHECK(node_uplink_send(0, NULL) == NODE_UPLINK_SENT);
+    CHECK(push_byte(60, 0, 0, 0) == 0);
+    node_uplink_tx_done(NODE_API_OK, 0);
+    CHECK(api.data[0] == 0);
+    CHECK(deliver(0) == 2);
+}
+
+static void test_spill(void)
+{
+    node_uplink_stats_t stats;
+    int i, total = NODE_UPLINK_QUEUE_SIZE + 5;
+
+    api_reset();
+    node_uplink_init(1);
+    spill_head = spill_count = 0;
+    node_uplink_set_spill(&spill);
+
+    // The frames past a full queue go to the store, and come back in order as the queue empties
+    for (i = 0; i < total; i++) {
+        CHECK(push_byte(i, 0, 0, i) == 0);
+    }
+    CHECK(node_uplink_count() == NODE_UPLINK_QUEUE_SIZE);
+    CHECK(spill_count == 5);
+    for (i = 0; i < total; i++) {
+        CHECK(deliver(100) == i);
+    }
+    CHECK(spill_count == 0 && node_uplink_count() == 0);
+    node_uplink_get_stats(&stats);
+    CHECK(stats.spilled == 5 && stats.dropped == 0 && stats.delivered == (unsigned int)total);
+
+    // A frame of a higher priority takes the place of the oldest of the lowest one, which is spilled
+    for (i = 0; i < NODE_UPLINK_QUEUE_SIZE; i++) {
+        CHECK(push_byte(i, 0, 0, 0) == 0);
+    }
+    CHECK(push_byte(50, NODE_UPLINK_CONFIRMED, 0, 0) == 0);
+    CHECK(spill_count == 1 && spill_frames[spill_head].data[0] == 0);
+    CHECK(deliver(0) == 50);
+    CHECK(deliver(0) == 0);
+    for (i = 1; i < NODE_UPLINK_QUEUE_SIZE; i++) {
+        CHECK(deliver(0) == i);
+    }
+
+    // A full store drops as without one
+    spill_full = true;
+    for (i = 0; i <= NODE_UPLINK_QUEUE_SIZE; i++) {
+        CHECK(push_byte(i, 0, 0, 0) == 0);
+    }
+    node_uplink_get_stats(&stats);
+    CHECK(stats.dropped == 1);
+    spill_full = false;
+    CHECK(deliver(0) == 1);
+    node_uplink_init(1);
+
+    // Frames spilled before a reset come back when the store is set
+    CHECK(spill_store(&spill_frames[0]) == 0);
+    node_uplink_init(1);
+    node_uplink_set_spill(&spill);
+    CHECK(node_uplink_count() == 1 && spill_count == 0);
+    node_uplink_set_spill(NULL);
+}
+
+/* Simulation of the sensor reports of main.cpp */
+
+#define SIM_HOURS           6
+#define SIM_PERIOD_MS       10000   // Report interval
+#define SIM_STEP_MS         10      // State loop period in NODE_STATE_TX
+
+typedef struct {
+    const char *name;
+    unsigned int refuse_pct;        // Sends refused by the stack
+    unsigned int lost_pct;          // TX done failed
+    unsigned int tx_ms;             // Time from the send to the TX done
+    unsigned int outage_start_ms;   // All TX done failed in [start, end)
+    unsigned int outage_end_ms;
+} sim_scenario_t;
+
+typedef struct {
+    unsigned int readings;
+    unsigned int delivered;
+    unsigned int attempts;
+    unsigned long long latency_sum_ms;
+    unsigned int latency_max_ms;
+} sim_result_t;
+
+static unsigned int sim_reading_ms[SIM_HOURS * 3600000 / SIM_PERIOD_MS + 1];
+
+static void sim_reading(char *frame, unsigned int reading)
+{
+    memcpy(frame, &reading, sizeof(reading));
+}
+
+static unsigned char sim_tx_done(const sim_scenario_t *s, unsigned int now)
+{
+    if (now >= s->outage_start_ms && now < s->outage_end_ms) {
+        return NODE_API_NOK;
+    }
+    return ((unsigned int)(rand() % 100) < s->lost_pct) ? NODE_API_NOK : NODE_API_OK;
+}
+
+static void sim_delivered(sim_result_t *r, unsigned int now)
+{
+    unsigned int reading, latency;
+
+    memcpy(&reading, api.data, sizeof(reading));
+    latency = now - sim_reading_ms[reading];
+    r->delivered++;
+    r->latency_sum_ms += latency;
+    if (latency > r->latency_max_ms) {
+        r->latency_max_ms = latency;
+    }
+}
+
+/* Former main.cpp: a reading is sent once, and none is taken while a frame is in flight */
+static void sim_direct(const sim_scenario_t *s, sim_result_t *r)
+{
+    unsigned int now, end = SIM_HOURS * 3600000, tx_done_ms = 0;
+    bool in_flight = false;
+    char frame[sizeof(unsigned int)];
+
+    for (now = 0; now < end; now += SIM_STEP_MS) {
+        if (in_flight && now >= tx_done_ms) {
+            in_flight = false;
+            if (sim_tx_done(s, now) == NODE_API_OK) {
+                sim_delivered(r, now);
+            }
+        }
+        if (now % SIM_PERIOD_MS != 0) {
+            continue;
+        }
+        sim_reading_ms[r->readings] = now;
+        sim_reading(frame, r->readings++);
+        if (in_flight) {
+            continue;
+        }
+        r->attempts++;
+        if (nodeApiSendData(1, frame, sizeof(frame)) == NODE_API_OK) {
+            in_flight = true;
+            tx_done_ms = now + s->tx_ms;
+        }
+    }
+}
+
+/* main.cpp with the uplink queue, coalescing the readings or spilling them to a store of SPILL_SIZE frames */
+static void sim_queue(const sim_scenario_t *s, sim_result_t *r, bool spilled)
+{
+    unsigned int now, end = SIM_HOURS * 3600000, tx_done_ms = 0;
+    char frame[sizeof(unsigned int)];
+    node_uplink_stats_t stats;
+
+    node_uplink_init(1);
+    spill_head = spill_count = 0;
+    node_uplink_set_spill(spilled ? &spill : NULL);
+    for (now = 0; now < end; now += SIM_STEP_MS) {
+        if (node_uplink_busy() && now >= tx_done_ms) {
+            unsigned char rc = sim_tx_done(s, now);
+
+            if (rc == NODE_API_OK) {
+                sim_delivered(r, now);
+            }
+            node_uplink_tx_done(rc, now);
+            if (node_uplink_until_due(now) == 0 && node_uplink_send(now, NULL) == NODE_UPLINK_SENT) {
+                tx_done_ms = now + s->tx_ms;
+            }
+        }
+        if (now % SIM_PERIOD_MS != 0) {
+            continue;
+        }
+        sim_reading_ms[r->readings] = now;
+        sim_reading(frame, r->readings++);
+        node_uplink_push(1, frame, sizeof(frame), 0, spilled ? 0 : 1, now);
+        if (node_uplink_send(now, NULL) == NODE_UPLINK_SENT) {
+            tx_done_ms = now + s->tx_ms;
+        }
+    }
+
+    node_uplink_get_stats(&stats);
+    r->attempts = stats.sent + stats.refused;
+    CHECK(stats.delivered == r->delivered);
+    CHECK(stats.latency_max_ms == r->latency_max_ms);
+    node_uplink_set_spill(NULL);
+}
+
+static void sim_print(const char *mode, const sim_result_t *r)
+{
+    printf("  %-7s %5u readings  %5u delivered  %5.1f %%  %6u attempts  latency %6.1f s mean  %7.1f s max\n",
+           mode, r->readings, r->delivered, 100.0 * r->delivered / r->readings, r->attempts,
+           r->delivered ? r->latency_sum_ms / 1000.0 / r->delivered : 0.0, r->latency_max_ms / 1000.0);
+}
+
+static void simulate(void)
+{
+    static const sim_scenario_t scenarios[] = {
+        {"No failures", 0, 0, 2000, 0, 0},
+        {"10 % refused, 10 % lost", 10, 10, 2000, 0, 0},
+        {"30 % refused, 30 % lost", 30, 30, 2000, 0, 0},
+        {"30 min outage", 0, 0, 2000, 2 * 3600000, 2 * 3600000 + 1800000},
+        {"TX done after 12 s", 0, 0, 12000, 0, 0},
+    };
+
+    printf("Sensor readings every %d s over %d hours\n", SIM_PERIOD_MS / 1000, SIM_HOURS);
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        const sim_scenario_t *s = &scenarios[i];
+        sim_result_t direct, queue, spilled;
+
+        memset(&direct, 0, sizeof(direct));
+        memset(&queue, 0, sizeof(queue));
+        memset(&spilled, 0, sizeof(spilled));
+
+        printf("%s\n", s->name);
+        api_reset();
+        api.refuse_pct = s->refuse_pct;
+        srand(1);
+        sim_direct(s, &direct);
+        sim_print("direct", &direct);
+
+        api_reset();
+        api.refuse_pct = s->refuse_pct;
+        srand(1);
+        sim_queue(s, &queue, false);
+        sim_print("queue", &queue);
+
+        api_reset();
+        api.refuse_pct = s->refuse_pct;
+        srand(1);
+        sim_queue(s, &spilled, true);
+        sim_print("spill", &spilled);
+
+        CHECK(queue.delivered >= direct.delivered);
+        CHECK(spilled.delivered >= queue.delivered);
+        // A TX done later than the next reading: the link carries a frame per TX time, and the queue fills it
+        if (s->tx_ms > SIM_PERIOD_MS) {
+            CHECK(queue.delivered + 1 >= SIM_HOURS * 3600000 / s->tx_ms);
+        }
+    }
+}
+
+int main(void)
+{
+    test_send();
+    test_priority();
+    test_backoff();
+    test_coalesce();
+    test_full();
+    test_spill();
+    simulate();
+
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All tests passed\n");
+    return 0;
+}
@@ -0,0 +1,7 @@
+/* mbed.h stand-in: node_api.h only needs the serial class name */
+#ifndef MBED_H
+#define MBED_H
+
+class RawSerial;
+
+#endif
@@ -0,0 +1,351 @@
+/* Host test of the report window summary of node_window.cpp
+ *
+ * The summaries are checked against a batch computation in double precision
+ * over streams shaped like the sensor samples, and the P-square quantile
+ * against the exact one. The host runs the same single precision arithmetic
+ * as the FPU of the Cortex-M4. The cycles per sample are then measured.
+ */
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#include "node_window.h"
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+#define STREAM_MAX  86400   // A day of samples every second
+
+static int stream[STREAM_MAX];
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void)
+{
+    // xorshift32
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static double uniform(void)
+{
+    return (rng() >> 8) / 16777216.0;
+}
+
+static double gaussian(void)
+{
+    // Box-Muller
+    double u = uniform() + 1e-12, v = uniform();
+
+    return sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+static uint64_t cycles(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+#endif
+}
+
+static int compare_int(const void *a, const void *b)
+{
+    return *(const int *)a - *(const int *)b;
+}
+
+static void test_basic(void)
+{
+    node_window_t window;
+    node_window_summary_t summary;
+    char tlv[NODE_WINDOW_TLV_SIZE];
+
+    // An empty window has no summary
+    node_window_init(&window, 90);
+    CHECK(node_window_summary(&window, &summary) == -1);
+    CHECK(node_window_tlv(0x1, &window, tlv) == 0);
+
+    // One sample, then a few below 5, the quantile by nearest rank
+    node_window_add(&window, -1234);
+    CHECK(node_window_summary(&window, &summary) == 0);
+    CHECK(summary.count == 1 && summary.min == -1234 && summary.max == -1234);
+    CHECK(summary.mean == -1234 && summary.deviation == 0 && summary.quantile == -1234);
+    node_window_add(&window, 766);
+    node_window_add(&window, -234);
+    CHECK(node_window_summary(&window, &summary) == 0);
+    CHECK(summary.min == -1234 && summary.max == 766 && summary.mean == -234);
+    CHECK(summary.deviation == 816);    // sqrt(2000000 / 3)
+    CHECK(summary.quantile == 766);
+
+    // The TLV: type, length, then count, min, max, mean, deviation and quantile, 16-bit big endian
+    static const unsigned char expected[] = {0x81, 12, 0x00, 0x03, 0xfb, 0x2e, 0x02, 0xfe, 0xff, 0x16, 0x03, 0x30,
+                                             0x02, 0xfe};
+    CHECK(node_window_tlv(0x1, &window, tlv) == 14);
+    CHECK(memcmp(tlv, expected, sizeof(expected)) == 0);
+
+    // Without a quantile, the TLV is 2 bytes shorter
+    node_window_init(&window, 0);
+    node_window_add(&window, 4000);
+    CHECK(node_window_tlv(0x2, &window, tlv) == 12);
+    CHECK((unsigned char)tlv[0] == 0x82 && tlv[1] == 10);
+
+    // A reset starts the next window and keeps the quantile
+    node_window_init(&window, 95);
+    for (int i = 0; i < 100; i++) {
+        node_window_add(&window, i);
+    }
+    node_window_reset(&window);
+    CHECK(node_window_summary(&window, &summary) == -1);
+    for (int i = 0; i < 20; i++) {
+        node_window_add(&window, 1000 - i);
+    }
+    CHECK(node_window_summary(&window, &summary) == 0);
+    CHECK(summary.count == 20 && summary.min == 981 && summary.max == 1000 && summary.quantile >= 995);
+    CHECK(node_window_tlv(0x1, &window, tlv) == 14);
+
+    // The count saturates in the TLV; the deviation of 16-bit samples is at most 32768
+    node_window_init(&window, 0);
+    for (int i = 0; i < 70000; i++) {
+        node_window_add(&window, (i & 1) ? 32767 : -32768);
+    }
+    CHECK(node_window_summary(&window, &summary) == 0);
+    CHECK(summary.count == 70000 && summary.deviation >= 32767 && summary.deviation <= 32768);
+    CHECK(node_window_tlv(0x1, &window, tlv) == 12);
+    CHECK((unsigned char)tlv[2] == 0xff && (unsigned char)tlv[3] == 0xff);
+    CHECK(((unsigned char)tlv[10] << 8 | (unsigned char)tlv[11]) == (int)summary.deviation);
+}
+
+/* Streams of samples in the units of their TLV */
+typedef enum {
+    STREAM_TEMP,        // 0.01 C, a slow drift and the noise of the HDC1510
+    STREAM_HUM,         // 0.01 %RH, with a step
+    STREAM_CO2,         // ppm, with spikes of breath
+    STREAM_WIDE,        // the whole 16-bit range
+    STREAM_OFFSET,      // a large value with a small deviation, the worst case of a sum of squares
+    STREAM_COUNT
+} stream_kind_t;
+
+static const char *stream_names[STREAM_COUNT] = {"temperature", "humidity", "CO2", "16-bit", "offset"};
+
+static void make_stream(stream_kind_t kind, int count)
+{
+    for (int i = 0; i < count; i++) {
+        double v;
+
+        switch (kind) {
+            case STREAM_TEMP:
+                v = 2350 + 150 * sin(i * 2 * M_PI / 86400) + 2 * gaussian();
+                break;
+            case STREAM_HUM:
+                v = ((i % 3600) < 1800 ? 4500 : 6200) + 10 * gaussian();
+                break;
+            case STREAM_CO2:
+                v = 650 + 15 * gaussian() + ((rng() % 100) == 0 ? 400 * uniform() : 0);
+                break;
+            case STREAM_WIDE:
+                v = rng() % 65536;
+                break;
+            default:
+                v = 65000 + gaussian();
+                break;
+        }
+        stream[i] = (int)floor(v + 0.5);
+    }
+}
+
+typedef struct {
+    double mean_error;      // Largest error of the mean, in units
+    double mean_relative;   // Same, in deviations
+    double deviation_error; // Largest relative error of the deviation
+    double naive_error;     // Same, with a float sum of squares
+    double quantile_error;  // Largest error of the quantile, in deviations
+    int quantile_misses;    // Number of quantiles off by half a deviation, 4 units and 1 % of rank
+} accuracy_t;
+
+/* Summarize windows of a stream, against a double precision batch computation */
+static void check_windows(int count, int window_len, int quantile, accuracy_t *acc)
+{
+    static int sorted[STREAM_MAX];
+    node_window_t window;
+    node_window_summary_t summary;
+
+    for (int start = 0; start + window_len <= count; start += window_len) {
+        const int *x = &stream[start];
+        double sum = 0, sq = 0, mean, deviation;
+        float naive_sum = 0, naive_sq = 0, naive;
+        int min = x[0], max = x[0];
+
+        node_window_init(&window, quantile);
+        for (int i = 0; i < window_len; i++) {
+            node_window_add(&window, x[i]);
+            sum += x[i];
+            naive_sum += x[i];
+            naive_sq += (float)x[i] * x[i];
+            min = (x[i] < min) ? x[i] : min;
+            max = (x[i] > max) ? x[i] : max;
+        }
+        mean = sum / window_len;
+        for (int i = 0; i < window_len; i++) {
+            sq += (x[i] - mean) * (x[i] - mean);
+        }
+        deviation = sqrt(sq / window_len);
+        naive = naive_sq / window_len - (naive_sum / window_len) * (naive_sum / window_len);
+        naive = (naive > 0) ? sqrtf(naive) : 0;
+
+        CHECK(node_window_summary(&window, &summary) == 0);
+        CHECK((int)summary.count == window_len && summary.min == min && summary.max == max);
+
+        // The float mean and deviation, against the rounded exact ones
+        double mean_error = fabs(window.first + (double)window.mean - mean);
+        double deviation_error = (deviation >= 1) ? fabs(sqrt(window.m2 / window_len) - deviation) / deviation : 0;
+        double naive_error = (deviation >= 1) ? fabs(naive - deviation) / deviation : 0;
+
+        // The rounded mean is exact, or one off next to a half within the error
+        int rounded = (int)floor(mean + 0.5);
+        bool half = fabs(mean - floor(mean) - 0.5) <= mean_error;
+
+        CHECK(summary.mean == rounded || (half && abs(summary.mean - rounded) == 1));
+        acc->mean_error = fmax(acc->mean_error, mean_error);
+        acc->mean_relative = fmax(acc->mean_relative, mean_error / fmax(deviation, 1));
+        acc->deviation_error = fmax(acc->deviation_error, deviation_error);
+        acc->naive_error = fmax(acc->naive_error, naive_error);
+
+        if (quantile > 0 && window_len >= 100) {
+            double p = quantile / 100.0, error;
+            int exact, below = 0, equal = 0;
+
+            // The quantile by nearest rank
+            memcpy(sorted, x, window_len * sizeof(int));
+            qsort(sorted, window_len, sizeof(int), compare_int);
+            exact = sorted[(int)ceil(p * window_len) - 1];
+            error = fabs(summary.quantile - exact) / fmax(deviation, 1);
+            acc->quantile_error = fmax(acc->quantile_error, error);
+
+            // In a sparse tail, the estimate is off in value but not in rank; among a few values, by a few units
+            for (int i = 0; i < window_len; i++) {
+                below += sorted[i] < summary.quantile;
+                equal += sorted[i] == summary.quantile;
+            }
+            if (error >= 0.5 && abs(summary.quantile - exact) > 4 && (p * window_len < below - 0.01 * window_len ||
+                                 p * window_len > below + equal + 0.01 * window_len)) {
+                acc->quantile_misses++;
+            }
+        }
+    }
+}
+
+static void test_accuracy(void)
+{
+    static const int windows[] = {10, 60, 600, 3600, STREAM_MAX};
+
+    printf("Largest errors against double precision, over a day of samples every second:\n");
+    printf("  %-12s %6s %10s %12s %12s %10s\n", "stream", "window", "mean", "deviation", "float sum", "p90 error");
+    for (int kind = 0; kind < STREAM_COUNT; kind++) {
+        make_stream((stream_kind_t)kind, STREAM_MAX);
+        for (size_t w = 0; w < sizeof(windows) / sizeof(windows[0]); w++) {
+            accuracy_t acc;
+
+            memset(&acc, 0, sizeof(acc));
+            check_windows(STREAM_MAX, windows[w], 90, &acc);
+            printf("  %-12s %6d %10.4f %11.5f%% %11.3f%% %6.3f dev\n", stream_names[kind], windows[w], acc.mean_error,
+                   acc.deviation_error * 100, acc.naive_error * 100, acc.quantile_error);
+
+            // Welford keeps the mean within a hundredth and the deviation within 0.1 %, up to a day of samples
+            CHECK(acc.mean_relative < 1e-5 || acc.mean_error < 0.001);
+            CHECK(acc.deviation_error < 0.001);
+            if (windows[w] >= 600) {
+                CHECK(acc.quantile_misses == 0);
+            }
+        }
+    }
+}
+
+static void test_quantiles(void)
+{
+    static const int quantiles[] = {1, 10, 50, 90, 99};
+
+    // Every quantile on the spiky stream, the hardest for the markers
+    make_stream(STREAM_CO2, 3600);
+    for (size_t q = 0; q < sizeof(quantiles) / sizeof(quantiles[0]); q++) {
+        accuracy_t acc;
+
+        memset(&acc, 0, sizeof(acc));
+        check_windows(3600, 3600, quantiles[q], &acc);
+        CHECK(acc.quantile_misses == 0);
+    }
+
+    // A constant stream
+    node_window_t window;
+    node_window_summary_t summary;
+
+    node_window_init(&window, 50);
+    for (int i = 0; i < 1000; i++) {
+        node_window_add(&window, 42);
+    }
+    CHECK(node_window_summary(&window, &summary) == 0);
+    CHECK(summary.mean == 42 && summary.deviation == 0 && summary.quantile == 42);
+}
+
+static void bench(void)
+{
+    const int count = 1000000;
+    node_window_t window;
+    node_window_summary_t summary;
+    uint64_t start, plain, p2;
+    volatile int sink;
+
+    make_stream(STREAM_TEMP, STREAM_MAX);
+
+    node_window_init(&window, 0);
+    start = cycles();
+    for (int i = 0; i < count; i++) {
+        node_window_add(&window, stream[i % STREAM_MAX]);
+    }
+    plain = cycles() - start;
+    node_window_summary(&window, &summary);
+    sink = summary.mean;
+
+    node_window_init(&window, 90);
+    start = cycles();
+    for (int i = 0; i < count; i++) {
+        node_window_add(&window, stream[i % STREAM_MAX]);
+    }
+    p2 = cycles() - start;
+    node_window_summary(&window, &summary);
+    sink = summary.quantile;
+    (void)sink;
+
+    printf("Host cycles per sample: %.1f without a quantile, %.1f with the P-square p90\n",
+           (double)plain / count, (double)p2 / count);
+    printf("Window size: %u bytes per channel\n", (unsigned int)sizeof(node_window_t));
+}
+
+int main(void)
+{
+    test_basic();
+    test_accuracy();
+    test_quantiles();
+    bench();
+
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All tests passed\n");
+    return 0;
+}
@@ -0,0 +1,53 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Default first-fit allocator, rtx_memory.c */
+
+#include "rtx_memory_host.h"
+
+#define osRtxMemoryInit     first_fit_init
+#define osRtxMemoryAlloc    first_fit_alloc
+#define osRtxMemoryFree     first_fit_free
+
+#include "../../../rtos/TARGET_CORTEX/rtx5/RTX/Source/rtx_memory.c"
+
+static void first_fit_stats(void *mem, rtx_memory_stats_t *stats)
+{
+    mem_block_t *p = MemBlockPtr(mem, sizeof(mem_head_t));
+
+    memset(stats, 0, sizeof(*stats));
+    stats->used = MemHeadPtr(mem)->used;
+
+    // The holes are the gaps between the end of a block and the next one
+    while (p->next != NULL) {
+        uint32_t hole = (uint32_t)p->next - (uint32_t)p - (p->info & MB_INFO_LEN_MASK);
+        if (hole != 0U) {
+            stats->free_total += hole;
+            stats->free_count++;
+            if (hole > stats->free_largest) {
+                stats->free_largest = hole;
+            }
+        }
+        p = p->next;
+    }
+
+    // The last block holds the max used memory
+    stats->max_used = p->info;
+}
+
+const rtx_memory_allocator_t rtx_memory_first_fit = {
+    "first-fit", first_fit_init, first_fit_alloc, first_fit_free, first_fit_stats
+};
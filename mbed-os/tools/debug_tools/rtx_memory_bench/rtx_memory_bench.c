@@ -0,0 +1,236 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Randomized alloc/free benchmark of the RTX memory pool allocators.
+ *
+ * Runs the same pseudo random sequence of allocations and releases against the
+ * first-fit and the TLSF allocator and reports the time per operation and the
+ * fragmentation of the pool over the run.
+ *
+ * usage: rtx_memory_bench [ops] [pool size] [seed] [samples]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <inttypes.h>
+#include <sys/mman.h>
+
+#include "rtx_memory_host.h"
+
+#define SLOTS           256
+#define POOL_SIZE_MAX   (1024 * 1024)
+
+typedef struct {
+    void *ptr;
+    uint32_t size;
+    uint8_t fill;
+} slot_t;
+
+typedef struct {
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+} op_stats_t;
+
+static uint64_t *pool;
+static slot_t slots[SLOTS];
+static uint32_t rng_state;
+
+static uint32_t rng(void)
+{
+    // xorshift32
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// Mostly control block and message sized requests, with the odd thread stack
+static uint32_t random_size(void)
+{
+    uint32_t r = rng() % 100;
+    if (r < 75) {
+        return 8 + rng() % 57;
+    } else if (r < 95) {
+        return 64 + rng() % 449;
+    } else {
+        return 512 + rng() % 1537;
+    }
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static void op_record(op_stats_t *stats, uint64_t ns)
+{
+    stats->count++;
+    stats->total_ns += ns;
+    if (ns > stats->max_ns) {
+        stats->max_ns = ns;
+    }
+}
+
+// 1 - largest free block / total free: 0 when the free memory is contiguous
+static double fragmentation(const rtx_memory_stats_t *stats)
+{
+    return stats->free_total ? 1.0 - (double)stats->free_largest / (double)stats->free_total : 0.0;
+}
+
+// The allocators keep addresses in 32-bit words, so a 64-bit build needs the pool in the low 4 GB
+static uint64_t *pool_map(void)
+{
+#if UINTPTR_MAX > 0xFFFFFFFFu
+#ifdef MAP_32BIT
+    void *mem = mmap(NULL, POOL_SIZE_MAX, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+#else
+    void *mem = mmap((void *)0x10000000, POOL_SIZE_MAX, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#endif
+    if ((mem == MAP_FAILED) || ((uintptr_t)mem + POOL_SIZE_MAX - 1 > 0xFFFFFFFFu)) {
+        return NULL;
+    }
+    return (uint64_t *)mem;
+#else
+    static uint64_t mem[POOL_SIZE_MAX / sizeof(uint64_t)];
+    return mem;
+#endif
+}
+
+static int run(const rtx_memory_allocator_t *allocator, uint32_t ops, uint32_t pool_size,
+               uint32_t seed, uint32_t samples)
+{
+    op_stats_t alloc_stats = { 0 };
+    op_stats_t free_stats = { 0 };
+    rtx_memory_stats_t stats;
+    uint32_t failures = 0;
+    uint32_t step = ops / samples ? ops / samples : 1;
+    double frag_sum = 0.0;
+    uint32_t frag_count = 0;
+    int errors = 0;
+
+    memset(slots, 0, sizeof(slots));
+    rng_state = seed;
+
+    if (!allocator->init(pool, pool_size)) {
+        printf("%s: init failed\n", allocator->name);
+        return 1;
+    }
+
+    printf("%s\n", allocator->name);
+    printf("%10s %10s %10s %10s %10s %14s\n", "op", "used", "free", "largest", "holes", "fragmentation");
+
+    for (uint32_t i = 0; i < ops; i++) {
+        slot_t *slot = &slots[rng() % SLOTS];
+        uint32_t size = random_size();
+        uint64_t start;
+
+        if (slot->ptr == NULL) {
+            start = now_ns();
+            slot->ptr = allocator->alloc(pool, size, 0);
+            op_record(&alloc_stats, now_ns() - start);
+            if (slot->ptr == NULL) {
+                failures++;
+            } else {
+                // Fill the block to catch overlapping allocations
+                slot->size = size;
+                slot->fill = (uint8_t)i;
+                memset(slot->ptr, slot->fill, size);
+            }
+        } else {
+            const uint8_t *data = (const uint8_t *)slot->ptr;
+            for (uint32_t j = 0; j < slot->size; j++) {
+                if (data[j] != slot->fill) {
+                    printf("%s: block %p corrupted at offset %" PRIu32 "\n", allocator->name, slot->ptr, j);
+                    errors++;
+                    break;
+                }
+            }
+            start = now_ns();
+            if (!allocator->free(pool, slot->ptr)) {
+                printf("%s: free of %p failed\n", allocator->name, slot->ptr);
+                errors++;
+            }
+            op_record(&free_stats, now_ns() - start);
+            slot->ptr = NULL;
+        }
+
+        if (((i + 1) % step) == 0) {
+            allocator->stats(pool, &stats);
+            frag_sum += fragmentation(&stats);
+            frag_count++;
+            printf("%10" PRIu32 " %10" PRIu32 " %10" PRIu32 " %10" PRIu32 " %10" PRIu32 " %13.1f%%\n",
+                   i + 1, stats.used, stats.free_total, stats.free_largest, stats.free_count,
+                   fragmentation(&stats) * 100.0);
+        }
+    }
+
+    // Release everything, the pool must return to a single free block
+    for (uint32_t i = 0; i < SLOTS; i++) {
+        if (slots[i].ptr != NULL) {
+            if (!allocator->free(pool, slots[i].ptr)) {
+                printf("%s: free of %p failed\n", allocator->name, slots[i].ptr);
+                errors++;
+            }
+            slots[i].ptr = NULL;
+        }
+    }
+    allocator->stats(pool, &stats);
+    if (stats.free_count != 1) {
+        printf("%s: %" PRIu32 " free blocks left after releasing all blocks\n", allocator->name, stats.free_count);
+        errors++;
+    }
+
+    printf("\n");
+    printf("  alloc: %" PRIu64 " ops, %" PRIu32 " failed, avg %.1f ns, max %" PRIu64 " ns\n",
+           alloc_stats.count, failures,
+           alloc_stats.count ? (double)alloc_stats.total_ns / alloc_stats.count : 0.0, alloc_stats.max_ns);
+    printf("  free:  %" PRIu64 " ops, avg %.1f ns, max %" PRIu64 " ns\n",
+           free_stats.count,
+           free_stats.count ? (double)free_stats.total_ns / free_stats.count : 0.0, free_stats.max_ns);
+    printf("  max used: %" PRIu32 " of %" PRIu32 " bytes, mean fragmentation %.1f%%\n\n",
+           stats.max_used, pool_size, frag_count ? frag_sum / frag_count * 100.0 : 0.0);
+
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t ops = (argc > 1) ? strtoul(argv[1], NULL, 0) : 100000;
+    uint32_t pool_size = (argc > 2) ? strtoul(argv[2], NULL, 0) : 32768;
+    uint32_t seed = (argc > 3) ? strtoul(argv[3], NULL, 0) : 1;
+    uint32_t samples = (argc > 4) ? strtoul(argv[4], NULL, 0) : 10;
+
+    if ((pool_size > POOL_SIZE_MAX) || (pool_size & 7) || !seed || !samples) {
+        fprintf(stderr, "usage: %s [ops] [pool size <= %d, multiple of 8] [seed != 0] [samples]\n",
+                argv[0], POOL_SIZE_MAX);
+        return 1;
+    }
+
+    pool = pool_map();
+    if (pool == NULL) {
+        fprintf(stderr, "%s: no memory below 4 GB for the pool, build with make M32=1\n", argv[0]);
+        return 1;
+    }
+
+    int errors = run(&rtx_memory_first_fit, ops, pool_size, seed, samples);
+    errors += run(&rtx_memory_tlsf, ops, pool_size, seed, samples);
+
+    return errors ? 1 : 0;
+}
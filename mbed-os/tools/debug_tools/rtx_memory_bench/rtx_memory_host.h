@@ -0,0 +1,60 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Host build of the RTX memory pool allocators.
+ *
+ * Stands in for rtx_lib.h, so the allocator sources can be compiled without
+ * the CMSIS core headers, and declares the interface used by the benchmark.
+ */
+
+#ifndef RTX_MEMORY_HOST_H
+#define RTX_MEMORY_HOST_H
+
+/* Prevent the allocator sources from including the target rtx_lib.h */
+#define RTX_LIB_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define __WEAK                  __attribute__((weak))
+#define __STATIC_INLINE         static inline
+#define __CLZ(x)                ((uint8_t)__builtin_clz(x))
+
+#define EvrRtxMemoryInit(mem, size, result)
+#define EvrRtxMemoryAlloc(mem, size, type, block)
+#define EvrRtxMemoryFree(mem, block, result)
+
+typedef struct {
+    uint32_t used;          /* bytes used, including pool and block headers */
+    uint32_t max_used;      /* high water mark of used */
+    uint32_t free_total;    /* bytes available in free blocks or holes */
+    uint32_t free_largest;  /* largest free block or hole */
+    uint32_t free_count;    /* number of free blocks or holes */
+} rtx_memory_stats_t;
+
+typedef struct {
+    const char *name;
+    uint32_t (*init)(void *mem, uint32_t size);
+    void *(*alloc)(void *mem, uint32_t size, uint32_t type);
+    uint32_t (*free)(void *mem, void *block);
+    void (*stats)(void *mem, rtx_memory_stats_t *stats);
+} rtx_memory_allocator_t;
+
+extern const rtx_memory_allocator_t rtx_memory_first_fit;
+extern const rtx_memory_allocator_t rtx_memory_tlsf;
+
+#endif
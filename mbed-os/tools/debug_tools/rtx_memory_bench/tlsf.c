@@ -0,0 +1,53 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Two-level segregated fit allocator, rtx_memory_tlsf.c */
+
+#include "rtx_memory_host.h"
+
+#define OS_MEMORY_TLSF      1
+
+#define osRtxMemoryInit     tlsf_init
+#define osRtxMemoryAlloc    tlsf_alloc
+#define osRtxMemoryFree     tlsf_free
+
+#include "../../../rtos/TARGET_CORTEX/rtx5/RTX/Source/rtx_memory_tlsf.c"
+
+static void tlsf_stats(void *mem, rtx_memory_stats_t *stats)
+{
+    mem_tlsf_block_t *p = MemBlockPtr(mem, MEM_HEAD_SIZE);
+
+    memset(stats, 0, sizeof(*stats));
+    stats->used = MemHeadPtr(mem)->used;
+    stats->max_used = MemHeadPtr(mem)->max_used;
+
+    // Walk the physical blocks up to the sentinel
+    while ((p->info & MB_INFO_LEN_MASK) != 0U) {
+        if ((p->info & MB_INFO_FREE) != 0U) {
+            uint32_t size = p->info & MB_INFO_LEN_MASK;
+            stats->free_total += size;
+            stats->free_count++;
+            if (size > stats->free_largest) {
+                stats->free_largest = size;
+            }
+        }
+        p = MemBlockNext(p);
+    }
+}
+
+const rtx_memory_allocator_t rtx_memory_tlsf = {
+    "tlsf", tlsf_init, tlsf_alloc, tlsf_free, tlsf_stats
+};
@@ -0,0 +1,41 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Message queue with 8 priority buckets */
+
+#define OS_MSGQUEUE_PRIO_BUCKETS    8
+
+/* A single indexed queue, so that a second queue is left without an index */
+#define OS_MSGQUEUE_PRIO_NUM        1
+
+#define osMessageQueueNew           buckets_osMessageQueueNew
+#define osMessageQueueGetName       buckets_osMessageQueueGetName
+#define osMessageQueuePut           buckets_osMessageQueuePut
+#define osMessageQueueGet           buckets_osMessageQueueGet
+#define osMessageQueueGetCapacity   buckets_osMessageQueueGetCapacity
+#define osMessageQueueGetMsgSize    buckets_osMessageQueueGetMsgSize
+#define osMessageQueueGetCount      buckets_osMessageQueueGetCount
+#define osMessageQueueGetSpace      buckets_osMessageQueueGetSpace
+#define osMessageQueueReset         buckets_osMessageQueueReset
+#define osMessageQueueDelete        buckets_osMessageQueueDelete
+
+#include "rtx_msgqueue_host.h"
+
+#include "../../../rtos/TARGET_CORTEX/rtx5/RTX/Source/rtx_msgqueue.c"
+
+const rtx_msgqueue_t rtx_msgqueue_buckets = {
+    "buckets", osMessageQueueNew, osMessageQueuePut, osMessageQueueGet, osMessageQueueDelete
+};
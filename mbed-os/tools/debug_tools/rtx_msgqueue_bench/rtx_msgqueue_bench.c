@@ -0,0 +1,319 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Message queue benchmark for RTX.
+ *
+ * Fills 256-entry queues with skewed mixes of message priorities, then drains
+ * them, with the sorted queue of rtx_msgqueue.c and with priority buckets.
+ * Checks that messages come out by priority and in FIFO order within a
+ * priority, and reports the average cost of putting and getting a message.
+ * The order is also checked for a queue created while the priority index
+ * table is full, which is not indexed.
+ *
+ * usage: rtx_msgqueue_bench [rounds] [seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <time.h>
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#include "rtx_msgqueue_host.h"
+
+#define QUEUE_SIZE      256
+
+typedef struct {
+    const char *name;
+    uint8_t (*priority)(uint32_t index);
+} mix_t;
+
+osRtxInfo_t osRtxInfo;
+
+static uint64_t queue_cb[64];
+static uint64_t queue_mem[QUEUE_SIZE * 8];
+static uint64_t other_cb[64];
+static uint64_t other_mem[8];
+static uint32_t rng_state;
+
+static uint32_t rng(void)
+{
+    // xorshift32
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static uint64_t cycles(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+#endif
+}
+
+/* Kernel functions used by rtx_msgqueue.c, only called when a thread blocks or is woken up */
+
+void osRtxThreadListPut(os_object_t *object, os_thread_t *thread)
+{
+    abort();
+}
+
+os_thread_t *osRtxThreadListGet(os_object_t *object)
+{
+    abort();
+}
+
+uint32_t *osRtxThreadRegPtr(const os_thread_t *thread)
+{
+    abort();
+}
+
+void osRtxThreadDispatch(os_thread_t *thread)
+{
+    abort();
+}
+
+void osRtxThreadWaitExit(os_thread_t *thread, uint32_t ret_val, bool_t dispatch)
+{
+    abort();
+}
+
+bool_t osRtxThreadWaitEnter(uint8_t state, uint32_t timeout)
+{
+    abort();
+}
+
+void *osRtxMemoryAlloc(void *mem, uint32_t size, uint32_t type)
+{
+    return NULL;
+}
+
+uint32_t osRtxMemoryFree(void *mem, void *block)
+{
+    return 0U;
+}
+
+void osRtxPostProcess(os_object_t *object)
+{
+    abort();
+}
+
+uint32_t __get_PSP(void)
+{
+    abort();
+}
+
+/* Fixed block memory pool, as rtx_mempool.c */
+
+uint32_t osRtxMemoryPoolInit(os_mp_info_t *mp_info, uint32_t block_count, uint32_t block_size, void *block_mem)
+{
+    uint8_t *block = (uint8_t *)block_mem;
+
+    mp_info->max_blocks  = block_count;
+    mp_info->used_blocks = 0U;
+    mp_info->block_size  = block_size;
+    mp_info->block_base  = block_mem;
+    mp_info->block_free  = block_mem;
+    mp_info->block_lim   = block + block_count * block_size;
+
+    for (uint32_t i = 0; i < block_count - 1U; i++) {
+        *((void **)(void *)block) = block + block_size;
+        block += block_size;
+    }
+    *((void **)(void *)block) = NULL;
+
+    return 1U;
+}
+
+void *osRtxMemoryPoolAlloc(os_mp_info_t *mp_info)
+{
+    void *block = mp_info->block_free;
+
+    if (block != NULL) {
+        mp_info->block_free = *((void **)block);
+        mp_info->used_blocks++;
+    }
+    return block;
+}
+
+osStatus_t osRtxMemoryPoolFree(os_mp_info_t *mp_info, void *block)
+{
+    *((void **)block) = mp_info->block_free;
+    mp_info->block_free = block;
+    mp_info->used_blocks--;
+    return osOK;
+}
+
+/* Priority mixes */
+
+// All messages at the default priority
+static uint8_t mix_default(uint32_t index)
+{
+    return 0;
+}
+
+// Normal traffic with 10% of urgent messages
+static uint8_t mix_urgent(uint32_t index)
+{
+    return (rng() % 10) == 0 ? 7 : 0;
+}
+
+// Uniform over 8 priorities
+static uint8_t mix_uniform(uint32_t index)
+{
+    return rng() % 8;
+}
+
+// Each message more urgent than the queued ones
+static uint8_t mix_rising(uint32_t index)
+{
+    return index * 8 / QUEUE_SIZE;
+}
+
+// Uniform over all 256 priorities, beyond the indexed ones
+static uint8_t mix_wide(uint32_t index)
+{
+    return rng() & 0xFF;
+}
+
+static const mix_t mixes[] = {
+    { "default", mix_default },
+    { "10% urgent", mix_urgent },
+    { "uniform 0-7", mix_uniform },
+    { "rising", mix_rising },
+    { "uniform 0-255", mix_wide },
+};
+
+static int run(const rtx_msgqueue_t *queue, const mix_t *mix, uint32_t rounds, uint32_t seed,
+               double *put_cycles, double *get_cycles)
+{
+    osMessageQueueAttr_t attr = { 0 };
+    osMessageQueueId_t mq;
+    uint64_t put_total = 0;
+    uint64_t get_total = 0;
+    uint64_t start;
+
+    attr.cb_mem = queue_cb;
+    attr.cb_size = sizeof(queue_cb);
+    attr.mq_mem = queue_mem;
+    attr.mq_size = sizeof(queue_mem);
+    mq = queue->create(QUEUE_SIZE, sizeof(uint32_t), &attr);
+    if (mq == NULL) {
+        printf("%s: failed to create the queue\n", queue->name);
+        return 1;
+    }
+
+    rng_state = seed;
+
+    for (uint32_t round = 0; round < rounds; round++) {
+        uint32_t last_seq = 0;
+        uint8_t last_prio = 0xFF;
+
+        for (uint32_t i = 0; i < QUEUE_SIZE; i++) {
+            uint8_t prio = mix->priority(i);
+            start = cycles();
+            osStatus_t status = queue->put(mq, &i, prio, 0);
+            put_total += cycles() - start;
+            if (status != osOK) {
+                printf("%s: put failed with %d\n", queue->name, (int)status);
+                return 1;
+            }
+        }
+
+        for (uint32_t i = 0; i < QUEUE_SIZE; i++) {
+            uint32_t seq;
+            uint8_t prio;
+            start = cycles();
+            osStatus_t status = queue->get(mq, &seq, &prio, 0);
+            get_total += cycles() - start;
+            if (status != osOK) {
+                printf("%s: get failed with %d\n", queue->name, (int)status);
+                return 1;
+            }
+            if ((prio > last_prio) || ((prio == last_prio) && (seq < last_seq))) {
+                printf("%s: message %" PRIu32 " of priority %u out of order\n", queue->name, seq, prio);
+                return 1;
+            }
+            last_prio = prio;
+            last_seq = seq;
+        }
+    }
+
+    queue->remove(mq);
+
+    *put_cycles = (double)put_total / (rounds * QUEUE_SIZE);
+    *get_cycles = (double)get_total / (rounds * QUEUE_SIZE);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t rounds = (argc > 1) ? strtoul(argv[1], NULL, 0) : 1000;
+    uint32_t seed = (argc > 2) ? strtoul(argv[2], NULL, 0) : 1;
+
+    if (!rounds || !seed) {
+        fprintf(stderr, "usage: %s [rounds] [seed != 0]\n", argv[0]);
+        return 1;
+    }
+
+#if defined(__i386__) || defined(__x86_64__)
+    printf("Average TSC cycles per message, %d-entry queue\n", QUEUE_SIZE);
+#else
+    printf("Average nanoseconds per message, %d-entry queue\n", QUEUE_SIZE);
+#endif
+    printf("%-16s %12s %12s %12s %12s\n", "priorities", "put sorted", "put buckets", "get sorted", "get buckets");
+
+    for (size_t i = 0; i < sizeof(mixes) / sizeof(mixes[0]); i++) {
+        double sorted_put, sorted_get, buckets_put, buckets_get;
+
+        if (run(&rtx_msgqueue_sorted, &mixes[i], rounds, seed, &sorted_put, &sorted_get) ||
+            run(&rtx_msgqueue_buckets, &mixes[i], rounds, seed, &buckets_put, &buckets_get)) {
+            return 1;
+        }
+        printf("%-16s %12.1f %12.1f %12.1f %12.1f\n", mixes[i].name, sorted_put, buckets_put, sorted_get, buckets_get);
+    }
+
+    // Another queue holds the only index entry: the queue of run() is not indexed
+    osMessageQueueAttr_t attr = { 0 };
+    attr.cb_mem = other_cb;
+    attr.cb_size = sizeof(other_cb);
+    attr.mq_mem = other_mem;
+    attr.mq_size = sizeof(other_mem);
+    osMessageQueueId_t other = rtx_msgqueue_buckets.create(1, sizeof(uint32_t), &attr);
+    if (other == NULL) {
+        printf("buckets: failed to create the queue holding the index\n");
+        return 1;
+    }
+    printf("%-16s %12s %12s\n", "not indexed", "", "put buckets");
+    for (size_t i = 0; i < sizeof(mixes) / sizeof(mixes[0]); i++) {
+        double buckets_put, buckets_get;
+
+        if (run(&rtx_msgqueue_buckets, &mixes[i], rounds, seed, &buckets_put, &buckets_get)) {
+            return 1;
+        }
+        printf("%-16s %12s %12.1f\n", mixes[i].name, "", buckets_put);
+    }
+    rtx_msgqueue_buckets.remove(other);
+
+    return 0;
+}
@@ -0,0 +1,132 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Host build of the RTX message queue.
+ *
+ * Stands in for rtx_lib.h, so rtx_msgqueue.c can be compiled without the CMSIS
+ * core headers. Calls are made from thread mode and never block: the SVC calls
+ * go straight to the service functions and the kernel functions used to block
+ * and wake up threads are not expected to be called.
+ */
+
+#ifndef RTX_MSGQUEUE_HOST_H
+#define RTX_MSGQUEUE_HOST_H
+
+/* Prevent the RTX sources from including the target rtx_lib.h */
+#define RTX_LIB_H_
+
+#define EVR_RTX_DISABLE
+
+#include <stdbool.h>
+#include <string.h>
+#include "rtx_evr.h"
+
+#define __STATIC_INLINE         static inline
+#define __CLZ(x)                ((uint8_t)__builtin_clz(x))
+
+typedef bool bool_t;
+#define FALSE                   ((bool_t)0)
+#define TRUE                    ((bool_t)1)
+
+#define os_thread_t             osRtxThread_t
+#define os_mp_info_t            osRtxMpInfo_t
+#define os_message_t            osRtxMessage_t
+#define os_message_queue_t      osRtxMessageQueue_t
+#define os_object_t             osRtxObject_t
+
+#define EXCLUSIVE_ACCESS        1
+
+static inline uint32_t atomic_inc32(uint32_t *mem)
+{
+    return (*mem)++;
+}
+
+static inline uint32_t atomic_dec32_nz(uint32_t *mem)
+{
+    uint32_t ret = *mem;
+    if (ret != 0U) {
+        *mem = ret - 1U;
+    }
+    return ret;
+}
+
+static inline uint8_t atomic_wr8(uint8_t *mem, uint8_t val)
+{
+    uint8_t ret = *mem;
+    *mem = val;
+    return ret;
+}
+
+static inline bool_t IsIrqMode(void)
+{
+    return FALSE;
+}
+
+static inline bool_t IsIrqMasked(void)
+{
+    return FALSE;
+}
+
+#define SVC0_1(f, t, t1) \
+static inline t __svc##f(t1 a1) { return svcRtx##f(a1); }
+#define SVC0_3(f, t, t1, t2, t3) \
+static inline t __svc##f(t1 a1, t2 a2, t3 a3) { return svcRtx##f(a1, a2, a3); }
+#define SVC0_4(f, t, t1, t2, t3, t4) \
+static inline t __svc##f(t1 a1, t2 a2, t3 a3, t4 a4) { return svcRtx##f(a1, a2, a3, a4); }
+
+extern osRtxInfo_t osRtxInfo;
+
+static inline os_object_t *osRtxObject(void *object)
+{
+    return (os_object_t *)object;
+}
+
+static inline os_message_queue_t *osRtxMessageQueueId(osMessageQueueId_t mq_id)
+{
+    return (os_message_queue_t *)mq_id;
+}
+
+static inline os_thread_t *osRtxThreadGetRunning(void)
+{
+    return osRtxInfo.thread.run.curr;
+}
+
+void         osRtxThreadListPut   (os_object_t *object, os_thread_t *thread);
+os_thread_t *osRtxThreadListGet   (os_object_t *object);
+uint32_t    *osRtxThreadRegPtr    (const os_thread_t *thread);
+void         osRtxThreadDispatch  (os_thread_t *thread);
+void         osRtxThreadWaitExit  (os_thread_t *thread, uint32_t ret_val, bool_t dispatch);
+bool_t       osRtxThreadWaitEnter (uint8_t state, uint32_t timeout);
+uint32_t     osRtxMemoryPoolInit  (os_mp_info_t *mp_info, uint32_t block_count, uint32_t block_size, void *block_mem);
+void        *osRtxMemoryPoolAlloc (os_mp_info_t *mp_info);
+osStatus_t   osRtxMemoryPoolFree  (os_mp_info_t *mp_info, void *block);
+void        *osRtxMemoryAlloc     (void *mem, uint32_t size, uint32_t type);
+uint32_t     osRtxMemoryFree      (void *mem, void *block);
+void         osRtxPostProcess     (os_object_t *object);
+uint32_t     __get_PSP            (void);
+
+typedef struct {
+    const char *name;
+    osMessageQueueId_t (*create)(uint32_t msg_count, uint32_t msg_size, const osMessageQueueAttr_t *attr);
+    osStatus_t (*put)(osMessageQueueId_t mq_id, const void *msg_ptr, uint8_t msg_prio, uint32_t timeout);
+    osStatus_t (*get)(osMessageQueueId_t mq_id, void *msg_ptr, uint8_t *msg_prio, uint32_t timeout);
+    osStatus_t (*remove)(osMessageQueueId_t mq_id);
+} rtx_msgqueue_t;
+
+extern const rtx_msgqueue_t rtx_msgqueue_sorted;
+extern const rtx_msgqueue_t rtx_msgqueue_buckets;
+
+#endif
@@ -0,0 +1,38 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Sorted message queue, MessageQueuePut scans from the tail */
+
+#define OS_MSGQUEUE_PRIO_BUCKETS    0
+
+#define osMessageQueueNew           sorted_osMessageQueueNew
+#define osMessageQueueGetName       sorted_osMessageQueueGetName
+#define osMessageQueuePut           sorted_osMessageQueuePut
+#define osMessageQueueGet           sorted_osMessageQueueGet
+#define osMessageQueueGetCapacity   sorted_osMessageQueueGetCapacity
+#define osMessageQueueGetMsgSize    sorted_osMessageQueueGetMsgSize
+#define osMessageQueueGetCount      sorted_osMessageQueueGetCount
+#define osMessageQueueGetSpace      sorted_osMessageQueueGetSpace
+#define osMessageQueueReset         sorted_osMessageQueueReset
+#define osMessageQueueDelete        sorted_osMessageQueueDelete
+
+#include "rtx_msgqueue_host.h"
+
+#include "../../../rtos/TARGET_CORTEX/rtx5/RTX/Source/rtx_msgqueue.c"
+
+const rtx_msgqueue_t rtx_msgqueue_sorted = {
+    "sorted", osMessageQueueNew, osMessageQueuePut, osMessageQueueGet, osMessageQueueDelete
+};
@@ -0,0 +1,286 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Ready list benchmark and test harness for the RTX scheduler core.
+ *
+ * Checks that the priority indexed Ready list (rtx_thread_ready.c) keeps the
+ * threads in the same order as the sorted list of rtx_thread.c over a random
+ * sequence of operations, then compares the cost of making a thread ready and
+ * of a preemption with 4, 16 and 64 ready threads.
+ *
+ * usage: rtx_ready_bench [iterations] [seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <time.h>
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#include "rtx_ready_host.h"
+
+#define THREADS_MAX     64
+
+osRtxInfo_t osRtxInfo;
+
+static osRtxObject_t sorted_ready;
+static osRtxThread_t threads[THREADS_MAX];
+static osRtxThread_t sorted_threads[THREADS_MAX];
+static uint32_t rng_state;
+
+static uint32_t rng(void)
+{
+    // xorshift32
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static uint64_t cycles(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+#endif
+}
+
+/* Sorted list, as osRtxThreadListPut/Get/Remove and osRtxThreadBlock in rtx_thread.c */
+
+static void sorted_put(osRtxThread_t *thread)
+{
+    osRtxThread_t *prev = osRtxThreadObject(&sorted_ready);
+    osRtxThread_t *next = sorted_ready.thread_list;
+
+    while ((next != NULL) && (next->priority >= thread->priority)) {
+        prev = next;
+        next = next->thread_next;
+    }
+    thread->thread_prev = prev;
+    thread->thread_next = next;
+    prev->thread_next = thread;
+    if (next != NULL) {
+        next->thread_prev = thread;
+    }
+}
+
+static void sorted_put_head(osRtxThread_t *thread)
+{
+    osRtxThread_t *prev = osRtxThreadObject(&sorted_ready);
+    osRtxThread_t *next = sorted_ready.thread_list;
+
+    while ((next != NULL) && (next->priority > thread->priority)) {
+        prev = next;
+        next = next->thread_next;
+    }
+    thread->thread_prev = prev;
+    thread->thread_next = next;
+    prev->thread_next = thread;
+    if (next != NULL) {
+        next->thread_prev = thread;
+    }
+}
+
+static void sorted_remove(osRtxThread_t *thread)
+{
+    if (thread->thread_prev != NULL) {
+        thread->thread_prev->thread_next = thread->thread_next;
+        if (thread->thread_next != NULL) {
+            thread->thread_next->thread_prev = thread->thread_prev;
+        }
+        thread->thread_prev = NULL;
+    }
+}
+
+static osRtxThread_t *sorted_get(void)
+{
+    osRtxThread_t *thread = sorted_ready.thread_list;
+    if (thread != NULL) {
+        sorted_remove(thread);
+    }
+    return thread;
+}
+
+static void reset(void)
+{
+    memset(&osRtxInfo, 0, sizeof(osRtxInfo));
+    memset(&sorted_ready, 0, sizeof(sorted_ready));
+    memset(threads, 0, sizeof(threads));
+    memset(sorted_threads, 0, sizeof(sorted_threads));
+    osRtxThreadReadyInit();
+    for (int i = 0; i < THREADS_MAX; i++) {
+        threads[i].id = osRtxIdThread;
+        sorted_threads[i].id = osRtxIdThread;
+    }
+}
+
+static int lists_equal(void)
+{
+    osRtxThread_t *a = osRtxInfo.thread.ready.thread_list;
+    osRtxThread_t *b = sorted_ready.thread_list;
+
+    while ((a != NULL) && (b != NULL)) {
+        if (((a - threads) != (b - sorted_threads)) || (a->priority != b->priority)) {
+            return 0;
+        }
+        a = a->thread_next;
+        b = b->thread_next;
+    }
+    return (a == NULL) && (b == NULL);
+}
+
+static int test(uint32_t iterations, uint32_t seed)
+{
+    int8_t in_list[THREADS_MAX] = { 0 };
+
+    reset();
+    rng_state = seed;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        uint32_t n = rng() % THREADS_MAX;
+        osRtxThread_t *a = &threads[n];
+        osRtxThread_t *b = &sorted_threads[n];
+        const char *op;
+
+        if (!in_list[n]) {
+            a->priority = b->priority = (int8_t)(osPriorityLow + rng() % 8);
+            if (rng() & 1) {
+                op = "insert";
+                osRtxThreadReadyInsert(a, FALSE);
+                sorted_put(b);
+            } else {
+                op = "insert at head";
+                osRtxThreadReadyInsert(a, TRUE);
+                sorted_put_head(b);
+            }
+            in_list[n] = 1;
+        } else {
+            switch (rng() % 3) {
+                case 0:
+                    op = "get";
+                    a = osRtxThreadReadyGet();
+                    b = sorted_get();
+                    in_list[a - threads] = 0;
+                    break;
+                case 1:
+                    op = "remove";
+                    osRtxThreadReadyRemove(a);
+                    sorted_remove(b);
+                    in_list[n] = 0;
+                    break;
+                default:
+                    op = "change priority";
+                    a->priority = b->priority = (int8_t)(osPriorityLow + rng() % 8);
+                    osRtxThreadReadySort(a);
+                    sorted_remove(b);
+                    sorted_put(b);
+                    break;
+            }
+        }
+
+        if (!lists_equal()) {
+            printf("Ready lists differ after %s of thread %" PRIu32 " at iteration %" PRIu32 "\n", op, n, i);
+            return 1;
+        }
+    }
+
+    printf("Ready list order matches the sorted list over %" PRIu32 " operations\n\n", iterations);
+    return 0;
+}
+
+static void bench(uint32_t count, uint32_t iterations, uint32_t seed)
+{
+    uint64_t sorted_insert = 0, sorted_preempt = 0;
+    uint64_t ready_insert = 0, ready_preempt = 0;
+    uint64_t start;
+
+    reset();
+    rng_state = seed;
+
+    for (uint32_t i = 0; i < count; i++) {
+        threads[i].priority = sorted_threads[i].priority = (int8_t)(osPriorityLow + rng() % (osPriorityRealtime - osPriorityLow));
+        osRtxThreadReadyInsert(&threads[i], FALSE);
+        sorted_put(&sorted_threads[i]);
+    }
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        uint32_t n = rng() % count;
+        osRtxThread_t *thread;
+
+        // A ready thread waits and is woken up again
+        osRtxThreadReadyRemove(&threads[n]);
+        start = cycles();
+        osRtxThreadReadyInsert(&threads[n], FALSE);
+        ready_insert += cycles() - start;
+
+        sorted_remove(&sorted_threads[n]);
+        start = cycles();
+        sorted_put(&sorted_threads[n]);
+        sorted_insert += cycles() - start;
+
+        // A ready thread preempts the running one
+        thread = osRtxThreadReadyGet();
+        start = cycles();
+        osRtxThreadReadyInsert(thread, TRUE);
+        thread = osRtxThreadReadyGet();
+        ready_preempt += cycles() - start;
+        osRtxThreadReadyInsert(thread, TRUE);
+
+        thread = sorted_get();
+        start = cycles();
+        sorted_put_head(thread);
+        thread = sorted_get();
+        sorted_preempt += cycles() - start;
+        sorted_put_head(thread);
+    }
+
+    printf("%8" PRIu32 " %14.1f %14.1f %14.1f %14.1f\n", count,
+           (double)sorted_insert / iterations, (double)ready_insert / iterations,
+           (double)sorted_preempt / iterations, (double)ready_preempt / iterations);
+}
+
+int main(int argc, char *argv[])
+{
+    static const uint32_t counts[] = { 4, 16, 64 };
+    uint32_t iterations = (argc > 1) ? strtoul(argv[1], NULL, 0) : 100000;
+    uint32_t seed = (argc > 2) ? strtoul(argv[2], NULL, 0) : 1;
+
+    if (!iterations || !seed) {
+        fprintf(stderr, "usage: %s [iterations] [seed != 0]\n", argv[0]);
+        return 1;
+    }
+
+    if (test(iterations, seed)) {
+        return 1;
+    }
+
+#if defined(__i386__) || defined(__x86_64__)
+    printf("Average TSC cycles per operation\n");
+#else
+    printf("Average nanoseconds per operation\n");
+#endif
+    printf("%8s %14s %14s %14s %14s\n", "threads", "insert sorted", "insert index", "preempt sorted", "preempt index");
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        bench(counts[i], iterations, seed);
+    }
+
+    return 0;
+}
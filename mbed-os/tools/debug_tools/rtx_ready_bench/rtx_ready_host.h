@@ -0,0 +1,58 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Host build of the RTX Ready list.
+ *
+ * Stands in for rtx_lib.h, so the Ready list index can be compiled without the
+ * CMSIS core headers.
+ */
+
+#ifndef RTX_READY_HOST_H
+#define RTX_READY_HOST_H
+
+/* Prevent the RTX sources from including the target rtx_lib.h */
+#define RTX_LIB_H_
+
+#include <stdbool.h>
+#include <string.h>
+#include "rtx_os.h"
+
+#define OS_THREAD_READY_BITMAP  1
+
+#define __STATIC_INLINE         static inline
+#define __CLZ(x)                ((uint8_t)__builtin_clz(x))
+
+typedef bool bool_t;
+#define FALSE                   ((bool_t)0)
+#define TRUE                    ((bool_t)1)
+
+#define os_thread_t             osRtxThread_t
+#define os_object_t             osRtxObject_t
+
+extern osRtxInfo_t osRtxInfo;
+
+static inline os_thread_t *osRtxThreadObject(os_object_t *object)
+{
+    return (os_thread_t *)object;
+}
+
+void         osRtxThreadReadyInit  (void);
+void         osRtxThreadReadyInsert(os_thread_t *thread, bool_t head);
+os_thread_t *osRtxThreadReadyGet   (void);
+void         osRtxThreadReadyRemove(os_thread_t *thread);
+void         osRtxThreadReadySort  (os_thread_t *thread);
+
+#endif
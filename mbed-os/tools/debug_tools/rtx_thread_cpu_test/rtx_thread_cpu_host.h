@@ -0,0 +1,49 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Host build of the RTX thread run time accounting.
+ *
+ * Stands in for rtx_lib.h, so rtx_thread_cpu.c can be compiled without the
+ * CMSIS core headers. The time stamps come from a mock clock.
+ */
+
+#ifndef RTX_THREAD_CPU_HOST_H
+#define RTX_THREAD_CPU_HOST_H
+
+/* Prevent the RTX sources from including the target rtx_lib.h */
+#define RTX_LIB_H_
+
+#define OS_THREAD_CPU_TIME      1
+
+/* As many entries as threads in the test, so that the table is full */
+#define OS_THREAD_CPU_TIME_NUM  8
+
+#define __STATIC_INLINE         static inline
+
+#include <stdint.h>
+#include "rtx_os.h"
+
+#define os_thread_t             osRtxThread_t
+
+extern osRtxInfo_t osRtxInfo;
+
+uint32_t osRtxThreadCpuTimeStamp (void);
+void     osRtxThreadCpuTimeNew   (const os_thread_t *thread);
+void     osRtxThreadCpuTimeFree  (const os_thread_t *thread);
+void     osRtxThreadCpuTimeSwitch(os_thread_t *thread);
+uint32_t osRtxThreadCpuTimeGet   (const os_thread_t *thread, uint64_t *cpu_time, uint32_t *switch_count);
+
+#endif
@@ -0,0 +1,222 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Test of the RTX thread run time accounting (rtx_thread_cpu.c) against a
+ * mock scheduler.
+ *
+ * The mock switches between threads at random times the way rtx_thread.c
+ * does: osRtxThreadSwitch selects the next thread in 'run.next' and the
+ * context switch at the end of the SVC or PendSV handler copies it to
+ * 'run.curr'. It also makes several switches in one handler, terminates
+ * running threads and lets the 32-bit clock wrap. The times and switch
+ * counts it expects are compared with those of the accounting, whose table
+ * has one entry per thread of the test.
+ *
+ * usage: rtx_thread_cpu_test [iterations] [seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "rtx_thread_cpu_host.h"
+
+#define THREADS_MAX     8
+
+osRtxInfo_t osRtxInfo;
+
+// One more control block than the table holds
+static osRtxThread_t threads[THREADS_MAX + 1];
+static uint64_t expected_time[THREADS_MAX];
+static uint32_t expected_switches[THREADS_MAX];
+static uint32_t clock_now;
+static uint32_t rng_state;
+
+static uint32_t rng(void)
+{
+    // xorshift32
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+uint32_t osRtxThreadCpuTimeStamp(void)
+{
+    return clock_now;
+}
+
+/* Same steps as osRtxThreadSwitch, without the stack check and the events */
+static void thread_switch(osRtxThread_t *thread)
+{
+    osRtxThreadCpuTimeSwitch(thread);
+    thread->state = osRtxThreadRunning;
+    osRtxInfo.thread.run.next = thread;
+}
+
+/* Context switch at the exit of the SVC or PendSV handler */
+static void context_switch(void)
+{
+    osRtxInfo.thread.run.curr = osRtxInfo.thread.run.next;
+}
+
+static void thread_new(int i)
+{
+    memset(&threads[i], 0, sizeof(threads[i]));
+    threads[i].id = osRtxIdThread;
+    threads[i].state = osRtxThreadReady;
+    osRtxThreadCpuTimeNew(&threads[i]);
+    expected_time[i] = 0;
+    expected_switches[i] = 0;
+}
+
+static int check(int running, uint32_t iteration)
+{
+    for (int i = 0; i < THREADS_MAX; i++) {
+        uint64_t time;
+        uint32_t switches;
+        if (!osRtxThreadCpuTimeGet(&threads[i], &time, &switches)) {
+            printf("FAIL at iteration %" PRIu32 ": thread %d not accounted\n", iteration, i);
+            return 0;
+        }
+        if (time != expected_time[i] || switches != expected_switches[i]) {
+            printf("FAIL at iteration %" PRIu32 ": thread %d%s time %" PRIu64 " (expected %" PRIu64 ")"
+                   " switches %" PRIu32 " (expected %" PRIu32 ")\n",
+                   iteration, i, (i == running) ? " (running)" : "", time, expected_time[i],
+                   switches, expected_switches[i]);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t iterations = (argc > 1) ? strtoul(argv[1], NULL, 0) : 1000000;
+    rng_state = (argc > 2) ? strtoul(argv[2], NULL, 0) : 1;
+    if (rng_state == 0) {
+        rng_state = 1;
+    }
+
+    // Start close to the wrap of the 32-bit clock
+    clock_now = 0xFFFFFFFFU - 100000U;
+    for (int i = 0; i < THREADS_MAX; i++) {
+        thread_new(i);
+    }
+
+    // Kernel start: no thread running yet
+    int running = 0;
+    thread_switch(&threads[running]);
+    context_switch();
+    expected_switches[running]++;
+
+    uint32_t wraps = 0;
+    uint32_t terminated = 0;
+    for (uint32_t n = 0; n < iterations; n++) {
+        // The running thread runs for a while, sometimes long enough for the clock to wrap
+        uint32_t run = (rng() % 16 == 0) ? rng() % 10000000U : rng() % 2000U;
+        if (clock_now + run < clock_now) {
+            wraps++;
+        }
+        clock_now += run;
+        expected_time[running] += run;
+
+        // Read the times while the thread runs, as mbed_stats_thread_get_each does
+        if ((n % 64) == 0 && !check(running, n)) {
+            return 1;
+        }
+
+        uint32_t op = rng() % 8;
+        if (op == 0) {
+            // The running thread exits and its control block is reused
+            int next = (running + 1 + rng() % (THREADS_MAX - 1)) % THREADS_MAX;
+            thread_switch(&threads[next]);
+            context_switch();
+            expected_switches[next]++;
+            osRtxThreadCpuTimeFree(&threads[running]);
+            thread_new(running);
+            running = next;
+            terminated++;
+        } else if (op == 1) {
+            // Two switches in one handler: the first selected thread never runs
+            int first = rng() % THREADS_MAX;
+            int second = rng() % THREADS_MAX;
+            thread_switch(&threads[first]);
+            thread_switch(&threads[second]);
+            context_switch();
+            if (first != running) {
+                expected_switches[first]++;
+            }
+            if (second != first) {
+                expected_switches[second]++;
+            }
+            running = second;
+        } else {
+            int next = rng() % THREADS_MAX;
+            thread_switch(&threads[next]);
+            context_switch();
+            if (next != running) {
+                expected_switches[next]++;
+            }
+            running = next;
+        }
+    }
+
+    if (!check(running, iterations)) {
+        return 1;
+    }
+
+    // The table is full: a thread created now is not accounted, until an entry is released
+    uint64_t time;
+    uint32_t switches;
+    osRtxThreadCpuTimeNew(&threads[THREADS_MAX]);
+    if (osRtxThreadCpuTimeGet(&threads[THREADS_MAX], &time, &switches) || time != 0 || switches != 0) {
+        printf("FAIL: thread accounted while the table is full\n");
+        return 1;
+    }
+    int last = (running + 1) % THREADS_MAX;
+    osRtxThreadCpuTimeFree(&threads[last]);
+    if (osRtxThreadCpuTimeGet(&threads[last], &time, &switches)) {
+        printf("FAIL: thread %d accounted after its release\n", last);
+        return 1;
+    }
+    osRtxThreadCpuTimeNew(&threads[THREADS_MAX]);
+    if (!osRtxThreadCpuTimeGet(&threads[THREADS_MAX], &time, &switches) || time != 0 || switches != 0) {
+        printf("FAIL: thread not accounted in a released entry\n");
+        return 1;
+    }
+    for (int i = 0; i < THREADS_MAX; i++) {
+        if (i != last && !osRtxThreadCpuTimeGet(&threads[i], &time, &switches)) {
+            printf("FAIL: thread %d lost after a release\n", i);
+            return 1;
+        }
+    }
+
+    uint64_t total = 0;
+    for (int i = 0; i < THREADS_MAX; i++) {
+        total += expected_time[i];
+    }
+    printf("PASS: %" PRIu32 " iterations, %" PRIu32 " clock wraps, %" PRIu32 " threads terminated\n",
+           iterations, wraps, terminated);
+    printf("%-8s %14s %10s\n", "thread", "time (us)", "switches");
+    for (int i = 0; i < THREADS_MAX; i++) {
+        printf("%-8d %14" PRIu64 " %10" PRIu32 "\n", i, expected_time[i], expected_switches[i]);
+    }
+    printf("total    %14" PRIu64 "\n", total);
+
+    return 0;
+}
@@ -0,0 +1,491 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Convert a dump of the RTX event ring (mbed_rtx_evr_ring_read) to the Chrome
+ * trace event JSON format, which chrome://tracing and Perfetto can open, and
+ * print a per-thread summary of run time, context switches and waits.
+ *
+ * usage: rtx_trace <dump> <trace.json> [-n]
+ *   -n  leave out the instant events, only keep the thread and wait timelines
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "rtos/TARGET_CORTEX/mbed_rtx_evr_ring.h"
+
+/* Process IDs of the two groups of timelines in the trace */
+#define PID_THREADS     1
+#define PID_WAITS       2
+
+/* Ticker deltas above this are taken as a timestamp going back by up to 1 ms */
+#define BACKWARD_LIMIT  (0xFFFFFFFFU - 1000U)
+
+/* Event numbers (component and message number) from rtx_evr.c */
+#define EVT_THREAD_BLOCKED      0xF216
+#define EVT_THREAD_UNBLOCKED    0xF217
+#define EVT_THREAD_SWITCHED     0xF219
+#define EVT_THREAD_DESTROYED    0xF21C
+#define EVT_THREAD_DELAY        0xF229
+#define EVT_THREAD_DELAY_UNTIL  0xF22A
+
+struct event_name_t {
+    uint32_t number;
+    const char *name;
+};
+
+static const event_name_t event_names[] = {
+    { 0xF000, "MemoryInit" },
+    { 0xF001, "MemoryAlloc" },
+    { 0xF002, "MemoryFree" },
+    { 0xF003, "MemoryBlockInit" },
+    { 0xF004, "MemoryBlockAlloc" },
+    { 0xF005, "MemoryBlockFree" },
+    { 0xF100, "KernelError" },
+    { 0xF101, "KernelInitialize" },
+    { 0xF102, "KernelInitializeCompleted" },
+    { 0xF103, "KernelGetInfo" },
+    { 0xF104, "KernelInfoRetrieved" },
+    { 0xF105, "KernelInfoRetrieved_Detail" },
+    { 0xF106, "KernelGetState" },
+    { 0xF107, "KernelStart" },
+    { 0xF108, "KernelStarted" },
+    { 0xF109, "KernelLock" },
+    { 0xF10A, "KernelLocked" },
+    { 0xF10B, "KernelUnlock" },
+    { 0xF10C, "KernelUnlocked" },
+    { 0xF10D, "KernelRestoreLock" },
+    { 0xF10E, "KernelLockRestored" },
+    { 0xF10F, "KernelSuspend" },
+    { 0xF110, "KernelSuspended" },
+    { 0xF111, "KernelResume" },
+    { 0xF112, "KernelResumed" },
+    { 0xF113, "KernelGetTickCount" },
+    { 0xF114, "KernelGetTickFreq" },
+    { 0xF115, "KernelGetSysTimerCount" },
+    { 0xF116, "KernelGetSysTimerFreq" },
+    { 0xF200, "ThreadError" },
+    { 0xF201, "ThreadNew" },
+    { 0xF202, "ThreadNew_Detail" },
+    { 0xF203, "ThreadCreated" },
+    { 0xF204, "ThreadGetName" },
+    { 0xF205, "ThreadGetName_Detail" },
+    { 0xF206, "ThreadGetId" },
+    { 0xF207, "ThreadGetState" },
+    { 0xF208, "ThreadGetStackSize" },
+    { 0xF209, "ThreadGetStackSpace" },
+    { 0xF20A, "ThreadSetPriority" },
+    { 0xF20B, "ThreadGetPriority" },
+    { 0xF20C, "ThreadYield" },
+    { 0xF20D, "ThreadSuspend" },
+    { 0xF20E, "ThreadSuspended" },
+    { 0xF20F, "ThreadResume" },
+    { 0xF210, "ThreadResumed" },
+    { 0xF211, "ThreadDetach" },
+    { 0xF212, "ThreadDetached" },
+    { 0xF213, "ThreadJoin" },
+    { 0xF214, "ThreadJoinPending" },
+    { 0xF215, "ThreadJoined" },
+    { 0xF216, "ThreadBlocked" },
+    { 0xF217, "ThreadUnblocked" },
+    { 0xF218, "ThreadPreempted" },
+    { 0xF219, "ThreadSwitched" },
+    { 0xF21A, "ThreadExit" },
+    { 0xF21B, "ThreadTerminate" },
+    { 0xF21C, "ThreadDestroyed" },
+    { 0xF21D, "ThreadGetCount" },
+    { 0xF21E, "ThreadEnumerate" },
+    { 0xF21F, "ThreadFlagsSet" },
+    { 0xF220, "ThreadFlagsSetDone" },
+    { 0xF221, "ThreadFlagsClear" },
+    { 0xF222, "ThreadFlagsClearDone" },
+    { 0xF223, "ThreadFlagsGet" },
+    { 0xF224, "ThreadFlagsWait" },
+    { 0xF225, "ThreadFlagsWaitPending" },
+    { 0xF226, "ThreadFlagsWaitTimeout" },
+    { 0xF227, "ThreadFlagsWaitCompleted" },
+    { 0xF228, "ThreadFlagsWaitNotCompleted" },
+    { 0xF229, "ThreadDelay" },
+    { 0xF22A, "ThreadDelayUntil" },
+    { 0xF22B, "ThreadDelayCompleted" },
+    { 0xF300, "TimerError" },
+    { 0xF301, "TimerCallback" },
+    { 0xF302, "TimerNew" },
+    { 0xF303, "TimerNew_Detail" },
+    { 0xF304, "TimerCreated" },
+    { 0xF305, "TimerGetName" },
+    { 0xF306, "TimerGetName_Detail" },
+    { 0xF307, "TimerStart" },
+    { 0xF308, "TimerStarted" },
+    { 0xF309, "TimerStop" },
+    { 0xF30A, "TimerStopped" },
+    { 0xF30B, "TimerIsRunning" },
+    { 0xF30C, "TimerDelete" },
+    { 0xF30D, "TimerDestroyed" },
+    { 0xF400, "EventFlagsError" },
+    { 0xF401, "EventFlagsNew" },
+    { 0xF402, "EventFlagsNew_Detail" },
+    { 0xF403, "EventFlagsCreated" },
+    { 0xF404, "EventFlagsGetName" },
+    { 0xF405, "EventFlagsGetName_Detail" },
+    { 0xF406, "EventFlagsSet" },
+    { 0xF407, "EventFlagsSetDone" },
+    { 0xF408, "EventFlagsClear" },
+    { 0xF409, "EventFlagsClearDone" },
+    { 0xF40A, "EventFlagsGet" },
+    { 0xF40B, "EventFlagsWait" },
+    { 0xF40C, "EventFlagsWaitPending" },
+    { 0xF40D, "EventFlagsWaitTimeout" },
+    { 0xF40E, "EventFlagsWaitCompleted" },
+    { 0xF40F, "EventFlagsWaitNotCompleted" },
+    { 0xF410, "EventFlagsDelete" },
+    { 0xF411, "EventFlagsDestroyed" },
+    { 0xF500, "MutexError" },
+    { 0xF501, "MutexNew" },
+    { 0xF502, "MutexNew_Detail" },
+    { 0xF503, "MutexCreated" },
+    { 0xF504, "MutexGetName" },
+    { 0xF505, "MutexGetName_Detail" },
+    { 0xF506, "MutexAcquire" },
+    { 0xF507, "MutexAcquirePending" },
+    { 0xF508, "MutexAcquireTimeout" },
+    { 0xF509, "MutexAcquired" },
+    { 0xF50A, "MutexNotAcquired" },
+    { 0xF50B, "MutexRelease" },
+    { 0xF50C, "MutexReleased" },
+    { 0xF50D, "MutexGetOwner" },
+    { 0xF50E, "MutexDelete" },
+    { 0xF50F, "MutexDestroyed" },
+    { 0xF600, "SemaphoreError" },
+    { 0xF601, "SemaphoreNew" },
+    { 0xF602, "SemaphoreNew_Detail" },
+    { 0xF603, "SemaphoreCreated" },
+    { 0xF604, "SemaphoreGetName" },
+    { 0xF605, "SemaphoreGetName_Detail" },
+    { 0xF606, "SemaphoreAcquire" },
+    { 0xF607, "SemaphoreAcquirePending" },
+    { 0xF608, "SemaphoreAcquireTimeout" },
+    { 0xF609, "SemaphoreAcquired" },
+    { 0xF60A, "SemaphoreNotAcquired" },
+    { 0xF60B, "SemaphoreRelease" },
+    { 0xF60C, "SemaphoreReleased" },
+    { 0xF60D, "SemaphoreGetCount" },
+    { 0xF60E, "SemaphoreDelete" },
+    { 0xF60F, "SemaphoreDestroyed" },
+    { 0xF700, "MemoryPoolError" },
+    { 0xF701, "MemoryPoolNew" },
+    { 0xF702, "MemoryPoolNew_Detail" },
+    { 0xF703, "MemoryPoolCreated" },
+    { 0xF704, "MemoryPoolGetName" },
+    { 0xF705, "MemoryPoolGetName_Detail" },
+    { 0xF706, "MemoryPoolAlloc" },
+    { 0xF707, "MemoryPoolAllocPending" },
+    { 0xF708, "MemoryPoolAllocTimeout" },
+    { 0xF709, "MemoryPoolAllocated" },
+    { 0xF70A, "MemoryPoolAllocFailed" },
+    { 0xF70B, "MemoryPoolFree" },
+    { 0xF70C, "MemoryPoolDeallocated" },
+    { 0xF70D, "MemoryPoolFreeFailed" },
+    { 0xF70E, "MemoryPoolGetCapacity" },
+    { 0xF70F, "MemoryPoolGetBlockSize" },
+    { 0xF710, "MemoryPoolGetCount" },
+    { 0xF711, "MemoryPoolGetSpace" },
+    { 0xF712, "MemoryPoolDelete" },
+    { 0xF713, "MemoryPoolDestroyed" },
+    { 0xF800, "MessageQueueError" },
+    { 0xF801, "MessageQueueNew" },
+    { 0xF802, "MessageQueueNew_Detail" },
+    { 0xF803, "MessageQueueCreated" },
+    { 0xF804, "MessageQueueGetName" },
+    { 0xF805, "MessageQueueGetName_Detail" },
+    { 0xF806, "MessageQueuePut" },
+    { 0xF807, "MessageQueuePutPending" },
+    { 0xF808, "MessageQueuePutTimeout" },
+    { 0xF809, "MessageQueueInsertPending" },
+    { 0xF80A, "MessageQueueInserted" },
+    { 0xF80B, "MessageQueueNotInserted" },
+    { 0xF80C, "MessageQueueGet" },
+    { 0xF80D, "MessageQueueGetPending" },
+    { 0xF80E, "MessageQueueGetTimeout" },
+    { 0xF80F, "MessageQueueRetrieved" },
+    { 0xF810, "MessageQueueNotRetrieved" },
+    { 0xF811, "MessageQueueGetCapacity" },
+    { 0xF812, "MessageQueueGetMsgSize" },
+    { 0xF813, "MessageQueueGetCount" },
+    { 0xF814, "MessageQueueGetSpace" },
+    { 0xF815, "MessageQueueReset" },
+    { 0xF816, "MessageQueueResetDone" },
+    { 0xF817, "MessageQueueDelete" },
+    { 0xF818, "MessageQueueDestroyed" },
+};
+
+struct thread_t {
+    std::string name;
+    uint64_t run_start;
+    uint64_t run_time;
+    uint32_t switches;
+    bool waiting;
+    uint64_t wait_start;
+    std::string wait_reason;
+    uint32_t wait_object;
+    uint32_t wait_timeout;
+    uint32_t waits;
+    uint64_t wait_time;
+    uint64_t max_wait;
+};
+
+static std::map<uint32_t, thread_t> threads;
+static std::map<uint32_t, const char *> names;
+static FILE *out;
+static bool first_event = true;
+
+static const char *event_name(uint32_t id)
+{
+    static char buf[32];
+    std::map<uint32_t, const char *>::const_iterator it = names.find(id & 0xFFFF);
+    if (it != names.end()) {
+        return it->second;
+    }
+    snprintf(buf, sizeof(buf), "Event 0x%02" PRIX32 ":0x%02" PRIX32, (id >> 8) & 0xFF, id & 0xFF);
+    return buf;
+}
+
+static thread_t &thread(uint32_t id)
+{
+    std::map<uint32_t, thread_t>::iterator it = threads.find(id);
+    if (it == threads.end()) {
+        thread_t t = thread_t();
+        char buf[16];
+        snprintf(buf, sizeof(buf), "0x%08" PRIx32, id);
+        t.name = buf;
+        it = threads.insert(std::make_pair(id, t)).first;
+    }
+    return it->second;
+}
+
+static void begin_event()
+{
+    fprintf(out, first_event ? "\n" : ",\n");
+    first_event = false;
+}
+
+static uint64_t duration(uint64_t start, uint64_t end)
+{
+    return (end > start) ? end - start : 0;
+}
+
+static void complete_event(const char *name, int pid, uint32_t tid, uint64_t start, uint64_t end, const char *args)
+{
+    begin_event();
+    fprintf(out, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%" PRIu32 ",\"ts\":%" PRIu64 ",\"dur\":%" PRIu64 "%s%s%s}",
+            name, pid, tid, start, duration(start, end), args ? ",\"args\":{" : "", args ? args : "", args ? "}" : "");
+}
+
+static void end_run(uint32_t id, uint64_t now)
+{
+    thread_t &t = thread(id);
+    t.run_time += duration(t.run_start, now);
+    complete_event(t.name.c_str(), PID_THREADS, id, t.run_start, now, NULL);
+}
+
+static void end_wait(uint32_t id, uint64_t now, const char *result)
+{
+    thread_t &t = thread(id);
+    char args[96];
+    uint64_t wait = duration(t.wait_start, now);
+
+    snprintf(args, sizeof(args), "\"object\":\"0x%08" PRIx32 "\",\"timeout\":%" PRIu32 ",\"result\":\"%s\"",
+             t.wait_object, t.wait_timeout, result);
+    complete_event(t.wait_reason.c_str(), PID_WAITS, id, t.wait_start, now, args);
+    t.waiting = false;
+    t.waits++;
+    t.wait_time += wait;
+    if (wait > t.max_wait) {
+        t.max_wait = wait;
+    }
+}
+
+static void metadata(const char *name, int pid, uint32_t tid, const char *value)
+{
+    begin_event();
+    fprintf(out, "{\"name\":\"%s\",\"ph\":\"M\",\"pid\":%d,\"tid\":%" PRIu32 ",\"args\":{\"name\":\"%s\"}}",
+            name, pid, tid, value);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <dump> <trace.json> [-n]\n", argv[0]);
+        return 1;
+    }
+    bool instants = !(argc > 3 && strcmp(argv[3], "-n") == 0);
+
+    FILE *file = fopen(argv[1], "rb");
+    if (!file) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    std::vector<mbed_rtx_evr_record_t> records;
+    mbed_rtx_evr_record_t record;
+    while (fread(&record, sizeof(record), 1, file) == 1) {
+        records.push_back(record);
+    }
+    fclose(file);
+
+    out = fopen(argv[2], "w");
+    if (!out) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    for (size_t i = 0; i < sizeof(event_names) / sizeof(event_names[0]); i++) {
+        names[event_names[i].number] = event_names[i].name;
+    }
+
+    fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    metadata("process_name", PID_THREADS, 0, "Threads");
+    metadata("process_name", PID_WAITS, 0, "Waits");
+
+    uint32_t running = 0;
+    bool have_running = false;
+    std::string pending_reason;
+    uint32_t pending_object = 0;
+    uint64_t now = 0;
+    uint64_t start = 0;
+    uint32_t last = 0;
+
+    for (size_t i = 0; i < records.size(); i++) {
+        const mbed_rtx_evr_record_t &r = records[i];
+        uint32_t number = r.id & 0xFFFF;
+
+        /* Extend the 32-bit ticker time, which wraps every 71 minutes. Records
+         * written by preempting interrupts can be slightly out of order, so
+         * small backward steps are kept as such rather than taken as a wrap. */
+        if (i == 0) {
+            now = r.timestamp;
+            start = now;
+        } else {
+            uint32_t delta = r.timestamp - last;
+            if (delta > BACKWARD_LIMIT) {
+                now -= (uint32_t)(0 - delta);
+            } else {
+                now += delta;
+            }
+        }
+        last = r.timestamp;
+
+        switch (number) {
+            case MBED_RTX_EVR_RING_THREAD_NAME: {
+                char name[13];
+                memcpy(name, &r.val[1], 12);
+                name[12] = '\0';
+                thread(r.val[0]).name = name;
+                continue;
+            }
+
+            case EVT_THREAD_SWITCHED:
+                if (have_running) {
+                    end_run(running, now);
+                }
+                running = r.val[0];
+                have_running = true;
+                thread(running).run_start = now;
+                thread(running).switches++;
+                break;
+
+            case EVT_THREAD_BLOCKED: {
+                thread_t &t = thread(r.val[0]);
+                t.waiting = true;
+                t.wait_start = now;
+                t.wait_reason = pending_reason.empty() ? "Blocked" : pending_reason;
+                t.wait_object = pending_object;
+                t.wait_timeout = r.val[1];
+                pending_reason.clear();
+                pending_object = 0;
+                break;
+            }
+
+            case EVT_THREAD_UNBLOCKED:
+                if (thread(r.val[0]).waiting) {
+                    end_wait(r.val[0], now, ((int32_t)r.val[1] == -2) ? "timeout" : "ok");
+                }
+                break;
+
+            case EVT_THREAD_DESTROYED:
+                if (thread(r.val[0]).waiting) {
+                    end_wait(r.val[0], now, "destroyed");
+                }
+                break;
+
+            case EVT_THREAD_DELAY:
+            case EVT_THREAD_DELAY_UNTIL:
+                pending_reason = event_name(r.id);
+                pending_object = 0;
+                break;
+
+            default: {
+                /* The "...Pending" events precede the block and name the object waited for */
+                const char *name = event_name(r.id);
+                size_t len = strlen(name);
+                if (len > 7 && strcmp(name + len - 7, "Pending") == 0) {
+                    pending_reason = name;
+                    pending_object = r.val[0];
+                }
+                break;
+            }
+        }
+
+        if (instants) {
+            begin_event();
+            fprintf(out, "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%" PRIu32 ",\"ts\":%" PRIu64
+                    ",\"args\":{\"v0\":\"0x%08" PRIx32 "\",\"v1\":\"0x%08" PRIx32 "\",\"v2\":\"0x%08" PRIx32 "\",\"v3\":\"0x%08" PRIx32 "\"}}",
+                    event_name(r.id), PID_THREADS, running, now, r.val[0], r.val[1], r.val[2], r.val[3]);
+        }
+    }
+
+    /* Close the slices still open at the end of the trace */
+    if (have_running) {
+        end_run(running, now);
+    }
+    for (std::map<uint32_t, thread_t>::iterator it = threads.begin(); it != threads.end(); ++it) {
+        if (it->second.waiting) {
+            end_wait(it->first, now, "pending");
+        }
+        metadata("thread_name", PID_THREADS, it->first, it->second.name.c_str());
+        metadata("thread_name", PID_WAITS, it->first, it->second.name.c_str());
+    }
+    fprintf(out, "\n]}\n");
+    fclose(out);
+
+    uint64_t total = now - start;
+    printf("%zu records, %" PRIu64 " us\n\n", records.size(), total);
+    printf("%-12s %-12s %12s %7s %9s %7s %12s %10s\n",
+           "thread", "name", "run (us)", "run %", "switches", "waits", "wait (us)", "max wait");
+    for (std::map<uint32_t, thread_t>::const_iterator it = threads.begin(); it != threads.end(); ++it) {
+        const thread_t &t = it->second;
+        printf("0x%08" PRIx32 "   %-12s %12" PRIu64 " %6.1f%% %9" PRIu32 " %7" PRIu32 " %12" PRIu64 " %10" PRIu64 "\n",
+               it->first, t.name.c_str(), t.run_time, total ? (100.0 * t.run_time) / total : 0.0,
+               t.switches, t.waits, t.wait_time, t.max_wait);
+    }
+
+    return 0;
+}
@@ -0,0 +1,337 @@
+/* Host benchmark of the block write and read of the serial drivers
+ *
+ * Built twice: with MOCK_BUFFER, the mocked HAL has block functions like the
+ * STM32 targets, without it the drivers use the per character defaults of
+ * hal/mbed_serial_api.c.
+ */
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "drivers/Serial.h"
+#include "drivers/RawSerial.h"
+#include "serial_mock.h"
+
+using namespace mbed;
+
+#if MOCK_BUFFER
+#define VARIANT "block"
+#else
+#define VARIANT "weak"
+#endif
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+/* A Stream overriding only _putc and _getc, the fallback of the drivers without block hooks */
+class LoopSerial : public SerialBase, public Stream {
+public:
+    LoopSerial() : SerialBase(UART_TX, UART_RX, 9600), Stream(NULL), calls(0) {}
+
+    uint32_t calls;
+
+protected:
+    virtual int _putc(int c)
+    {
+        calls++;
+        return _base_putc(c);
+    }
+
+    virtual int _getc()
+    {
+        calls++;
+        return _base_getc();
+    }
+};
+
+/* mbed stand-ins */
+
+static ssize_t cookie_write(void *cookie, const char *buffer, size_t size)
+{
+    return static_cast<FileHandle *>(cookie)->write(buffer, size);
+}
+
+static ssize_t cookie_read(void *cookie, char *buffer, size_t size)
+{
+    return static_cast<FileHandle *>(cookie)->read(buffer, size);
+}
+
+std::FILE *mbed::fdopen(FileHandle *fh, const char *mode)
+{
+    cookie_io_functions_t functions = {cookie_read, cookie_write, NULL, NULL};
+
+    return fopencookie(fh, mode, functions);
+}
+
+void mbed::mbed_set_unbuffered_stream(std::FILE *file)
+{
+    setvbuf(file, NULL, _IONBF, 0);
+}
+
+int mbed::mbed_getc(std::FILE *file)
+{
+    return fgetc(file);
+}
+
+char *mbed::mbed_gets(char *s, int size, std::FILE *file)
+{
+    return fgets(s, size, file);
+}
+
+extern "C" {
+
+void sleep_manager_lock_deep_sleep_internal(void)
+{
+}
+
+void sleep_manager_unlock_deep_sleep_internal(void)
+{
+}
+
+void core_util_critical_section_enter(void)
+{
+}
+
+void core_util_critical_section_exit(void)
+{
+}
+
+void wait_us(int us)
+{
+    (void)us;
+}
+
+void mbed_assert_internal(const char *expr, const char *file, int line)
+{
+    printf("assertion failed: %s, %s:%d\n", expr, file, line);
+    exit(1);
+}
+
+}
+
+void error(const char *format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    exit(1);
+}
+
+/* Tests */
+
+static char data[256];
+
+static void fill_data(void)
+{
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (char)(i * 7 + 3);
+    }
+}
+
+static bool sent(const void *expected, size_t length)
+{
+    return (serial_mock_tx_count == length) && (memcmp(serial_mock_tx, expected, length) == 0);
+}
+
+static void test_write(void)
+{
+    LoopSerial loop;
+    Serial serial(UART_TX, UART_RX);
+    RawSerial raw(UART_TX, UART_RX);
+    FileHandle &loop_file = loop;
+    FileHandle &serial_file = serial;
+
+    serial_mock_reset();
+    CHECK(loop_file.write(data, sizeof(data)) == (ssize_t)sizeof(data));
+    CHECK(sent(data, sizeof(data)));
+    CHECK(loop.calls == sizeof(data));
+
+    serial_mock_reset();
+    CHECK(serial_file.write(data, sizeof(data)) == (ssize_t)sizeof(data));
+    CHECK(sent(data, sizeof(data)));
+#if MOCK_BUFFER
+    // One call for the whole block
+    CHECK(serial_mock_stats.hal_calls == 1);
+#endif
+
+    serial_mock_reset();
+    CHECK(raw.write(data, sizeof(data)) == (int)sizeof(data));
+    CHECK(sent(data, sizeof(data)));
+
+    serial_mock_reset();
+    CHECK(raw.puts("hello") == 0);
+    CHECK(sent("hello", 5));
+
+    // Nothing to write
+    serial_mock_reset();
+    CHECK(serial_file.write(data, 0) == 0);
+    CHECK(raw.write(data, 0) == 0);
+    CHECK(serial_mock_tx_count == 0);
+
+    // printf goes through the stream
+    serial_mock_reset();
+    CHECK(serial.printf("%d-%s", 42, "ok") == 5);
+    CHECK(sent("42-ok", 5));
+}
+
+static void test_read(void)
+{
+    LoopSerial loop;
+    Serial serial(UART_TX, UART_RX);
+    RawSerial raw(UART_TX, UART_RX);
+    FileHandle &loop_file = loop;
+    FileHandle &serial_file = serial;
+    char buffer[sizeof(data) + 1];
+
+    serial_mock_reset();
+    serial_mock_receive(data, sizeof(data));
+    memset(buffer, 0, sizeof(buffer));
+    CHECK(loop_file.read(buffer, sizeof(data)) == (ssize_t)sizeof(data));
+    CHECK(memcmp(buffer, data, sizeof(data)) == 0);
+
+    serial_mock_reset();
+    serial_mock_receive(data, sizeof(data));
+    memset(buffer, 0, sizeof(buffer));
+    CHECK(serial_file.read(buffer, sizeof(data)) == (ssize_t)sizeof(data));
+    CHECK(memcmp(buffer, data, sizeof(data)) == 0);
+    CHECK(serial_mock_stats.rdr_loads == sizeof(data));
+#if MOCK_BUFFER
+    // The block call and its wait for the first character
+    CHECK(serial_mock_stats.hal_calls == 2);
+#endif
+
+    // Only the characters asked for are read
+    serial_mock_reset();
+    serial_mock_receive(data, sizeof(data));
+    memset(buffer, 0, sizeof(buffer));
+    CHECK(raw.read(buffer, 10) == 10);
+    CHECK(memcmp(buffer, data, 10) == 0);
+    CHECK(buffer[10] == 0);
+    CHECK(raw.read(buffer, 5) == 5);
+    CHECK(memcmp(buffer, data + 10, 5) == 0);
+    CHECK(raw.getc() == data[15]);
+    CHECK(serial_mock_stats.rdr_loads == 16);
+}
+
+/* HAL accesses per byte and host time of the writes and reads */
+
+typedef void (*transfer_t)(void *serial, size_t length);
+
+static void loop_write(void *serial, size_t length)
+{
+    static_cast<FileHandle *>(static_cast<LoopSerial *>(serial))->write(data, length);
+}
+
+static void serial_write(void *serial, size_t length)
+{
+    static_cast<FileHandle *>(static_cast<Serial *>(serial))->write(data, length);
+}
+
+static void raw_putc(void *serial, size_t length)
+{
+    for (size_t i = 0; i < length; i++) {
+        static_cast<RawSerial *>(serial)->putc(data[i]);
+    }
+}
+
+static void raw_write(void *serial, size_t length)
+{
+    static_cast<RawSerial *>(serial)->write(data, length);
+}
+
+static void loop_read(void *serial, size_t length)
+{
+    char buffer[sizeof(data)];
+
+    serial_mock_receive(data, length);
+    static_cast<FileHandle *>(static_cast<LoopSerial *>(serial))->read(buffer, length);
+}
+
+static void serial_read(void *serial, size_t length)
+{
+    char buffer[sizeof(data)];
+
+    serial_mock_receive(data, length);
+    static_cast<FileHandle *>(static_cast<Serial *>(serial))->read(buffer, length);
+}
+
+static void raw_getc(void *serial, size_t length)
+{
+    serial_mock_receive(data, length);
+    for (size_t i = 0; i < length; i++) {
+        static_cast<RawSerial *>(serial)->getc();
+    }
+}
+
+static void raw_read(void *serial, size_t length)
+{
+    char buffer[sizeof(data)];
+
+    serial_mock_receive(data, length);
+    static_cast<RawSerial *>(serial)->read(buffer, length);
+}
+
+static void report(const char *name, transfer_t transfer, void *serial, size_t length)
+{
+    struct timespec start, end;
+    const int transfers = 20000;
+    double calls, status, ns;
+
+    serial_mock_reset();
+    transfer(serial, length);
+    calls = (double)serial_mock_stats.hal_calls / length;
+    status = (double)serial_mock_stats.status_reads / length;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int n = 0; n < transfers; n++) {
+        transfer(serial, length);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    ns = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / ((double)transfers * length);
+
+    printf("%-5s %-17s %5u  %9.2f  %12.2f  %7.1f\n", VARIANT, name, (unsigned)length, calls, status, ns);
+}
+
+int main(void)
+{
+    static const size_t lengths[] = {1, 16, 256};
+
+    fill_data();
+    test_write();
+    test_read();
+
+    LoopSerial loop;
+    Serial serial(UART_TX, UART_RX);
+    RawSerial raw(UART_TX, UART_RX);
+
+    printf("                        bytes  HAL calls  status reads  host ns\n");
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+        report("Stream loop write", loop_write, &loop, lengths[i]);
+        report("Serial write", serial_write, &serial, lengths[i]);
+        report("RawSerial putc", raw_putc, &raw, lengths[i]);
+        report("RawSerial write", raw_write, &raw, lengths[i]);
+    }
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+        report("Stream loop read", loop_read, &loop, lengths[i]);
+        report("Serial read", serial_read, &serial, lengths[i]);
+        report("RawSerial getc", raw_getc, &raw, lengths[i]);
+        report("RawSerial read", raw_read, &raw, lengths[i]);
+    }
+
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All tests passed\n");
+    return 0;
+}
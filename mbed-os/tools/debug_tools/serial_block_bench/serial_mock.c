@@ -0,0 +1,182 @@
+/* Mocked serial_api, in its own translation unit so that the drivers call it
+ * like the target HAL
+ *
+ * The functions follow TARGET_STM32L4/serial_device.c: serial_putc waits on
+ * serial_writable and stores TDR, serial_getc waits on serial_readable and
+ * loads RDR. With MOCK_BUFFER, it also has the block functions of the target,
+ * otherwise the drivers use the defaults of hal/mbed_serial_api.c.
+ */
+#include <string.h>
+
+#include "hal/serial_api.h"
+#include "serial_mock.h"
+
+serial_mock_stats_t serial_mock_stats;
+uint8_t serial_mock_tx[SERIAL_MOCK_TX_SIZE];
+uint32_t serial_mock_tx_count;
+
+static const uint8_t *rx_data;
+static size_t rx_length;
+static size_t rx_position;
+
+/* Registers */
+
+static volatile uint32_t tdr;
+
+static int tx_empty(void)
+{
+    serial_mock_stats.status_reads++;
+    return 1;
+}
+
+static int rx_not_empty(void)
+{
+    serial_mock_stats.status_reads++;
+    return rx_position < rx_length;
+}
+
+static void tdr_store(uint8_t c)
+{
+    serial_mock_stats.tdr_stores++;
+    tdr = c;
+    serial_mock_tx[serial_mock_tx_count++ & (SERIAL_MOCK_TX_SIZE - 1)] = c;
+}
+
+static uint8_t rdr_load(void)
+{
+    serial_mock_stats.rdr_loads++;
+    return rx_data[rx_position++];
+}
+
+void serial_mock_receive(const void *data, size_t length)
+{
+    rx_data = (const uint8_t *)data;
+    rx_length = length;
+    rx_position = 0;
+}
+
+void serial_mock_reset(void)
+{
+    memset(&serial_mock_stats, 0, sizeof(serial_mock_stats));
+    serial_mock_tx_count = 0;
+}
+
+/* serial_api */
+
+void serial_init(serial_t *obj, PinName tx, PinName rx)
+{
+    (void)tx;
+    (void)rx;
+    obj->index = 0;
+}
+
+void serial_free(serial_t *obj)
+{
+    (void)obj;
+}
+
+void serial_baud(serial_t *obj, int baudrate)
+{
+    (void)obj;
+    (void)baudrate;
+}
+
+void serial_format(serial_t *obj, int data_bits, SerialParity parity, int stop_bits)
+{
+    (void)obj;
+    (void)data_bits;
+    (void)parity;
+    (void)stop_bits;
+}
+
+void serial_irq_handler(serial_t *obj, uart_irq_handler handler, uint32_t id)
+{
+    (void)obj;
+    (void)handler;
+    (void)id;
+}
+
+void serial_irq_set(serial_t *obj, SerialIrq irq, uint32_t enable)
+{
+    (void)obj;
+    (void)irq;
+    (void)enable;
+}
+
+int serial_readable(serial_t *obj)
+{
+    (void)obj;
+    serial_mock_stats.hal_calls++;
+    return rx_not_empty();
+}
+
+int serial_writable(serial_t *obj)
+{
+    (void)obj;
+    serial_mock_stats.hal_calls++;
+    return tx_empty();
+}
+
+int serial_getc(serial_t *obj)
+{
+    serial_mock_stats.hal_calls++;
+    while (!serial_readable(obj));
+    return rdr_load();
+}
+
+void serial_putc(serial_t *obj, int c)
+{
+    serial_mock_stats.hal_calls++;
+    while (!serial_writable(obj));
+    tdr_store((uint8_t)c);
+}
+
+#if MOCK_BUFFER
+void serial_putc_buffer(serial_t *obj, const void *buffer, size_t length)
+{
+    const uint8_t *data = (const uint8_t *)buffer;
+
+    (void)obj;
+    serial_mock_stats.hal_calls++;
+    while (length--) {
+        while (!tx_empty());
+        tdr_store(*data++);
+    }
+}
+
+size_t serial_getc_buffer(serial_t *obj, void *buffer, size_t length)
+{
+    uint8_t *data = (uint8_t *)buffer;
+    size_t count = 0;
+
+    serial_mock_stats.hal_calls++;
+    if (length == 0) {
+        return 0;
+    }
+    while (!serial_readable(obj));
+    do {
+        data[count++] = rdr_load();
+    } while ((count < length) && rx_not_empty());
+    return count;
+}
+#endif
+
+void serial_clear(serial_t *obj)
+{
+    (void)obj;
+}
+
+void serial_break_set(serial_t *obj)
+{
+    (void)obj;
+}
+
+void serial_break_clear(serial_t *obj)
+{
+    (void)obj;
+}
+
+void serial_pinout_tx(PinName tx)
+{
+    (void)tx;
+}
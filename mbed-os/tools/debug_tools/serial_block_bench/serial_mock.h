@@ -0,0 +1,35 @@
+/* Mocked serial_api for the serial block benchmark */
+#ifndef SERIAL_MOCK_H
+#define SERIAL_MOCK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t hal_calls;         // calls into the serial_api functions
+    uint32_t status_reads;      // reads of the TXE and RXNE flags
+    uint32_t tdr_stores;
+    uint32_t rdr_loads;
+} serial_mock_stats_t;
+
+extern serial_mock_stats_t serial_mock_stats;
+
+/* Transmitted characters, the last SERIAL_MOCK_TX_SIZE of them */
+#define SERIAL_MOCK_TX_SIZE     4096
+extern uint8_t serial_mock_tx[SERIAL_MOCK_TX_SIZE];
+extern uint32_t serial_mock_tx_count;
+
+/* Characters to receive, available at once */
+void serial_mock_receive(const void *data, size_t length);
+
+void serial_mock_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,29 @@
+/* Host stand-in for device.h: one mocked UART */
+#ifndef SERIAL_BLOCK_BENCH_DEVICE_H
+#define SERIAL_BLOCK_BENCH_DEVICE_H
+
+#include <stdint.h>
+
+#define DEVICE_SERIAL                                   1
+#define MBED_CONF_PLATFORM_DEFAULT_SERIAL_BAUD_RATE     9600
+
+typedef enum {
+    UART_TX = 0,
+    UART_RX = 1,
+    NC = (int)0xFFFFFFFF
+} PinName;
+
+typedef enum {
+    PullNone = 0,
+    PullDefault = PullNone
+} PinMode;
+
+struct serial_s {
+    int index;
+};
+
+static inline void NVIC_SystemReset(void)
+{
+}
+
+#endif
@@ -0,0 +1,28 @@
+/* Host stand-in for platform/FileHandle.h, without the retarget layer */
+#ifndef SERIAL_BLOCK_BENCH_FILEHANDLE_H
+#define SERIAL_BLOCK_BENCH_FILEHANDLE_H
+
+#include <cstdio>
+#include <sys/types.h>
+
+namespace mbed {
+
+class FileHandle {
+public:
+    virtual ~FileHandle() {}
+    virtual ssize_t read(void *buffer, size_t size) = 0;
+    virtual ssize_t write(const void *buffer, size_t size) = 0;
+    virtual off_t seek(off_t offset, int whence = SEEK_SET) = 0;
+    virtual int close() = 0;
+    virtual int sync() { return 0; }
+    virtual int isatty() { return 0; }
+    virtual off_t tell() { return 0; }
+    virtual void rewind() {}
+    virtual off_t size() { return 0; }
+};
+
+std::FILE *fdopen(FileHandle *fh, const char *mode);
+
+} // namespace mbed
+
+#endif
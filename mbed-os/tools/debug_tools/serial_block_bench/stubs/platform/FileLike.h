@@ -0,0 +1,17 @@
+/* Host stand-in for platform/FileLike.h, without the file system names */
+#ifndef SERIAL_BLOCK_BENCH_FILELIKE_H
+#define SERIAL_BLOCK_BENCH_FILELIKE_H
+
+#include "platform/FileHandle.h"
+
+namespace mbed {
+
+class FileLike : public FileHandle {
+public:
+    FileLike(const char *name = NULL) {}
+    virtual ~FileLike() {}
+};
+
+} // namespace mbed
+
+#endif
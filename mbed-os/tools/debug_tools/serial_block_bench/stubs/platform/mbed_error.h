@@ -0,0 +1,10 @@
+/* Host stand-in for platform/mbed_error.h */
+#ifndef SERIAL_BLOCK_BENCH_MBED_ERROR_H
+#define SERIAL_BLOCK_BENCH_MBED_ERROR_H
+
+#define MBED_MAKE_ERROR(module, code)               (code)
+#define MBED_ERROR1(status, message, value)         error("%s\n", message)
+
+void error(const char *format, ...);
+
+#endif
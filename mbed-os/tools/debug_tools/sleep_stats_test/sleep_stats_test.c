@@ -0,0 +1,242 @@
+/* Host test of the deep sleep lock accounting of hal/mbed_sleep_manager.c
+ *
+ * The lp ticker is replaced by a fake one, whose time only moves when the
+ * test advances it, so the hold times reported for each owner are exact.
+ * Owners are distinct strings standing for the MBED_FILENAME of drivers.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../../hal/mbed_sleep_manager.c"
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+/* Fake lp ticker */
+
+static us_timestamp_t fake_now;
+static int deep_sleeps;
+static int sleeps;
+
+const ticker_data_t *get_lp_ticker_data(void)
+{
+    static int ticker;
+
+    return (const ticker_data_t *)&ticker;
+}
+
+us_timestamp_t ticker_read_us(const ticker_data_t *const ticker)
+{
+    (void)ticker;
+    return fake_now;
+}
+
+static void advance(us_timestamp_t us)
+{
+    fake_now += us;
+}
+
+void hal_sleep(void)
+{
+    sleeps++;
+    advance(100);
+}
+
+void hal_deepsleep(void)
+{
+    deep_sleeps++;
+    advance(1000);
+}
+
+void core_util_critical_section_enter(void)
+{
+}
+
+void core_util_critical_section_exit(void)
+{
+}
+
+uint16_t core_util_atomic_incr_u16(volatile uint16_t *valuePtr, uint16_t delta)
+{
+    return *valuePtr += delta;
+}
+
+uint16_t core_util_atomic_decr_u16(volatile uint16_t *valuePtr, uint16_t delta)
+{
+    return *valuePtr -= delta;
+}
+
+void mbed_assert_internal(const char *expr, const char *file, int line)
+{
+    printf("%s:%d: assertion failed: %s\n", file, line, expr);
+    exit(1);
+}
+
+void sleep_stats_test_error(const char *message)
+{
+    printf("error: %s\n", message);
+    exit(1);
+}
+
+/* The lock and unlock macros of mbed_power_mgmt.h, with the owner given */
+static void lock(const char *owner)
+{
+    sleep_manager_lock_deep_sleep_internal();
+    sleep_tracker_lock(owner, __LINE__);
+}
+
+static void unlock(const char *owner)
+{
+    sleep_manager_unlock_deep_sleep_internal();
+    sleep_tracker_unlock(owner, __LINE__);
+}
+
+static void reset(void)
+{
+    memset(sleep_stats, 0, sizeof(sleep_stats));
+    deep_sleep_lock = 0;
+    fake_now = 1000000;
+}
+
+static const mbed_stats_sleep_t *find(const mbed_stats_sleep_t *stats, size_t count, const char *owner)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (stats[i].owner == owner) {
+            return &stats[i];
+        }
+    }
+    return NULL;
+}
+
+static void test_hold_time(void)
+{
+    static const char serial[] = "SerialBase.cpp";
+    static const char i2c[] = "I2C.cpp";
+    mbed_stats_sleep_t stats[STATISTIC_COUNT];
+    const mbed_stats_sleep_t *s;
+
+    reset();
+    CHECK(mbed_stats_sleep_get_each(stats, STATISTIC_COUNT) == 0);
+
+    // A nested lock keeps the first lock time, and the hold ends with the last unlock
+    lock(serial);
+    advance(300);
+    lock(serial);
+    advance(200);
+    unlock(serial);
+    CHECK(!sleep_manager_can_deep_sleep());
+    advance(500);
+    unlock(serial);
+    CHECK(sleep_manager_can_deep_sleep());
+    advance(10000);
+
+    CHECK(mbed_stats_sleep_get_each(stats, STATISTIC_COUNT) == 1);
+    CHECK(stats[0].owner == serial);
+    CHECK(stats[0].lock_count == 0);
+    CHECK(stats[0].lock_total == 2 && stats[0].unlock_total == 2);
+    CHECK(stats[0].time_held == 1000);
+    CHECK(stats[0].uptime == fake_now);
+
+    // A lock still held counts up to now, and its owner is in the current set
+    lock(i2c);
+    advance(2500);
+    CHECK(mbed_stats_sleep_get_each(stats, STATISTIC_COUNT) == 2);
+    s = find(stats, 2, i2c);
+    CHECK(s != NULL && s->lock_count == 1 && s->time_held == 2500);
+    s = find(stats, 2, serial);
+    CHECK(s != NULL && s->lock_count == 0 && s->time_held == 1000);
+
+    // Sleep is not deep while a lock is held
+    sleep_manager_sleep_auto();
+    CHECK(sleeps == 1 && deep_sleeps == 0);
+    unlock(i2c);
+    sleep_manager_sleep_auto();
+    CHECK(deep_sleeps == 1);
+    CHECK(mbed_time_deepsleep() == 1000 && mbed_time_sleep() == 100);
+
+    // The hold of i2c includes the 100 us of sleep, not the deep sleep after the unlock
+    mbed_stats_sleep_get_each(stats, STATISTIC_COUNT);
+    s = find(stats, 2, i2c);
+    CHECK(s != NULL && s->lock_count == 0 && s->time_held == 2600);
+
+    // Holds add up over many periods
+    for (int i = 0; i < 1000; i++) {
+        lock(i2c);
+        advance(7);
+        unlock(i2c);
+        advance(13);
+    }
+    mbed_stats_sleep_get_each(stats, STATISTIC_COUNT);
+    s = find(stats, 2, i2c);
+    CHECK(s != NULL && s->time_held == 2600 + 7000 && s->lock_total == 1001 && s->unlock_total == 1001);
+
+    // A smaller array gets the first owners only
+    CHECK(mbed_stats_sleep_get_each(stats, 1) == 1);
+}
+
+static void test_owners(void)
+{
+    // Owners whose pointers hash to the same slot, as the strings of an array
+    static char names[STATISTIC_COUNT + 1][4 * STATISTIC_COUNT];
+    mbed_stats_sleep_t stats[STATISTIC_COUNT + 1];
+
+    reset();
+    for (int i = 0; i <= STATISTIC_COUNT; i++) {
+        snprintf(names[i], sizeof(names[i]), "owner%d.cpp", i);
+    }
+    CHECK(sleep_tracker_slot(names[0]) == sleep_tracker_slot(names[1]));
+
+    // Each owner gets its slot by probing, until the table is full
+    for (int i = 0; i <= STATISTIC_COUNT; i++) {
+        lock(names[i]);
+        advance(i + 1);
+    }
+    for (int i = 0; i < STATISTIC_COUNT; i++) {
+        CHECK(sleep_tracker_find(names[i]) != NULL);
+    }
+    CHECK(sleep_tracker_find(names[STATISTIC_COUNT]) == NULL);
+
+    // The owner past the table is not accounted, but the deep sleep lock still holds
+    for (int i = 0; i <= STATISTIC_COUNT; i++) {
+        unlock(names[i]);
+    }
+    CHECK(sleep_manager_can_deep_sleep());
+    CHECK(mbed_stats_sleep_get_each(stats, STATISTIC_COUNT + 1) == STATISTIC_COUNT);
+    for (int i = 0; i < STATISTIC_COUNT; i++) {
+        const mbed_stats_sleep_t *s = find(stats, STATISTIC_COUNT, names[i]);
+
+        CHECK(s != NULL && s->lock_total == 1 && s->unlock_total == 1 && s->lock_count == 0);
+        // Owner i locked before the advances of owners i to STATISTIC_COUNT, and unlocked at once
+        CHECK(s != NULL && s->time_held == (us_timestamp_t)(STATISTIC_COUNT + 1) * (STATISTIC_COUNT + 2) / 2 - (us_timestamp_t)i * (i + 1) / 2);
+    }
+
+    // An unlock without a lock is reported and not counted
+    reset();
+    sleep_tracker_unlock(names[0], __LINE__);
+    CHECK(mbed_stats_sleep_get_each(stats, STATISTIC_COUNT) == 0);
+    lock(names[1]);
+    sleep_tracker_unlock(names[1], __LINE__);
+    sleep_tracker_unlock(names[1], __LINE__);
+    mbed_stats_sleep_get_each(stats, STATISTIC_COUNT);
+    CHECK(stats[0].lock_total == 1 && stats[0].unlock_total == 1);
+}
+
+int main(void)
+{
+    test_hold_time();
+    test_owners();
+
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All tests passed\n");
+    return 0;
+}
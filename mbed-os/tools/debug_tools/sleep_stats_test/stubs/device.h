@@ -0,0 +1,9 @@
+/* Host stand-in for the target device.h */
+#ifndef SLEEP_STATS_TEST_DEVICE_H
+#define SLEEP_STATS_TEST_DEVICE_H
+
+#include <stdint.h>
+
+void NVIC_SystemReset(void);
+
+#endif
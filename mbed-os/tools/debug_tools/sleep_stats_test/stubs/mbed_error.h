@@ -0,0 +1,9 @@
+/* Host stand-in for mbed_error.h, an error of the sleep manager ends the test */
+#ifndef SLEEP_STATS_TEST_MBED_ERROR_H
+#define SLEEP_STATS_TEST_MBED_ERROR_H
+
+void sleep_stats_test_error(const char *message);
+
+#define MBED_ERROR1(error_status, error_msg, error_value) sleep_stats_test_error(error_msg)
+
+#endif
@@ -0,0 +1,14 @@
+/* Host stand-in for the target device.h, with a struct trng_s for the mocked TRNG */
+#ifndef TRNG_POOL_TEST_DEVICE_H
+#define TRNG_POOL_TEST_DEVICE_H
+
+#include <stdint.h>
+
+void NVIC_SystemReset(void);
+
+struct trng_s {
+    uint32_t handler;
+    uint32_t id;
+};
+
+#endif
@@ -0,0 +1,380 @@
+/* Host test of the entropy pool of hal/mbed_trng_pool.c
+ *
+ * The TRNG is replaced by a mocked source, whose words are delivered to the
+ * pool handler like the TRNG interrupt would while it is enabled. The source
+ * can be switched to failure modes: stuck, biased, or reporting errors.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../../hal/mbed_trng_pool.c"
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+/* Mocked TRNG */
+
+typedef enum {
+    SOURCE_GOOD,
+    SOURCE_STUCK,           // every byte 0x5A
+    SOURCE_BIASED,          // a quarter of the bytes 0xA5
+} source_mode_t;
+
+static struct {
+    int inits;
+    int frees;
+    trng_handler handler;
+    uint32_t id;
+    int enabled;
+    int starts;
+    source_mode_t mode;
+    uint32_t state;
+    uint32_t words;
+    uint32_t tested;        // bytes delivered since the last failure detected by the pool
+} source;
+
+static int deep_sleep_locks;
+
+/* Bytes expected out of the pool, in order */
+static uint8_t expected[TRNG_POOL_SIZE];
+static uint32_t expected_head;
+static uint32_t expected_tail;
+
+void trng_init(trng_t *obj)
+{
+    (void)obj;
+    source.inits++;
+}
+
+void trng_free(trng_t *obj)
+{
+    (void)obj;
+    source.frees++;
+}
+
+void trng_irq_handler(trng_t *obj, trng_handler handler, uint32_t id)
+{
+    (void)obj;
+    source.handler = handler;
+    source.id = id;
+}
+
+void trng_irq_set(trng_t *obj, uint32_t enable)
+{
+    (void)obj;
+    if (enable && !source.enabled) {
+        source.starts++;
+    }
+    source.enabled = enable;
+}
+
+static uint32_t xorshift(void)
+{
+    source.state ^= source.state << 13;
+    source.state ^= source.state >> 17;
+    source.state ^= source.state << 5;
+    return source.state;
+}
+
+static uint32_t source_word(void)
+{
+    uint32_t word = xorshift();
+    int i;
+
+    switch (source.mode) {
+        case SOURCE_STUCK:
+            return 0x5A5A5A5A;
+        case SOURCE_BIASED:
+            for (i = 0; i < 4; i++) {
+                if ((xorshift() & 3) == 0) {
+                    word = (word & ~(0xFFUL << (8 * i))) | (0xA5UL << (8 * i));
+                }
+            }
+            return word;
+        default:
+            return word;
+    }
+}
+
+static uint32_t detected(void)
+{
+    return pool_stats.rct_failures + pool_stats.apt_failures + pool_stats.source_errors;
+}
+
+/* Deliver a word or an error like the TRNG interrupt, and check what the pool did with it */
+static void source_deliver(uint32_t word, int error)
+{
+    uint32_t head = pool_head;
+    uint32_t tail = pool_tail;
+    uint32_t failed = detected();
+    uint32_t i;
+
+    source.words++;
+    source.handler(source.id, word, error);
+
+    if (detected() != failed) {
+        // The pool is emptied and cleared
+        CHECK(pool_head == pool_tail);
+        for (i = 0; i < TRNG_POOL_SIZE; i++) {
+            CHECK(pool[i] == 0);
+        }
+        CHECK(source.enabled);
+        expected_tail = expected_head;
+        source.tested = 0;
+        return;
+    }
+
+    CHECK(pool_tail == tail);
+    CHECK(pool_head - head <= 4);
+    // Only the bytes after TRNG_POOL_STARTUP_BYTES tested ones are added
+    if (pool_head != head) {
+        CHECK(source.tested + 4 - (pool_head - head) >= TRNG_POOL_STARTUP_BYTES);
+    }
+    for (i = 0; head + i != pool_head; i++) {
+        CHECK(pool[(head + i) & (TRNG_POOL_SIZE - 1)] == (uint8_t)(word >> (8 * i)));
+        expected[expected_head++ & (TRNG_POOL_SIZE - 1)] = (uint8_t)(word >> (8 * i));
+    }
+    source.tested += 4;
+}
+
+/* Run the source while the pool enables it */
+static int source_run(int max_words)
+{
+    int words = 0;
+
+    while (source.enabled && (words < max_words)) {
+        source_deliver(source_word(), 0);
+        words++;
+    }
+    return words;
+}
+
+static void take(size_t length, int expect_ret)
+{
+    uint8_t output[256];
+    size_t output_length = 0;
+    size_t available = trng_pool_available();
+    size_t i;
+    int ret;
+
+    memset(output, 0xEE, sizeof(output));
+    ret = trng_pool_get_bytes(output, length, &output_length);
+    CHECK(ret == expect_ret);
+    CHECK(output_length == ((length < available) ? length : available));
+    for (i = 0; i < output_length; i++) {
+        CHECK(output[i] == expected[expected_tail++ & (TRNG_POOL_SIZE - 1)]);
+    }
+    CHECK(output[output_length] == 0xEE);
+    CHECK(trng_pool_available() == available - output_length);
+}
+
+/* mbed stand-ins */
+
+void sleep_manager_lock_deep_sleep_internal(void)
+{
+    deep_sleep_locks++;
+}
+
+void sleep_manager_unlock_deep_sleep_internal(void)
+{
+    deep_sleep_locks--;
+}
+
+void core_util_critical_section_enter(void)
+{
+}
+
+void core_util_critical_section_exit(void)
+{
+}
+
+void mbed_assert_internal(const char *expr, const char *file, int line)
+{
+    printf("assertion failed: %s, %s:%d\n", expr, file, line);
+    exit(1);
+}
+
+static void start(void)
+{
+    memset(&source, 0, sizeof(source));
+    source.state = 2463534242UL;
+    expected_head = expected_tail = 0;
+    trng_pool_init();
+}
+
+static void test_fill(void)
+{
+    int words;
+    int i;
+
+    start();
+    CHECK(source.inits == 1);
+    CHECK(source.handler != NULL);
+    CHECK(source.enabled);
+    CHECK(deep_sleep_locks == 1);
+    CHECK(trng_pool_available() == 0);
+
+    // Nothing is served before the start up bytes are tested
+    take(4, -1);
+
+    words = source_run(100000);
+    CHECK(words == TRNG_POOL_STARTUP_BYTES / 4 + TRNG_POOL_SIZE / 4);
+    CHECK(!source.enabled);
+    CHECK(deep_sleep_locks == 0);
+    CHECK(trng_pool_available() == TRNG_POOL_SIZE);
+
+    // Requests are served at once and the pool filled again in the background
+    take(16, 0);
+    CHECK(source.enabled);
+    CHECK(deep_sleep_locks == 1);
+    for (i = 0; i < 16; i++) {
+        CHECK(pool[i] == 0);
+    }
+    take(5, 0);
+    words = source_run(100000);
+    CHECK(words == 6);
+    CHECK(trng_pool_available() == TRNG_POOL_SIZE);
+
+    // A request larger than the pool is served partially
+    take(TRNG_POOL_SIZE + 10, -1);
+    CHECK(pool_stats.short_requests == 2);
+    source_run(100000);
+
+    // Taking nothing does not start the TRNG
+    take(0, 0);
+    CHECK(!source.enabled);
+
+    trng_pool_free();
+    CHECK(source.frees == 1);
+    CHECK(!source.enabled);
+    CHECK(deep_sleep_locks == 0);
+    CHECK(trng_pool_available() == 0);
+}
+
+static void test_repetition(void)
+{
+    start();
+    source_run(100000);
+
+    // Eight identical bytes in a row pass
+    take(TRNG_POOL_SIZE, 0);
+    source_deliver(0x01020304, 0);
+    source_deliver(0x77777777, 0);
+    source_deliver(0x77777777, 0);
+    source_deliver(0x05060708, 0);
+    CHECK(pool_stats.rct_failures == 0);
+    CHECK(trng_pool_available() == 16);
+
+    // Nine fail
+    source_deliver(0x77777777, 0);
+    source_deliver(0x77777777, 0);
+    CHECK(trng_pool_available() == 24);
+    source_deliver(0x01020377, 0);
+    CHECK(pool_stats.rct_failures == 1);
+    CHECK(trng_pool_available() == 0);
+
+    // A stuck source keeps failing, and the pool stays empty
+    source.mode = SOURCE_STUCK;
+    source_run(1000);
+    CHECK(pool_stats.rct_failures > 100);
+    CHECK(trng_pool_available() == 0);
+    take(1, -1);
+
+    // The pool is filled again once the source recovers
+    source.mode = SOURCE_GOOD;
+    source_run(100000);
+    CHECK(trng_pool_available() == TRNG_POOL_SIZE);
+    take(TRNG_POOL_SIZE, 0);
+    trng_pool_free();
+}
+
+static void test_proportion(void)
+{
+    int i;
+
+    start();
+    source_run(100000);
+
+    // A source giving one byte value a quarter of the time fails the windows starting with it
+    source.mode = SOURCE_BIASED;
+    for (i = 0; i < 10000; i++) {
+        take(trng_pool_available(), 0);
+        source_run(4);
+    }
+    CHECK(pool_stats.apt_failures > 10);
+    CHECK(pool_stats.rct_failures == 0);
+
+    source.mode = SOURCE_GOOD;
+    source_run(100000);
+    take(TRNG_POOL_SIZE, 0);
+    trng_pool_free();
+}
+
+static void test_errors(void)
+{
+    start();
+    source_run(100000);
+    take(8, 0);
+
+    // An error of the TRNG empties the pool
+    source_deliver(0, -1);
+    CHECK(pool_stats.source_errors == 1);
+    CHECK(trng_pool_available() == 0);
+    CHECK(source.enabled);
+    source_run(100000);
+    take(TRNG_POOL_SIZE, 0);
+
+    // Errors during the start up restart it
+    source_run(10);
+    source_deliver(0, -1);
+    source_run(100);
+    source_deliver(0, -1);
+    CHECK(pool_stats.source_errors == 3);
+    CHECK(source_run(100000) == TRNG_POOL_STARTUP_BYTES / 4 + TRNG_POOL_SIZE / 4);
+    take(TRNG_POOL_SIZE, 0);
+    trng_pool_free();
+}
+
+static void test_long_run(void)
+{
+    uint32_t taken = 0;
+    int i;
+
+    // A good source never fails over 4 MB, served in small requests
+    start();
+    for (i = 0; i < 200000; i++) {
+        source_run(100000);
+        take(4 + (i % 17), 0);
+        taken += 4 + (i % 17);
+    }
+    CHECK(detected() == 0);
+    CHECK(pool_stats.bytes == taken);
+
+    printf("%u bytes served in %u requests from %u words, %u TRNG starts\n",
+           pool_stats.bytes, pool_stats.requests, pool_stats.words, source.starts);
+    trng_pool_free();
+}
+
+int main(void)
+{
+    test_fill();
+    test_repetition();
+    test_proportion();
+    test_errors();
+    test_long_run();
+    CHECK(deep_sleep_locks == 0);
+
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All tests passed\n");
+    return 0;
+}
@@ -0,0 +1,157 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Benchmark of Thread::wait_us against the wait_us busy wait and the tick
+ * based Thread::wait.
+ *
+ * For each delay it reports how long the calls actually take, how much CPU
+ * time a background thread gets meanwhile, the share of the time spent in
+ * the idle thread, where the core sleeps, and an estimate of the average
+ * current drawn.
+ */
+
+#include "mbed.h"
+#include "platform/mbed_stats.h"
+
+#if !defined(MBED_THREAD_STATS_ENABLED)
+#error "Define MBED_THREAD_STATS_ENABLED in mbed_app.json"
+#endif
+
+/* Current drawn by the core in run and sleep mode, in microamps (STM32L443 at 80 MHz) */
+#define I_RUN_UA        8000
+#define I_SLEEP_UA      2800
+
+#define RUNS            100
+
+#define MAX_THREADS     8
+
+static const uint32_t delays_us[] = { 20, 50, 100, 250, 500, 1000, 2500, 6500, 15000 };
+
+typedef enum {
+    METHOD_BUSY,            // wait_us()
+    METHOD_THREAD_US,       // Thread::wait_us()
+    METHOD_THREAD_MS,       // Thread::wait(), rounded up to the next millisecond
+    METHODS
+} method_t;
+
+static const char *method_names[METHODS] = { "wait_us", "Thread::wait_us", "Thread::wait" };
+
+static volatile uint32_t background_loops;
+static volatile bool background_run;
+
+// Lower priority thread standing for the rest of the application
+static void background_thread()
+{
+    while (true) {
+        while (background_run) {
+            background_loops++;
+        }
+        Thread::wait(1);
+    }
+}
+
+// Time spent in the idle thread, which puts the core to sleep
+static uint64_t idle_time()
+{
+    mbed_stats_thread_t stats[MAX_THREADS];
+    size_t count = mbed_stats_thread_get_each(stats, MAX_THREADS);
+
+    for (size_t i = 0; i < count; i++) {
+        if ((stats[i].name != NULL) && (strcmp(stats[i].name, "idle_thread") == 0)) {
+            return stats[i].cpu_time;
+        }
+    }
+    return 0;
+}
+
+static void delay(method_t method, uint32_t us)
+{
+    switch (method) {
+        case METHOD_BUSY:
+            wait_us(us);
+            break;
+        case METHOD_THREAD_US:
+            Thread::wait_us(us);
+            break;
+        default:
+            Thread::wait((us + 999) / 1000);
+            break;
+    }
+}
+
+static void bench(method_t method, uint32_t us, bool background)
+{
+    uint32_t min = 0xFFFFFFFF;
+    uint32_t max = 0;
+    uint64_t total = 0;
+
+    background_loops = 0;
+    background_run = background;
+    Thread::wait(2);
+
+    uint64_t start_idle = idle_time();
+    uint32_t start = us_ticker_read();
+    for (int i = 0; i < RUNS; i++) {
+        uint32_t before = us_ticker_read();
+        delay(method, us);
+        uint32_t elapsed = us_ticker_read() - before;
+
+        total += elapsed;
+        if (elapsed < min) {
+            min = elapsed;
+        }
+        if (elapsed > max) {
+            max = elapsed;
+        }
+    }
+    uint32_t span = us_ticker_read() - start;
+    uint64_t idle = idle_time() - start_idle;
+    background_run = false;
+
+    if (idle > span) {
+        idle = span;
+    }
+    uint32_t idle_pct = (uint32_t)(idle * 100 / span);
+    uint32_t current = I_RUN_UA - (uint32_t)((I_RUN_UA - I_SLEEP_UA) * idle / span);
+
+    printf("%6lu %-16s %8lu %6lu %6lu %10lu %6lu%% %8lu\r\n", (unsigned long)us, method_names[method],
+           (unsigned long)(total / RUNS), (unsigned long)min, (unsigned long)max,
+           (unsigned long)background_loops, (unsigned long)idle_pct, (unsigned long)current);
+}
+
+int main()
+{
+    Thread background(osPriorityLow);
+
+    background.start(background_thread);
+
+    printf("Thread::wait_us benchmark, %d runs per delay\r\n", RUNS);
+    for (int background_on = 0; background_on < 2; background_on++) {
+        printf("\r\n%s background thread\r\n", background_on ? "With a" : "Without a");
+        printf("%6s %-16s %8s %6s %6s %10s %7s %8s\r\n",
+               "delay", "method", "mean", "min", "max", "bg loops", "idle", "est. uA");
+        for (size_t i = 0; i < sizeof(delays_us) / sizeof(delays_us[0]); i++) {
+            for (int m = 0; m < METHODS; m++) {
+                bench((method_t)m, delays_us[i], background_on);
+            }
+        }
+    }
+
+    printf("\r\nDone\r\n");
+    while (true) {
+        Thread::wait(1000);
+    }
+}
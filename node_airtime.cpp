@@ -0,0 +1,312 @@
+/**
+ * @file node_airtime.cpp
+ *
+ * @brief LoRa time on air and duty cycle budget
+ *
+ * @author AdvanWISE
+*/
+
+#include <stddef.h>
+#include "node_airtime.h"
+
+#define NODE_AIRTIME_FSK 0
+
+///< EU868 data rates, DR7 is FSK
+static const node_airtime_dr_t node_airtime_eu_drs[]={
+    {12, 125, 51}, {11, 125, 51}, {10, 125, 51}, {9, 125, 115},
+    {8, 125, 222}, {7, 125, 222}, {7, 250, 222}, {NODE_AIRTIME_FSK, 0, 222},
+};
+
+///< EU868 sub-bands of ETSI EN 300 220
+static const node_airtime_band_t node_airtime_eu_bands[]={
+    {868000000, 868600000, 100},    // g1, default channels, 1 %
+    {865000000, 868000000, 100},    // g, 1 %
+    {868700000, 869200000, 1000},   // g2, 0.1 %
+    {869400000, 869650000, 10},     // g3, 10 %
+    {869700000, 870000000, 100},    // g4, 1 %
+    {863000000, 865000000, 1000},   // 0.1 %
+};
+
+///< AS923 data rates with the uplink dwell time on: DR0 and DR1 are too long for 400 ms
+static const node_airtime_dr_t node_airtime_as923_drs[]={
+    {12, 125, 0}, {11, 125, 0}, {10, 125, 11}, {9, 125, 53},
+    {8, 125, 125}, {7, 125, 242}, {7, 250, 242}, {NODE_AIRTIME_FSK, 0, 242},
+};
+
+///< Japan: at most 360 s on air per hour with listen before talk, ARIB STD-T108
+static const node_airtime_band_t node_airtime_jp_bands[]={
+    {920600000, 928000000, 10},
+};
+
+static const node_airtime_band_t node_airtime_tw_bands[]={
+    {920000000, 925000000, 0},
+};
+
+///< US915 uplink data rates, Regional Parameters 1.0.2
+static const node_airtime_dr_t node_airtime_us_drs[]={
+    {10, 125, 11}, {9, 125, 53}, {8, 125, 125}, {7, 125, 242}, {8, 500, 242},
+};
+
+static const node_airtime_band_t node_airtime_us_bands[]={
+    {902000000, 928000000, 0},
+};
+
+///< AU915 uplink data rates, Regional Parameters 1.0.2rB, without the uplink dwell time
+static const node_airtime_dr_t node_airtime_au_drs[]={
+    {12, 125, 51}, {11, 125, 51}, {10, 125, 51}, {9, 125, 115},
+    {8, 125, 242}, {7, 125, 242}, {8, 500, 242},
+};
+
+static const node_airtime_band_t node_airtime_au_bands[]={
+    {915000000, 928000000, 0},
+};
+
+static const node_airtime_dr_t node_airtime_cn470_drs[]={
+    {12, 125, 51}, {11, 125, 51}, {10, 125, 51}, {9, 125, 115}, {8, 125, 222}, {7, 125, 222},
+};
+
+static const node_airtime_band_t node_airtime_cn470_bands[]={
+    {470000000, 510000000, 0},
+};
+
+#define NODE_AIRTIME_COUNT(a) ((unsigned char)(sizeof(a)/sizeof((a)[0])))
+
+static const node_airtime_region_t node_airtime_regions[]={
+    {"AU915", node_airtime_au_drs, NODE_AIRTIME_COUNT(node_airtime_au_drs),
+        node_airtime_au_bands, NODE_AIRTIME_COUNT(node_airtime_au_bands), 0},
+    {"CN470", node_airtime_cn470_drs, NODE_AIRTIME_COUNT(node_airtime_cn470_drs),
+        node_airtime_cn470_bands, NODE_AIRTIME_COUNT(node_airtime_cn470_bands), 0},
+    {"EU868", node_airtime_eu_drs, NODE_AIRTIME_COUNT(node_airtime_eu_drs),
+        node_airtime_eu_bands, NODE_AIRTIME_COUNT(node_airtime_eu_bands), 0},
+    {"AS923 JP", node_airtime_as923_drs, NODE_AIRTIME_COUNT(node_airtime_as923_drs),
+        node_airtime_jp_bands, NODE_AIRTIME_COUNT(node_airtime_jp_bands), 400},
+    {"AS923 TW", node_airtime_as923_drs, NODE_AIRTIME_COUNT(node_airtime_as923_drs),
+        node_airtime_tw_bands, NODE_AIRTIME_COUNT(node_airtime_tw_bands), 400},
+    {"US915", node_airtime_us_drs, NODE_AIRTIME_COUNT(node_airtime_us_drs),
+        node_airtime_us_bands, NODE_AIRTIME_COUNT(node_airtime_us_bands), 400},
+};
+
+static const node_airtime_region_t *node_airtime_region;
+
+/** @brief Budget of a sub-band
+ *
+ *  The credit is in us of elapsed time: a frame costs its time on air times
+ *  the inverse of the duty cycle. It goes negative if a frame is sent early.
+ */
+static struct
+{
+    long long credit;
+    unsigned int last_ms;
+} node_airtime_budget[NODE_AIRTIME_MAX_BANDS];
+
+unsigned int node_airtime_lora_us(const node_airtime_lora_t *lora, unsigned int len)
+{
+    int sf=lora->sf;
+    int de=lora->low_dr_optimize?1:0;
+    int num=8*(int)len-4*sf+28+16*(lora->crc?1:0)-20*(lora->implicit_header?1:0);
+    int den=4*(sf-2*de);
+    unsigned long long quarters;
+    unsigned int symbols=8;
+
+    if(num>0)
+        symbols+=((num+den-1)/den)*(lora->cr+4);
+
+    // The preamble lasts 4.25 symbols more than programmed: count quarters of symbols, for whole us
+    quarters=4ULL*(lora->preamble+symbols)+17;
+    return (unsigned int)(((quarters<<sf)*1000000ULL)/(4ULL*lora->bw_hz));
+}
+
+unsigned int node_airtime_fsk_us(unsigned int len)
+{
+    // 5 bytes of preamble, 3 of sync word, a length byte and a 2-byte CRC, 20 us per bit
+    return (5+3+1+len+2)*8*20;
+}
+
+const node_airtime_region_t *node_airtime_get_region(int region)
+{
+    if(region<NODE_REGION_AU||region>NODE_REGION_US)
+        return NULL;
+    return &node_airtime_regions[region-NODE_REGION_AU];
+}
+
+void node_airtime_init(const node_airtime_region_t *region, unsigned int now)
+{
+    int i;
+
+    node_airtime_region=region;
+    for(i=0; i<NODE_AIRTIME_MAX_BANDS; i++)
+    {
+        node_airtime_budget[i].credit=NODE_AIRTIME_WINDOW_MS*1000LL;
+        node_airtime_budget[i].last_ms=now;
+    }
+}
+
+/** @brief Get a data rate of the region, NULL if it is not available
+ *
+ */
+static const node_airtime_dr_t *node_airtime_get_dr(int dr)
+{
+    if(node_airtime_region==NULL||dr<0||dr>=node_airtime_region->dr_count)
+        return NULL;
+    if(node_airtime_region->drs[dr].max_payload==0)
+        return NULL;
+    return &node_airtime_region->drs[dr];
+}
+
+/** @brief Time on air of a PHY payload at a data rate
+ *
+ */
+static unsigned int node_airtime_phy_us(const node_airtime_dr_t *rate, unsigned int len)
+{
+    node_airtime_lora_t lora;
+
+    if(rate->sf==NODE_AIRTIME_FSK)
+        return node_airtime_fsk_us(len);
+
+    // LoRaWAN: 8 preamble symbols, explicit header, CRC, 4/5, and the low data rate optimization past 16 ms symbols
+    lora.sf=rate->sf;
+    lora.bw_hz=rate->bw_khz*1000;
+    lora.cr=1;
+    lora.preamble=8;
+    lora.implicit_header=0;
+    lora.crc=1;
+    lora.low_dr_optimize=((1000U<<rate->sf)/rate->bw_khz>=16000)?1:0;
+    return node_airtime_lora_us(&lora, len);
+}
+
+unsigned int node_airtime_frame_us(int dr, unsigned int len)
+{
+    const node_airtime_dr_t *rate=node_airtime_get_dr(dr);
+
+    if(rate==NULL)
+        return 0;
+    return node_airtime_phy_us(rate, len+NODE_AIRTIME_LORAWAN_OVERHEAD);
+}
+
+int node_airtime_max_payload(int dr)
+{
+    const node_airtime_dr_t *rate=node_airtime_get_dr(dr);
+    int len;
+
+    if(rate==NULL)
+        return -1;
+
+    len=rate->max_payload;
+    if(node_airtime_region->dwell_ms!=0)
+    {
+        while(len>0&&node_airtime_frame_us(dr, len)>node_airtime_region->dwell_ms*1000U)
+            len--;
+    }
+    return len;
+}
+
+int node_airtime_safe_payload(void)
+{
+    int dr, len, safe=-1;
+
+    if(node_airtime_region==NULL)
+        return -1;
+
+    for(dr=0; dr<node_airtime_region->dr_count; dr++)
+    {
+        len=node_airtime_max_payload(dr);
+        if(len>=0&&(safe<0||len<safe))
+            safe=len;
+    }
+    return safe;
+}
+
+int node_airtime_pack(int dr, unsigned int len)
+{
+    int max=node_airtime_max_payload(dr);
+    unsigned int us;
+
+    if(max<0||len>(unsigned int)max)
+        return -1;
+
+    us=node_airtime_frame_us(dr, len);
+    while(len<(unsigned int)max&&node_airtime_frame_us(dr, len+1)==us)
+        len++;
+    return len;
+}
+
+int node_airtime_band(unsigned int freq_hz)
+{
+    int i;
+
+    if(node_airtime_region==NULL)
+        return -1;
+
+    for(i=0; i<node_airtime_region->band_count; i++)
+    {
+        if(freq_hz>=node_airtime_region->bands[i].freq_min_hz&&freq_hz<node_airtime_region->bands[i].freq_max_hz)
+            return i;
+    }
+    return -1;
+}
+
+/** @brief Credit a sub-band with the time elapsed since its last update
+ *
+ */
+static void node_airtime_update(int band, unsigned int now)
+{
+    long long cap=NODE_AIRTIME_WINDOW_MS*1000LL;
+
+    node_airtime_budget[band].credit+=(long long)(now-node_airtime_budget[band].last_ms)*1000;
+    if(node_airtime_budget[band].credit>cap)
+        node_airtime_budget[band].credit=cap;
+    node_airtime_budget[band].last_ms=now;
+}
+
+int node_airtime_until(int dr, int band, unsigned int len, unsigned int now)
+{
+    int max=node_airtime_max_payload(dr);
+    long long cost;
+    unsigned short duty;
+
+    if(max<0||len>(unsigned int)max||band<0||band>=node_airtime_region->band_count)
+        return -1;
+
+    duty=node_airtime_region->bands[band].duty_cycle;
+    if(duty==0)
+        return 0;
+
+    cost=(long long)node_airtime_frame_us(dr, len)*duty;
+    if(cost>NODE_AIRTIME_WINDOW_MS*1000LL)
+        return -1;
+
+    node_airtime_update(band, now);
+    if(node_airtime_budget[band].credit>=cost)
+        return 0;
+    return (int)((cost-node_airtime_budget[band].credit+999)/1000);
+}
+
+void node_airtime_commit(int dr, int band, unsigned int len, unsigned int now)
+{
+    unsigned short duty;
+
+    if(node_airtime_get_dr(dr)==NULL||band<0||band>=node_airtime_region->band_count)
+        return;
+
+    duty=node_airtime_region->bands[band].duty_cycle;
+    if(duty==0)
+        return;
+
+    node_airtime_update(band, now);
+    node_airtime_budget[band].credit-=(long long)node_airtime_frame_us(dr, len)*duty;
+}
+
+long long node_airtime_budget_us(int band, unsigned int now)
+{
+    unsigned short duty;
+
+    if(node_airtime_region==NULL||band<0||band>=node_airtime_region->band_count)
+        return -1;
+
+    duty=node_airtime_region->bands[band].duty_cycle;
+    if(duty==0)
+        return -1;
+
+    node_airtime_update(band, now);
+    return node_airtime_budget[band].credit/duty;
+}
@@ -0,0 +1,179 @@
+/**
+ * @file node_airtime.h
+ *
+ * @brief LoRa time on air and duty cycle budget
+ *
+ * The time on air of a frame follows the formula of the Semtech SX1272/76
+ * datasheets, computed in integer microseconds. The data rates, largest
+ * payloads, dwell time and duty cycle sub-bands of the region selected in
+ * make.sh come from the LoRaWAN Regional Parameters; AS923 is taken with the
+ * uplink dwell time on, as an end device starts.
+ *
+ * Each sub-band with a duty cycle has a budget of airtime, filled at the duty
+ * cycle rate up to its share of NODE_AIRTIME_WINDOW_MS, and spent by each
+ * frame sent. The scheduler asks for the earliest time a frame is legal
+ * before sending it, instead of learning it from a refused send.
+ *
+ * @author AdvanWISE
+*/
+
+#ifndef NODE_AIRTIME_H
+#define NODE_AIRTIME_H
+
+/** @brief Regions, numbered as in make.sh */
+#define NODE_REGION_AU              1       ///< AU915
+#define NODE_REGION_CN470           2       ///< CN470
+#define NODE_REGION_EU              3       ///< EU868
+#define NODE_REGION_JP              4       ///< AS923, Japan
+#define NODE_REGION_TW              5       ///< AS923, Taiwan
+#define NODE_REGION_US              6       ///< US915
+
+/* NODE_REGION is the region of the LoRa library linked, set by make.sh and by the IAR project */
+#ifndef NODE_REGION
+#error "NODE_REGION must be set to the region of the LoRa library, NODE_REGION_AU to NODE_REGION_US"
+#endif
+
+#ifndef NODE_AIRTIME_WINDOW_MS
+#define NODE_AIRTIME_WINDOW_MS      3600000 ///< Window over which a duty cycle is averaged
+#endif
+
+#define NODE_AIRTIME_LORAWAN_OVERHEAD 13    ///< MHDR, FHDR without options, FPort and MIC around the application payload
+#define NODE_AIRTIME_MAX_BANDS      6       ///< Largest number of duty cycle sub-bands of a region
+
+/** @brief LoRa modulation and packet settings */
+typedef struct
+{
+    unsigned char sf;               ///< Spreading factor, 6 to 12
+    unsigned int bw_hz;             ///< Bandwidth
+    unsigned char cr;               ///< Coding rate 4/(4+cr), 1 to 4
+    unsigned short preamble;        ///< Number of programmed preamble symbols
+    unsigned char implicit_header;  ///< 1 without the explicit header
+    unsigned char crc;              ///< 1 with the payload CRC
+    unsigned char low_dr_optimize;  ///< 1 with the low data rate optimization
+} node_airtime_lora_t;
+
+/** @brief Data rate of a region */
+typedef struct
+{
+    unsigned char sf;               ///< Spreading factor, 0 for FSK at 50 kbps
+    unsigned short bw_khz;          ///< Bandwidth
+    unsigned char max_payload;      ///< Largest application payload, 0 if the data rate is not available
+} node_airtime_dr_t;
+
+/** @brief Duty cycle sub-band of a region */
+typedef struct
+{
+    unsigned int freq_min_hz;       ///< Lowest frequency, included
+    unsigned int freq_max_hz;       ///< Highest frequency, excluded
+    unsigned short duty_cycle;      ///< Inverse of the duty cycle: 100 for 1 %, 0 for none
+} node_airtime_band_t;
+
+/** @brief Region */
+typedef struct
+{
+    const char *name;
+    const node_airtime_dr_t *drs;
+    unsigned char dr_count;
+    const node_airtime_band_t *bands;   ///< Sub-bands; the first one holds the default channels
+    unsigned char band_count;
+    unsigned short dwell_ms;        ///< Longest time on air of a frame, 0 for no limit
+} node_airtime_region_t;
+
+/** @brief Compute the time on air of a LoRa packet
+ *
+ *  @param lora modulation and packet settings
+ *  @param len PHY payload length
+ *  @returns time on air in us
+ */
+unsigned int node_airtime_lora_us(const node_airtime_lora_t *lora, unsigned int len);
+
+/** @brief Compute the time on air of a LoRaWAN FSK packet at 50 kbps
+ *
+ *  @param len PHY payload length
+ *  @returns time on air in us
+ */
+unsigned int node_airtime_fsk_us(unsigned int len);
+
+/** @brief Get a region
+ *
+ *  @param region NODE_REGION_AU to NODE_REGION_US
+ *  @returns region, or NULL if unknown
+ */
+const node_airtime_region_t *node_airtime_get_region(int region);
+
+/** @brief Select the region and fill the budgets of its sub-bands
+ *
+ *  @param region region
+ *  @param now current time in ms
+ */
+void node_airtime_init(const node_airtime_region_t *region, unsigned int now);
+
+/** @brief Compute the time on air of a LoRaWAN frame
+ *
+ *  @param dr data rate of the region
+ *  @param len application payload length
+ *  @returns time on air in us, 0 if the data rate is not available
+ */
+unsigned int node_airtime_frame_us(int dr, unsigned int len);
+
+/** @brief Get the largest application payload of a data rate
+ *
+ *  @param dr data rate of the region
+ *  @returns largest payload within the region limit and dwell time, -1 if the data rate is not available
+ */
+int node_airtime_max_payload(int dr);
+
+/** @brief Get the largest payload every data rate of the region carries
+ *
+ *  For the frames of a stack picking the data rate itself.
+ *
+ *  @returns smallest largest payload of the available data rates, -1 without a region
+ */
+int node_airtime_safe_payload(void);
+
+/** @brief Get the largest payload as long on air as another
+ *
+ *  A LoRa packet grows by whole blocks of symbols, so bytes up to the end of
+ *  the last block add no time on air.
+ *
+ *  @param dr data rate of the region
+ *  @param len application payload length
+ *  @returns largest payload length taking as long as len, up to the largest payload, or -1 if len does not fit
+ */
+int node_airtime_pack(int dr, unsigned int len);
+
+/** @brief Find the sub-band of a frequency
+ *
+ *  @param freq_hz channel frequency
+ *  @returns sub-band, or -1 outside the region
+ */
+int node_airtime_band(unsigned int freq_hz);
+
+/** @brief Get the time until a frame is legal
+ *
+ *  @param dr data rate of the region
+ *  @param band sub-band of the channel
+ *  @param len application payload length
+ *  @param now current time in ms
+ *  @returns 0 if the frame may be sent now, the time until it may in ms, or -1 if it never may
+ */
+int node_airtime_until(int dr, int band, unsigned int len, unsigned int now);
+
+/** @brief Spend the airtime of a frame sent
+ *
+ *  @param dr data rate of the region
+ *  @param band sub-band of the channel
+ *  @param len application payload length
+ *  @param now current time in ms
+ */
+void node_airtime_commit(int dr, int band, unsigned int len, unsigned int now);
+
+/** @brief Get the airtime budget left in a sub-band
+ *
+ *  @param band sub-band
+ *  @param now current time in ms
+ *  @returns airtime that may be sent at once in us, or -1 if the sub-band has no duty cycle
+ */
+long long node_airtime_budget_us(int band, unsigned int now);
+
+#endif /* NODE_AIRTIME_H */
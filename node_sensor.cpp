@@ -0,0 +1,123 @@
+/**
+ * @file node_sensor.cpp
+ *
+ * @brief Sensor sampling framework
+ *
+ * @author AdvanWISE
+*/
+
+#include <string.h>
+#include "node_sensor.h"
+
+static node_sensor_t *node_sensor_list;
+static events::EventQueue *node_sensor_queue;
+static mbed::I2CBus *node_sensor_bus;
+static node_sensor_stats_t node_sensor_stats;
+
+/** @brief Time from now to a tick, negative if it has passed
+ *
+ */
+static int node_sensor_until(unsigned int tick, unsigned int now)
+{
+    return (int)(tick - now);
+}
+
+/** @brief End of a sensor transaction
+ *
+ */
+static void node_sensor_read_done(node_sensor_t *sensor, int event)
+{
+    if(event!=I2C_EVENT_TRANSFER_COMPLETE)
+        node_sensor_stats.errors++;
+
+    sensor->read_cb(sensor, event);
+}
+
+static void node_sensor_wakeup(void);
+
+/** @brief Schedule the wake-up of the next sample
+ *
+ */
+static void node_sensor_schedule(unsigned int now)
+{
+    node_sensor_t *sensor;
+    int delay=-1;
+
+    // The earliest sample sets the wake-up; the ones due within their jitter after it join it
+    for(sensor=node_sensor_list; sensor!=NULL; sensor=sensor->next)
+    {
+        int until=node_sensor_until(sensor->due, now);
+
+        if(until<0)
+            until=0;
+        if(delay<0||until<delay)
+            delay=until;
+    }
+
+    if(delay>=0)
+        node_sensor_queue->call_in(delay, node_sensor_wakeup);
+}
+
+/** @brief Start the samples due now or within their jitter
+ *
+ */
+static void node_sensor_wakeup(void)
+{
+    unsigned int now=node_sensor_queue->tick();
+    node_sensor_t *sensor;
+
+    node_sensor_stats.wakeups++;
+
+    for(sensor=node_sensor_list; sensor!=NULL; sensor=sensor->next)
+    {
+        if(node_sensor_until(sensor->due, now)>(int)sensor->jitter_ms)
+            continue;
+
+        if(node_sensor_bus->submit(&sensor->transaction)==0)
+            node_sensor_stats.samples++;
+        else
+            node_sensor_stats.overruns++;
+
+        // Keep the phase of the period, unless the sample is late by a whole period
+        sensor->due+=sensor->period_ms;
+        if(node_sensor_until(sensor->due, now)<=0)
+            sensor->due=now+sensor->period_ms;
+    }
+
+    node_sensor_schedule(now);
+}
+
+void node_sensor_register(node_sensor_t *sensor)
+{
+    node_sensor_t **last=&node_sensor_list;
+
+    sensor->transaction=mbed::I2CTransaction(sensor->address, sensor->cmd, sensor->cmd_len,
+                                             sensor->data, sensor->data_len, sensor->latency_ms);
+    sensor->transaction.callback=mbed::callback(node_sensor_read_done, sensor);
+
+    // Samples due together are started in the order of registration
+    while(*last!=NULL)
+        last=&(*last)->next;
+    sensor->next=NULL;
+    *last=sensor;
+}
+
+void node_sensor_start(events::EventQueue *queue, mbed::I2CBus *bus)
+{
+    node_sensor_t *sensor;
+    unsigned int now=queue->tick();
+
+    node_sensor_queue=queue;
+    node_sensor_bus=bus;
+    memset(&node_sensor_stats, 0, sizeof(node_sensor_stats));
+
+    for(sensor=node_sensor_list; sensor!=NULL; sensor=sensor->next)
+        sensor->due=now;
+
+    node_sensor_queue->call(node_sensor_wakeup);
+}
+
+void node_sensor_get_stats(node_sensor_stats_t *stats)
+{
+    *stats=node_sensor_stats;
+}
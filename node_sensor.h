@@ -0,0 +1,94 @@
+/**
+ * @file node_sensor.h
+ *
+ * @brief Sensor sampling framework
+ *
+ * Sensors are sampled from one event queue instead of one thread each. Every
+ * sensor declares its sampling period, the latency of its conversion and a read
+ * callback; its command and read are run as one transaction on the shared I2C
+ * bus, which is released during the conversion. Samples due within the jitter
+ * of a sensor are moved into the same wake-up, so sensors of different periods
+ * share their wake-ups.
+ *
+ * @author AdvanWISE
+*/
+
+#ifndef NODE_SENSOR_H
+#define NODE_SENSOR_H
+
+#include "drivers/I2CBus.h"
+#include "events/EventQueue.h"
+
+#ifndef NODE_SENSOR_STACK_SIZE
+#define NODE_SENSOR_STACK_SIZE      2048    ///< Stack size of the thread dispatching the sensor queue and running the read callbacks
+#endif
+
+#ifndef NODE_SENSOR_QUEUE_EVENTS
+#define NODE_SENSOR_QUEUE_EVENTS    16      ///< Number of events the sensor queue can hold
+#endif
+
+typedef struct node_sensor node_sensor_t;
+
+/** @brief Sensor read callback, called from the sensor queue
+ *
+ *  @param sensor sensor read, its data buffer holds the data read
+ *  @param event I2C_EVENT_TRANSFER_COMPLETE, or the I2C_EVENT_ERROR* flags of a failed read
+ */
+typedef void (*node_sensor_read_cb_t)(node_sensor_t *sensor, int event);
+
+/** @brief Sensor declaration
+ *
+ *  Set the fields up to read_cb, then register the sensor. The sensor must stay
+ *  valid as long as the framework runs.
+ */
+struct node_sensor
+{
+    const char *name;               ///< Sensor name
+    unsigned int period_ms;         ///< Sampling period
+    unsigned int jitter_ms;         ///< Time a sample may be moved ahead to share a wake-up, 0 to keep the period exact
+    unsigned int latency_ms;        ///< Conversion time between the command and the read
+    int address;                    ///< 8-bit I2C address
+    const char *cmd;                ///< Command starting a conversion, or NULL
+    int cmd_len;                    ///< Length of the command
+    char *data;                     ///< Buffer for the data read
+    int data_len;                   ///< Number of bytes to read
+    node_sensor_read_cb_t read_cb;  ///< Called with the data read
+
+    /* Framework state */
+    mbed::I2CTransaction transaction;
+    unsigned int due;               ///< Time of the next sample, in queue ticks
+    node_sensor_t *next;
+};
+
+/** @brief Sampling statistics */
+typedef struct
+{
+    unsigned int wakeups;           ///< Number of wake-ups of the sampling timer
+    unsigned int samples;           ///< Number of samples started
+    unsigned int errors;            ///< Number of samples ended by an I2C error
+    unsigned int overruns;          ///< Number of samples skipped as the previous one was still running
+} node_sensor_stats_t;
+
+/** @brief Register a sensor, before node_sensor_start
+ *
+ *  @param sensor sensor declaration
+ */
+void node_sensor_register(node_sensor_t *sensor);
+
+/** @brief Start sampling the registered sensors
+ *
+ *  The first sample of each sensor is taken at once. The queue must be
+ *  dispatched by one thread, which also runs the read callbacks.
+ *
+ *  @param queue event queue scheduling the samples
+ *  @param bus I2C bus of the sensors, running on the same queue
+ */
+void node_sensor_start(events::EventQueue *queue, mbed::I2CBus *bus);
+
+/** @brief Get the sampling statistics
+ *
+ *  @param stats statistics since node_sensor_start
+ */
+void node_sensor_get_stats(node_sensor_stats_t *stats);
+
+#endif /* NODE_SENSOR_H */
@@ -0,0 +1,261 @@
+/**
+ * @file node_series.cpp
+ *
+ * @brief Packing of sensor series in uplink frames
+ *
+ * @author AdvanWISE
+*/
+
+#include <string.h>
+#include "node_series.h"
+
+#define NODE_SERIES_VARINT_MAX      5       ///< Largest varint of 32 bits
+#define NODE_SERIES_FRAME_MAX       (NODE_SERIES_HEADER_SIZE+255)   ///< The length byte counts up to 255
+
+static unsigned char node_series_types[NODE_SERIES_MAX_CHANNELS];
+static int node_series_channels;
+static unsigned int node_series_period_s;
+static int node_series_samples;
+static int node_series_max_len;
+
+static int node_series_values[NODE_SERIES_MAX_SAMPLES][NODE_SERIES_MAX_CHANNELS];
+static int node_series_held;                ///< Number of readings of the open series
+static unsigned int node_series_time_s;     ///< Time of its first reading
+static int node_series_len;                 ///< Length of its frame
+
+/** @brief Map a signed value to an unsigned one, small for values close to 0
+ *
+ */
+static unsigned int node_series_zigzag(int value)
+{
+    return ((unsigned int)value<<1)^(unsigned int)(value>>31);
+}
+
+static int node_series_unzigzag(unsigned int value)
+{
+    return (int)(value>>1)^-(int)(value&1);
+}
+
+/** @brief Number of bytes of a varint
+ *
+ */
+static int node_series_varint_len(unsigned int value)
+{
+    int len=1;
+
+    while(value>=0x80)
+    {
+        value>>=7;
+        len++;
+    }
+    return len;
+}
+
+/** @brief Write a varint, 7 bits per byte from the lowest, the top bit set on all bytes but the last
+ *
+ */
+static int node_series_put_varint(unsigned char *out, unsigned int value)
+{
+    int len=0;
+
+    while(value>=0x80)
+    {
+        out[len++]=(unsigned char)(value|0x80);
+        value>>=7;
+    }
+    out[len++]=(unsigned char)value;
+    return len;
+}
+
+/** @brief Read a varint
+ *
+ *  @returns number of bytes read, -1 if it is truncated or over 32 bits
+ */
+static int node_series_get_varint(const unsigned char *in, int len, unsigned int *value)
+{
+    int i;
+
+    *value=0;
+    for(i=0; i<len&&i<NODE_SERIES_VARINT_MAX; i++)
+    {
+        if(i==NODE_SERIES_VARINT_MAX-1&&in[i]>0x0f)
+            return -1;
+        *value|=(unsigned int)(in[i]&0x7f)<<(7*i);
+        if(!(in[i]&0x80))
+            return i+1;
+    }
+    return -1;
+}
+
+/** @brief Bytes of a series of one reading
+ *
+ */
+static int node_series_first_cost(const int *values)
+{
+    int i, cost=NODE_SERIES_HEADER_SIZE+4+node_series_varint_len(node_series_period_s)+1;
+
+    // Each channel starts with its type and its value
+    for(i=0; i<node_series_channels; i++)
+        cost+=1+node_series_varint_len(node_series_zigzag(values[i]));
+    return cost;
+}
+
+/** @brief Bytes a reading adds to the open series
+ *
+ */
+static int node_series_cost(const int *values)
+{
+    int i, cost=0;
+
+    if(node_series_held==0)
+        return node_series_first_cost(values);
+
+    // The difference is taken modulo 2^32, as the decoder adds it back
+    for(i=0; i<node_series_channels; i++)
+    {
+        unsigned int delta=(unsigned int)values[i]-(unsigned int)node_series_values[node_series_held-1][i];
+
+        cost+=node_series_varint_len(node_series_zigzag((int)delta));
+    }
+    return cost;
+}
+
+/** @brief Tell whether a reading is one period after the last one of the open series
+ *
+ */
+static int node_series_follows(unsigned int time_s)
+{
+    unsigned int expected=node_series_time_s+node_series_held*node_series_period_s;
+    int late=(int)(time_s-expected);
+
+    // Within half a period of the time it is expected
+    return late>=-(int)(node_series_period_s/2)&&late<(int)(node_series_period_s-node_series_period_s/2);
+}
+
+int node_series_init(const unsigned char *types, int channels, unsigned int period_s, int samples, int max_len)
+{
+    if(channels<1||channels>NODE_SERIES_MAX_CHANNELS||period_s==0||samples<2||samples>NODE_SERIES_MAX_SAMPLES)
+        return -1;
+
+    memcpy(node_series_types, types, channels);
+    node_series_channels=channels;
+    node_series_period_s=period_s;
+    node_series_samples=samples;
+    node_series_max_len=(max_len<NODE_SERIES_FRAME_MAX)?max_len:NODE_SERIES_FRAME_MAX;
+    node_series_held=0;
+    node_series_len=0;
+    return 0;
+}
+
+int node_series_flush(char *frame)
+{
+    unsigned char *out=(unsigned char *)frame;
+    int i, j, len;
+
+    if(node_series_held==0)
+        return 0;
+
+    len=NODE_SERIES_HEADER_SIZE;
+    out[len++]=(unsigned char)(node_series_time_s>>24);
+    out[len++]=(unsigned char)(node_series_time_s>>16);
+    out[len++]=(unsigned char)(node_series_time_s>>8);
+    out[len++]=(unsigned char)node_series_time_s;
+    len+=node_series_put_varint(&out[len], node_series_period_s);
+    out[len++]=(unsigned char)node_series_held;
+
+    for(i=0; i<node_series_channels; i++)
+    {
+        out[len++]=node_series_types[i];
+        len+=node_series_put_varint(&out[len], node_series_zigzag(node_series_values[0][i]));
+        for(j=1; j<node_series_held; j++)
+        {
+            unsigned int delta=(unsigned int)node_series_values[j][i]-(unsigned int)node_series_values[j-1][i];
+
+            len+=node_series_put_varint(&out[len], node_series_zigzag((int)delta));
+        }
+    }
+
+    out[0]=(unsigned char)(len-NODE_SERIES_HEADER_SIZE);
+    out[1]=NODE_SERIES_TYPE;
+    node_series_held=0;
+    node_series_len=0;
+    return len;
+}
+
+int node_series_add(unsigned int time_s, const int *values, char *frame)
+{
+    int len=0;
+
+    if(node_series_first_cost(values)>node_series_max_len)
+        return -1;
+
+    // A reading that does not continue the open series, or does not fit in it, starts the next one
+    if(node_series_held>0&&(!node_series_follows(time_s)||node_series_len+node_series_cost(values)>node_series_max_len))
+        len=node_series_flush(frame);
+
+    if(node_series_held==0)
+        node_series_time_s=time_s;
+
+    node_series_len+=node_series_cost(values);
+    memcpy(node_series_values[node_series_held], values, node_series_channels*sizeof(int));
+    node_series_held++;
+
+    // With 2 readings or more per series, a reading closes at most one frame
+    if(node_series_held>=node_series_samples)
+        len=node_series_flush(frame);
+    return len;
+}
+
+int node_series_count(void)
+{
+    return node_series_held;
+}
+
+int node_series_decode(const char *frame, int len, node_series_t *series)
+{
+    const unsigned char *in=(const unsigned char *)frame;
+    unsigned int value;
+    int pos, n, i;
+
+    if(len<NODE_SERIES_HEADER_SIZE+4+1+1||in[0]!=len-NODE_SERIES_HEADER_SIZE||in[1]!=NODE_SERIES_TYPE)
+        return -1;
+
+    pos=NODE_SERIES_HEADER_SIZE;
+    series->time_s=((unsigned int)in[pos]<<24)|((unsigned int)in[pos+1]<<16)|((unsigned int)in[pos+2]<<8)|in[pos+3];
+    pos+=4;
+
+    n=node_series_get_varint(&in[pos], len-pos, &series->period_s);
+    if(n<0||pos+n>=len)
+        return -1;
+    pos+=n;
+
+    series->samples=in[pos++];
+    if(series->samples<1||series->samples>NODE_SERIES_MAX_SAMPLES)
+        return -1;
+
+    series->channels=0;
+    while(pos<len)
+    {
+        int channel=series->channels;
+
+        if(channel>=NODE_SERIES_MAX_CHANNELS)
+            return -1;
+        series->types[channel]=in[pos++];
+
+        for(i=0; i<series->samples; i++)
+        {
+            n=node_series_get_varint(&in[pos], len-pos, &value);
+            if(n<0)
+                return -1;
+            pos+=n;
+
+            if(i==0)
+                series->values[channel][i]=node_series_unzigzag(value);
+            else
+                series->values[channel][i]=(int)((unsigned int)series->values[channel][i-1]+(unsigned int)node_series_unzigzag(value));
+        }
+        series->channels++;
+    }
+
+    return (series->channels>0)?0:-1;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file node_series.h
+ *
+ * @brief Packing of sensor series in uplink frames
+ *
+ * The readings of the sensors are gathered into series, sent as one frame
+ * instead of a frame per reading. A series frame keeps the header of the
+ * sensor TLV frame and carries the time of its first reading, the sampling
+ * period and, for each channel, its TLV type, its first value and the
+ * differences between the next ones, as zig-zag varints:
+ *
+ *     length  0x0d  time (4 bytes)  period  count  { type  value  delta ... } ...
+ *
+ * The length counts the bytes after the 2-byte header, the time is in s, big
+ * endian, and the period in s. A reading of a slowly changing sensor then
+ * takes a byte per channel. A series closes when it holds its number of
+ * readings, when the next reading would not fit in the largest payload, or
+ * when the next reading is not one period after the last one.
+ *
+ * @author AdvanWISE
+*/
+
+#ifndef NODE_SERIES_H
+#define NODE_SERIES_H
+
+#define NODE_SERIES_TYPE            0x0d    ///< Frame type of a series, after 0x0c of a single reading
+#define NODE_SERIES_HEADER_SIZE     2       ///< Length and frame type
+
+#ifndef NODE_SERIES_MAX_CHANNELS
+#define NODE_SERIES_MAX_CHANNELS    5       ///< Largest number of channels of a series
+#endif
+
+#ifndef NODE_SERIES_MAX_SAMPLES
+#define NODE_SERIES_MAX_SAMPLES     32      ///< Largest number of readings of a series
+#endif
+
+/** @brief Series decoded from a frame */
+typedef struct
+{
+    unsigned int time_s;                ///< Time of the first reading
+    unsigned int period_s;              ///< Time between two readings
+    int samples;                        ///< Number of readings
+    int channels;                       ///< Number of channels
+    unsigned char types[NODE_SERIES_MAX_CHANNELS];  ///< TLV type of each channel
+    int values[NODE_SERIES_MAX_CHANNELS][NODE_SERIES_MAX_SAMPLES];  ///< Readings of each channel
+} node_series_t;
+
+/** @brief Set the channels and the size of the series, dropping the readings held
+ *
+ *  @param types TLV type of each channel
+ *  @param channels number of channels, up to NODE_SERIES_MAX_CHANNELS
+ *  @param period_s sampling period
+ *  @param samples readings per series, 2 to NODE_SERIES_MAX_SAMPLES
+ *  @param max_len largest frame length
+ *  @returns 0 on success, -1 on an invalid setting
+ */
+int node_series_init(const unsigned char *types, int channels, unsigned int period_s, int samples, int max_len);
+
+/** @brief Add a reading of every channel
+ *
+ *  @param time_s time of the reading
+ *  @param values value of each channel
+ *  @param frame buffer of the largest frame length, filled with a series closed by the reading
+ *  @returns length of the frame closed, 0 if none, or -1 if the reading does not fit in a frame alone
+ */
+int node_series_add(unsigned int time_s, const int *values, char *frame);
+
+/** @brief Close the series held
+ *
+ *  @param frame buffer of the largest frame length, filled with the series
+ *  @returns length of the frame, 0 if no reading is held
+ */
+int node_series_flush(char *frame);
+
+/** @brief Get the number of readings held
+ *
+ *  @returns number of readings of the open series
+ */
+int node_series_count(void);
+
+/** @brief Decode a series frame
+ *
+ *  @param frame series frame
+ *  @param len frame length
+ *  @param series filled with the series
+ *  @returns 0 on success, -1 if the frame is not a valid series
+ */
+int node_series_decode(const char *frame, int len, node_series_t *series);
+
+#endif /* NODE_SERIES_H */
@@ -0,0 +1,435 @@
+/**
+ * @file node_uplink.cpp
+ *
+ * @brief Uplink queue
+ *
+ * @author AdvanWISE
+*/
+
+#include <string.h>
+#include "mbed.h"
+#include "node_api.h"
+#include "node_uplink.h"
+
+static node_uplink_frame_t node_uplink_queue[NODE_UPLINK_QUEUE_SIZE];
+static unsigned char node_uplink_used[NODE_UPLINK_QUEUE_SIZE];
+static int node_uplink_flight=-1;                   ///< Slot of the frame in flight, or -1
+static unsigned int node_uplink_flight_ms;          ///< Time the frame in flight was sent
+static unsigned int node_uplink_tx_seq;             ///< Number of the last send taken by the LoRa stack
+static unsigned int node_uplink_done_seq;           ///< Number of the last send whose TX done came or was given up
+static unsigned int node_uplink_owed_ms;            ///< Time the last frame in flight expired
+static unsigned int node_uplink_seq;
+static unsigned int node_uplink_rand;
+static const node_uplink_spill_t *node_uplink_spill;
+static node_uplink_stats_t node_uplink_stats;
+
+/** @brief Time from now to a tick, negative if it has passed
+ *
+ */
+static int node_uplink_until(unsigned int tick, unsigned int now)
+{
+    return (int)(tick - now);
+}
+
+/** @brief Next number of the backoff randomness, a xorshift generator
+ *
+ */
+static unsigned int node_uplink_random(void)
+{
+    unsigned int x=node_uplink_rand;
+
+    x^=x<<13;
+    x^=x>>17;
+    x^=x<<5;
+    node_uplink_rand=x;
+    return x;
+}
+
+/** @brief Find a free slot
+ *
+ */
+static int node_uplink_free_slot(void)
+{
+    int i;
+
+    for(i=0; i<NODE_UPLINK_QUEUE_SIZE; i++)
+    {
+        if(!node_uplink_used[i])
+            return i;
+    }
+    return -1;
+}
+
+/** @brief Tell whether the frame of slot a goes before the one of slot b
+ *
+ */
+static int node_uplink_before(int a, int b)
+{
+    const node_uplink_frame_t *fa=&node_uplink_queue[a];
+    const node_uplink_frame_t *fb=&node_uplink_queue[b];
+
+    if(fa->flags!=fb->flags)
+        return fa->flags>fb->flags;
+    return (int)(fa->seq - fb->seq)<0;
+}
+
+/** @brief Find the frame to evict from a full queue: the oldest of the lowest priority
+ *
+ */
+static int node_uplink_victim(void)
+{
+    int i, victim=-1;
+
+    for(i=0; i<NODE_UPLINK_QUEUE_SIZE; i++)
+    {
+        if(!node_uplink_used[i]||i==node_uplink_flight)
+            continue;
+        if(victim<0||node_uplink_queue[i].flags<node_uplink_queue[victim].flags
+            ||(node_uplink_queue[i].flags==node_uplink_queue[victim].flags&&!node_uplink_before(victim, i)))
+            victim=i;
+    }
+    return victim;
+}
+
+/** @brief Hand a frame out of the queue to the spill store, or drop it
+ *
+ */
+static int node_uplink_evict(const node_uplink_frame_t *frame)
+{
+    if(node_uplink_spill!=NULL&&node_uplink_spill->store(frame)==0)
+    {
+        node_uplink_stats.spilled++;
+        return 0;
+    }
+    node_uplink_stats.dropped++;
+    return -1;
+}
+
+/** @brief Take frames back from the spill store into the free slots
+ *
+ */
+static void node_uplink_unspill(void)
+{
+    int slot;
+
+    if(node_uplink_spill==NULL)
+        return;
+
+    while((slot=node_uplink_free_slot())>=0)
+    {
+        if(node_uplink_spill->load(&node_uplink_queue[slot])!=0)
+            break;
+        node_uplink_used[slot]=1;
+    }
+}
+
+/** @brief Remove a frame from the queue
+ *
+ */
+static void node_uplink_remove(int slot)
+{
+    node_uplink_used[slot]=0;
+    node_uplink_unspill();
+}
+
+/** @brief Retry a failed frame later, or drop it after its last attempt
+ *
+ */
+static void node_uplink_backoff(int slot, unsigned int now)
+{
+    node_uplink_frame_t *frame=&node_uplink_queue[slot];
+    unsigned int delay=NODE_UPLINK_BACKOFF_MIN_MS;
+    int i;
+
+    if(frame->attempts>=NODE_UPLINK_MAX_ATTEMPTS)
+    {
+        node_uplink_stats.expired++;
+        node_uplink_remove(slot);
+        return;
+    }
+
+    for(i=1; i<frame->attempts&&delay<NODE_UPLINK_BACKOFF_MAX_MS; i++)
+        delay*=2;
+    if(delay>NODE_UPLINK_BACKOFF_MAX_MS)
+        delay=NODE_UPLINK_BACKOFF_MAX_MS;
+
+    // Half of the delay is random, so that nodes failing together do not retry together
+    delay=delay/2+node_uplink_random()%(delay/2+1);
+    frame->due_ms=now+delay;
+}
+
+/** @brief Get the time until the TX done of an expired frame is given up
+ *
+ *  The LoRa stack gives no frame to its TX done, only the order of the sends. While the TX done of an
+ *  expired frame may still come, no other frame is sent, so that it is not taken as the TX done of the
+ *  next one.
+ *
+ *  @returns 0 if no TX done is owed, the time left otherwise
+ */
+static int node_uplink_owed(unsigned int now)
+{
+    int t;
+
+    if(node_uplink_done_seq==node_uplink_tx_seq)
+        return 0;
+    t=node_uplink_until(node_uplink_owed_ms+NODE_UPLINK_TX_TIMEOUT_MS, now);
+    if(t>0)
+        return t;
+
+    // The TX done never came
+    node_uplink_done_seq=node_uplink_tx_seq;
+    return 0;
+}
+
+/** @brief Find the next frame to send: the first due by priority, then by arrival
+ *
+ */
+static int node_uplink_next(unsigned int now)
+{
+    int i, next=-1;
+
+    for(i=0; i<NODE_UPLINK_QUEUE_SIZE; i++)
+    {
+        if(!node_uplink_used[i]||i==node_uplink_flight)
+            continue;
+        if(node_uplink_until(node_uplink_queue[i].due_ms, now)>0)
+            continue;
+        if(next<0||node_uplink_before(i, next))
+            next=i;
+    }
+    return next;
+}
+
+void node_uplink_init(unsigned int seed)
+{
+    memset(node_uplink_used, 0, sizeof(node_uplink_used));
+    memset(&node_uplink_stats, 0, sizeof(node_uplink_stats));
+    node_uplink_flight=-1;
+    node_uplink_tx_seq=0;
+    node_uplink_done_seq=0;
+    node_uplink_seq=0;
+    // A xorshift generator never leaves 0
+    node_uplink_rand=(seed!=0)?seed:0x2545F491;
+}
+
+void node_uplink_set_spill(const node_uplink_spill_t *spill)
+{
+    node_uplink_spill=spill;
+    node_uplink_unspill();
+}
+
+int node_uplink_push(unsigned char port, const char *data, unsigned char len, unsigned char flags, unsigned char key, unsigned int now)
+{
+    node_uplink_frame_t frame;
+    int i, slot;
+
+    if(len>NODE_UPLINK_FRAME_SIZE)
+        return -1;
+
+    frame.time_ms=now;
+    frame.due_ms=now;
+    frame.seq=node_uplink_seq++;
+    frame.port=port;
+    frame.flags=flags;
+    frame.key=key;
+    frame.attempts=0;
+    frame.len=len;
+    memcpy(frame.data, data, len);
+
+    // The stale readings of the key give way to the new one, except the one in flight
+    if(key!=0)
+    {
+        for(i=0; i<NODE_UPLINK_QUEUE_SIZE; i++)
+        {
+            node_uplink_frame_t *queued=&node_uplink_queue[i];
+
+            if(!node_uplink_used[i]||i==node_uplink_flight||queued->key!=key||queued->port!=port)
+                continue;
+            if(node_uplink_until(queued->time_ms+NODE_UPLINK_STALE_MS, now)>0)
+                continue;
+            node_uplink_used[i]=0;
+            node_uplink_stats.coalesced++;
+        }
+    }
+
+    node_uplink_unspill();
+
+    slot=node_uplink_free_slot();
+    if(slot<0)
+    {
+        slot=node_uplink_victim();
+
+        // With a store, a new frame of the lowest priority follows the queued ones there, keeping their order
+        if(slot>=0&&node_uplink_queue[slot].flags==flags&&node_uplink_spill!=NULL&&node_uplink_spill->store(&frame)==0)
+        {
+            node_uplink_stats.queued++;
+            node_uplink_stats.spilled++;
+            return 0;
+        }
+        if(slot<0||node_uplink_queue[slot].flags>flags)
+        {
+            node_uplink_stats.queued++;
+            return node_uplink_evict(&frame);
+        }
+        node_uplink_evict(&node_uplink_queue[slot]);
+    }
+
+    memcpy(&node_uplink_queue[slot], &frame, sizeof(frame));
+    node_uplink_used[slot]=1;
+    node_uplink_stats.queued++;
+    return 0;
+}
+
+int node_uplink_send(unsigned int now, const node_uplink_frame_t **sent)
+{
+    node_uplink_frame_t *frame;
+    unsigned short ret;
+    int slot;
+
+    if(sent!=NULL)
+        *sent=NULL;
+
+    node_uplink_expire(now);
+    if(node_uplink_flight>=0||node_uplink_owed(now)>0)
+        return NODE_UPLINK_IDLE;
+
+    slot=node_uplink_next(now);
+    if(slot<0)
+        return NODE_UPLINK_IDLE;
+
+    frame=&node_uplink_queue[slot];
+    frame->attempts++;
+
+    switch(frame->flags&(NODE_UPLINK_HIGH_PRI|NODE_UPLINK_CONFIRMED))
+    {
+        case NODE_UPLINK_HIGH_PRI:
+            ret=nodeApiSendDataHighPri(frame->port, frame->data, frame->len);
+            break;
+        case NODE_UPLINK_CONFIRMED:
+            ret=nodeApiSendDataConfirm(frame->port, frame->data, frame->len);
+            break;
+        case NODE_UPLINK_HIGH_PRI|NODE_UPLINK_CONFIRMED:
+            ret=nodeApiSendDataHighPriConfirm(frame->port, frame->data, frame->len);
+            break;
+        default:
+            ret=nodeApiSendData(frame->port, frame->data, frame->len);
+            break;
+    }
+
+    // A refused attempt counts toward NODE_UPLINK_MAX_ATTEMPTS too, so that a frame the stack never takes leaves
+    if(ret!=NODE_API_OK)
+    {
+        node_uplink_stats.refused++;
+        node_uplink_backoff(slot, now);
+        return NODE_UPLINK_REFUSED;
+    }
+
+    node_uplink_flight=slot;
+    node_uplink_flight_ms=now;
+    node_uplink_tx_seq++;
+    node_uplink_stats.sent++;
+    if(sent!=NULL)
+        *sent=frame;
+    return NODE_UPLINK_SENT;
+}
+
+const node_uplink_frame_t *node_uplink_peek(unsigned int now)
+{
+    int slot;
+
+    if(node_uplink_flight>=0||node_uplink_owed(now)>0)
+        return NULL;
+
+    slot=node_uplink_next(now);
+    return (slot>=0)?&node_uplink_queue[slot]:NULL;
+}
+
+void node_uplink_tx_done(unsigned char rc, unsigned int now)
+{
+    int slot=node_uplink_flight;
+
+    // The TX done come in the order of the sends; none is owed to a send already done or given up
+    if(node_uplink_done_seq==node_uplink_tx_seq)
+        return;
+    node_uplink_done_seq++;
+
+    // A late TX done of an expired frame is dropped, the frame has been taken as failed
+    if(slot<0)
+    {
+        node_uplink_stats.late++;
+        return;
+    }
+    node_uplink_flight=-1;
+
+    if(rc!=NODE_API_OK)
+    {
+        node_uplink_stats.failed++;
+        node_uplink_backoff(slot, now);
+        return;
+    }
+
+    unsigned int latency=now-node_uplink_queue[slot].time_ms;
+
+    node_uplink_stats.delivered++;
+    node_uplink_stats.latency_sum_ms+=latency;
+    if(latency>node_uplink_stats.latency_max_ms)
+        node_uplink_stats.latency_max_ms=latency;
+    node_uplink_remove(slot);
+}
+
+int node_uplink_expire(unsigned int now)
+{
+    int slot=node_uplink_flight;
+
+    if(slot<0||node_uplink_until(node_uplink_flight_ms+NODE_UPLINK_TX_TIMEOUT_MS, now)>0)
+        return 0;
+
+    // No TX done came: the frame is taken as lost, and its TX done is waited for until it is given up
+    node_uplink_flight=-1;
+    node_uplink_owed_ms=now;
+    node_uplink_stats.failed++;
+    node_uplink_backoff(slot, now);
+    return 1;
+}
+
+int node_uplink_until_due(unsigned int now)
+{
+    int i, owed, until=-1;
+
+    if(node_uplink_flight>=0)
+        return -1;
+    owed=node_uplink_owed(now);
+
+    for(i=0; i<NODE_UPLINK_QUEUE_SIZE; i++)
+    {
+        int t;
+
+        if(!node_uplink_used[i])
+            continue;
+        t=node_uplink_until(node_uplink_queue[i].due_ms, now);
+        if(t<owed)
+            t=owed;
+        if(until<0||t<until)
+            until=t;
+    }
+    return until;
+}
+
+int node_uplink_busy(void)
+{
+    return node_uplink_flight>=0;
+}
+
+int node_uplink_count(void)
+{
+    int i, count=0;
+
+    for(i=0; i<NODE_UPLINK_QUEUE_SIZE; i++)
+        count+=node_uplink_used[i];
+    return count;
+}
+
+void node_uplink_get_stats(node_uplink_stats_t *stats)
+{
+    *stats=node_uplink_stats;
+}
@@ -0,0 +1,191 @@
+/**
+ * @file node_uplink.h
+ *
+ * @brief Uplink queue
+ *
+ * Frames are queued instead of sent at once, so that a frame refused by the
+ * LoRa stack or lost on the air is retried instead of dropped, and readings
+ * taken while a frame is in flight wait for their turn. One frame is in flight
+ * at a time; the next one is sent when the TX done callback ends it. A failed
+ * frame is retried after an exponential backoff with a random part, up to
+ * NODE_UPLINK_MAX_ATTEMPTS times. A frame without TX done within
+ * NODE_UPLINK_TX_TIMEOUT_MS is taken as failed; as the TX done only gives a
+ * result, not the frame, the next frame waits for the late TX done, dropped,
+ * for up to NODE_UPLINK_TX_TIMEOUT_MS more.
+ *
+ * Frames are sent by priority, then in their order of arrival. A frame of a
+ * coalescing key replaces the queued readings of the same key older than
+ * NODE_UPLINK_STALE_MS, so a long outage leaves the latest readings instead of
+ * a backlog of stale ones. When the queue is full, the frames past it go to
+ * the optional spill store, and come back in order as the queue empties.
+ * Without a store, the oldest frame of the lowest priority is dropped to make
+ * room.
+ *
+ * The queue is not locked: call it from one thread only.
+ *
+ * @author AdvanWISE
+*/
+
+#ifndef NODE_UPLINK_H
+#define NODE_UPLINK_H
+
+#ifndef NODE_UPLINK_QUEUE_SIZE
+#define NODE_UPLINK_QUEUE_SIZE      8       ///< Number of frames the queue holds in RAM
+#endif
+
+#ifndef NODE_UPLINK_FRAME_SIZE
+#define NODE_UPLINK_FRAME_SIZE      64      ///< Largest frame payload
+#endif
+
+#ifndef NODE_UPLINK_MAX_ATTEMPTS
+#define NODE_UPLINK_MAX_ATTEMPTS    8       ///< Number of attempts before a frame is dropped
+#endif
+
+#ifndef NODE_UPLINK_BACKOFF_MIN_MS
+#define NODE_UPLINK_BACKOFF_MIN_MS  2000    ///< Backoff after the first failure, doubled at each next one
+#endif
+
+#ifndef NODE_UPLINK_BACKOFF_MAX_MS
+#define NODE_UPLINK_BACKOFF_MAX_MS  120000  ///< Longest backoff
+#endif
+
+#ifndef NODE_UPLINK_STALE_MS
+#define NODE_UPLINK_STALE_MS        60000   ///< Age after which a reading is replaced by a newer one of its key
+#endif
+
+#ifndef NODE_UPLINK_TX_TIMEOUT_MS
+#define NODE_UPLINK_TX_TIMEOUT_MS   60000   ///< Time after which a frame without TX done is taken as failed
+#endif
+
+/** @brief Frame flags, selecting the node API send function */
+#define NODE_UPLINK_HIGH_PRI        0x1     ///< Sent with nodeApiSendDataHighPri
+#define NODE_UPLINK_CONFIRMED       0x2     ///< Sent as a confirmed frame
+
+/** @brief Results of node_uplink_send */
+#define NODE_UPLINK_SENT            1       ///< A frame is in flight
+#define NODE_UPLINK_IDLE            0       ///< Nothing due, or a frame is already in flight
+#define NODE_UPLINK_REFUSED         (-1)    ///< The LoRa stack refused the frame, which backs off
+
+/** @brief Queued frame */
+typedef struct
+{
+    unsigned int time_ms;           ///< Time of the reading
+    unsigned int due_ms;            ///< Earliest time of the next attempt
+    unsigned int seq;               ///< Order of arrival
+    unsigned char port;             ///< LoRa port
+    unsigned char flags;            ///< NODE_UPLINK_HIGH_PRI and NODE_UPLINK_CONFIRMED; higher values are sent first
+    unsigned char key;              ///< Coalescing key, 0 for none
+    unsigned char attempts;         ///< Number of attempts so far
+    unsigned char len;              ///< Payload length
+    char data[NODE_UPLINK_FRAME_SIZE];
+} node_uplink_frame_t;
+
+/** @brief Store taking the frames evicted from a full queue, e.g. in flash
+ *
+ *  The queue takes the frames back, oldest first, as it empties.
+ */
+typedef struct
+{
+    int (*store)(const node_uplink_frame_t *frame);    ///< Keep a frame, 0 on success
+    int (*load)(node_uplink_frame_t *frame);           ///< Take back the oldest frame kept, 0 if there was one
+} node_uplink_spill_t;
+
+/** @brief Uplink statistics */
+typedef struct
+{
+    unsigned int queued;            ///< Number of frames queued
+    unsigned int coalesced;         ///< Number of stale readings replaced by a newer one
+    unsigned int sent;              ///< Number of attempts accepted by the LoRa stack
+    unsigned int refused;           ///< Number of attempts refused by the LoRa stack
+    unsigned int failed;            ///< Number of attempts ended by a failed TX done, or none
+    unsigned int late;              ///< Number of TX done dropped as coming after the timeout of their frame
+    unsigned int delivered;         ///< Number of frames ended by a successful TX done
+    unsigned int expired;           ///< Number of frames dropped after NODE_UPLINK_MAX_ATTEMPTS
+    unsigned int dropped;           ///< Number of frames dropped from a full queue
+    unsigned int spilled;           ///< Number of frames moved to the spill store
+    unsigned int latency_max_ms;    ///< Longest time from a reading to its delivery
+    unsigned long long latency_sum_ms; ///< Total time from the readings to their delivery
+} node_uplink_stats_t;
+
+/** @brief Empty the queue
+ *
+ *  @param seed seed of the backoff randomness, different on every node
+ */
+void node_uplink_init(unsigned int seed);
+
+/** @brief Set the store of the frames evicted from a full queue
+ *
+ *  @param spill store, or NULL to drop the evicted frames
+ */
+void node_uplink_set_spill(const node_uplink_spill_t *spill);
+
+/** @brief Queue a frame
+ *
+ *  @param port LoRa port
+ *  @param data payload
+ *  @param len payload length, up to NODE_UPLINK_FRAME_SIZE
+ *  @param flags NODE_UPLINK_HIGH_PRI and NODE_UPLINK_CONFIRMED
+ *  @param key coalescing key, 0 for none
+ *  @param now current time in ms
+ *  @returns 0 if the frame is queued, -1 if it is too long, or dropped as lower in priority than a full queue
+ */
+int node_uplink_push(unsigned char port, const char *data, unsigned char len, unsigned char flags, unsigned char key, unsigned int now);
+
+/** @brief Send the next due frame, unless one is in flight
+ *
+ *  @param now current time in ms
+ *  @param frame set to the frame sent, may be NULL
+ *  @returns NODE_UPLINK_SENT, NODE_UPLINK_IDLE or NODE_UPLINK_REFUSED
+ */
+int node_uplink_send(unsigned int now, const node_uplink_frame_t **frame);
+
+/** @brief Get the frame node_uplink_send would send
+ *
+ *  @param now current time in ms
+ *  @returns next due frame, or NULL if none is due or one is in flight
+ */
+const node_uplink_frame_t *node_uplink_peek(unsigned int now);
+
+/** @brief End the frame in flight, from the result of the TX done callback
+ *
+ *  A TX done coming after the frame expired, or without a frame sent, is dropped.
+ *
+ *  @param rc result of the TX done callback, NODE_API_OK on success
+ *  @param now current time in ms
+ */
+void node_uplink_tx_done(unsigned char rc, unsigned int now);
+
+/** @brief End the frame in flight if its TX done did not come within NODE_UPLINK_TX_TIMEOUT_MS
+ *
+ *  @param now current time in ms
+ *  @returns 1 if the frame in flight is taken as lost, 0 otherwise
+ */
+int node_uplink_expire(unsigned int now);
+
+/** @brief Get the time until a frame is due
+ *
+ *  @param now current time in ms
+ *  @returns 0 if a frame is due, the time until the next one in ms, or -1 if none is queued or one is in flight.
+ *  A frame waiting for the TX done of an expired one is not due.
+ */
+int node_uplink_until_due(unsigned int now);
+
+/** @brief Tell whether a frame is in flight
+ *
+ *  @returns 1 if a frame waits for its TX done, 0 otherwise
+ */
+int node_uplink_busy(void);
+
+/** @brief Get the number of queued frames, the one in flight included
+ *
+ *  @returns number of frames in RAM
+ */
+int node_uplink_count(void);
+
+/** @brief Get the uplink statistics
+ *
+ *  @param stats statistics since node_uplink_init
+ */
+void node_uplink_get_stats(node_uplink_stats_t *stats);
+
+#endif /* NODE_UPLINK_H */
@@ -0,0 +1,204 @@
+/**
+ * @file node_window.cpp
+ *
+ * @brief Summary of the sensor samples of a report window
+ *
+ * @author AdvanWISE
+*/
+
+#include <math.h>
+#include <string.h>
+#include "node_window.h"
+
+/** @brief Round a float to the nearest integer
+ *
+ */
+static int node_window_round(float value)
+{
+    return (int)floorf(value+0.5f);
+}
+
+/** @brief Sort the first samples, kept in the markers until there are 5
+ *
+ */
+static void node_window_sort(float *values, unsigned int count)
+{
+    unsigned int i, j;
+
+    for(i=1; i<count; i++)
+    {
+        float value=values[i];
+
+        for(j=i; j>0&&values[j-1]>value; j--)
+            values[j]=values[j-1];
+        values[j]=value;
+    }
+}
+
+/** @brief Move a P-square marker one position toward its desired one
+ *
+ */
+static void node_window_adjust(node_window_t *window, int i)
+{
+    float *q=window->heights;
+    int *n=window->positions;
+    float d=window->desired[i]-n[i];
+    int s;
+    float h;
+
+    if(!((d>=1.0f&&n[i+1]-n[i]>1)||(d<=-1.0f&&n[i-1]-n[i]<-1)))
+        return;
+    s=(d>0.0f)?1:-1;
+
+    // Parabolic prediction, linear if it leaves the neighbouring markers out of order
+    h=q[i]+(float)s/(n[i+1]-n[i-1])*((n[i]-n[i-1]+s)*(q[i+1]-q[i])/(n[i+1]-n[i])
+        +(n[i+1]-n[i]-s)*(q[i]-q[i-1])/(n[i]-n[i-1]));
+    if(!(q[i-1]<h&&h<q[i+1]))
+        h=q[i]+s*(q[i+s]-q[i])/(n[i+s]-n[i]);
+    q[i]=h;
+    n[i]+=s;
+}
+
+/** @brief Fold a sample into the P-square markers
+ *
+ */
+static void node_window_p2(node_window_t *window, float value)
+{
+    float *q=window->heights;
+    float p=window->quantile;
+    int i, k;
+
+    if(window->count<=5)
+    {
+        q[window->count-1]=value;
+        if(window->count==5)
+        {
+            node_window_sort(q, 5);
+            for(i=0; i<5; i++)
+                window->positions[i]=i;
+            window->desired[0]=0.0f;
+            window->desired[1]=2.0f*p;
+            window->desired[2]=4.0f*p;
+            window->desired[3]=2.0f+2.0f*p;
+            window->desired[4]=4.0f;
+        }
+        return;
+    }
+
+    // The cell of the sample, the extreme markers following the minimum and maximum
+    if(value<q[0])
+    {
+        q[0]=value;
+        k=0;
+    }
+    else if(value>=q[4])
+    {
+        q[4]=value;
+        k=3;
+    }
+    else
+    {
+        for(k=0; value>=q[k+1]; k++)
+            ;
+    }
+
+    for(i=k+1; i<5; i++)
+        window->positions[i]++;
+    window->desired[1]+=p/2.0f;
+    window->desired[2]+=p;
+    window->desired[3]+=(1.0f+p)/2.0f;
+    window->desired[4]+=1.0f;
+
+    for(i=1; i<4; i++)
+        node_window_adjust(window, i);
+}
+
+void node_window_init(node_window_t *window, int quantile)
+{
+    memset(window, 0, sizeof(*window));
+    if(quantile>0&&quantile<100)
+        window->quantile=quantile/100.0f;
+}
+
+void node_window_reset(node_window_t *window)
+{
+    node_window_init(window, node_window_round(window->quantile*100.0f));
+}
+
+void node_window_add(node_window_t *window, int value)
+{
+    float delta;
+
+    window->count++;
+    if(window->count==1)
+        window->first=value;
+    if(window->count==1||value<window->min)
+        window->min=value;
+    if(window->count==1||value>window->max)
+        window->max=value;
+
+    // Welford: the mean and the squared differences are updated without a sum of squares
+    delta=(value-window->first)-window->mean;
+    window->mean+=delta/window->count;
+    window->m2+=delta*((value-window->first)-window->mean);
+
+    if(window->quantile>0.0f)
+        node_window_p2(window, (float)value);
+}
+
+int node_window_summary(const node_window_t *window, node_window_summary_t *summary)
+{
+    if(window->count==0)
+        return -1;
+
+    summary->count=window->count;
+    summary->min=window->min;
+    summary->max=window->max;
+    summary->mean=window->first+node_window_round(window->mean);
+    summary->deviation=(window->m2>0.0f)?node_window_round(sqrtf(window->m2/window->count)):0;
+    summary->quantile=0;
+
+    if(window->quantile>0.0f)
+    {
+        if(window->count>=5)
+            summary->quantile=node_window_round(window->heights[2]);
+        else
+        {
+            // Nearest rank among the first samples
+            float first[5];
+            int rank=(int)ceilf(window->quantile*window->count)-1;
+
+            memcpy(first, window->heights, sizeof(first));
+            node_window_sort(first, window->count);
+            summary->quantile=node_window_round(first[(rank>0)?rank:0]);
+        }
+    }
+    return 0;
+}
+
+int node_window_tlv(unsigned char type, const node_window_t *window, char *data)
+{
+    node_window_summary_t summary;
+    int values[6];
+    int i, count, len=2;
+
+    if(node_window_summary(window, &summary)!=0)
+        return 0;
+
+    values[0]=(summary.count>0xffff)?0xffff:summary.count;
+    values[1]=summary.min;
+    values[2]=summary.max;
+    values[3]=summary.mean;
+    values[4]=(summary.deviation>0xffff)?0xffff:summary.deviation;
+    values[5]=summary.quantile;
+    count=(window->quantile>0.0f)?6:5;
+
+    data[0]=type|NODE_WINDOW_TLV_SUMMARY;
+    data[1]=count*2;
+    for(i=0; i<count; i++)
+    {
+        data[len++]=(values[i]>>8)&0xff;
+        data[len++]=values[i]&0xff;
+    }
+    return len;
+}
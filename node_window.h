@@ -0,0 +1,93 @@
+/**
+ * @file node_window.h
+ *
+ * @brief Summary of the sensor samples of a report window
+ *
+ * Each sample read between two reports is folded into its channel window in
+ * constant time and memory: the count, the minimum and maximum, the mean and
+ * variance by Welford's method, and optionally a quantile by the P-square
+ * algorithm of Jain and Chlamtac, which keeps 5 markers instead of the
+ * samples. The mean is kept from the first sample, so that the single
+ * precision of the FPU goes to the variations of the samples rather than to
+ * their level. At the report, the summary of the window goes out as a TLV of
+ * the channel type with NODE_WINDOW_TLV_SUMMARY set, of 16-bit big endian
+ * values in the units of the channel TLV:
+ *
+ *     type|0x80  length  count  min  max  mean  deviation  [quantile]
+ *
+ * The count saturates at 65535 and the deviation is the standard deviation
+ * of the samples of the window.
+ *
+ * @author AdvanWISE
+*/
+
+#ifndef NODE_WINDOW_H
+#define NODE_WINDOW_H
+
+#define NODE_WINDOW_TLV_SUMMARY     0x80    ///< Set in the TLV type of a summary
+#define NODE_WINDOW_TLV_SIZE        14      ///< Largest summary TLV, with the quantile
+
+/** @brief Window of a channel */
+typedef struct
+{
+    unsigned int count;             ///< Number of samples
+    int min;
+    int max;
+    int first;                      ///< First sample, the origin of the mean
+    float mean;                     ///< Mean from the first sample
+    float m2;                       ///< Sum of the squared differences from the mean
+    float quantile;                 ///< Quantile estimated, 0 for none
+    float heights[5];               ///< P-square markers, the first samples until there are 5
+    int positions[5];
+    float desired[5];
+} node_window_t;
+
+/** @brief Summary of a window */
+typedef struct
+{
+    unsigned int count;
+    int min;
+    int max;
+    int mean;                       ///< Rounded mean
+    unsigned int deviation;         ///< Rounded standard deviation
+    int quantile;                   ///< Rounded quantile, 0 if none is estimated
+} node_window_summary_t;
+
+/** @brief Set up a window
+ *
+ *  @param window window of a channel
+ *  @param quantile quantile to estimate in percent, 1 to 99, or 0 for none
+ */
+void node_window_init(node_window_t *window, int quantile);
+
+/** @brief Start the next window, keeping the quantile
+ *
+ *  @param window window of a channel
+ */
+void node_window_reset(node_window_t *window);
+
+/** @brief Fold a sample into a window
+ *
+ *  @param window window of a channel
+ *  @param value sample, in the units of the channel TLV
+ */
+void node_window_add(node_window_t *window, int value);
+
+/** @brief Get the summary of a window
+ *
+ *  @param window window of a channel
+ *  @param summary filled with the summary
+ *  @returns 0 on success, -1 if the window has no sample
+ */
+int node_window_summary(const node_window_t *window, node_window_summary_t *summary);
+
+/** @brief Write the summary TLV of a window
+ *
+ *  @param type TLV type of the channel
+ *  @param window window of a channel
+ *  @param data buffer of NODE_WINDOW_TLV_SIZE bytes, filled with the TLV
+ *  @returns length of the TLV, 0 if the window has no sample
+ */
+int node_window_tlv(unsigned char type, const node_window_t *window, char *data);
+
+#endif /* NODE_WINDOW_H */